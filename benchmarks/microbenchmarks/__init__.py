@@ -1,17 +1,59 @@
 from .atomic_ops import AtomicOpsPlan
+from .block_range_for import BlockRangeForPlan
+from .cache_compression import CacheCompressionPlan
+from .cache_startup import CacheStartupPlan
+from .compile_large_kernel import CompileLargeKernelPlan
+from .compile_warmup import CompileWarmupPlan
+from .dynamic_list import DynamicListPlan
 from .fill import FillPlan
+from .graph_replay import GraphReplayPlan
+from .iterative_solver import IterativeSolverPlan
+from .kernel_link import KernelLinkPlan
+from .launch_overhead import LaunchOverheadPlan
+from .loop_schedule import LoopSchedulePlan
 from .math_opts import MathOpsPlan
 from .matrix_ops import MatrixOpsPlan
 from .memcpy import MemcpyPlan
+from .ndarray_churn import NdarrayChurnPlan
+from .reduction import ReductionPlan
 from .saxpy import SaxpyPlan
+from .simd_struct_for import SimdStructForPlan
+from .sparse_activation import SparseActivationPlan
+from .sparse_assembly import SparseAssemblyPlan
+from .sparse_gc import SparseGCPlan
+from .sparse_spmv import SparseSpmvPlan
 from .stencil2d import Stencil2DPlan
+from .stream_dense import StreamDensePlan
+from .thread_pool import ThreadPoolPlan
+from .timeline import TimelinePlan
 
 benchmark_plan_list = [
     AtomicOpsPlan,
+    BlockRangeForPlan,
+    CacheCompressionPlan,
+    CacheStartupPlan,
+    CompileLargeKernelPlan,
+    CompileWarmupPlan,
+    DynamicListPlan,
     FillPlan,
+    GraphReplayPlan,
+    IterativeSolverPlan,
+    KernelLinkPlan,
+    LaunchOverheadPlan,
+    LoopSchedulePlan,
     MathOpsPlan,
     MatrixOpsPlan,
     MemcpyPlan,
+    NdarrayChurnPlan,
+    ReductionPlan,
     SaxpyPlan,
+    SimdStructForPlan,
+    SparseActivationPlan,
+    SparseAssemblyPlan,
+    SparseGCPlan,
+    SparseSpmvPlan,
     Stencil2DPlan,
+    StreamDensePlan,
+    ThreadPoolPlan,
+    TimelinePlan,
 ]
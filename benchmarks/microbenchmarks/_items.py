@@ -5,6 +5,9 @@ import taichi as ti
 
 class BenchmarkItem:
     name = "item"
+    # If True, the implementation of the selected tag is also passed to
+    # ti.init() as the keyword argument `name`.
+    init_option = False
 
     def __init__(self):
         self._items = {}  # {'tag': impl, ...}
@@ -114,3 +117,35 @@ class AtomicOps(BenchmarkItem):
             return False
         else:
             return True
+
+
+class CpuThreadPool(BenchmarkItem):
+    name = "cpu_thread_pool"
+    init_option = True
+
+    def __init__(self):
+        self._items = {"default": "default", "work_stealing": "work_stealing"}
+
+
+class CpuBlockRangeFor(BenchmarkItem):
+    name = "cpu_block_range_for"
+    init_option = True
+
+    def __init__(self):
+        self._items = {"per_iteration": False, "per_block": True}
+
+
+class CpuLoopSchedule(BenchmarkItem):
+    name = "cpu_loop_schedule"
+    init_option = True
+
+    def __init__(self):
+        self._items = {"static": "static", "dynamic": "dynamic", "guided": "guided"}
+
+
+class SimdWidth(BenchmarkItem):
+    name = "simd_width"
+    init_option = True
+
+    def __init__(self):
+        self._items = {"scalar": 1, "simd": 8}
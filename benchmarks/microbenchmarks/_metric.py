@@ -37,11 +37,11 @@ class MetricType(BenchmarkItem):
         }
 
     @staticmethod
-    def init_taichi(arch: str, tag_list: list):
+    def init_taichi(arch: str, tag_list: list, **init_options):
         if set(["kernel_elapsed_time_ms"]).issubset(tag_list):
-            ti.init(kernel_profiler=True, arch=get_ti_arch(arch))
+            ti.init(kernel_profiler=True, arch=get_ti_arch(arch), **init_options)
         elif set(["end2end_time_ms"]).issubset(tag_list):
-            ti.init(kernel_profiler=False, arch=get_ti_arch(arch))
+            ti.init(kernel_profiler=False, arch=get_ti_arch(arch), **init_options)
         else:
             return False
         return True
@@ -22,6 +22,9 @@ class Funcs:
 
 
 class BenchmarkPlan:
+    # None: the plan runs on every arch enabled in the suite
+    archs = None
+
     def __init__(self, name="plan", arch="x64", basic_repeat_times=1):
         self.name = name
         self.arch = arch
@@ -48,7 +51,7 @@ class BenchmarkPlan:
     def run(self):
         for case, plan in self.plan.items():
             tag_list = plan["tags"]
-            MetricType.init_taichi(self.arch, tag_list)
+            MetricType.init_taichi(self.arch, tag_list, **self._get_init_options(tag_list))
             _ms = self.funcs.get_func(tag_list)(self.arch, self.basic_repeat_times, **self._get_kwargs(tag_list))
             plan["result"] = _ms
             print(f"{tag_list}={_ms}")
@@ -63,6 +66,13 @@ class BenchmarkPlan:
             kwargs[item.name] = item.impl(tag) if impl == True else tag
         return kwargs
 
+    def _get_init_options(self, tags):
+        options = {}
+        for item, tag in zip(self.items.values(), tags[1:]):
+            if item.init_option:
+                options[item.name] = item.impl(tag)
+        return options
+
     def _remove_conflict_items(self):
         remove_list = []
         # logical_atomic with float_type
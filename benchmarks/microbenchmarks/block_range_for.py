@@ -0,0 +1,67 @@
+from microbenchmarks._items import BenchmarkItem, CpuBlockRangeFor, DataType
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class DenseWorkload(BenchmarkItem):
+    name = "workload"
+
+    def __init__(self):
+        self._items = {"saxpy": None, "stencil_1d": None, "stencil_2d": None}
+
+
+def saxpy(arch, repeat, cpu_block_range_for, workload, dtype, get_metric):
+    n = 16 * 1024 * 1024
+    x = ti.ndarray(dtype, shape=n)
+    y = ti.ndarray(dtype, shape=n)
+
+    @ti.kernel
+    def saxpy_kernel(a: dtype, x: ti.types.ndarray(), y: ti.types.ndarray()):
+        for i in range(x.shape[0]):
+            y[i] = a * x[i] + y[i]
+
+    x.fill(1.0)
+    return get_metric(repeat, saxpy_kernel, 2.0, x, y)
+
+
+def stencil_1d(arch, repeat, cpu_block_range_for, workload, dtype, get_metric):
+    n = 16 * 1024 * 1024
+    x = ti.ndarray(dtype, shape=n)
+    y = ti.ndarray(dtype, shape=n)
+
+    @ti.kernel
+    def stencil_kernel(x: ti.types.ndarray(), y: ti.types.ndarray()):
+        for i in range(1, x.shape[0] - 1):
+            y[i] = 0.25 * x[i - 1] + 0.5 * x[i] + 0.25 * x[i + 1]
+
+    x.fill(1.0)
+    return get_metric(repeat, stencil_kernel, x, y)
+
+
+def stencil_2d(arch, repeat, cpu_block_range_for, workload, dtype, get_metric):
+    n = 4096
+    x = ti.field(dtype, shape=(n, n))
+    y = ti.field(dtype, shape=(n, n))
+
+    @ti.kernel
+    def stencil_kernel():
+        for i, j in ti.ndrange((1, n - 1), (1, n - 1)):
+            y[i, j] = 0.2 * (x[i, j] + x[i - 1, j] + x[i + 1, j] + x[i, j - 1] + x[i, j + 1])
+
+    x.fill(1.0)
+    return get_metric(repeat, stencil_kernel)
+
+
+class BlockRangeForPlan(BenchmarkPlan):
+    archs = ["x64"]
+
+    def __init__(self, arch: str):
+        super().__init__("block_range_for", arch, basic_repeat_times=10)
+        dtype = DataType()
+        dtype.remove_integer()
+        self.create_plan(CpuBlockRangeFor(), DenseWorkload(), dtype, MetricType())
+        self.add_func(["saxpy"], saxpy)
+        self.add_func(["stencil_1d"], stencil_1d)
+        self.add_func(["stencil_2d"], stencil_2d)
@@ -0,0 +1,98 @@
+import os
+import shutil
+from tempfile import mkdtemp
+
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._plan import BenchmarkPlan
+from microbenchmarks._utils import End2EndTimer, get_ti_arch
+
+import taichi as ti
+
+num_kernels = 64
+
+
+class CacheEncoding(BenchmarkItem):
+    name = "cache_encoding"
+
+    def __init__(self):
+        # (offline_cache_compression, offline_cache_dedup)
+        self._items = {
+            "raw": (False, False),
+            "compressed": (True, False),
+            "dedup": (False, True),
+            "compressed_dedup": (True, True),
+        }
+
+
+class CacheMeasure(BenchmarkItem):
+    name = "measure"
+
+    def __init__(self):
+        self._items = {"cache_size_kb": None, "load_time_ms": None}
+
+
+def _make_kernel(c):
+    @ti.kernel
+    def k(x: ti.types.ndarray(dtype=ti.f32, ndim=1)):
+        for i in x:
+            x[i] = ti.sin(x[i] * c) + ti.sqrt(ti.abs(x[i] - c))
+
+    return k
+
+
+def _with_populated_cache(arch, cache_encoding, measure):
+    compression, dedup = cache_encoding
+    cache_path = mkdtemp()
+    kernels = [_make_kernel(float(i)) for i in range(num_kernels)]
+
+    def init_and_run_all():
+        ti.init(
+            arch=get_ti_arch(arch),
+            offline_cache=True,
+            offline_cache_file_path=cache_path,
+            offline_cache_compression=compression,
+            offline_cache_dedup=dedup,
+        )
+        x = ti.ndarray(ti.f32, shape=16)
+        for k in kernels:
+            k(x)
+        ti.sync()
+
+    try:
+        # ti.reset() writes the cache to disk.
+        init_and_run_all()
+        ti.reset()
+        return measure(cache_path, init_and_run_all)
+    finally:
+        ti.reset()
+        shutil.rmtree(cache_path, ignore_errors=True)
+
+
+def cache_size(arch, repeat, cache_encoding, measure):
+    def get_size(cache_path, init_and_run_all):
+        size = 0
+        for root, _, files in os.walk(cache_path):
+            size += sum(os.path.getsize(os.path.join(root, f)) for f in files)
+        return size / 1024  # KB
+
+    return _with_populated_cache(arch, cache_encoding, get_size)
+
+
+def load_time(arch, repeat, cache_encoding, measure):
+    def time_loading(cache_path, init_and_run_all):
+        timer = End2EndTimer()
+        timer.tick()
+        init_and_run_all()
+        return timer.tock() * 1000  # ms
+
+    return _with_populated_cache(arch, cache_encoding, time_loading)
+
+
+class CacheCompressionPlan(BenchmarkPlan):
+    archs = ["x64", "cuda"]
+
+    def __init__(self, arch: str):
+        super().__init__("cache_compression", arch, basic_repeat_times=1)
+        self.create_plan(CacheEncoding(), CacheMeasure())
+        self.add_func(["cache_size_kb"], cache_size)
+        self.add_func(["load_time_ms"], load_time)
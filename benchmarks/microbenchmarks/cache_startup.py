@@ -0,0 +1,88 @@
+import shutil
+from tempfile import mkdtemp
+
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import end2end_executor
+from microbenchmarks._plan import BenchmarkPlan
+from microbenchmarks._utils import End2EndTimer, get_ti_arch
+
+import taichi as ti
+
+
+class CacheFormat(BenchmarkItem):
+    name = "cache_format"
+
+    def __init__(self):
+        self._items = {"files": "files", "pack": "pack"}
+
+
+class Startup(BenchmarkItem):
+    name = "startup"
+
+    def __init__(self):
+        self._items = {"cold": False, "warm": True}
+
+
+class KernelCount(BenchmarkItem):
+    name = "kernel_count"
+
+    def __init__(self):
+        self._items = {f"kernels_{n}": n for n in [16, 64, 256]}
+
+
+class StartupMetric(BenchmarkItem):
+    name = "get_metric"
+
+    def __init__(self):
+        # The time is measured by the case itself, from ti.init() to every
+        # kernel being ready.
+        self._items = {"end2end_time_ms": end2end_executor}
+
+
+def _make_kernel(c):
+    @ti.kernel
+    def k(x: ti.types.ndarray(dtype=ti.f32, ndim=1)):
+        for i in x:
+            x[i] = ti.sin(x[i] * c) + ti.sqrt(ti.abs(x[i] - c))
+
+    return k
+
+
+def cache_startup(arch, repeat, cache_format, startup, kernel_count, get_metric):
+    cache_path = mkdtemp()
+    kernels = [_make_kernel(float(i)) for i in range(kernel_count)]
+
+    def init_and_run_all():
+        ti.init(
+            arch=get_ti_arch(arch),
+            offline_cache=True,
+            offline_cache_file_path=cache_path,
+            offline_cache_format=cache_format,
+        )
+        x = ti.ndarray(ti.f32, shape=16)
+        for k in kernels:
+            k(x)
+        ti.sync()
+
+    try:
+        if startup:
+            # Populate the cache, which ti.reset() writes to disk.
+            init_and_run_all()
+            ti.reset()
+        timer = End2EndTimer()
+        timer.tick()
+        init_and_run_all()
+        return timer.tock() * 1000  # ms
+    finally:
+        ti.reset()
+        shutil.rmtree(cache_path, ignore_errors=True)
+
+
+class CacheStartupPlan(BenchmarkPlan):
+    archs = ["x64", "cuda"]
+
+    def __init__(self, arch: str):
+        super().__init__("cache_startup", arch, basic_repeat_times=1)
+        self.create_plan(CacheFormat(), Startup(), KernelCount(), StartupMetric())
+        self.add_func(["files"], cache_startup)
+        self.add_func(["pack"], cache_startup)
@@ -0,0 +1,122 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import end2end_executor
+from microbenchmarks._plan import BenchmarkPlan
+from microbenchmarks._utils import End2EndTimer
+
+import taichi as ti
+from taichi.lang import impl
+
+
+class KernelSize(BenchmarkItem):
+    name = "kernel_size"
+
+    def __init__(self):
+        # Number of unrolled iterations, of about eight statements each
+        self._items = {f"unroll_{n}": n for n in [256, 1024, 2560]}
+
+
+class KernelShape(BenchmarkItem):
+    name = "kernel_shape"
+
+    def __init__(self):
+        # "chain": each iteration depends on the previous one.
+        # "independent": the iterations only share loads and stores, so that
+        # most rewrites of the simplification passes stay local.
+        # "local_vars": a local variable stored in a branch per iteration, so
+        # that the dataflow analyses of the CFG optimization see thousands of
+        # nodes, allocas and stores.
+        self._items = {
+            "chain": "chain",
+            "independent": "independent",
+            "local_vars": "local_vars",
+        }
+
+
+class OfflineCache(BenchmarkItem):
+    name = "offline_cache"
+    init_option = True
+
+    def __init__(self):
+        self._items = {"cold": False}
+
+
+class CompileMetric(BenchmarkItem):
+    name = "get_metric"
+
+    def __init__(self):
+        # The kernel is only compiled once, so the time is measured by the case
+        # itself.
+        self._items = {"end2end_time_ms": end2end_executor}
+
+
+def _make_chain_kernel(n):
+    @ti.kernel
+    def k(x: ti.types.ndarray(dtype=ti.f32, ndim=1)):
+        for i in x:
+            v = x[i]
+            for j in ti.static(range(n)):
+                # Redundant casts, identities and common subexpressions for
+                # the simplification passes
+                w = ti.cast(ti.cast(v, ti.f64), ti.f32) * 1.0
+                v = w + x[i] * (j % 7) + (x[i] * (j % 7) - v * 0)
+            x[i] = v
+
+    return k
+
+
+def _make_independent_kernel(n):
+    @ti.kernel
+    def k(x: ti.types.ndarray(dtype=ti.f32, ndim=1), y: ti.types.ndarray(dtype=ti.i32, ndim=1)):
+        for i in x:
+            for j in ti.static(range(n)):
+                # Foldable integer arithmetic and identities, independent of
+                # the other iterations
+                t = (y[i] * 4 + j) - j
+                y[i] = t // 4 + (j * 3 - j * 3) + y[i] * 0
+                x[i] += ti.cast(y[i], ti.f32) * 1.0
+
+    return k
+
+
+def _make_local_vars_kernel(n):
+    @ti.kernel
+    def k(x: ti.types.ndarray(dtype=ti.f32, ndim=1), y: ti.types.ndarray(dtype=ti.i32, ndim=1)):
+        for i in x:
+            acc = 0.0
+            for j in ti.static(range(n)):
+                v = x[i] * j
+                if y[i] > j:
+                    v += 1.0
+                acc += v
+            x[i] = acc
+
+    return k
+
+
+def compile_large_kernel(arch, repeat, kernel_size, kernel_shape, offline_cache, get_metric):
+    x = ti.ndarray(ti.f32, shape=1024)
+    y = ti.ndarray(ti.i32, shape=1024)
+    # Transforming the Python AST is left out of the measured time.
+    if kernel_shape == "chain":
+        kernel = _make_chain_kernel(kernel_size)._primal
+        key = kernel.ensure_compiled(x)
+    else:
+        make_kernel = _make_independent_kernel if kernel_shape == "independent" else _make_local_vars_kernel
+        kernel = make_kernel(kernel_size)._primal
+        key = kernel.ensure_compiled(x, y)
+    t_kernel = kernel.compiled_kernels[key]
+
+    prog = impl.get_runtime().prog
+    timer = End2EndTimer()
+    timer.tick()
+    prog.compile_kernels(prog.config(), prog.get_device_caps(), [t_kernel])
+    return timer.tock() * 1000  # ms
+
+
+class CompileLargeKernelPlan(BenchmarkPlan):
+    archs = ["x64", "cuda"]
+
+    def __init__(self, arch: str):
+        super().__init__("compile_large_kernel", arch, basic_repeat_times=1)
+        self.create_plan(KernelSize(), KernelShape(), OfflineCache(), CompileMetric())
+        self.add_func(["cold"], compile_large_kernel)
@@ -0,0 +1,65 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import end2end_executor
+from microbenchmarks._plan import BenchmarkPlan
+from microbenchmarks._utils import End2EndTimer
+
+import taichi as ti
+
+num_kernels = 100
+
+
+class NumCompileThreads(BenchmarkItem):
+    name = "num_compile_threads"
+    init_option = True
+
+    def __init__(self):
+        self._items = {f"threads_{n}": n for n in [1, 2, 4, 8]}
+
+
+class OfflineCache(BenchmarkItem):
+    name = "offline_cache"
+    init_option = True
+
+    def __init__(self):
+        # Every case must start from a cold cache.
+        self._items = {"cold": False}
+
+
+class WarmupMetric(BenchmarkItem):
+    name = "get_metric"
+
+    def __init__(self):
+        # Each kernel is only compiled once, so there is no warm-up run and
+        # the time is measured by the case itself.
+        self._items = {"end2end_time_ms": end2end_executor}
+
+
+def _make_kernel(c):
+    @ti.kernel
+    def k(x: ti.types.ndarray(dtype=ti.f32, ndim=1)):
+        for i in x:
+            x[i] = ti.sin(x[i] * c) + ti.sqrt(ti.abs(x[i] - c))
+        for i in x:
+            x[i] = ti.atomic_max(x[(i + 1) % x.shape[0]], x[i])
+
+    return k
+
+
+def cold_warmup(arch, repeat, num_compile_threads, offline_cache, get_metric):
+    x = ti.ndarray(ti.f32, shape=1024)
+    kernels = [(_make_kernel(float(i)), (x,)) for i in range(num_kernels)]
+    # Transforming the Python ASTs stays serial and is included, as it is
+    # part of the warm-up users see.
+    timer = End2EndTimer()
+    timer.tick()
+    ti.compile_kernels(kernels)
+    return timer.tock() * 1000  # ms
+
+
+class CompileWarmupPlan(BenchmarkPlan):
+    archs = ["x64", "cuda"]
+
+    def __init__(self, arch: str):
+        super().__init__("compile_warmup", arch, basic_repeat_times=1)
+        self.create_plan(NumCompileThreads(), OfflineCache(), WarmupMetric())
+        self.add_func(["cold"], cold_warmup)
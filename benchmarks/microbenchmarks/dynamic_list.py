@@ -0,0 +1,70 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class DynamicListOps(BenchmarkItem):
+    name = "list_op"
+
+    def __init__(self):
+        self._items = {"append": None, "random_read": None}
+
+
+class ListLength(BenchmarkItem):
+    name = "list_length"
+
+    def __init__(self):
+        self._items = {"64K": 64 * 1024, "1M": 1024 * 1024, "16M": 16 * 1024 * 1024}
+
+
+def _make_lists(list_length):
+    num_lists = 8
+    chunk_size = 1024
+    x = ti.field(ti.i32)
+    lists = ti.root.dense(ti.i, num_lists).dynamic(ti.j, list_length, chunk_size=chunk_size)
+    lists.place(x)
+
+    @ti.kernel
+    def append():
+        for i in range(num_lists):
+            for j in range(list_length):
+                x[i].append(j)
+
+    return x, lists, num_lists, append
+
+
+def dynamic_append(arch, repeat, list_op, list_length, get_metric):
+    x, lists, num_lists, append = _make_lists(list_length)
+
+    def append_deactivate():
+        append()
+        lists.deactivate_all()
+
+    return get_metric(repeat, append_deactivate)
+
+
+def dynamic_random_read(arch, repeat, list_op, list_length, get_metric):
+    x, lists, num_lists, append = _make_lists(list_length)
+    append()
+    num_reads = 1024 * 1024
+
+    @ti.kernel
+    def random_read() -> ti.i32:
+        s = 0
+        for k in range(num_reads):
+            i = k % num_lists
+            j = ti.cast(ti.random() * list_length, ti.i32)
+            s += x[i, j]
+        return s
+
+    return get_metric(repeat, random_read)
+
+
+class DynamicListPlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__("dynamic_list", arch, basic_repeat_times=10)
+        self.create_plan(DynamicListOps(), ListLength(), MetricType())
+        self.add_func(["append"], dynamic_append)
+        self.add_func(["random_read"], dynamic_random_read)
@@ -0,0 +1,54 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+num_dispatches = 50
+
+
+class ReplayMode(BenchmarkItem):
+    name = "replay"
+
+    def __init__(self):
+        self._items = {"run": None, "bound": None}
+
+
+def _build_graph():
+    # A chain of tiny kernels, so that the graph launch is all there is.
+    @ti.kernel
+    def step(x: ti.types.ndarray(dtype=ti.f32, ndim=1), y: ti.types.ndarray(dtype=ti.f32, ndim=1), alpha: ti.f32):
+        for i in x:
+            y[i] += alpha * x[i]
+
+    sym_x = ti.graph.Arg(ti.graph.ArgKind.NDARRAY, "x", ti.f32, ndim=1)
+    sym_y = ti.graph.Arg(ti.graph.ArgKind.NDARRAY, "y", ti.f32, ndim=1)
+    sym_alpha = ti.graph.Arg(ti.graph.ArgKind.SCALAR, "alpha", ti.f32)
+    builder = ti.graph.GraphBuilder()
+    for i in range(num_dispatches):
+        if i % 2 == 0:
+            builder.dispatch(step, sym_x, sym_y, sym_alpha)
+        else:
+            builder.dispatch(step, sym_y, sym_x, sym_alpha)
+    return builder.compile()
+
+
+def graph_run(arch, repeat, replay, get_metric):
+    graph = _build_graph()
+    args = {"x": ti.ndarray(ti.f32, shape=16), "y": ti.ndarray(ti.f32, shape=16), "alpha": 0.5}
+    return get_metric(repeat, graph.run, args)
+
+
+def graph_bound(arch, repeat, replay, get_metric):
+    graph = _build_graph()
+    args = {"x": ti.ndarray(ti.f32, shape=16), "y": ti.ndarray(ti.f32, shape=16), "alpha": 0.5}
+    bound = graph.bind(args)
+    return get_metric(repeat, bound.run)
+
+
+class GraphReplayPlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__("graph_replay", arch, basic_repeat_times=1000)
+        self.create_plan(ReplayMode(), MetricType())
+        self.add_func(["run"], graph_run)
+        self.add_func(["bound"], graph_bound)
@@ -0,0 +1,87 @@
+from microbenchmarks._items import BenchmarkItem, DataType
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class SolverImpl(BenchmarkItem):
+    name = "solver"
+
+    def __init__(self):
+        # "sparse_cg" is the Eigen-based SparseCG, the others are
+        # IterativeSolver configurations as (method, preconditioner).
+        self._items = {
+            "sparse_cg": ("sparse_cg", None),
+            "cg": ("cg", None),
+            "cg_jacobi": ("cg", "jacobi"),
+            "cg_ic0": ("cg", "ic0"),
+            "bicgstab_jacobi": ("bicgstab", "jacobi"),
+        }
+
+
+class GridSize(BenchmarkItem):
+    name = "grid_size"
+
+    def __init__(self):
+        self._items = {f"grid_{n}": n for n in [128, 512]}
+
+
+def iterative_solve(arch, repeat, solver, grid_size, dtype, get_metric):
+    # The 2D Poisson problem, solved to a relative residual of 1e-6
+    method, preconditioner = solver
+    n = grid_size * grid_size
+    builder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=5 * n, dtype=dtype)
+    b = ti.ndarray(dtype, n)
+    x = ti.ndarray(dtype, n)
+
+    @ti.kernel
+    def fill(builder: ti.types.sparse_matrix_builder(), b: ti.types.ndarray()):
+        for i, j in ti.ndrange(grid_size, grid_size):
+            row = i * grid_size + j
+            builder[row, row] += 4.0
+            if i > 0:
+                builder[row, row - grid_size] += -1.0
+            if i < grid_size - 1:
+                builder[row, row + grid_size] += -1.0
+            if j > 0:
+                builder[row, row - 1] += -1.0
+            if j < grid_size - 1:
+                builder[row, row + 1] += -1.0
+            b[row] = 1.0
+
+    fill(builder, b)
+    A = builder.build(dtype=dtype)
+    max_iter = 4 * grid_size
+    if method == "sparse_cg":
+
+        def func():
+            x.fill(0)
+            cg = ti.linalg.SparseCG(A, b, x, max_iter=max_iter, atol=1e-6)
+            cg.solve()
+
+    else:
+        it_solver = ti.linalg.IterativeSolver(
+            method=method, preconditioner=preconditioner, max_iter=max_iter, rtol=1e-6
+        )
+        it_solver.compute(A)
+
+        def func():
+            x.fill(0)
+            it_solver.solve(b, x)
+
+    return get_metric(repeat, func)
+
+
+class IterativeSolverPlan(BenchmarkPlan):
+    # Eigen sparse matrices only live on CPUs.
+    archs = ["x64"]
+
+    def __init__(self, arch: str):
+        super().__init__("iterative_solver", arch, basic_repeat_times=2)
+        dtype = DataType()
+        dtype.remove_integer()
+        metric = MetricType()
+        metric.remove(["kernel_elapsed_time_ms"])
+        self.create_plan(SolverImpl(), GridSize(), dtype, metric)
+        self.add_func(["end2end_time_ms"], iterative_solve)
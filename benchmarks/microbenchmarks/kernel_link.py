@@ -0,0 +1,81 @@
+import resource
+import sys
+
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._plan import BenchmarkPlan
+from microbenchmarks._utils import End2EndTimer, get_ti_arch
+
+import taichi as ti
+
+num_kernels = 500
+
+
+class LinkMeasure(BenchmarkItem):
+    name = "measure"
+
+    def __init__(self):
+        self._items = {
+            "compile_time_ms_per_kernel": None,
+            "rss_kb_per_kernel": None,
+        }
+
+
+def _make_kernel(c):
+    @ti.kernel
+    def k(x: ti.types.ndarray(dtype=ti.f32, ndim=1)):
+        for i in x:
+            x[i] = x[i] * c + 1.0
+
+    return k
+
+
+def _max_rss_kb():
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # ru_maxrss is in bytes on macOS, and in KB elsewhere.
+    return rss / 1024 if sys.platform == "darwin" else rss
+
+
+def _compile_all(arch, measure):
+    ti.init(arch=get_ti_arch(arch), offline_cache=False)
+    try:
+        x = ti.ndarray(ti.f32, shape=16)
+        kernels = [_make_kernel(float(i)) for i in range(num_kernels)]
+        # Warm up the runtime so that only the kernels are measured.
+        _make_kernel(-1.0)(x)
+        ti.sync()
+        return measure(x, kernels) / num_kernels
+    finally:
+        ti.reset()
+
+
+def compile_time(arch, repeat, measure):
+    def time_compiling(x, kernels):
+        timer = End2EndTimer()
+        timer.tick()
+        for k in kernels:
+            k(x)
+        ti.sync()
+        return timer.tock() * 1000  # ms
+
+    return _compile_all(arch, time_compiling)
+
+
+def rss_growth(arch, repeat, measure):
+    def rss_compiling(x, kernels):
+        rss = _max_rss_kb()
+        for k in kernels:
+            k(x)
+        ti.sync()
+        return _max_rss_kb() - rss
+
+    return _compile_all(arch, rss_compiling)
+
+
+class KernelLinkPlan(BenchmarkPlan):
+    archs = ["x64", "cuda"]
+
+    def __init__(self, arch: str):
+        super().__init__("kernel_link", arch, basic_repeat_times=1)
+        self.create_plan(LinkMeasure())
+        self.add_func(["compile_time_ms_per_kernel"], compile_time)
+        self.add_func(["rss_kb_per_kernel"], rss_growth)
@@ -0,0 +1,79 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class KernelArgs(BenchmarkItem):
+    name = "kernel_args"
+
+    def __init__(self):
+        self._items = {"scalar": None, "ndarray": None, "argpack": None}
+
+
+# Empty kernels with a dozen arguments, so that the launch is all there is.
+def scalar_args(arch, repeat, kernel_args, get_metric):
+    @ti.kernel
+    def k(
+        a0: ti.i32,
+        a1: ti.i32,
+        a2: ti.i32,
+        a3: ti.i32,
+        a4: ti.i32,
+        a5: ti.i32,
+        a6: ti.f32,
+        a7: ti.f32,
+        a8: ti.f32,
+        a9: ti.f32,
+        a10: ti.f32,
+        a11: ti.f32,
+    ):
+        pass
+
+    return get_metric(repeat, k, 0, 1, 2, 3, 4, 5, 0.0, 1.0, 2.0, 3.0, 4.0, 5.0)
+
+
+def ndarray_args(arch, repeat, kernel_args, get_metric):
+    arrs = [ti.ndarray(ti.f32, shape=16) for _ in range(12)]
+    arr_t = ti.types.ndarray(dtype=ti.f32, ndim=1)
+
+    @ti.kernel
+    def k(
+        a0: arr_t,
+        a1: arr_t,
+        a2: arr_t,
+        a3: arr_t,
+        a4: arr_t,
+        a5: arr_t,
+        a6: arr_t,
+        a7: arr_t,
+        a8: arr_t,
+        a9: arr_t,
+        a10: arr_t,
+        a11: arr_t,
+    ):
+        pass
+
+    return get_metric(repeat, k, *arrs)
+
+
+def argpack_args(arch, repeat, kernel_args, get_metric):
+    pack_t = ti.types.argpack(**{f"x{i}": ti.f32 for i in range(6)})
+    packs = [pack_t(**{f"x{i}": float(i) for i in range(6)}) for _ in range(2)]
+
+    @ti.kernel
+    def k(p0: pack_t, p1: pack_t):
+        pass
+
+    return get_metric(repeat, k, *packs)
+
+
+class LaunchOverheadPlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        # A launch takes microseconds, so use many of them.
+        super().__init__("launch_overhead", arch, basic_repeat_times=10000)
+        self.create_plan(KernelArgs(), MetricType())
+        self.add_func(["scalar"], scalar_args)
+        self.add_func(["ndarray"], ndarray_args)
+        self.add_func(["argpack"], argpack_args)
@@ -0,0 +1,68 @@
+from microbenchmarks._items import BenchmarkItem, CpuLoopSchedule
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class LoopScheduleWorkload(BenchmarkItem):
+    name = "workload"
+
+    def __init__(self):
+        self._items = {"uniform": None, "triangular": None, "sparse_hot": None}
+
+
+def uniform(arch, repeat, cpu_loop_schedule, workload, get_metric):
+    n = 16 * 1024 * 1024
+    x = ti.field(ti.f32, shape=n)
+
+    @ti.kernel
+    def saxpy(x: ti.template()):
+        for i in range(n):
+            x[i] = x[i] * 0.5 + 1.0
+
+    return get_metric(repeat, saxpy, x)
+
+
+def triangular(arch, repeat, cpu_loop_schedule, workload, get_metric):
+    n = 8 * 1024
+    x = ti.field(ti.f32, shape=n)
+
+    # Iteration i costs O(i): the last thread of an even split gets most work.
+    @ti.kernel
+    def prefix(x: ti.template()):
+        for i in range(n):
+            s = 0.0
+            for j in range(i):
+                s += ti.sin(ti.cast(j, ti.f32))
+            x[i] = s
+
+    return get_metric(repeat, prefix, x)
+
+
+def sparse_hot(arch, repeat, cpu_loop_schedule, workload, get_metric):
+    n = 1024 * 1024
+    x = ti.field(ti.f32, shape=n)
+
+    # One iteration in 1024 is 1000x as expensive as the others.
+    @ti.kernel
+    def hot_spots(x: ti.template()):
+        for i in range(n):
+            s = 0.0
+            if i % 1024 == 0:
+                for j in range(1000):
+                    s += ti.sin(ti.cast(j, ti.f32))
+            x[i] = s
+
+    return get_metric(repeat, hot_spots, x)
+
+
+class LoopSchedulePlan(BenchmarkPlan):
+    archs = ["x64"]
+
+    def __init__(self, arch: str):
+        super().__init__("loop_schedule", arch, basic_repeat_times=10)
+        self.create_plan(CpuLoopSchedule(), LoopScheduleWorkload(), MetricType())
+        self.add_func(["uniform"], uniform)
+        self.add_func(["triangular"], triangular)
+        self.add_func(["sparse_hot"], sparse_hot)
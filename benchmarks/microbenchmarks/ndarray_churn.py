@@ -0,0 +1,74 @@
+from microbenchmarks._items import BenchmarkItem, DataSize
+from microbenchmarks._metric import end2end_executor
+from microbenchmarks._plan import BenchmarkPlan
+from microbenchmarks._utils import get_ti_arch
+
+import taichi as ti
+
+num_temporaries = 4
+
+
+class ChurnMetric(BenchmarkItem):
+    name = "get_metric"
+
+    def __init__(self):
+        self._items = {
+            "end2end_time_ms": end2end_executor,
+            "cache_hit_rate": None,
+            "peak_mb": None,
+        }
+
+
+def _make_step(n):
+    @ti.kernel
+    def step(x: ti.types.ndarray(ndim=1), tmp: ti.types.ndarray(ndim=1)):
+        for i in x:
+            tmp[i] = x[i] * 0.5
+        for i in x:
+            x[i] = tmp[i] + 1.0
+
+    def run(x):
+        # Temporaries are created and dropped every step.
+        for _ in range(num_temporaries):
+            tmp = ti.ndarray(ti.f32, shape=n)
+            step(x, tmp)
+            del tmp
+        ti.sync()
+
+    return run
+
+
+def churn_time(arch, repeat, dsize, get_metric):
+    n = dsize // 4
+    x = ti.ndarray(ti.f32, shape=n)
+    return get_metric(repeat, _make_step(n), x)
+
+
+def _churn_stats(arch, repeat, dsize):
+    ti.init(arch=get_ti_arch(arch))
+    n = dsize // 4
+    x = ti.ndarray(ti.f32, shape=n)
+    run = _make_step(n)
+    for _ in range(repeat * 10):
+        run(x)
+    return ti.profiler.get_caching_allocator_stats()
+
+
+def churn_hit_rate(arch, repeat, dsize, get_metric):
+    return _churn_stats(arch, repeat, dsize)["hit_rate"]
+
+
+def churn_peak(arch, repeat, dsize, get_metric):
+    return _churn_stats(arch, repeat, dsize)["peak_bytes"] / (1024 * 1024)
+
+
+class NdarrayChurnPlan(BenchmarkPlan):
+    # The caching allocator only backs CPU ndarrays.
+    archs = ["x64"]
+
+    def __init__(self, arch: str):
+        super().__init__("ndarray_churn", arch, basic_repeat_times=10)
+        self.create_plan(DataSize(), ChurnMetric())
+        self.add_func(["end2end_time_ms"], churn_time)
+        self.add_func(["cache_hit_rate"], churn_hit_rate)
+        self.add_func(["peak_mb"], churn_peak)
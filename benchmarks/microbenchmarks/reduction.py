@@ -0,0 +1,67 @@
+from microbenchmarks._items import BenchmarkItem, Container, DataSize, DataType
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+from microbenchmarks._utils import dtype_size, fill_random, scaled_repeat_times
+
+import taichi as ti
+
+
+class ReductionLoop(BenchmarkItem):
+    name = "loop"
+
+    def __init__(self):
+        self._items = {"range_for": None, "struct_for": None}
+
+
+def reduction_range_for(arch, repeat, container, dtype, dsize, loop, get_metric):
+    repeat = scaled_repeat_times(arch, dsize, repeat)
+    num_elements = dsize // dtype_size(dtype)
+    x = container(dtype, num_elements)
+    y = ti.field(dtype, shape=())
+    fill_random(x, dtype, container)
+
+    @ti.kernel
+    def reduce_field(x: ti.template(), y: ti.template()):
+        for i in range(num_elements):
+            y[None] += x[i]
+
+    @ti.kernel
+    def reduce_array(x: ti.types.ndarray(), y: ti.template()):
+        for i in range(num_elements):
+            y[None] += x[i]
+
+    func = reduce_field if container == ti.field else reduce_array
+    return get_metric(repeat, func, x, y)
+
+
+def reduction_struct_for(arch, repeat, container, dtype, dsize, loop, get_metric):
+    repeat = scaled_repeat_times(arch, dsize, repeat)
+    num_elements = dsize // dtype_size(dtype)
+    # Many small sparse blocks: TLS xlogues used to run once per block here.
+    block = ti.root.pointer(ti.i, num_elements // 64)
+    x = ti.field(dtype)
+    block.dense(ti.i, 64).place(x)
+    y = ti.field(dtype, shape=())
+
+    @ti.kernel
+    def activate_all(x: ti.template()):
+        for i in range(num_elements):
+            x[i] = ti.cast(1, dtype)
+
+    @ti.kernel
+    def reduce_sparse(x: ti.template(), y: ti.template()):
+        for i in x:
+            y[None] += x[i]
+
+    activate_all(x)
+    return get_metric(repeat, reduce_sparse, x, y)
+
+
+class ReductionPlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__("reduction", arch, basic_repeat_times=10)
+        self.create_plan(ReductionLoop(), Container(), DataType(), DataSize(), MetricType())
+        # Sparse fields are always ti.field, skip the duplicated ndarray cases.
+        self.remove_cases_with_tags(["struct_for", "ndarray"])
+        self.add_func(["range_for"], reduction_range_for)
+        self.add_func(["struct_for"], reduction_struct_for)
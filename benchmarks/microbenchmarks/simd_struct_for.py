@@ -0,0 +1,116 @@
+from microbenchmarks._items import BenchmarkItem, DataType, SimdWidth
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class DenseLoop(BenchmarkItem):
+    name = "loop"
+
+    def __init__(self):
+        self._items = {
+            "stencil_2d": None,
+            "stencil_3d": None,
+            "transpose": None,
+            "reduce_sum": None,
+            "reduce_max": None,
+        }
+
+
+def stencil_2d(arch, repeat, simd_width, loop, dtype, get_metric):
+    n = 4096
+    x = ti.field(dtype, shape=(n, n))
+    y = ti.field(dtype, shape=(n, n))
+
+    @ti.kernel
+    def stencil_kernel():
+        for i, j in y:
+            if 0 < i < n - 1 and 0 < j < n - 1:
+                y[i, j] = 0.2 * (x[i, j] + x[i - 1, j] + x[i + 1, j] + x[i, j - 1] + x[i, j + 1])
+
+    x.fill(1.0)
+    return get_metric(repeat, stencil_kernel)
+
+
+def stencil_3d(arch, repeat, simd_width, loop, dtype, get_metric):
+    n = 256
+    x = ti.field(dtype, shape=(n, n, n))
+    y = ti.field(dtype, shape=(n, n, n))
+
+    @ti.kernel
+    def stencil_kernel():
+        for i, j, k in y:
+            if 0 < i < n - 1 and 0 < j < n - 1 and 0 < k < n - 1:
+                y[i, j, k] = (
+                    x[i - 1, j, k]
+                    + x[i + 1, j, k]
+                    + x[i, j - 1, k]
+                    + x[i, j + 1, k]
+                    + x[i, j, k - 1]
+                    + x[i, j, k + 1]
+                    - 6.0 * x[i, j, k]
+                )
+
+    x.fill(1.0)
+    return get_metric(repeat, stencil_kernel)
+
+
+def transpose(arch, repeat, simd_width, loop, dtype, get_metric):
+    # Strided loads, which become gathers
+    n = 4096
+    x = ti.field(dtype, shape=(n, n))
+    y = ti.field(dtype, shape=(n, n))
+
+    @ti.kernel
+    def transpose_kernel():
+        for i, j in y:
+            y[i, j] = x[j, i]
+
+    x.fill(1.0)
+    return get_metric(repeat, transpose_kernel)
+
+
+def reduce_sum(arch, repeat, simd_width, loop, dtype, get_metric):
+    n = 16 * 1024 * 1024
+    x = ti.field(dtype, shape=n)
+
+    @ti.kernel
+    def sum_kernel() -> dtype:
+        s = ti.cast(0, dtype)
+        for i in x:
+            s += x[i]
+        return s
+
+    x.fill(1)
+    return get_metric(repeat, sum_kernel)
+
+
+def reduce_max(arch, repeat, simd_width, loop, dtype, get_metric):
+    n = 16 * 1024 * 1024
+    x = ti.field(dtype, shape=n)
+
+    @ti.kernel
+    def max_kernel() -> dtype:
+        s = ti.cast(0, dtype)
+        for i in x:
+            ti.atomic_max(s, x[i])
+        return s
+
+    x.fill(1)
+    return get_metric(repeat, max_kernel)
+
+
+class SimdStructForPlan(BenchmarkPlan):
+    archs = ["x64"]
+
+    def __init__(self, arch: str):
+        super().__init__("simd_struct_for", arch, basic_repeat_times=10)
+        dtype = DataType()
+        dtype.remove_integer()
+        self.create_plan(SimdWidth(), DenseLoop(), dtype, MetricType())
+        self.add_func(["stencil_2d"], stencil_2d)
+        self.add_func(["stencil_3d"], stencil_3d)
+        self.add_func(["transpose"], transpose)
+        self.add_func(["reduce_sum"], reduce_sum)
+        self.add_func(["reduce_max"], reduce_max)
@@ -0,0 +1,77 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class SparseSNode(BenchmarkItem):
+    name = "snode"
+
+    def __init__(self):
+        self._items = {"pointer": None, "dynamic": None}
+
+
+class NumActivations(BenchmarkItem):
+    name = "num_activations"
+
+    def __init__(self):
+        # Every activation allocates a node, so this is the allocator load.
+        self._items = {"64K": 64 * 1024, "1M": 1024 * 1024}
+
+
+def pointer_activation(arch, repeat, snode, num_activations, get_metric):
+    block_size = 4
+    x = ti.field(ti.f32)
+    block = ti.root.pointer(ti.i, num_activations).dense(ti.i, block_size)
+    block.place(x)
+
+    @ti.kernel
+    def activate():
+        for i in range(num_activations):
+            x[i * block_size] = 1.0
+
+    @ti.kernel
+    def deactivate():
+        for i in range(num_activations):
+            ti.deactivate(block, i)
+
+    def activate_deactivate():
+        activate()
+        deactivate()
+
+    return get_metric(repeat, activate_deactivate)
+
+
+def dynamic_activation(arch, repeat, snode, num_activations, get_metric):
+    chunk_size = 4
+    num_lists = num_activations // 4
+    x = ti.field(ti.i32)
+    lists = ti.root.dense(ti.i, num_lists).dynamic(ti.j, 4 * chunk_size, chunk_size=chunk_size)
+    lists.place(x)
+
+    # Each list takes four chunks, i.e. four allocations.
+    @ti.kernel
+    def append():
+        for i in range(num_lists):
+            for j in range(4 * chunk_size):
+                x[i].append(j)
+
+    @ti.kernel
+    def deactivate():
+        for i in range(num_lists):
+            ti.deactivate(lists, i)
+
+    def append_deactivate():
+        append()
+        deactivate()
+
+    return get_metric(repeat, append_deactivate)
+
+
+class SparseActivationPlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__("sparse_activation", arch, basic_repeat_times=10)
+        self.create_plan(SparseSNode(), NumActivations(), MetricType())
+        self.add_func(["pointer"], pointer_activation)
+        self.add_func(["dynamic"], dynamic_activation)
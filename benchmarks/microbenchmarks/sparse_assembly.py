@@ -0,0 +1,80 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class Assembly(BenchmarkItem):
+    name = "assembly"
+
+    def __init__(self):
+        self._items = {"rebuild": False, "refill": True}
+
+
+class GridSize(BenchmarkItem):
+    name = "grid_size"
+
+    def __init__(self):
+        self._items = {f"grid_{n}": n for n in [64, 128, 256]}
+
+
+class Factorize(BenchmarkItem):
+    name = "factorize"
+
+    def __init__(self):
+        self._items = {"assemble_only": False, "with_factorize": True}
+
+
+def sparse_assembly(arch, repeat, assembly, grid_size, factorize, get_metric):
+    # A 2D Laplacian plus a time-dependent diagonal, like the system matrix of
+    # an implicit solver whose pattern is fixed across time steps.
+    n = grid_size * grid_size
+    builder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=5 * n)
+
+    @ti.kernel
+    def fill(builder: ti.types.sparse_matrix_builder(), dt: ti.f32):
+        for i, j in ti.ndrange(grid_size, grid_size):
+            row = i * grid_size + j
+            builder[row, row] += 4.0 + 1.0 / dt
+            if i > 0:
+                builder[row, row - grid_size] += -1.0
+            if i < grid_size - 1:
+                builder[row, row + grid_size] += -1.0
+            if j > 0:
+                builder[row, row - 1] += -1.0
+            if j < grid_size - 1:
+                builder[row, row + 1] += -1.0
+
+    fill(builder, 1.0)
+    A = builder.build()
+    solver = ti.linalg.SparseSolver(solver_type="LLT")
+    solver.analyze_pattern(A)
+    state = {"A": A, "dt": 1.0}
+
+    def step():
+        state["dt"] *= 0.999
+        fill(builder, state["dt"])
+        if assembly:
+            builder.refill(state["A"])
+        else:
+            state["A"] = builder.build()
+        if factorize:
+            solver.analyze_pattern(state["A"])
+            solver.factorize(state["A"])
+        ti.sync()
+
+    return get_metric(repeat, step)
+
+
+class SparseAssemblyPlan(BenchmarkPlan):
+    # Eigen sparse matrices are only refilled on CPUs.
+    archs = ["x64"]
+
+    def __init__(self, arch: str):
+        super().__init__("sparse_assembly", arch, basic_repeat_times=10)
+        metric = MetricType()
+        metric.remove(["kernel_elapsed_time_ms"])
+        self.create_plan(Assembly(), GridSize(), Factorize(), metric)
+        self.add_func(["rebuild"], sparse_assembly)
+        self.add_func(["refill"], sparse_assembly)
@@ -0,0 +1,41 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class BlockSize(BenchmarkItem):
+    name = "block_size"
+
+    def __init__(self):
+        # Bytes of every recycled node the GC has to zero-fill.
+        self._items = {"64B": 16, "4KB": 1024}
+
+
+def pointer_gc(arch, repeat, block_size, get_metric):
+    num_blocks = 64 * 1024
+    x = ti.field(ti.f32)
+    block = ti.root.pointer(ti.i, num_blocks).dense(ti.i, block_size)
+    block.place(x)
+
+    @ti.kernel
+    def activate():
+        for i in range(num_blocks):
+            x[i * block_size] = 1.0
+
+    # Every deactivation recycles all the blocks, so the GC run before the
+    # next activation dominates.
+    def activate_deactivate():
+        activate()
+        block.deactivate_all()
+
+    return get_metric(repeat, activate_deactivate)
+
+
+class SparseGCPlan(BenchmarkPlan):
+    def __init__(self, arch: str):
+        super().__init__("sparse_gc", arch, basic_repeat_times=10)
+        self.create_plan(BlockSize(), MetricType())
+        self.add_func(["64B"], pointer_gc)
+        self.add_func(["4KB"], pointer_gc)
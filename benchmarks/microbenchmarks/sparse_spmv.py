@@ -0,0 +1,74 @@
+from microbenchmarks._items import BenchmarkItem, DataType
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class SpmvImpl(BenchmarkItem):
+    name = "impl"
+
+    def __init__(self):
+        # "eigen" is the single-threaded Eigen product that spmv() used to
+        # run, "csr_kernel" is the multithreaded kernel used now.
+        self._items = {"eigen": "eigen", "csr_kernel": "csr_kernel"}
+
+
+class StorageFormat(BenchmarkItem):
+    name = "storage_format"
+
+    def __init__(self):
+        self._items = {"col_major": "col_major", "row_major": "row_major"}
+
+
+class NumRows(BenchmarkItem):
+    name = "num_rows"
+
+    def __init__(self):
+        # A 7-point stencil, so about 7 nonzeros per row
+        self._items = {f"rows_{n}": n for n in [1 << 14, 1 << 18, 1 << 21]}
+
+
+def sparse_spmv(arch, repeat, impl, storage_format, num_rows, dtype, get_metric):
+    n = num_rows
+    builder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=7 * n, dtype=dtype, storage_format=storage_format)
+
+    @ti.kernel
+    def fill(builder: ti.types.sparse_matrix_builder()):
+        for i in range(n):
+            builder[i, i] += 6.0
+            for k in ti.static([1, 64, 4096]):
+                builder[i, (i + k) % n] += -1.0
+                builder[i, (i - k + n) % n] += -1.0
+
+    fill(builder)
+    A = builder.build()
+    x = ti.ndarray(dtype, n)
+    x.fill(1.0)
+    if impl == "eigen":
+        x_np = x.to_numpy()
+
+        def func():
+            return A.matrix.mat_vec_mul(x_np)
+
+    else:
+
+        def func():
+            return A @ x
+
+    return get_metric(repeat, func)
+
+
+class SparseSpmvPlan(BenchmarkPlan):
+    # Eigen sparse matrices only live on CPUs.
+    archs = ["x64"]
+
+    def __init__(self, arch: str):
+        super().__init__("sparse_spmv", arch, basic_repeat_times=10)
+        dtype = DataType()
+        dtype.remove_integer()
+        metric = MetricType()
+        metric.remove(["kernel_elapsed_time_ms"])
+        self.create_plan(SpmvImpl(), StorageFormat(), NumRows(), dtype, metric)
+        self.add_func(["eigen"], sparse_spmv)
+        self.add_func(["csr_kernel"], sparse_spmv)
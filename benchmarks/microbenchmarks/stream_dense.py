@@ -0,0 +1,86 @@
+from microbenchmarks._items import BenchmarkItem, CpuThreadPool
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+# 128 MB per f32 field, well over the last level cache.
+num_elements = 32 * 1024 * 1024
+
+
+class StreamOp(BenchmarkItem):
+    name = "stream_op"
+
+    def __init__(self):
+        self._items = {op: op for op in ["copy", "scale", "add", "triad"]}
+
+
+class CpuHugePages(BenchmarkItem):
+    name = "cpu_huge_pages"
+    init_option = True
+
+    def __init__(self):
+        self._items = {"4k_pages": False, "huge_pages": True}
+
+
+class CpuNumaFirstTouch(BenchmarkItem):
+    name = "cpu_numa_first_touch"
+    init_option = True
+
+    def __init__(self):
+        self._items = {"serial_touch": False, "first_touch": True}
+
+
+def _place_field():
+    # One SNode tree per field, so that each root buffer holds a single field
+    # and is split between the threads like the loops over it.
+    fb = ti.FieldsBuilder()
+    x = ti.field(ti.f32)
+    fb.dense(ti.i, num_elements).place(x)
+    fb.finalize()
+    return x
+
+
+def stream_dense(arch, repeat, stream_op, cpu_thread_pool, cpu_huge_pages, cpu_numa_first_touch, get_metric):
+    a, b, c = _place_field(), _place_field(), _place_field()
+    s = 3.0
+
+    @ti.kernel
+    def init():
+        for i in a:
+            a[i] = 1.0
+            b[i] = 2.0
+            c[i] = 0.0
+
+    @ti.kernel
+    def copy():
+        for i in c:
+            c[i] = a[i]
+
+    @ti.kernel
+    def scale():
+        for i in b:
+            b[i] = s * c[i]
+
+    @ti.kernel
+    def add():
+        for i in c:
+            c[i] = a[i] + b[i]
+
+    @ti.kernel
+    def triad():
+        for i in a:
+            a[i] = b[i] + s * c[i]
+
+    init()
+    func = {"copy": copy, "scale": scale, "add": add, "triad": triad}[stream_op]
+    return get_metric(repeat, func)
+
+
+class StreamDensePlan(BenchmarkPlan):
+    archs = ["x64"]
+
+    def __init__(self, arch: str):
+        super().__init__("stream_dense", arch, basic_repeat_times=10)
+        self.create_plan(StreamOp(), CpuThreadPool(), CpuHugePages(), CpuNumaFirstTouch(), MetricType())
+        self.add_func(["stream_dense"], stream_dense)
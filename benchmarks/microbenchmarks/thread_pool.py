@@ -0,0 +1,50 @@
+from microbenchmarks._items import BenchmarkItem, CpuThreadPool
+from microbenchmarks._metric import MetricType
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class ThreadPoolWorkload(BenchmarkItem):
+    name = "workload"
+
+    def __init__(self):
+        # {'tag': number of elements}
+        self._items = {
+            "launch_latency": 256,  # a handful of tiny blocks per launch
+            "throughput": 16 * 1024 * 1024,
+        }
+
+
+def launch_latency(arch, repeat, cpu_thread_pool, workload, get_metric):
+    x = ti.field(ti.f32, shape=workload)
+
+    @ti.kernel
+    def tiny_blocks(x: ti.template()):
+        ti.loop_config(block_dim=16)
+        for i in x:
+            x[i] = x[i] * 0.5 + 1.0
+
+    # A launch takes microseconds, so use many more of them.
+    return get_metric(repeat * 1000, tiny_blocks, x)
+
+
+def throughput(arch, repeat, cpu_thread_pool, workload, get_metric):
+    x = ti.field(ti.f32, shape=workload)
+
+    @ti.kernel
+    def large_range(x: ti.template()):
+        for i in x:
+            x[i] = x[i] * 0.5 + 1.0
+
+    return get_metric(repeat, large_range, x)
+
+
+class ThreadPoolPlan(BenchmarkPlan):
+    archs = ["x64"]
+
+    def __init__(self, arch: str):
+        super().__init__("thread_pool", arch, basic_repeat_times=10)
+        self.create_plan(CpuThreadPool(), ThreadPoolWorkload(), MetricType())
+        self.add_func(["launch_latency"], launch_latency)
+        self.add_func(["throughput"], throughput)
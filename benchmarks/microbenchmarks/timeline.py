@@ -0,0 +1,44 @@
+from microbenchmarks._items import BenchmarkItem
+from microbenchmarks._metric import end2end_executor
+from microbenchmarks._plan import BenchmarkPlan
+
+import taichi as ti
+
+
+class NumThreads(BenchmarkItem):
+    name = "num_threads"
+
+    def __init__(self):
+        self._items = {f"threads_{n}": n for n in [1, 4, 16]}
+
+
+class TimelineState(BenchmarkItem):
+    name = "enabled"
+
+    def __init__(self):
+        self._items = {"disabled": False, "enabled": True}
+
+
+class TimelineMetric(BenchmarkItem):
+    name = "get_metric"
+
+    def __init__(self):
+        # The time is measured by the case itself, in C++.
+        self._items = {"end2end_time_ms": end2end_executor}
+
+
+def timeline(arch, repeat, num_threads, enabled, get_metric):
+    # The time every thread takes to record 10^6 events, i.e. the overhead
+    # in ms per second of tracing at 10^6 events/s.
+    num_events = 1000000
+    seconds = min(ti._lib.core.benchmark_timeline(num_threads, num_events, enabled) for _ in range(max(repeat, 3)))
+    return seconds * 1000
+
+
+class TimelinePlan(BenchmarkPlan):
+    archs = ["x64"]
+
+    def __init__(self, arch: str):
+        super().__init__("timeline", arch, basic_repeat_times=1)
+        self.create_plan(NumThreads(), TimelineState(), TimelineMetric())
+        self.add_func(["end2end_time_ms"], timeline)
@@ -11,6 +11,7 @@ class MicroBenchmark:
         "cuda": {"enable": True},
         "vulkan": {"enable": False},
         "opengl": {"enable": False},
+        "x64": {"enable": False},
     }
 
     def __init__(self):
@@ -32,6 +33,8 @@ class MicroBenchmark:
                 arch_results = {}
                 self._info[arch] = {}
                 for plan in benchmark_plan_list:
+                    if plan.archs is not None and arch not in plan.archs:
+                        continue
                     plan_impl = plan(arch)
                     results = plan_impl.run()
                     self._info[arch][plan_impl.name] = results["info"]
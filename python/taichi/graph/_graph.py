@@ -65,30 +65,75 @@ class GraphBuilder:
         return Graph(self._graph_builder.compile())
 
 
+def _flatten_runtime_args(args):
+    # Support native python numerical types (int, float), Ndarray.
+    # Taichi Matrix types are flattened into (int, float) arrays.
+    # TODO diminish the flatten behavior when Matrix becomes a Taichi native type.
+    flattened = {}
+    for k, v in args.items():
+        if isinstance(v, Ndarray):
+            flattened[k] = v.arr
+        elif isinstance(v, Texture):
+            flattened[k] = v.tex
+        elif isinstance(v, Matrix):
+            flattened[k] = v.entries
+        elif isinstance(v, (int, float)):
+            flattened[k] = v
+        else:
+            raise TaichiRuntimeError(
+                f"Only python int, float, ti.Matrix and ti.Ndarray are supported as runtime arguments but got {type(v)}"
+            )
+    return flattened
+
+
 class Graph:
     def __init__(self, compiled_graph) -> None:
         self._compiled_graph = compiled_graph
 
     def run(self, args):
-        # Support native python numerical types (int, float), Ndarray.
-        # Taichi Matrix types are flattened into (int, float) arrays.
-        # TODO diminish the flatten behavior when Matrix becomes a Taichi native type.
-        flattened = {}
-        for k, v in args.items():
-            if isinstance(v, Ndarray):
-                flattened[k] = v.arr
-            elif isinstance(v, Texture):
-                flattened[k] = v.tex
-            elif isinstance(v, Matrix):
-                flattened[k] = v.entries
-            elif isinstance(v, (int, float)):
-                flattened[k] = v
-            else:
-                raise TaichiRuntimeError(
-                    f"Only python int, float, ti.Matrix and ti.Ndarray are supported as runtime arguments but got {type(v)}"
-                )
+        flattened = _flatten_runtime_args(args)
         self._compiled_graph.jit_run(impl.get_runtime().prog.config(), flattened)
 
+    def bind(self, args):
+        """Binds runtime values to the graph for repeated replays.
+
+        Argument names are resolved and the values validated only once, here,
+        so that :meth:`BoundGraph.run` just launches the dispatched kernels.
+
+        Args:
+            args (Dict[str, Any]): Runtime values of all graph arguments.
+
+        Returns:
+            BoundGraph: The graph with `args` bound.
+        """
+        return BoundGraph(self, args)
+
+
+class BoundGraph:
+    """A :class:`Graph` with its runtime arguments bound, see :meth:`Graph.bind`."""
+
+    def __init__(self, graph, args) -> None:
+        self._graph = graph
+        # Keeps the bound ndarrays and textures alive.
+        self._args = _flatten_runtime_args(args)
+        self._bound_graph = graph._compiled_graph.jit_bind(impl.get_runtime().prog.config(), self._args)
+
+    def set_args(self, args):
+        """Re-binds some of the graph arguments.
+
+        Only the dispatches using the given arguments are updated; re-binding
+        an argument to the value it already holds is a no-op.
+
+        Args:
+            args (Dict[str, Any]): New runtime values, keyed by argument name.
+        """
+        flattened = _flatten_runtime_args(args)
+        self._bound_graph.set_args(self._graph._compiled_graph, flattened)
+        self._args.update(flattened)
+
+    def run(self):
+        self._bound_graph.run()
+
 
 def _deprecate_arg_args(kwargs: Dict[str, Any]):
     if "field_dim" in kwargs:
@@ -286,4 +331,4 @@ def Arg(*args, **kwargs):
     return _make_arg(kwargs)
 
 
-__all__ = ["GraphBuilder", "Graph", "Arg", "ArgKind"]
+__all__ = ["GraphBuilder", "Graph", "BoundGraph", "Arg", "ArgKind"]
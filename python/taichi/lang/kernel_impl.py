@@ -1242,4 +1242,40 @@ def data_oriented(cls):
     return cls
 
 
-__all__ = ["data_oriented", "func", "kernel", "pyfunc", "real_func"]
+def compile_kernels(kernels):
+    """Compiles several kernels ahead of their first launch.
+
+    The kernels that miss the offline cache are compiled concurrently, on up
+    to ``num_compile_threads`` threads on LLVM backends. Later calls of the
+    kernels with arguments of the same types reuse the compiled kernels.
+
+    Example::
+
+        >>> x = ti.ndarray(ti.f32, shape=16)
+        >>> ti.compile_kernels([(fill, (x, 1.0)), (scale, (x,))])
+
+    Args:
+        kernels (List[Tuple[Callable, Tuple]]): Each kernel decorated with
+            :func:`~taichi.lang.kernel_impl.kernel`, together with the arguments it will be
+            called with. Only their types and, for ndarrays, their dtypes and
+            dimensions matter.
+    """
+    t_kernels = []
+    for kernel, args in kernels:
+        primal = kernel._primal
+        if isinstance(kernel, _BoundedDifferentiableMethod) and not kernel._is_staticmethod:
+            args = (kernel._kernel_owner, *args)
+        args = _process_args(primal, tuple(args), {})
+        key = primal.ensure_compiled(*args)
+        t_kernels.append(primal.compiled_kernels[key])
+    try:
+        prog = impl.get_runtime().prog
+        prog.compile_kernels(prog.config(), prog.get_device_caps(), t_kernels)
+    except Exception as e:
+        e = handle_exception_from_cpp(e)
+        if impl.get_runtime().print_full_traceback:
+            raise e
+        raise e from None
+
+
+__all__ = ["compile_kernels", "data_oriented", "func", "kernel", "pyfunc", "real_func"]
@@ -346,8 +346,15 @@ def init(
             https://github.com/taichi-dev/taichi/blob/master/taichi/program/compile_config.h.
 
             * ``cpu_max_num_threads`` (int): Sets the number of threads used by the CPU thread pool.
+            * ``cpu_thread_pool`` (str): Selects the CPU thread pool, either ``"default"`` or ``"work_stealing"``.
+            * ``cpu_loop_schedule`` (str): Default schedule of CPU parallel range-fors, one of ``"static"``, ``"dynamic"`` or ``"guided"``. See :func:`loop_config`.
+            * ``cpu_block_range_for`` (bool): Runs each block of a CPU parallel range-for in one call of the generated code instead of one call per iteration, so that LLVM can unroll and vectorize the loop. Default to False.
+            * ``simd_width`` (int): Caps the number of 32-bit lanes LLVM is asked to vectorize CPU loops over dense fields with. The host CPU features cap it too. Set it to 1 to leave these loops to the LLVM cost model. Default to 8 on x64 and 4 on arm64.
+            * ``cpu_huge_pages`` (bool): Backs large host buffers with transparent huge pages where available. Default to False.
+            * ``cpu_numa_first_touch`` (bool): Faults in the pages of new fields and ndarrays from the CPU threads, split as statically scheduled range-fors over them are, so that each page lands on the NUMA node of the thread using it. Works best with ``cpu_thread_pool="work_stealing"``. Default to False.
             * ``debug`` (bool): Enables the debug mode, under which Taichi does a few more things like boundary checks.
             * ``print_ir`` (bool): Prints the CHI IR of the Taichi kernels.
+            * ``print_full_simplify_stats`` (bool): Prints how many times each pass of the full simplification of a kernel ran or was skipped, and the time it took. Default to False.
             *``offline_cache`` (bool): Enables offline cache of the compiled kernels. Default to True. When this is enabled Taichi will cache compiled kernel on your local disk to accelerate future calls.
             *``random_seed`` (int): Sets the seed of the random generator. The default is 0.
     """
@@ -604,6 +611,11 @@ def _block_dim_adaptive(block_dim_adaptive):
         get_runtime().prog.config().cpu_block_dim_adaptive = block_dim_adaptive
 
 
+def _cpu_schedule(schedule):
+    """Sets how the iterations of the next range-for are distributed to CPU threads."""
+    get_runtime().compiling_callable.ast_builder().cpu_schedule(schedule)
+
+
 def _bit_vectorize():
     """Enable bit vectorization of struct fors on quant_arrays."""
     get_runtime().compiling_callable.ast_builder().bit_vectorize()
@@ -616,6 +628,7 @@ def loop_config(
     parallelize=None,
     block_dim_adaptive=True,
     bit_vectorize=False,
+    schedule=None,
 ):
     """Sets directives for the next loop
 
@@ -625,6 +638,10 @@ def loop_config(
         parallelize (int): The number of threads to use on CPU
         block_dim_adaptive (bool): Whether to allow backends set block_dim adaptively, enabled by default
         bit_vectorize (bool): Whether to enable bit vectorization of struct fors on quant_arrays.
+        schedule (str): How the iterations of a range-for are distributed to threads on CPU. `"static"` splits them
+            evenly before the launch, `"dynamic"` hands out chunks sized from the measured cost of previous launches,
+            and `"guided"` hands out chunks shrinking with the remaining work, down to `block_dim`. Defaults to the
+            `cpu_loop_schedule` option of `ti.init`.
 
     Examples::
 
@@ -662,6 +679,14 @@ def loop_config(
             # 32 bits, instead of 1 bit, will be copied at a time
             for i, j in x:
                 y[i, j] = x[i, j]
+
+        @ti.kernel
+        def skewed():
+            ti.loop_config(schedule="guided")
+            # Iterations with a larger i cost more, so an even split would leave most threads idle.
+            for i in range(n):
+                for j in range(i):
+                    val[i] += j
     """
     if block_dim is not None:
         _block_dim(block_dim)
@@ -677,6 +702,9 @@ def loop_config(
     if bit_vectorize:
         _bit_vectorize()
 
+    if schedule is not None:
+        _cpu_schedule(schedule)
+
 
 def global_thread_idx():
     """Returns the global thread id of this running thread,
@@ -1,5 +1,6 @@
 """Taichi support module for sparse matrix operations."""
 
+from taichi.linalg.iterative_solver import IterativeSolver
 from taichi.linalg.sparse_cg import SparseCG
 from taichi.linalg.sparse_matrix import *
 from taichi.linalg.sparse_solver import SparseSolver
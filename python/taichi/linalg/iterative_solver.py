@@ -0,0 +1,98 @@
+from taichi._lib import core as _ti_core
+from taichi.lang._ndarray import Ndarray
+from taichi.lang.exception import TaichiRuntimeError
+from taichi.lang.impl import get_runtime
+from taichi.linalg.sparse_matrix import SparseMatrix
+from taichi.types import f32, f64
+
+
+class IterativeSolver:
+    """Preconditioned iterative solver for sparse linear systems.
+
+    Solves Ax = b in place on ndarrays with the conjugate-gradient (for symmetric
+    positive definite A) or the BiCGSTAB method. The matrix-vector products and
+    vector operations run on the CPU threads.
+
+    Args:
+        method (str): "cg" or "bicgstab".
+        preconditioner (str): None, "jacobi" or "ic0" (incomplete Cholesky without fill-in).
+        max_iter (int): Maximum number of iterations.
+        rtol (float): Tolerance of the residual norm, relative to the norm of b.
+        atol (float): Absolute tolerance of the residual norm.
+        verbose (bool): Print the residual norm of every iteration.
+
+    Example::
+
+        >>> solver = ti.linalg.IterativeSolver(method="cg", preconditioner="ic0")
+        >>> solver.compute(A)
+        >>> x.fill(0)
+        >>> for step in range(num_steps):
+        >>>     update_rhs(b)
+        >>>     solver.solve(b, x)  # Warm starts from the previous x
+    """
+
+    def __init__(self, method="cg", preconditioner=None, max_iter=1000, rtol=1e-6, atol=0.0, verbose=False):
+        taichi_arch = get_runtime().prog.config().arch
+        if taichi_arch not in [_ti_core.Arch.x64, _ti_core.Arch.arm64]:
+            raise TaichiRuntimeError("IterativeSolver only supports CPU for now.")
+        self.method = method.lower()
+        self.preconditioner = "none" if preconditioner is None else preconditioner.lower()
+        self.max_iter = max_iter
+        self.rtol = rtol
+        self.atol = atol
+        self.verbose = verbose
+        self.matrix = None
+        self.solver = None
+
+    def compute(self, sparse_matrix):
+        """Set up the solver, including the preconditioner, for a sparse matrix.
+
+        Call it again once the values of the matrix change.
+
+        Args:
+            sparse_matrix (SparseMatrix): The coefficient matrix A of the linear system.
+        """
+        if not isinstance(sparse_matrix, SparseMatrix):
+            raise TaichiRuntimeError(f"The parameter type: {type(sparse_matrix)} is not supported.")
+        if sparse_matrix.dtype == f32:
+            make_solver = _ti_core.make_iterative_solver_float32
+        elif sparse_matrix.dtype == f64:
+            make_solver = _ti_core.make_iterative_solver_float64
+        else:
+            raise TaichiRuntimeError(f"Unsupported IterativeSolver dtype: {sparse_matrix.dtype}")
+        if self.solver is None or self.matrix.dtype != sparse_matrix.dtype:
+            self.solver = make_solver(
+                self.method, self.preconditioner, self.max_iter, self.rtol, self.atol, self.verbose
+            )
+        self.matrix = sparse_matrix
+        self.solver.compute(sparse_matrix.matrix)
+
+    def solve(self, b, x):
+        """Solve Ax = b, starting from the current content of x.
+
+        Args:
+            b (Ndarray): The right-hand side of the linear system.
+            x (Ndarray): The initial guess, overwritten by the solution.
+
+        Returns:
+            bool: True if the solver converged.
+        """
+        if self.matrix is None:
+            raise TaichiRuntimeError("Please call compute() before calling solve().")
+        if not isinstance(b, Ndarray) or not isinstance(x, Ndarray):
+            raise TaichiRuntimeError("IterativeSolver only supports ti.ndarray right-hand sides and solutions.")
+        get_runtime().sync()
+        return self.solver.solve(get_runtime().prog, b.arr, x.arr)
+
+    @property
+    def residuals(self):
+        """The residual norms of the last solve, before the first iteration and after each iteration."""
+        return list(self.solver.get_residuals()) if self.solver is not None else []
+
+    @property
+    def iterations(self):
+        """The number of iterations of the last solve."""
+        return self.solver.get_iterations() if self.solver is not None else 0
+
+
+__all__ = ["IterativeSolver"]
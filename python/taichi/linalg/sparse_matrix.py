@@ -292,6 +292,30 @@ class SparseMatrixBuilder:
             return SparseMatrix(sm=sm, dtype=self.dtype)
         raise TaichiRuntimeError("Sparse matrix only supports CPU and CUDA backends.")
 
+    def refill(self, sparse_matrix):
+        """Refill a sparse matrix with the triplets, reusing its sparsity pattern.
+
+        If every triplet hits an entry already stored in `sparse_matrix`, only its values are
+        written and solvers skip `analyze_pattern()` for it. Otherwise the matrix is rebuilt.
+
+        Args:
+            sparse_matrix (SparseMatrix): the matrix to refill, usually built by this builder.
+
+        Example::
+
+            >>> A = builder.build()
+            >>> solver.analyze_pattern(A)
+            >>> for step in range(num_steps):
+            >>>     fill(builder)
+            >>>     builder.refill(A)
+            >>>     solver.analyze_pattern(A)  # A no-op while the pattern is unchanged
+            >>>     solver.factorize(A)
+        """
+        taichi_arch = get_runtime().prog.config().arch
+        if taichi_arch not in [_ti_core.Arch.x64, _ti_core.Arch.arm64]:
+            raise TaichiRuntimeError("Refilling a sparse matrix is only supported on CPU for now.")
+        self.ptr.refill(get_runtime().prog, sparse_matrix.matrix)
+
     def __del__(self):
         if get_runtime() is not None and get_runtime().prog is not None:
             self.ptr.delete_ndarray(get_runtime().prog)
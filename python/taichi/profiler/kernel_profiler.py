@@ -397,7 +397,11 @@ def query_kernel_profiler_info(name):
         name (str): kernel name.
 
     Returns:
-        KernelProfilerQueryResult (class): with member variables(counter, min, max, avg)
+        KernelProfilerQueryResult (class): with member variables(counter, min, max, avg).
+        On CPU backends it also holds the thread pool metrics of the offloaded tasks:
+        `num_blocks` (blocks per launch), `load_imbalance` (busy time of the busiest
+        thread over the average thread, 1.0 being balanced) and `thread_busy_time`
+        (busy time of every thread in ms, summed over the launches).
 
     Example::
 
@@ -421,6 +425,7 @@ def query_kernel_profiler_info(name):
         >>> print("kernel elapsed time(min_in_ms) =",query_result.min)
         >>> print("kernel elapsed time(max_in_ms) =",query_result.max)
         >>> print("kernel elapsed time(avg_in_ms) =",query_result.avg)
+        >>> print("thread load imbalance =",query_result.load_imbalance)
 
     Note:
         [1] To get the correct result, query_kernel_profiler_info() must be used in conjunction with
@@ -10,4 +10,27 @@ def print_memory_profiler_info():
     get_runtime().prog.print_memory_profiler_info()
 
 
-__all__ = ["print_memory_profiler_info"]
+def get_caching_allocator_stats():
+    """Returns the statistics of the allocator caching the memory of ndarrays
+    on CPU backends.
+
+    Returns:
+        dict: ``num_allocations`` and ``num_cache_hits`` count the allocations
+        since ``ti.init()`` and those served by recycled memory, ``hit_rate``
+        is their ratio. ``bytes_in_use`` and ``bytes_cached`` are the bytes
+        currently held by live and by freed allocations, and ``peak_bytes`` is
+        the peak of their sum.
+    """
+    get_runtime().materialize()
+    stats = get_runtime().prog.get_caching_allocator_stats()
+    return {
+        "num_allocations": stats.num_allocations,
+        "num_cache_hits": stats.num_cache_hits,
+        "hit_rate": stats.num_cache_hits / max(stats.num_allocations, 1),
+        "bytes_in_use": stats.bytes_in_use,
+        "bytes_cached": stats.bytes_cached,
+        "peak_bytes": stats.peak_bytes,
+    }
+
+
+__all__ = ["print_memory_profiler_info", "get_caching_allocator_stats"]
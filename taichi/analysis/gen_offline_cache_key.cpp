@@ -398,6 +398,7 @@ class ASTSerializer : public IRVisitor, public ExpressionVisitor {
     emit(stmt->strictly_serialized);
     emit(stmt->mem_access_opt);
     emit(stmt->block_dim);
+    emit(stmt->cpu_schedule);
     emit(stmt->body.get());
   }
 
@@ -651,6 +652,7 @@ class ASTSerializer : public IRVisitor, public ExpressionVisitor {
   DEFINE_EMIT_ENUM(SNodeOpType);
   DEFINE_EMIT_ENUM(ForLoopType);
   DEFINE_EMIT_ENUM(SNodeAccessFlag);
+  DEFINE_EMIT_ENUM(CpuLoopSchedule);
   DEFINE_EMIT_ENUM(MeshRelationAccessType);
   DEFINE_EMIT_ENUM(ExternalFuncType);
   DEFINE_EMIT_ENUM(TextureOpType);
@@ -57,6 +57,9 @@ static std::vector<std::uint8_t> get_offline_cache_key_of_compile_config(
   if (arch_is_cpu(config.arch)) {
     serializer(config.default_cpu_block_dim);
     serializer(config.cpu_max_num_threads);
+    serializer(config.cpu_loop_schedule);
+    serializer(config.cpu_block_range_for);
+    serializer(config.simd_width);
   } else if (arch_is_gpu(config.arch)) {
     serializer(config.default_gpu_block_dim);
     serializer(config.gpu_max_reg);
@@ -35,6 +35,9 @@ class IRVerifier : public BasicStmtVisitor {
     TI_ASSERT_INFO(stmt->parent == current_block_,
                    "stmt({})->parent({}) != current_block({})", stmt->id,
                    fmt::ptr(stmt->parent), fmt::ptr(current_block_));
+    TI_ASSERT_INFO(stmt->operand_uses_linked(),
+                   "stmt {} {} has an operand assigned without set_operand()",
+                   stmt->type(), stmt->id);
     for (auto &op : stmt->get_operands()) {
       if (op == nullptr)
         continue;
@@ -38,6 +38,108 @@ void CompiledGraph::jit_run(
   }
 }
 
+namespace {
+
+// Validates |ival| against |symbolic_arg| and binds it to parameter |i| of
+// |ctx|.
+void bind_runtime_arg(const Arg &symbolic_arg,
+                      int i,
+                      const IValue &ival,
+                      LaunchContextBuilder &ctx) {
+  if (symbolic_arg.tag == aot::ArgKind::kNdarray) {
+    TI_ASSERT(ival.tag == aot::ArgKind::kNdarray);
+    Ndarray *arr = reinterpret_cast<Ndarray *>(ival.val);
+
+    TI_ERROR_IF(arr->get_element_shape() != symbolic_arg.element_shape,
+                "Mismatched shape information for argument {}",
+                symbolic_arg.name);
+    TI_ERROR_IF(arr->shape.size() != symbolic_arg.field_dim,
+                "Dispatch node is compiled for argument {} with "
+                "field_dim={} but got an ndarray with field_dim={}",
+                symbolic_arg.name, symbolic_arg.field_dim, arr->shape.size());
+
+    // CGraph uses aot::Arg as symbolic argument, which represents
+    // TensorType via combination of element_shape and PrimitiveTypeID
+    // Therefore we only check for element_type for now.
+    //
+    // TODO(zhanlue): Replace all "element_shape + PrimitiveType" use cases
+    // with direct use of "TensorType",
+    //                In the end, "element_shape" should only appear inside
+    //                TensorType and nowhere else.
+    //
+    //                This refactor includes aot::Arg, kernel::Arg,
+    //                MetalDataType, and more...
+    DataType symbolic_arg_primitive_dtype = symbolic_arg.dtype();
+    if (symbolic_arg.dtype()->is<TensorType>()) {
+      symbolic_arg_primitive_dtype =
+          symbolic_arg.dtype()->cast<TensorType>()->get_element_type();
+    }
+
+    DataType arr_primitive_dtype = arr->dtype;
+    if (arr->dtype->is<TensorType>()) {
+      arr_primitive_dtype =
+          arr->dtype->cast<TensorType>()->get_element_type();
+    }
+
+    TI_ERROR_IF(arr_primitive_dtype != symbolic_arg_primitive_dtype,
+                "Dispatch node is compiled for argument {} with "
+                "dtype={} but got an ndarray with dtype={}",
+                symbolic_arg.name, symbolic_arg_primitive_dtype.to_string(),
+                arr_primitive_dtype.to_string());
+    ctx.set_arg_ndarray({i}, *arr);
+  } else if (symbolic_arg.tag == aot::ArgKind::kScalar) {
+    TI_ASSERT(ival.tag == aot::ArgKind::kScalar);
+    // Matrix args are flattened so they're same as scalars.
+    int type_size = data_type_size(symbolic_arg.dtype());
+    switch (type_size) {
+      case 1:
+        ctx.set_arg({i},
+                    taichi_union_cast_with_different_sizes<int8>(ival.val));
+        break;
+      case 2:
+        ctx.set_arg({i},
+                    taichi_union_cast_with_different_sizes<int16>(ival.val));
+        break;
+      case 4:
+        ctx.set_arg({i},
+                    taichi_union_cast_with_different_sizes<int32>(ival.val));
+        break;
+      case 8:
+        ctx.set_arg({i},
+                    taichi_union_cast_with_different_sizes<int64>(ival.val));
+        break;
+      default:
+        TI_ERROR("Unsupported type size {}", type_size);
+    }
+  } else if (symbolic_arg.tag == aot::ArgKind::kTexture) {
+    TI_ASSERT(ival.tag == aot::ArgKind::kTexture);
+    Texture *tex = reinterpret_cast<Texture *>(ival.val);
+    ctx.set_arg_texture({i}, *tex);
+  } else if (symbolic_arg.tag == aot::ArgKind::kRWTexture) {
+    TI_ASSERT(ival.tag == aot::ArgKind::kTexture);
+    Texture *tex = reinterpret_cast<Texture *>(ival.val);
+    ctx.set_arg_rw_texture({i}, *tex);
+  } else if (symbolic_arg.tag == aot::ArgKind::kMatrix) {
+    TI_ASSERT(ival.tag == aot::ArgKind::kMatrix);
+    Matrix *mat = reinterpret_cast<Matrix *>(ival.val);
+
+    uint32_t symbolic_arg_size = (uint32_t)(symbolic_arg.element_shape[0] *
+                                            symbolic_arg.element_shape[1]);
+    TI_ERROR_IF(symbolic_arg_size != mat->length(),
+                "Dispatch node is compiled for argument {} with "
+                "size={} but got a matrix with size={}",
+                symbolic_arg.name, symbolic_arg_size, mat->length());
+    TI_ERROR_IF(mat->length() * data_type_size(mat->dtype()) > 128,
+                "Matrix size={} is out of bound",
+                mat->length() * data_type_size(mat->dtype()));
+    ctx.set_arg_matrix(i, *mat);
+  } else {
+    TI_ERROR("Error in compiled graph: unknown tag {}", int(ival.tag));
+  }
+}
+
+}  // namespace
+
 // static
 void CompiledGraph::init_runtime_context(
     const std::vector<Arg> &paramter_list,
@@ -48,96 +150,84 @@ void CompiledGraph::init_runtime_context(
     auto found = args.find(symbolic_arg.name);
     TI_ERROR_IF(found == args.end(), "Missing runtime value for {}",
                 symbolic_arg.name);
-    const aot::IValue &ival = found->second;
-    if (symbolic_arg.tag == aot::ArgKind::kNdarray) {
-      TI_ASSERT(ival.tag == aot::ArgKind::kNdarray);
-      Ndarray *arr = reinterpret_cast<Ndarray *>(ival.val);
+    bind_runtime_arg(symbolic_arg, i, found->second, ctx);
+  }
+}
+
+BoundGraph CompiledGraph::bind(
+    const std::unordered_map<std::string, IValue> &args) const {
+  return BoundGraph(*this, args, /*compile_config=*/nullptr);
+}
 
-      TI_ERROR_IF(arr->get_element_shape() != symbolic_arg.element_shape,
-                  "Mismatched shape information for argument {}",
+BoundGraph CompiledGraph::jit_bind(
+    const CompileConfig &compile_config,
+    const std::unordered_map<std::string, IValue> &args) const {
+  return BoundGraph(*this, args, &compile_config);
+}
+
+BoundGraph::BoundGraph(const CompiledGraph &graph,
+                       const std::unordered_map<std::string, IValue> &args,
+                       const CompileConfig *compile_config) {
+  dispatches_.reserve(graph.dispatches.size());
+  for (int d = 0; d < (int)graph.dispatches.size(); d++) {
+    const auto &dispatch = graph.dispatches[d];
+    const CompiledKernelData *compiled_kernel_data = nullptr;
+    if (compile_config) {
+      TI_ASSERT(dispatch.ti_kernel);
+      // Resolve the compiled kernel once so that a replay skips the lookup
+      // in the compilation cache.
+      auto *prog = dispatch.ti_kernel->program;
+      compiled_kernel_data = &prog->compile_kernel(
+          *compile_config, prog->get_device_caps(), *dispatch.ti_kernel);
+      dispatches_.push_back(
+          {&dispatch, LaunchContextBuilder(dispatch.ti_kernel),
+           compiled_kernel_data});
+    } else {
+      TI_ASSERT(dispatch.compiled_kernel);
+      dispatches_.push_back(
+          {&dispatch, LaunchContextBuilder(dispatch.compiled_kernel)});
+    }
+    auto &ctx = dispatches_.back().ctx;
+    for (int i = 0; i < (int)dispatch.symbolic_args.size(); i++) {
+      const auto &symbolic_arg = dispatch.symbolic_args[i];
+      auto found = args.find(symbolic_arg.name);
+      TI_ERROR_IF(found == args.end(), "Missing runtime value for {}",
                   symbolic_arg.name);
-      TI_ERROR_IF(arr->shape.size() != symbolic_arg.field_dim,
-                  "Dispatch node is compiled for argument {} with "
-                  "field_dim={} but got an ndarray with field_dim={}",
-                  symbolic_arg.name, symbolic_arg.field_dim, arr->shape.size());
-
-      // CGraph uses aot::Arg as symbolic argument, which represents
-      // TensorType via combination of element_shape and PrimitiveTypeID
-      // Therefore we only check for element_type for now.
-      //
-      // TODO(zhanlue): Replace all "element_shape + PrimitiveType" use cases
-      // with direct use of "TensorType",
-      //                In the end, "element_shape" should only appear inside
-      //                TensorType and nowhere else.
-      //
-      //                This refactor includes aot::Arg, kernel::Arg,
-      //                MetalDataType, and more...
-      DataType symbolic_arg_primitive_dtype = symbolic_arg.dtype();
-      if (symbolic_arg.dtype()->is<TensorType>()) {
-        symbolic_arg_primitive_dtype =
-            symbolic_arg.dtype()->cast<TensorType>()->get_element_type();
+      bind_runtime_arg(symbolic_arg, i, found->second, ctx);
+      uses_[symbolic_arg.name].push_back({d, i});
+      if (found->second.tag != ArgKind::kMatrix) {
+        values_.insert(*found);
       }
+    }
+  }
+}
 
-      DataType arr_primitive_dtype = arr->dtype;
-      if (arr->dtype->is<TensorType>()) {
-        arr_primitive_dtype =
-            arr->dtype->cast<TensorType>()->get_element_type();
-      }
+void BoundGraph::set_arg(const std::string &name, const IValue &value) {
+  auto found = uses_.find(name);
+  TI_ERROR_IF(found == uses_.end(), "Graph has no argument named {}", name);
+  auto bound = values_.find(name);
+  if (bound != values_.end() && bound->second.tag == value.tag &&
+      bound->second.val == value.val) {
+    return;
+  }
+  for (const auto &use : found->second) {
+    auto &bound_dispatch = dispatches_[use.dispatch];
+    bind_runtime_arg(bound_dispatch.dispatch->symbolic_args[use.param],
+                     use.param, value, bound_dispatch.ctx);
+  }
+  if (bound != values_.end()) {
+    bound->second = value;
+  }
+}
 
-      TI_ERROR_IF(arr_primitive_dtype != symbolic_arg_primitive_dtype,
-                  "Dispatch node is compiled for argument {} with "
-                  "dtype={} but got an ndarray with dtype={}",
-                  symbolic_arg.name, symbolic_arg_primitive_dtype.to_string(),
-                  arr_primitive_dtype.to_string());
-      ctx.set_arg_ndarray({i}, *arr);
-    } else if (symbolic_arg.tag == aot::ArgKind::kScalar) {
-      TI_ASSERT(ival.tag == aot::ArgKind::kScalar);
-      // Matrix args are flattened so they're same as scalars.
-      int type_size = data_type_size(symbolic_arg.dtype());
-      switch (type_size) {
-        case 1:
-          ctx.set_arg({i},
-                      taichi_union_cast_with_different_sizes<int8>(ival.val));
-          break;
-        case 2:
-          ctx.set_arg({i},
-                      taichi_union_cast_with_different_sizes<int16>(ival.val));
-          break;
-        case 4:
-          ctx.set_arg({i},
-                      taichi_union_cast_with_different_sizes<int32>(ival.val));
-          break;
-        case 8:
-          ctx.set_arg({i},
-                      taichi_union_cast_with_different_sizes<int64>(ival.val));
-          break;
-        default:
-          TI_ERROR("Unsupported type size {}", type_size);
-      }
-    } else if (symbolic_arg.tag == aot::ArgKind::kTexture) {
-      TI_ASSERT(ival.tag == aot::ArgKind::kTexture);
-      Texture *tex = reinterpret_cast<Texture *>(ival.val);
-      ctx.set_arg_texture({i}, *tex);
-    } else if (symbolic_arg.tag == aot::ArgKind::kRWTexture) {
-      TI_ASSERT(ival.tag == aot::ArgKind::kTexture);
-      Texture *tex = reinterpret_cast<Texture *>(ival.val);
-      ctx.set_arg_rw_texture({i}, *tex);
-    } else if (symbolic_arg.tag == aot::ArgKind::kMatrix) {
-      TI_ASSERT(ival.tag == aot::ArgKind::kMatrix);
-      Matrix *mat = reinterpret_cast<Matrix *>(ival.val);
-
-      uint32_t symbolic_arg_size = (uint32_t)(symbolic_arg.element_shape[0] *
-                                              symbolic_arg.element_shape[1]);
-      TI_ERROR_IF(symbolic_arg_size != mat->length(),
-                  "Dispatch node is compiled for argument {} with "
-                  "size={} but got a matrix with size={}",
-                  symbolic_arg.name, symbolic_arg_size, mat->length());
-      TI_ERROR_IF(mat->length() * data_type_size(mat->dtype()) > 128,
-                  "Matrix size={} is out of bound",
-                  mat->length() * data_type_size(mat->dtype()));
-      ctx.set_arg_matrix(i, *mat);
+void BoundGraph::run() {
+  for (auto &bound_dispatch : dispatches_) {
+    if (bound_dispatch.compiled_kernel_data) {
+      auto *prog = bound_dispatch.dispatch->ti_kernel->program;
+      prog->launch_kernel(*bound_dispatch.compiled_kernel_data,
+                          bound_dispatch.ctx);
     } else {
-      TI_ERROR("Error in compiled graph: unknown tag {}", int(ival.tag));
+      bound_dispatch.dispatch->compiled_kernel->launch(bound_dispatch.ctx);
     }
   }
 }
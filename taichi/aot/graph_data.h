@@ -9,6 +9,7 @@
 #define TI_RUNTIME_HOST
 #include "taichi/program/context.h"
 #undef TI_RUNTIME_HOST
+#include "taichi/program/launch_context_builder.h"
 
 template <typename T, typename G>
 T taichi_union_cast_with_different_sizes(G g);
@@ -19,6 +20,7 @@ class Ndarray;
 class Texture;
 class Matrix;
 class Kernel;
+class CompiledKernelData;
 
 namespace aot {
 // Currently only scalar, matrix and ndarray are supported.
@@ -162,6 +164,66 @@ struct CompiledDispatch {
   TI_IO_DEF(kernel_name, symbolic_args);
 };
 
+struct CompiledGraph;
+
+/**
+ * A CompiledGraph with its runtime values bound.
+ *
+ * Argument names are resolved to dispatch parameters and validated once, when
+ * the graph is bound, and every dispatch keeps its own launch context. A
+ * replay therefore only launches the kernels; set_arg() re-binds a single
+ * value and patches just the contexts of the dispatches that use it.
+ *
+ * Bound ndarrays and textures are referenced, not copied, and must outlive
+ * the BoundGraph, as must the CompiledGraph itself.
+ */
+class TI_DLL_EXPORT BoundGraph {
+ public:
+  BoundGraph(BoundGraph &&) = default;
+  BoundGraph &operator=(BoundGraph &&) = default;
+
+  /**
+   * @brief Re-binds the runtime value of the graph argument |name|
+   *
+   * Re-binding a scalar, ndarray or texture to the value it already holds is
+   * a no-op.
+   */
+  void set_arg(const std::string &name, const IValue &value);
+
+  /**
+   * @brief Launches every dispatch of the graph with the bound values
+   *
+   * This does not manage the device to host synchronization.
+   */
+  void run();
+
+ private:
+  friend struct CompiledGraph;
+
+  // One use of a graph argument: parameter |param| of dispatch |dispatch|.
+  struct ArgUse {
+    int dispatch;
+    int param;
+  };
+
+  struct BoundDispatch {
+    const CompiledDispatch *dispatch;
+    LaunchContextBuilder ctx;
+    // Only set for graphs bound with CompiledGraph::jit_bind().
+    const CompiledKernelData *compiled_kernel_data{nullptr};
+  };
+
+  explicit BoundGraph(const CompiledGraph &graph,
+                      const std::unordered_map<std::string, IValue> &args,
+                      const CompileConfig *compile_config);
+
+  std::vector<BoundDispatch> dispatches_;
+  std::unordered_map<std::string, std::vector<ArgUse>> uses_;
+  // Values of the bound scalars, ndarrays and textures. Matrices are copied
+  // into the contexts and never compared.
+  std::unordered_map<std::string, IValue> values_;
+};
+
 struct TI_DLL_EXPORT CompiledGraph {
   std::vector<CompiledDispatch> dispatches;
   std::unordered_map<std::string, aot::Arg> args;
@@ -170,6 +232,20 @@ struct TI_DLL_EXPORT CompiledGraph {
   void jit_run(const CompileConfig &compile_config,
                const std::unordered_map<std::string, IValue> &args) const;
 
+  /**
+   * @brief Binds |args| for replaying the graph loaded from an AOT module
+   */
+  BoundGraph bind(const std::unordered_map<std::string, IValue> &args) const;
+
+  /**
+   * @brief Binds |args| for replaying the graph with JIT-compiled kernels
+   *
+   * The kernels are compiled (or fetched from the cache) here, not on replay.
+   */
+  BoundGraph jit_bind(
+      const CompileConfig &compile_config,
+      const std::unordered_map<std::string, IValue> &args) const;
+
   TI_IO_DEF(dispatches);
 
  private:
@@ -96,6 +96,9 @@ LLVMCompiledKernel KernelCodeGen::compile_kernel_to_module() {
   }
   worker.flush();
 
+  // Linking and optimizing happen in the linking context, which is shared by
+  // the kernels being compiled concurrently.
+  std::lock_guard<std::mutex> _(tlctx_.linking_context_mut);
   auto llvm_compiled_kernel = tlctx_.link_compiled_tasks(std::move(data));
   optimize_module(llvm_compiled_kernel.module.get());
   return llvm_compiled_kernel;
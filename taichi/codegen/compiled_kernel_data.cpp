@@ -1,10 +1,48 @@
 #include "compiled_kernel_data.h"
+
+#include <cstring>
+#include <string_view>
+
 #include "taichi/common/logging.h"
+#include "taichi/common/miniz.h"
 
 #include "picosha2.h"
 
 namespace taichi::lang {
 
+namespace {
+
+// Flags of the files with the kExtHeadStr head
+enum ExtFlags : std::uint32_t {
+  kCompressed = 0x1,
+};
+
+template <typename T>
+void append_pod(std::string &buf, const T &value) {
+  buf.append((const char *)&value, sizeof(T));
+}
+
+template <typename T>
+bool read_pod(std::string_view &buf, T &value) {
+  if (buf.size() < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, buf.data(), sizeof(T));
+  buf.remove_prefix(sizeof(T));
+  return true;
+}
+
+bool read_str(std::string_view &buf, std::size_t size, std::string &str) {
+  if (buf.size() < size) {
+    return false;
+  }
+  str.assign(buf.data(), size);
+  buf.remove_prefix(size);
+  return true;
+}
+
+}  // namespace
+
 static CompiledKernelData::Err translate_err(CompiledKernelDataFile::Err err) {
   switch (err) {
     case CompiledKernelDataFile::Err::kNoError:
@@ -17,11 +55,21 @@ static CompiledKernelData::Err translate_err(CompiledKernelDataFile::Err err) {
       return CompiledKernelData::Err::kOutOfMemory;
     case CompiledKernelDataFile::Err::kIOStreamError:
       return CompiledKernelData::Err::kIOStreamError;
+    case CompiledKernelDataFile::Err::kSharedSrcNotFound:
+      return CompiledKernelData::Err::kSharedSrcNotFound;
   }
   return CompiledKernelData::Err::kUnknown;
 }
 
+void CompiledKernelDataFile::add_shared_src(std::string src) {
+  shared_src_keys_.push_back(picosha2::hash256_hex_string(src));
+  shared_srcs_.push_back(std::move(src));
+}
+
 CompiledKernelDataFile::Err CompiledKernelDataFile::dump(std::ostream &os) {
+  if (compressed_ || !shared_srcs_.empty()) {
+    return dump_ext(os);
+  }
   try {
     update_hash();
     std::uint32_t arch = static_cast<std::uint32_t>(arch_);
@@ -48,6 +96,8 @@ CompiledKernelDataFile::Err CompiledKernelDataFile::load(std::istream &is) {
   try {
     if (!is.read(head_, std::size(head_))) {
       return Err::kIOStreamError;
+    } else if (std::strncmp(head_, kExtHeadStr, kHeadSize) == 0) {
+      return load_ext(is);
     } else if (std::strncmp(head_, kHeadStr, kHeadSize) != 0) {
       return Err::kNotTicFile;
     }
@@ -83,6 +133,10 @@ bool CompiledKernelDataFile::update_hash() {
   picosha2::hash256_one_by_one hasher;
   hasher.process(metadata_.begin(), metadata_.end());
   hasher.process(src_code_.begin(), src_code_.end());
+  // The keys are the hashes of the shared sources.
+  for (const auto &key : shared_src_keys_) {
+    hasher.process(key.begin(), key.end());
+  }
   hasher.finish();
   auto hash = picosha2::get_hash_hex_string(hasher);
   if (hash == hash_) {
@@ -93,6 +147,129 @@ bool CompiledKernelDataFile::update_hash() {
   return true;
 }
 
+// The body holds the metadata, the source and the shared sources, and is
+// deflated if the kCompressed flag is set:
+//   head | arch | flags | raw body size | body size | body | hash
+CompiledKernelDataFile::Err CompiledKernelDataFile::dump_ext(std::ostream &os) {
+  try {
+    update_hash();
+    std::string body;
+    append_pod(body, (std::uint64_t)metadata_.size());
+    body.append(metadata_);
+    append_pod(body, (std::uint64_t)src_code_.size());
+    body.append(src_code_);
+    append_pod(body, (std::uint32_t)shared_srcs_.size());
+    for (std::size_t i = 0; i < shared_srcs_.size(); i++) {
+      const auto &key = shared_src_keys_[i];
+      const auto &src = shared_srcs_[i];
+      // Keep the source in the file if the store can't.
+      std::uint8_t inlined =
+          !shared_src_store_ || !shared_src_store_->store(key, src);
+      append_pod(body, inlined);
+      body.append(key);
+      if (inlined) {
+        append_pod(body, (std::uint64_t)src.size());
+        body.append(src);
+      }
+    }
+    std::uint32_t flags = 0;
+    std::uint64_t raw_body_size = body.size();
+    if (compressed_) {
+      std::string deflated(mz_compressBound(body.size()), '\0');
+      mz_ulong deflated_size = deflated.size();
+      if (mz_compress2((unsigned char *)deflated.data(), &deflated_size,
+                       (const unsigned char *)body.data(), body.size(),
+                       MZ_DEFAULT_LEVEL) == MZ_OK) {
+        deflated.resize(deflated_size);
+        body = std::move(deflated);
+        flags |= kCompressed;
+      }
+    }
+    std::uint32_t arch = static_cast<std::uint32_t>(arch_);
+    std::uint64_t body_size = body.size();
+    bool io_success =
+        os.write(kExtHeadStr, kHeadSize) &&
+        os.write((const char *)&arch, sizeof(arch)) &&
+        os.write((const char *)&flags, sizeof(flags)) &&
+        os.write((const char *)&raw_body_size, sizeof(raw_body_size)) &&
+        os.write((const char *)&body_size, sizeof(body_size)) &&
+        os.write(body.data(), body_size) &&
+        os.write((const char *)hash_.data(), kHashSize);
+    if (!io_success) {
+      return Err::kIOStreamError;
+    }
+  } catch (std::bad_alloc &) {
+    return Err::kOutOfMemory;
+  }
+  return Err::kNoError;
+}
+
+CompiledKernelDataFile::Err CompiledKernelDataFile::load_ext(std::istream &is) {
+  std::uint32_t arch;
+  std::uint32_t flags;
+  std::uint64_t raw_body_size;
+  std::uint64_t body_size;
+  bool io_success = is.read((char *)&arch, sizeof(arch)) &&
+                    is.read((char *)&flags, sizeof(flags)) &&
+                    is.read((char *)&raw_body_size, sizeof(raw_body_size)) &&
+                    is.read((char *)&body_size, sizeof(body_size));
+  if (!io_success) {
+    return Err::kIOStreamError;
+  }
+  arch_ = static_cast<Arch>(arch);
+  std::string body(body_size, '\0');
+  hash_.resize(kHashSize);
+  io_success = is.read(body.data(), body_size) &&
+               is.read((char *)hash_.data(), kHashSize);
+  if (!io_success) {
+    return Err::kIOStreamError;
+  }
+  if (flags & kCompressed) {
+    std::string inflated(raw_body_size, '\0');
+    mz_ulong inflated_size = inflated.size();
+    if (mz_uncompress((unsigned char *)inflated.data(), &inflated_size,
+                      (const unsigned char *)body.data(),
+                      body.size()) != MZ_OK ||
+        inflated_size != raw_body_size) {
+      return Err::kCorruptedFile;
+    }
+    body = std::move(inflated);
+  }
+
+  std::string_view buf = body;
+  std::uint64_t size;
+  std::uint32_t num_shared_srcs;
+  if (!read_pod(buf, size) || !read_str(buf, size, metadata_) ||
+      !read_pod(buf, size) || !read_str(buf, size, src_code_) ||
+      !read_pod(buf, num_shared_srcs)) {
+    return Err::kCorruptedFile;
+  }
+  shared_srcs_.clear();
+  shared_src_keys_.clear();
+  for (std::uint32_t i = 0; i < num_shared_srcs; i++) {
+    std::uint8_t inlined;
+    auto &key = shared_src_keys_.emplace_back();
+    auto &src = shared_srcs_.emplace_back();
+    if (!read_pod(buf, inlined) || !read_str(buf, kHashSize, key)) {
+      return Err::kCorruptedFile;
+    }
+    if (inlined) {
+      if (!read_pod(buf, size) || !read_str(buf, size, src)) {
+        return Err::kCorruptedFile;
+      }
+    } else if (!shared_src_store_ || !shared_src_store_->load(key, src)) {
+      return Err::kSharedSrcNotFound;
+    }
+    if (picosha2::hash256_hex_string(src) != key) {
+      return Err::kCorruptedFile;
+    }
+  }
+  if (update_hash()) {
+    return Err::kCorruptedFile;
+  }
+  return Err::kNoError;
+}
+
 #if !defined(TI_WITH_LLVM)
 CompiledKernelData::Creator *const CompiledKernelData::llvm_creator = nullptr;
 #endif
@@ -102,10 +279,12 @@ CompiledKernelData::Creator *const CompiledKernelData::llvm_creator = nullptr;
 CompiledKernelData::Creator *const CompiledKernelData::spriv_creator = nullptr;
 #endif
 
-CompiledKernelData::Err CompiledKernelData::load(std::istream &is) {
+CompiledKernelData::Err CompiledKernelData::load(std::istream &is,
+                                                 SharedSrcStore *store) {
   try {
     Err err = Err::kNoError;
     CompiledKernelDataFile file;
+    file.set_shared_src_store(store);
     if (err = translate_err(file.load(is)); err != Err::kNoError) {
       return err;
     }
@@ -115,10 +294,14 @@ CompiledKernelData::Err CompiledKernelData::load(std::istream &is) {
   }
 }
 
-CompiledKernelData::Err CompiledKernelData::dump(std::ostream &os) const {
+CompiledKernelData::Err CompiledKernelData::dump(std::ostream &os,
+                                                 SharedSrcStore *store,
+                                                 bool compress) const {
   try {
     Err err = Err::kNoError;
     CompiledKernelDataFile file;
+    file.set_shared_src_store(store);
+    file.set_compressed(compress);
     if (err = dump_impl(file); err != Err::kNoError) {
       return err;
     }
@@ -129,10 +312,13 @@ CompiledKernelData::Err CompiledKernelData::dump(std::ostream &os) const {
 }
 
 // static functions
-std::unique_ptr<CompiledKernelData> CompiledKernelData::load(std::istream &is,
-                                                             Err *p_err) {
+std::unique_ptr<CompiledKernelData> CompiledKernelData::load(
+    std::istream &is,
+    Err *p_err,
+    SharedSrcStore *store) {
   Err err = Err::kNoError;
   CompiledKernelDataFile file;
+  file.set_shared_src_store(store);
   std::unique_ptr<CompiledKernelData> result{nullptr};
   try {
     err = translate_err(file.load(is));
@@ -183,6 +369,8 @@ std::string CompiledKernelData::get_err_msg(Err err) {
       return "The taichi is not built with spirv";
     case Err::kCompiledKernelDataBroken:
       return "The CompiledKernelData is broken";
+    case Err::kSharedSrcNotFound:
+      return "A shared source of the file is not found";
     case Err::kUnknown:
       return "Unkown error";
   }
@@ -4,6 +4,7 @@
 #include <memory>
 #include <optional>
 #include <algorithm>
+#include <vector>
 
 #include "taichi/rhi/arch.h"
 
@@ -23,9 +24,22 @@ class KernelLaunchHandle {
   int launch_id_{-1};
 };
 
+// Keeps the sources shared by several cached kernels only once, see
+// CompiledKernelDataFile::add_shared_src().
+class SharedSrcStore {
+ public:
+  virtual ~SharedSrcStore() = default;
+
+  // |key| is the SHA-256 of |src|.
+  virtual bool load(const std::string &key, std::string &src) = 0;
+  virtual bool store(const std::string &key, const std::string &src) = 0;
+};
+
 class CompiledKernelDataFile {
  public:
   static constexpr char kHeadStr[] = "TIC";
+  // Head of the files which are compressed or have shared sources
+  static constexpr char kExtHeadStr[] = "TIX";
   static constexpr std::size_t kHeadSize = std::size(kHeadStr);
   static constexpr std::size_t kHashSize = 64;
   enum class Err {
@@ -34,6 +48,7 @@ class CompiledKernelDataFile {
     kCorruptedFile,
     kOutOfMemory,
     kIOStreamError,
+    kSharedSrcNotFound,
   };
 
   Err dump(std::ostream &os);
@@ -67,14 +82,42 @@ class CompiledKernelDataFile {
     return src_code_;
   }
 
+  // Adds a part of the source which other kernels may have as well, e.g. a
+  // runtime function. With a shared source store, dump() only writes its key
+  // and leaves the source to the store.
+  void add_shared_src(std::string src);
+
+  const std::vector<std::string> &shared_srcs() const {
+    return shared_srcs_;
+  }
+
+  void set_shared_src_store(SharedSrcStore *store) {
+    shared_src_store_ = store;
+  }
+
+  SharedSrcStore *shared_src_store() const {
+    return shared_src_store_;
+  }
+
+  // Deflate the metadata and the sources in dump()
+  void set_compressed(bool compressed) {
+    compressed_ = compressed;
+  }
+
  private:
   bool update_hash();
+  Err dump_ext(std::ostream &os);
+  Err load_ext(std::istream &is);
 
   char head_[kHeadSize];
   Arch arch_;
   std::string metadata_;
   std::string src_code_;
+  std::vector<std::string> shared_srcs_;
+  std::vector<std::string> shared_src_keys_;
   std::string hash_;
+  SharedSrcStore *shared_src_store_{nullptr};
+  bool compressed_{false};
 };
 
 class CompiledKernelData {
@@ -93,6 +136,7 @@ class CompiledKernelData {
     kTiWithoutLLVM,
     kTiWithoutSpirv,
     kCompiledKernelDataBroken,
+    kSharedSrcNotFound,
     kUnknown,
   };
 
@@ -103,8 +147,11 @@ class CompiledKernelData {
 
   virtual Arch arch() const = 0;
 
-  Err load(std::istream &is);
-  Err dump(std::ostream &os) const;
+  // Shared sources are loaded from and stored to |store| if there is one.
+  Err load(std::istream &is, SharedSrcStore *store = nullptr);
+  Err dump(std::ostream &os,
+           SharedSrcStore *store = nullptr,
+           bool compress = false) const;
 
   virtual std::unique_ptr<CompiledKernelData> clone() const = 0;
 
@@ -124,7 +171,10 @@ class CompiledKernelData {
     return kernel_launch_handle_;
   }
 
-  static std::unique_ptr<CompiledKernelData> load(std::istream &is, Err *p_err);
+  static std::unique_ptr<CompiledKernelData> load(
+      std::istream &is,
+      Err *p_err,
+      SharedSrcStore *store = nullptr);
 
   static std::string get_err_msg(Err err);
 
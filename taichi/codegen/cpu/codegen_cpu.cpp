@@ -23,6 +23,49 @@ namespace taichi::lang {
 
 namespace {
 
+// The features of the host CPU, as LLVM names them.
+const llvm::StringMap<bool> &get_host_cpu_features() {
+  static const llvm::StringMap<bool> features = [] {
+    llvm::StringMap<bool> features;
+    if (!llvm::sys::getHostCPUFeatures(features)) {
+      features.clear();
+    }
+    return features;
+  }();
+  return features;
+}
+
+bool host_has_cpu_feature(const std::string &feature) {
+  return get_host_cpu_features().lookup(feature);
+}
+
+// The width of the vector registers the generated code should use. LLVM also
+// prefers 256-bit vectors on AVX-512 CPUs, to avoid downclocking.
+int get_host_vector_bits() {
+  if (host_has_cpu_feature("avx") || host_has_cpu_feature("avx512f")) {
+    return 256;
+  } else if (host_has_cpu_feature("sse2") || host_has_cpu_feature("neon")) {
+    return 128;
+  }
+  return 0;
+}
+
+// Masked loads and stores are cheap enough for the vector loop to also run
+// the remainder iterations.
+bool host_has_masked_memory_ops() {
+  return host_has_cpu_feature("avx2") || host_has_cpu_feature("avx512f") ||
+         host_has_cpu_feature("sve");
+}
+
+std::string get_host_cpu_feature_string() {
+  std::vector<std::string> features;
+  for (auto &feature : get_host_cpu_features()) {
+    features.push_back((feature.second ? "+" : "-") + feature.first().str());
+  }
+  std::sort(features.begin(), features.end());
+  return fmt::format("{}", fmt::join(features, ","));
+}
+
 class TaskCodeGenCPU : public TaskCodeGenLLVM {
  public:
   using IRVisitor::visit;
@@ -66,12 +109,152 @@ class TaskCodeGenCPU : public TaskCodeGenLLVM {
 
     llvm::Value *epilogue = create_xlogue(stmt->tls_epilogue);
 
+    // The runtime tells the two kinds of bodies apart by |block_body|.
+    // Demoted dense struct-fors always run a block at a time, so that their
+    // block loops carry the vectorization hints.
+    llvm::Value *task_body = body;
+    const bool block_body = compile_config.cpu_block_range_for ||
+                            stmt->is_demoted_dense_struct_for;
+    if (block_body) {
+      task_body = builder->CreatePointerCast(
+          create_range_for_block_body(body, step,
+                                      stmt->is_demoted_dense_struct_for),
+          body->getType());
+    }
+
     auto [begin, end] = get_range_for_bounds(stmt);
 
-    call("cpu_parallel_range_for", get_arg(0),
+    if (stmt->cpu_schedule == CpuLoopSchedule::static_partition) {
+      call("cpu_parallel_range_for", get_arg(0),
+           tlctx->get_constant(stmt->num_cpu_threads), begin, end,
+           tlctx->get_constant(step), tlctx->get_constant(stmt->block_dim),
+           tls_prologue, task_body, epilogue,
+           tlctx->get_constant(stmt->tls_size),
+           tlctx->get_constant((int)block_body));
+      return;
+    }
+
+    // The measured cost per iteration outlives the launch, so that the next
+    // launch of this offload can size its chunks from it.
+    auto feedback_type = llvm::Type::getDoubleTy(*llvm_context);
+    auto feedback = new llvm::GlobalVariable(
+        *module, feedback_type, false, llvm::GlobalValue::InternalLinkage,
+        llvm::ConstantFP::get(feedback_type, 0.0), "schedule_feedback");
+    call("cpu_parallel_range_for_scheduled", get_arg(0),
          tlctx->get_constant(stmt->num_cpu_threads), begin, end,
          tlctx->get_constant(step), tlctx->get_constant(stmt->block_dim),
-         tls_prologue, body, epilogue, tlctx->get_constant(stmt->tls_size));
+         tls_prologue, task_body, epilogue, tlctx->get_constant(stmt->tls_size),
+         tlctx->get_constant((int)block_body),
+         tlctx->get_constant((int)stmt->cpu_schedule), feedback);
+  }
+
+  // Wraps the body of a range-for into a function running the iterations
+  // [block_start, block_end), from the top if |step| is -1. The body is
+  // called directly and inlined, so that the loop can be unrolled and
+  // vectorized instead of making an indirect call per iteration. The loop
+  // gets the vectorization hints if |dense_loop|, i.e. the range-for is a
+  // demoted struct-for over dense containers.
+  //
+  // Function structure:
+  //
+  // function_body (entry):
+  //   loop_index = step == 1 ? block_start : block_end - 1
+  //   goto block_loop_test
+  //
+  // block_loop_test:
+  //   if (step == 1 ? loop_index < block_end : loop_index >= block_start)
+  //     goto block_loop_body
+  //   else
+  //     goto block_loop_exit
+  //
+  // block_loop_body:
+  //   body(context, tls, loop_index)
+  //   loop_index += step
+  //   goto block_loop_test
+  //
+  // block_loop_exit:
+  llvm::Function *create_range_for_block_body(llvm::Function *body,
+                                              int step,
+                                              bool dense_loop) {
+    body->addFnAttr(llvm::Attribute::AlwaysInline);
+    auto guard = get_function_creation_guard(
+        {llvm::PointerType::get(get_runtime_type("RuntimeContext"), 0),
+         llvm::Type::getInt8PtrTy(*llvm_context), tlctx->get_data_type<int>(),
+         tlctx->get_data_type<int>()});
+
+    auto loop_test_bb =
+        llvm::BasicBlock::Create(*llvm_context, "block_loop_test", func);
+    auto loop_body_bb =
+        llvm::BasicBlock::Create(*llvm_context, "block_loop_body", func);
+    auto loop_exit_bb =
+        llvm::BasicBlock::Create(*llvm_context, "block_loop_exit", func);
+    auto loop_index = create_entry_block_alloca(PrimitiveType::i32);
+    if (step == 1) {
+      builder->CreateStore(get_arg(2), loop_index);
+    } else {
+      builder->CreateStore(
+          builder->CreateSub(get_arg(3), tlctx->get_constant(1)), loop_index);
+    }
+    builder->CreateBr(loop_test_bb);
+
+    {
+      builder->SetInsertPoint(loop_test_bb);
+      auto *loop_index_load =
+          builder->CreateLoad(builder->getInt32Ty(), loop_index);
+      auto cond =
+          step == 1
+              ? builder->CreateICmpSLT(loop_index_load, get_arg(3))
+              : builder->CreateICmpSGE(loop_index_load, get_arg(2));
+      builder->CreateCondBr(cond, loop_body_bb, loop_exit_bb);
+    }
+
+    {
+      builder->SetInsertPoint(loop_body_bb);
+      auto *loop_index_load =
+          builder->CreateLoad(builder->getInt32Ty(), loop_index);
+      call(body, {get_arg(0), get_arg(1), loop_index_load});
+      builder->CreateStore(
+          builder->CreateAdd(loop_index_load, tlctx->get_constant(step)),
+          loop_index);
+      auto back_edge = builder->CreateBr(loop_test_bb);
+      if (dense_loop) {
+        mark_dense_loop(back_edge);
+      }
+    }
+
+    builder->SetInsertPoint(loop_exit_bb);
+    return guard.body;
+  }
+
+  // Asks the loop vectorizer for |simd_width| 32-bit lanes, at most as many
+  // as the host vector registers hold, and to run the remainder iterations in
+  // the vector loop with masked loads and stores when the host has them.
+  // Non-contiguous accesses become gathers and scatters where the target
+  // supports them. A width hint, unlike llvm.loop.vectorize.enable, does not
+  // warn about the loops that cannot be vectorized, e.g. because of atomics.
+  void mark_dense_loop(llvm::BranchInst *back_edge) override {
+    const int width =
+        std::min(compile_config.simd_width, get_host_vector_bits() / 32);
+    if (width <= 1) {
+      return;
+    }
+    auto *i32_ty = llvm::Type::getInt32Ty(*llvm_context);
+    auto make_hint = [&](const char *name, llvm::Constant *value) {
+      return llvm::MDNode::get(
+          *llvm_context, {llvm::MDString::get(*llvm_context, name),
+                          llvm::ConstantAsMetadata::get(value)});
+    };
+    // The first operand of a loop ID refers to the loop ID itself
+    std::vector<llvm::Metadata *> operands{nullptr};
+    operands.push_back(make_hint("llvm.loop.vectorize.width",
+                                 llvm::ConstantInt::get(i32_ty, width)));
+    if (host_has_masked_memory_ops()) {
+      operands.push_back(make_hint("llvm.loop.vectorize.predicate.enable",
+                                   llvm::ConstantInt::getTrue(*llvm_context)));
+    }
+    auto *loop_id = llvm::MDNode::getDistinct(*llvm_context, operands);
+    loop_id->replaceOperandWith(0, loop_id);
+    back_edge->setMetadata(llvm::LLVMContext::MD_loop, loop_id);
   }
 
   void create_offload_mesh_for(OffloadedStmt *stmt) override {
@@ -269,9 +452,12 @@ void KernelCodeGenCPU::optimize_module(llvm::Module *module) {
   llvm::legacy::FunctionPassManager function_pass_manager(module);
   llvm::legacy::PassManager module_pass_manager;
 
+  // Target the exact features of the host, which may differ from those
+  // implied by the CPU name, e.g. on virtual machines
   llvm::StringRef mcpu = llvm::sys::getHostCPUName();
   std::unique_ptr<llvm::TargetMachine> target_machine(
-      target->createTargetMachine(triple.str(), mcpu.str(), "", options,
+      target->createTargetMachine(triple.str(), mcpu.str(),
+                                  get_host_cpu_feature_string(), options,
                                   llvm::Reloc::PIC_, llvm::CodeModel::Small,
                                   llvm::CodeGenOpt::Aggressive));
 
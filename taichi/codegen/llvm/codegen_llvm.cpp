@@ -242,6 +242,24 @@ std::unique_ptr<RuntimeObject> TaskCodeGenLLVM::emit_struct_meta_object(
     meta = std::make_unique<RuntimeObject>("DynamicMeta", this, builder.get());
     emit_struct_meta_base("Dynamic", meta->ptr, snode);
     meta->call("set_chunk_size", tlctx->get_constant(snode->chunk_size));
+    // Chunk table blocks come from the chunk allocator, so a block holds as
+    // many pointers as fit in a chunk. Short lists only walk the chunk list.
+    const int64 max_num_chunks =
+        (snode->max_num_elements() + snode->chunk_size - 1) / snode->chunk_size;
+    const int64 chunk_bytes =
+        sizeof(void *) + (int64)snode->cell_size_bytes * snode->chunk_size;
+    int64 fanout = std::min(chunk_bytes / (int64)sizeof(void *),
+                            (int64)std::numeric_limits<int>::max());
+    int64 stride = 1;
+    if (fanout < 2 || max_num_chunks <= taichi_dynamic_num_list_chunks) {
+      fanout = 0;
+    } else {
+      while (stride * fanout < max_num_chunks) {
+        stride *= fanout;
+      }
+    }
+    meta->call("set_chunk_table_fanout", tlctx->get_constant((int)fanout));
+    meta->call("set_chunk_table_stride", tlctx->get_constant((int)stride));
   } else if (snode->type == SNodeType::bitmasked) {
     meta =
         std::make_unique<RuntimeObject>("BitmaskedMeta", this, builder.get());
@@ -2108,6 +2126,14 @@ void TaskCodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt) {
     }
   }
 
+  // On CPU, the TLS xlogues are separate functions which the runtime calls
+  // once per thread (see cpu_parallel_struct_for), instead of once per block.
+  const bool per_thread_tls_xlogues = arch_is_cpu(current_arch());
+  llvm::Value *tls_prologue = nullptr;
+  if (per_thread_tls_xlogues) {
+    tls_prologue = create_xlogue(stmt->tls_prologue);
+  }
+
   {
     // Create the loop body function
     auto guard = get_function_creation_guard({
@@ -2176,7 +2202,7 @@ void TaskCodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt) {
     call(refine, parent_coordinates, block_corner_coordinates,
          tlctx->get_constant(0));
 
-    if (stmt->tls_prologue) {
+    if (stmt->tls_prologue && !per_thread_tls_xlogues) {
       stmt->tls_prologue->accept(this);
     }
 
@@ -2271,7 +2297,10 @@ void TaskCodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt) {
       builder->SetInsertPoint(body_tail_bb);
 
       create_increment(loop_index, block_dim);
-      builder->CreateBr(loop_test_bb);
+      auto back_edge = builder->CreateBr(loop_test_bb);
+      if (leaf_block->type == SNodeType::dense && !stmt->is_bit_vectorized) {
+        mark_dense_loop(back_edge);
+      }
 
       builder->SetInsertPoint(func_exit);
     }
@@ -2282,7 +2311,7 @@ void TaskCodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt) {
       call("block_barrier");  // "__syncthreads()"
     }
 
-    if (stmt->tls_epilogue) {
+    if (stmt->tls_epilogue && !per_thread_tls_xlogues) {
       stmt->tls_epilogue->accept(this);
     }
   }
@@ -2292,24 +2321,35 @@ void TaskCodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt) {
   int num_splits = std::max(1, list_element_size / stmt->block_dim +
                                    (list_element_size % stmt->block_dim != 0));
 
-  auto struct_for_func = get_runtime_function("parallel_struct_for");
-
-  if (arch_is_gpu(current_arch())) {
-    struct_for_func = llvm::cast<llvm::Function>(
-        module
-            ->getOrInsertFunction(
-                tlctx->get_struct_for_func_name(stmt->tls_size),
-                struct_for_func->getFunctionType(),
-                struct_for_func->getAttributes())
-            .getCallee());
-    struct_for_tls_sizes.insert(stmt->tls_size);
-  }
-  // Loop over nodes in the element list, in parallel
-  call(struct_for_func, get_context(), tlctx->get_constant(leaf_block->id),
-       tlctx->get_constant(list_element_size), tlctx->get_constant(num_splits),
-       body, tlctx->get_constant(stmt->tls_size),
-       tlctx->get_constant(stmt->num_cpu_threads));
-  // TODO: why do we need num_cpu_threads on GPUs?
+  if (per_thread_tls_xlogues) {
+    llvm::Value *tls_epilogue = create_xlogue(stmt->tls_epilogue);
+    call("cpu_parallel_struct_for", get_context(),
+         tlctx->get_constant(leaf_block->id),
+         tlctx->get_constant(list_element_size),
+         tlctx->get_constant(num_splits), body, tls_prologue, tls_epilogue,
+         tlctx->get_constant(stmt->tls_size),
+         tlctx->get_constant(stmt->num_cpu_threads));
+  } else {
+    auto struct_for_func = get_runtime_function("parallel_struct_for");
+
+    if (arch_is_gpu(current_arch())) {
+      struct_for_func = llvm::cast<llvm::Function>(
+          module
+              ->getOrInsertFunction(
+                  tlctx->get_struct_for_func_name(stmt->tls_size),
+                  struct_for_func->getFunctionType(),
+                  struct_for_func->getAttributes())
+              .getCallee());
+      struct_for_tls_sizes.insert(stmt->tls_size);
+    }
+    // Loop over nodes in the element list, in parallel
+    call(struct_for_func, get_context(), tlctx->get_constant(leaf_block->id),
+         tlctx->get_constant(list_element_size),
+         tlctx->get_constant(num_splits), body,
+         tlctx->get_constant(stmt->tls_size),
+         tlctx->get_constant(stmt->num_cpu_threads));
+    // TODO: why do we need num_cpu_threads on GPUs?
+  }
 
   current_coordinates = nullptr;
   parent_coordinates = nullptr;
@@ -356,6 +356,12 @@ class TaskCodeGenLLVM : public IRVisitor, public LLVMModuleBuilder {
 
   void create_offload_struct_for(OffloadedStmt *stmt);
 
+  // Called with the back edge of a loop over the cells of a dense container,
+  // whose iterations are independent. Backends may attach vectorization
+  // hints to it.
+  virtual void mark_dense_loop(llvm::BranchInst *back_edge) {
+  }
+
   void visit(LoopIndexStmt *stmt) override;
 
   void visit(LoopLinearIndexStmt *stmt) override;
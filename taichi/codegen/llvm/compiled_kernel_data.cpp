@@ -1,11 +1,145 @@
 #include "taichi/codegen/llvm/compiled_kernel_data.h"
 
+#include <unordered_set>
+
 #include "llvm/IR/Verifier.h"
 #include "llvm/AsmParser/Parser.h"
+#include "llvm/Linker/Linker.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 
 namespace taichi::lang {
 
+namespace {
+
+// Named metadata keeping the linkage of the globals which were made external
+// to move the functions using them to the shared sources
+constexpr char kInternalGlobalsMD[] = "taichi.internal_globals";
+constexpr char kPrivateGlobalsMD[] = "taichi.private_globals";
+// Smaller functions aren't worth a shared source of their own.
+constexpr std::size_t kMinSharedFunctionSize = 32;  // instructions
+
+std::string print_module(const llvm::Module &module) {
+  std::string str;
+  llvm::raw_string_ostream oss(str);
+  module.print(oss, /*AAW=*/nullptr);
+  return oss.str();
+}
+
+// Moves the functions linked from the runtime and the struct modules out of
+// |module|, and returns them printed one per module. Each of them is printed
+// in the same way in every kernel having it, so that a SharedSrcStore keeps
+// it only once.
+std::vector<std::string> split_shared_functions(
+    llvm::Module &module,
+    const std::vector<OffloadedTask> &tasks) {
+  std::unordered_set<std::string> task_names;
+  for (const auto &t : tasks) {
+    task_names.insert(t.name);
+  }
+  std::vector<llvm::Function *> shared;
+  for (auto &f : module) {
+    if (!f.isDeclaration() && f.hasLocalLinkage() &&
+        !task_names.count(f.getName().str()) &&
+        f.getInstructionCount() >= kMinSharedFunctionSize) {
+      shared.push_back(&f);
+    }
+  }
+  // The globals are linked back by name.
+  for (auto &gv : module.global_values()) {
+    if (gv.hasLocalLinkage() && !gv.hasName()) {
+      return {};
+    }
+  }
+  if (shared.empty()) {
+    return {};
+  }
+
+  auto &ctx = module.getContext();
+  std::vector<llvm::Metadata *> internal_globals;
+  std::vector<llvm::Metadata *> private_globals;
+  for (auto &gv : module.global_values()) {
+    if (gv.hasLocalLinkage()) {
+      auto &globals =
+          gv.hasPrivateLinkage() ? private_globals : internal_globals;
+      globals.push_back(llvm::MDString::get(ctx, gv.getName()));
+      gv.setLinkage(llvm::GlobalValue::ExternalLinkage);
+    }
+  }
+
+  std::vector<std::string> srcs;
+  for (auto *f : shared) {
+    llvm::ValueToValueMapTy vmap;
+    auto shared_module = llvm::CloneModule(
+        module, vmap, [f](const llvm::GlobalValue *gv) { return gv == f; });
+    shared_module->setModuleIdentifier("shared");
+    shared_module->setSourceFileName("shared");
+    while (!shared_module->named_metadata_empty()) {
+      shared_module->eraseNamedMetadata(
+          &*shared_module->named_metadata_begin());
+    }
+    // Only keep the declarations |f| uses.
+    for (auto iter = shared_module->begin(); iter != shared_module->end();) {
+      auto &g = *iter++;
+      if (g.isDeclaration() && g.use_empty()) {
+        g.eraseFromParent();
+      }
+    }
+    for (auto iter = shared_module->global_begin();
+         iter != shared_module->global_end();) {
+      auto &g = *iter++;
+      if (g.isDeclaration() && g.use_empty()) {
+        g.eraseFromParent();
+      }
+    }
+    srcs.push_back(print_module(*shared_module));
+    f->deleteBody();
+  }
+
+  module.getOrInsertNamedMetadata(kInternalGlobalsMD)
+      ->addOperand(llvm::MDNode::get(ctx, internal_globals));
+  module.getOrInsertNamedMetadata(kPrivateGlobalsMD)
+      ->addOperand(llvm::MDNode::get(ctx, private_globals));
+  return srcs;
+}
+
+// Undoes split_shared_functions().
+bool link_shared_functions(llvm::Module &module,
+                           const std::vector<std::string> &srcs) {
+  auto &ctx = module.getContext();
+  for (const auto &src : srcs) {
+    llvm::SMDiagnostic err;
+    auto shared_module = llvm::parseAssemblyString(src, err, ctx);
+    if (!shared_module) {
+      TI_DEBUG("Fail to parse llvm::Module from string: {}",
+               err.getMessage().str());
+      return false;
+    }
+    if (llvm::Linker::linkModules(module, std::move(shared_module))) {
+      return false;
+    }
+  }
+  auto restore_linkage = [&module](const char *md_name,
+                                   llvm::GlobalValue::LinkageTypes linkage) {
+    if (auto *md = module.getNamedMetadata(md_name)) {
+      for (auto *node : md->operands()) {
+        for (const auto &op : node->operands()) {
+          auto name = llvm::cast<llvm::MDString>(op)->getString();
+          if (auto *gv = module.getNamedValue(name)) {
+            gv->setLinkage(linkage);
+          }
+        }
+      }
+      module.eraseNamedMetadata(md);
+    }
+  };
+  restore_linkage(kInternalGlobalsMD, llvm::GlobalValue::InternalLinkage);
+  restore_linkage(kPrivateGlobalsMD, llvm::GlobalValue::PrivateLinkage);
+  return true;
+}
+
+}  // namespace
+
 static std::unique_ptr<CompiledKernelData> new_llvm_compiled_kernel_data() {
   return std::make_unique<LLVM::CompiledKernelData>();
 }
@@ -59,6 +193,9 @@ CompiledKernelData::Err CompiledKernelData::load_impl(
              err.getMessage().str());
     return Err::kParseSrcCodeFailed;
   }
+  if (!link_shared_functions(*ret, file.shared_srcs())) {
+    return Err::kParseSrcCodeFailed;
+  }
   data_.compiled_data.module = std::move(ret);
   return Err::kNoError;
 }
@@ -71,10 +208,17 @@ CompiledKernelData::Err CompiledKernelData::dump_impl(
   } catch (const liong::json::JsonException &) {
     return Err::kSerMetadataFailed;
   }
-  std::string str;
-  llvm::raw_string_ostream oss(str);
-  data_.compiled_data.module->print(oss, /*AAW=*/nullptr);
-  file.set_src_code(std::move(str));
+  const auto &compiled_data = data_.compiled_data;
+  if (!file.shared_src_store()) {
+    file.set_src_code(print_module(*compiled_data.module));
+    return Err::kNoError;
+  }
+  // Only worth it if the shared sources are kept once, by the store.
+  auto module = llvm::CloneModule(*compiled_data.module);
+  for (auto &src : split_shared_functions(*module, compiled_data.tasks)) {
+    file.add_shared_src(std::move(src));
+  }
+  file.set_src_code(print_module(*module));
   return Err::kNoError;
 }
 
@@ -107,10 +107,11 @@ void StructCompilerLLVM::generate_types(SNode &snode) {
     body_type = llvm::ArrayType::get(llvm::PointerType::getInt8PtrTy(*ctx),
                                      snode.max_num_elements());
   } else if (type == SNodeType::dynamic) {
-    // mutex and n (number of elements)
-    aux_type =
-        llvm::StructType::get(*ctx, {llvm::PointerType::getInt32Ty(*ctx),
-                                     llvm::PointerType::getInt32Ty(*ctx)});
+    // mutex, n (number of elements), number of chunks and the chunk table
+    auto i32_type = llvm::PointerType::getInt32Ty(*ctx);
+    aux_type = llvm::StructType::get(
+        *ctx, {i32_type, i32_type, i32_type,
+               llvm::PointerType::getInt8PtrTy(*ctx)});
     body_type = llvm::PointerType::getInt8PtrTy(*ctx);
   } else {
     TI_P(snode.type_name());
@@ -0,0 +1,398 @@
+#include "taichi/compilation_manager/kernel_cache_pack.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_set>
+
+#include "taichi/common/core.h"
+#include "taichi/common/version.h"
+#include "taichi/util/io.h"
+
+#if defined(TI_PLATFORM_WINDOWS)
+#include "taichi/platform/windows/windows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace taichi::lang {
+
+namespace {
+
+constexpr char kPackMagic[4] = {'T', 'I', 'P', 'K'};
+constexpr char kIndexMagic[4] = {'T', 'I', 'I', 'X'};
+constexpr std::uint32_t kFormatVersion = 1;
+
+struct PackHeader {
+  char magic[4];
+  std::uint32_t format_version;
+  std::uint16_t version[3];
+  std::uint16_t padding;
+  // Offset of the newest index block, 0 if there is none. append() updates it
+  // last, with a single aligned 8-byte write.
+  std::uint64_t last_index_offset;
+};
+static_assert(sizeof(PackHeader) == 24);
+
+// Followed by |num_entries| entries, each of them an u64 offset and an u64
+// size of the serialized kernel, then an u32 key size and the key bytes.
+struct IndexBlockHeader {
+  char magic[4];
+  std::uint32_t num_entries;
+  std::uint64_t prev_offset;
+  std::uint64_t entries_size;  // byte
+};
+
+// Size of an index entry besides its key
+constexpr std::size_t kIndexEntrySize =
+    2 * sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+PackHeader make_header() {
+  PackHeader header{};
+  std::memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+  header.format_version = kFormatVersion;
+  header.version[0] = TI_VERSION_MAJOR;
+  header.version[1] = TI_VERSION_MINOR;
+  header.version[2] = TI_VERSION_PATCH;
+  return header;
+}
+
+bool is_current(const PackHeader &header) {
+  return std::memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) == 0 &&
+         header.format_version == kFormatVersion &&
+         header.version[0] == TI_VERSION_MAJOR &&
+         header.version[1] == TI_VERSION_MINOR &&
+         header.version[2] == TI_VERSION_PATCH;
+}
+
+template <typename T>
+bool read_pod(const char *data, std::size_t size, std::size_t &pos, T &out) {
+  if (pos > size || size - pos < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&out, data + pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+template <typename T>
+void append_pod(std::string &buf, const T &value) {
+  buf.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// Writes |records| and their index block at |pos| of |os|, and returns the
+// offset of the index block.
+std::uint64_t write_batch(std::ostream &os,
+                          std::uint64_t pos,
+                          std::uint64_t prev_index_offset,
+                          const std::vector<KernelCachePack::Record> &records) {
+  std::string entries;
+  os.seekp(pos);
+  for (const auto &r : records) {
+    os.write(r.data.data(), r.data.size());
+    append_pod(entries, pos);
+    append_pod(entries, (std::uint64_t)r.data.size());
+    append_pod(entries, (std::uint32_t)r.kernel_key.size());
+    entries.append(r.kernel_key);
+    pos += r.data.size();
+  }
+  IndexBlockHeader block{};
+  std::memcpy(block.magic, kIndexMagic, sizeof(kIndexMagic));
+  block.num_entries = records.size();
+  block.prev_offset = prev_index_offset;
+  block.entries_size = entries.size();
+  os.write(reinterpret_cast<const char *>(&block), sizeof(block));
+  os.write(entries.data(), entries.size());
+  return pos;
+}
+
+// Flushes what was written to |filepath| to the disk. Anything written
+// afterwards, e.g. the header pointing to it, must not reach the disk first:
+// after a crash, the header could point to an index block that never did.
+bool sync_file(const std::string &filepath) {
+#if defined(TI_PLATFORM_WINDOWS)
+  auto file = CreateFileA(filepath.c_str(), GENERIC_WRITE,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE |
+                              FILE_SHARE_DELETE,
+                          nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                          nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  bool ok = FlushFileBuffers(file);
+  CloseHandle(file);
+  return ok;
+#else
+  int fd = ::open(filepath.c_str(), O_RDWR);
+  if (fd == -1) {
+    return false;
+  }
+  bool ok = ::fsync(fd) == 0;
+  ::close(fd);
+  return ok;
+#endif
+}
+
+// Writes a new pack file with |records| next to |filepath| and moves it over
+// |filepath|, so that readers never see it half written.
+bool write_new_pack(const std::string &filepath,
+                    const std::vector<KernelCachePack::Record> &records) {
+  const auto tmp_filepath = filepath + ".tmp";
+  {
+    std::ofstream fs(tmp_filepath,
+                     std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fs.is_open()) {
+      return false;
+    }
+    auto header = make_header();
+    header.last_index_offset =
+        write_batch(fs, sizeof(PackHeader), /*prev_index_offset=*/0, records);
+    fs.seekp(0);
+    fs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!fs.flush() || !sync_file(tmp_filepath)) {
+      return false;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp_filepath, filepath, ec);
+  if (ec) {
+    TI_WARN("Replacing {} failed: {}", filepath, ec.message());
+    std::remove(tmp_filepath.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+KernelCachePack::KernelCachePack(const std::string &filepath) {
+  if (!map(filepath)) {
+    return;
+  }
+  // The newest batch may have been published after the file was measured.
+  PackHeader header;
+  std::size_t pos = 0;
+  IndexBlockHeader block;
+  if (read_pod(data_, data_size_, pos, header) && is_current(header) &&
+      header.last_index_offset != 0) {
+    pos = header.last_index_offset;
+    if (!read_pod(data_, data_size_, pos, block) ||
+        data_size_ - pos < block.entries_size) {
+      unmap();
+      if (!map(filepath)) {
+        return;
+      }
+    }
+  }
+  load_index();
+}
+
+KernelCachePack::~KernelCachePack() {
+  unmap();
+}
+
+std::string_view KernelCachePack::find(const std::string &kernel_key) const {
+  auto iter = index_.find(kernel_key);
+  if (iter == index_.end()) {
+    return {};
+  }
+  return {data_ + iter->second.offset, (std::size_t)iter->second.size};
+}
+
+bool KernelCachePack::append(const std::string &filepath,
+                             const std::vector<Record> &records) {
+  if (records.empty()) {
+    return true;
+  }
+  std::fstream fs(filepath, std::ios::in | std::ios::out | std::ios::binary);
+  PackHeader header;
+  if (!fs.is_open() ||
+      !fs.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      !is_current(header)) {
+    fs.close();
+    return write_new_pack(filepath, records);
+  }
+  // Append right after the newest published batch, overwriting whatever an
+  // interrupted writer may have left behind.
+  std::uint64_t end = sizeof(PackHeader);
+  if (header.last_index_offset != 0) {
+    IndexBlockHeader block;
+    fs.seekg(header.last_index_offset);
+    if (!fs.read(reinterpret_cast<char *>(&block), sizeof(block)) ||
+        std::memcmp(block.magic, kIndexMagic, sizeof(kIndexMagic)) != 0) {
+      fs.close();
+      return write_new_pack(filepath, records);
+    }
+    end = header.last_index_offset + sizeof(block) + block.entries_size;
+  }
+  auto index_offset = write_batch(fs, end, header.last_index_offset, records);
+  if (!fs.flush() || !sync_file(filepath)) {
+    return false;
+  }
+  // Publish the batch, only once it is on the disk
+  fs.seekp(offsetof(PackHeader, last_index_offset));
+  fs.write(reinterpret_cast<const char *>(&index_offset),
+           sizeof(index_offset));
+  return (bool)fs.flush();
+}
+
+void KernelCachePack::compact(const std::string &filepath,
+                              std::size_t max_bytes,
+                              double cleaning_factor) {
+  std::vector<Record> records;
+  {
+    KernelCachePack pack(filepath);
+    // Broken and outdated files have no entries and are removed.
+    if (!pack.data_ ||
+        (!pack.entries_.empty() && pack.data_size_ <= max_bytes)) {
+      return;
+    }
+    const auto target_bytes = std::size_t(max_bytes * (1 - cleaning_factor));
+    std::size_t total_bytes = sizeof(PackHeader);
+    std::unordered_set<std::string> kept;
+    for (auto iter = pack.entries_.rbegin(); iter != pack.entries_.rend();
+         ++iter) {
+      const auto &[kernel_key, entry] = *iter;
+      if (!kept.insert(kernel_key).second) {
+        continue;  // Superseded by a newer entry
+      }
+      total_bytes += entry.size + kIndexEntrySize + kernel_key.size();
+      if (total_bytes > target_bytes) {
+        break;
+      }
+      records.push_back(
+          {kernel_key, std::string(pack.data_ + entry.offset, entry.size)});
+    }
+  }
+  if (records.empty()) {
+    std::remove(filepath.c_str());
+    return;
+  }
+  // Keep the newest kernels last, as if they were appended in order.
+  std::reverse(records.begin(), records.end());
+  write_new_pack(filepath, records);
+}
+
+bool KernelCachePack::map(const std::string &filepath) {
+#if defined(TI_PLATFORM_WINDOWS)
+  auto file = CreateFileA(filepath.c_str(), GENERIC_READ,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE |
+                              FILE_SHARE_DELETE,
+                          nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                          nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+  auto mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    CloseHandle(file);
+    return false;
+  }
+  auto *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  file_handle_ = file;
+  mapping_handle_ = mapping;
+  data_ = static_cast<const char *>(view);
+  data_size_ = size.QuadPart;
+#else
+  int fd = ::open(filepath.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  auto *ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping outlives the descriptor
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    return false;
+  }
+  data_ = static_cast<const char *>(ptr);
+  data_size_ = st.st_size;
+#endif
+  return true;
+}
+
+void KernelCachePack::unmap() {
+  if (!data_) {
+    return;
+  }
+#if defined(TI_PLATFORM_WINDOWS)
+  UnmapViewOfFile(data_);
+  CloseHandle(mapping_handle_);
+  CloseHandle(file_handle_);
+  mapping_handle_ = file_handle_ = nullptr;
+#else
+  ::munmap(const_cast<char *>(data_), data_size_);
+#endif
+  data_ = nullptr;
+  data_size_ = 0;
+  index_.clear();
+  entries_.clear();
+}
+
+void KernelCachePack::load_index() {
+  PackHeader header;
+  std::size_t pos = 0;
+  if (!read_pod(data_, data_size_, pos, header) || !is_current(header)) {
+    return;
+  }
+  // Walk the index blocks from the newest to the oldest.
+  std::vector<std::vector<std::pair<std::string, Entry>>> blocks;
+  auto offset = header.last_index_offset;
+  auto limit = std::numeric_limits<std::uint64_t>::max();
+  while (offset != 0 && offset < limit) {
+    IndexBlockHeader block;
+    pos = offset;
+    if (!read_pod(data_, data_size_, pos, block) ||
+        std::memcmp(block.magic, kIndexMagic, sizeof(kIndexMagic)) != 0) {
+      TI_WARN("Broken index block in the kernel cache pack");
+      break;
+    }
+    auto &entries = blocks.emplace_back();
+    for (std::uint32_t i = 0; i < block.num_entries; i++) {
+      Entry entry;
+      std::uint32_t key_size;
+      if (!read_pod(data_, data_size_, pos, entry.offset) ||
+          !read_pod(data_, data_size_, pos, entry.size) ||
+          !read_pod(data_, data_size_, pos, key_size) ||
+          data_size_ - pos < key_size || entry.offset > offset ||
+          offset - entry.offset < entry.size) {
+        TI_WARN("Broken index block in the kernel cache pack");
+        entries.clear();
+        break;
+      }
+      entries.emplace_back(std::string(data_ + pos, key_size), entry);
+      pos += key_size;
+    }
+    // Blocks only point backwards, which also rules out cycles.
+    limit = offset;
+    offset = block.prev_offset;
+  }
+  for (auto block = blocks.rbegin(); block != blocks.rend(); ++block) {
+    for (auto &[kernel_key, entry] : *block) {
+      index_[kernel_key] = entry;
+      entries_.emplace_back(std::move(kernel_key), entry);
+    }
+  }
+}
+
+}  // namespace taichi::lang
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "taichi/common/platform_macros.h"
+
+namespace taichi::lang {
+
+/**
+ * An offline kernel cache kept in a single, append-only pack file.
+ *
+ * The file starts with a header pointing to the newest index block. Every
+ * append() writes the serialized kernels of a batch, followed by an index
+ * block listing them and pointing to the previous one, syncs them to the
+ * disk, and publishes the batch by updating the header last. Readers map the
+ * file and walk the index blocks once, so they never lock it and a lookup is
+ * a hash table probe into the mapping. Writers still serialize with each
+ * other through the cache lock file.
+ */
+class KernelCachePack {
+ public:
+  static constexpr char kFilename[] = "ticache.pack";
+
+  struct Record {
+    std::string kernel_key;
+    std::string data;
+  };
+
+  // Maps |filepath|; a missing, broken or outdated pack file is empty.
+  explicit KernelCachePack(const std::string &filepath);
+  ~KernelCachePack();
+  KernelCachePack(const KernelCachePack &) = delete;
+  KernelCachePack &operator=(const KernelCachePack &) = delete;
+
+  // Returns the serialized kernel cached for |kernel_key|, or an empty view.
+  // The view is valid as long as |this|.
+  std::string_view find(const std::string &kernel_key) const;
+
+  std::size_t size() const {
+    return index_.size();
+  }
+
+  // Appends |records| to the pack file at |filepath| as one batch. The file is
+  // recreated if it is missing, broken or written by another Taichi version.
+  // The caller must hold the cache lock.
+  static bool append(const std::string &filepath,
+                     const std::vector<Record> &records);
+
+  // Rewrites the pack file at |filepath| with the newest kernels fitting in
+  // |max_bytes| * (1 - |cleaning_factor|) bytes, if it is over |max_bytes|.
+  // The caller must hold the cache lock.
+  static void compact(const std::string &filepath,
+                      std::size_t max_bytes,
+                      double cleaning_factor);
+
+ private:
+  struct Entry {
+    std::uint64_t offset;
+    std::uint64_t size;
+  };
+
+  bool map(const std::string &filepath);
+  void unmap();
+  void load_index();
+
+  const char *data_{nullptr};
+  std::size_t data_size_{0};
+#if defined(TI_PLATFORM_WINDOWS)
+  void *file_handle_{nullptr};
+  void *mapping_handle_{nullptr};
+#endif
+  std::unordered_map<std::string, Entry> index_;
+  // Index entries in the order they were appended
+  std::vector<std::pair<std::string, Entry>> entries_;
+};
+
+}  // namespace taichi::lang
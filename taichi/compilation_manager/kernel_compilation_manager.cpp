@@ -1,11 +1,85 @@
 #include "taichi/compilation_manager/kernel_compilation_manager.h"
 
+#include <unordered_set>
+
 #include "taichi/analysis/offline_cache_util.h"
 #include "taichi/codegen/compiled_kernel_data.h"
 #include "taichi/util/offline_cache.h"
 
 namespace taichi::lang {
 
+namespace {
+
+// Reads a kernel serialized in the pack file without copying it.
+class ViewStreamBuf : public std::streambuf {
+ public:
+  explicit ViewStreamBuf(std::string_view view) {
+    auto *begin = const_cast<char *>(view.data());
+    setg(begin, begin, begin + view.size());
+  }
+};
+
+// Keeps the shared sources in files next to the cached kernels.
+class SharedSrcFiles : public SharedSrcStore {
+ public:
+  explicit SharedSrcFiles(std::string path) : path_(std::move(path)) {
+  }
+
+  bool load(const std::string &key, std::string &src) override {
+    std::ifstream ifs(make_filename(key), std::ios::in | std::ios::binary);
+    if (!ifs.is_open()) {
+      return false;
+    }
+    src.assign(std::istreambuf_iterator<char>(ifs), {});
+    return !ifs.bad();
+  }
+
+  bool store(const std::string &key, const std::string &src) override {
+    const auto filename = make_filename(key);
+    if (!path_exists(filename)) {
+      std::ofstream ofs(filename, std::ios::out | std::ios::binary);
+      if (!ofs.write(src.data(), src.size())) {
+        return false;
+      }
+      stored_bytes += src.size();
+    }
+    keys.push_back(key);
+    return true;
+  }
+
+  // The keys stored and the bytes written since the last reset
+  std::vector<std::string> keys;
+  std::size_t stored_bytes{0};
+
+ private:
+  std::string make_filename(const std::string &key) const {
+    return join_path(
+        path_,
+        fmt::format(KernelCompilationManager::kSharedSrcFilenameFormat, key));
+  }
+
+  std::string path_;
+};
+
+// Removes the shared sources none of the kernels in |data| uses.
+void remove_unused_shared_srcs(const std::string &path,
+                               const CacheData &data) {
+  std::unordered_set<std::string> used;
+  for (const auto &[_, k] : data.kernels) {
+    used.insert(k.shared_srcs.begin(), k.shared_srcs.end());
+  }
+  traverse_directory(path, [&](const std::string &name, bool is_dir) {
+    if (!is_dir &&
+        filename_extension(name) ==
+            offline_cache::kTiCacheSharedSrcFilenameExt &&
+        !used.count(name.substr(0, name.find('.')))) {
+      taichi::remove(join_path(path, name));
+    }
+  });
+}
+
+}  // namespace
+
 namespace offline_cache {
 
 template <>
@@ -18,6 +92,7 @@ struct CacheCleanerUtils<CacheData> {
                             const MetadataType &data) {
     write_to_binary_file(
         data, taichi::join_path(config.path, config.metadata_filename));
+    remove_unused_shared_srcs(config.path, data);
     return true;
   }
 
@@ -37,23 +112,30 @@ struct CacheCleanerUtils<CacheData> {
 
   // To remove other files except cache files and offline cache metadta files
   static void remove_other_files(const CacheCleanerConfig &config) {
-    // Do nothing
+    remove_unused_shared_srcs(config.path, CacheData{});
   }
 
   // To check if a file is cache file
   static bool is_valid_cache_file(const CacheCleanerConfig &config,
                                   const std::string &name) {
     std::string ext = filename_extension(name);
-    return ext == kTiCacheFilenameExt;
+    return ext == kTiCacheFilenameExt || ext == kTiCacheSharedSrcFilenameExt;
   }
 };
 
 }  // namespace offline_cache
 
 KernelCompilationManager::KernelCompilationManager(Config config)
-    : config_(std::move(config)) {
+    : config_(std::move(config)),
+      compile_workers_("kernel_compile", config_.num_compile_threads) {
   TI_DEBUG("Create KernelCompilationManager with offline_cache_file_path = {}",
            config_.offline_cache_path);
+  if (config_.pack_offline_cache) {
+    // Writers only publish whole batches, so no lock is needed to read.
+    cache_pack_ = std::make_unique<KernelCachePack>(
+        join_path(config_.offline_cache_path, KernelCachePack::kFilename));
+    return;
+  }
   auto filepath = join_path(config_.offline_cache_path, kMetadataFilename);
   auto lock_path = join_path(config_.offline_cache_path, kMetadataLockName);
   if (path_exists(filepath)) {
@@ -72,16 +154,20 @@ const CompiledKernelData &KernelCompilationManager::load_or_compile(
     const CompileConfig &compile_config,
     const DeviceCapabilityConfig &caps,
     const Kernel &kernel_def) {
-  auto cache_mode = get_cache_mode(compile_config, kernel_def);
-  const auto kernel_key = make_kernel_key(compile_config, caps, kernel_def);
-  auto cached_kernel = try_load_cached_kernel(kernel_def, kernel_key,
-                                              compile_config.arch, cache_mode);
-  return cached_kernel ? *cached_kernel
-                       : compile_and_cache_kernel(kernel_key, compile_config,
-                                                  caps, kernel_def);
+  return *submit(compile_config, caps, kernel_def, /*async=*/false).get();
+}
+
+KernelCompilationManager::CompiledKernelFuture
+KernelCompilationManager::load_or_compile_async(
+    const CompileConfig &compile_config,
+    const DeviceCapabilityConfig &caps,
+    const Kernel &kernel_def) {
+  return submit(compile_config, caps, kernel_def, /*async=*/true);
 }
 
 void KernelCompilationManager::dump() {
+  compile_workers_.flush();
+  std::lock_guard<std::mutex> lock(mut_);
   if (caching_kernels_.empty()) {
     return;
   }
@@ -98,6 +184,10 @@ void KernelCompilationManager::dump() {
   }
 
   auto _ = make_unlocker(lock_path);
+  if (config_.pack_offline_cache) {
+    dump_pack();
+    return;
+  }
   CacheData data;
   data.version[0] = TI_VERSION_MAJOR;
   data.version[1] = TI_VERSION_MINOR;
@@ -122,15 +212,22 @@ void KernelCompilationManager::dump() {
   // Clear caching_kernels_
   caching_kernels_.clear();
   // Dump cached CompiledKernelData to disk
+  SharedSrcFiles shared_srcs(config_.offline_cache_path);
+  auto *store = config_.dedup_offline_cache ? &shared_srcs : nullptr;
   for (auto &[_, k] : kernels) {
     if (k.compiled_kernel_data) {
       auto cache_filename = make_filename(k.kernel_key);
       std::ofstream fs{cache_filename, std::ios::out | std::ios::binary};
       TI_ASSERT(fs.is_open());
-      auto err = k.compiled_kernel_data->dump(fs);
+      shared_srcs.keys.clear();
+      shared_srcs.stored_bytes = 0;
+      auto err = k.compiled_kernel_data->dump(fs, store,
+                                              config_.compress_offline_cache);
       if (err == CompiledKernelData::Err::kNoError) {
         TI_ASSERT(!!fs);
-        k.size = fs.tellp();
+        // A shared source counts for the kernel storing it first.
+        k.size = std::size_t(fs.tellp()) + shared_srcs.stored_bytes;
+        k.shared_srcs = std::move(shared_srcs.keys);
         data.size += k.size;
       } else {
         TI_DEBUG("Dump cached CompiledKernelData(kernel_key={}) failed: {}",
@@ -148,6 +245,26 @@ void KernelCompilationManager::clean_offline_cache(
     offline_cache::CleanCachePolicy policy,
     int max_bytes,
     double cleaning_factor) const {
+  if (config_.pack_offline_cache) {
+    if (policy == offline_cache::Never) {
+      return;
+    }
+    auto lock_path = join_path(config_.offline_cache_path, kMetadataLockName);
+    if (!lock_with_file(lock_path)) {
+      TI_WARN("Lock {} failed", lock_path);
+      return;
+    }
+    auto _ = make_unlocker(lock_path);
+    // Kernels are kept in the order they were first cached, so LRU and FIFO
+    // both drop the oldest ones.
+    std::size_t max_size = policy == offline_cache::OnlyOldVersion
+                               ? std::numeric_limits<std::size_t>::max()
+                               : max_bytes;
+    KernelCachePack::compact(
+        join_path(config_.offline_cache_path, KernelCachePack::kFilename),
+        max_size, cleaning_factor);
+    return;
+  }
   using CacheCleaner = offline_cache::CacheCleaner<CacheData>;
   offline_cache::CacheCleanerConfig config;
   config.path = config_.offline_cache_path;
@@ -213,6 +330,11 @@ const CompiledKernelData *KernelCompilationManager::try_load_cached_kernel(
   if (cache_mode == CacheData::MemAndDiskCache) {
     auto &kernels = cached_data_.kernels;
     auto iter = kernels.find(kernel_key);
+    if (iter == kernels.end() && cache_pack_ &&
+        !cache_pack_->find(kernel_key).empty()) {
+      iter = kernels.emplace(kernel_key, KernelCacheData{}).first;
+      iter->second.kernel_key = kernel_key;
+    }
     if (iter != kernels.end()) {
       auto &k = iter->second;
       if (k.compiled_kernel_data) {
@@ -233,7 +355,51 @@ const CompiledKernelData *KernelCompilationManager::try_load_cached_kernel(
   return nullptr;
 }
 
-const CompiledKernelData &KernelCompilationManager::compile_and_cache_kernel(
+KernelCompilationManager::CompiledKernelFuture
+KernelCompilationManager::submit(const CompileConfig &compile_config,
+                                 const DeviceCapabilityConfig &caps,
+                                 const Kernel &kernel_def,
+                                 bool async) {
+  auto cache_mode = get_cache_mode(compile_config, kernel_def);
+  const auto kernel_key = make_kernel_key(compile_config, caps, kernel_def);
+  std::unique_lock<std::mutex> lock(mut_);
+  if (auto cached_kernel = try_load_cached_kernel(
+          kernel_def, kernel_key, compile_config.arch, cache_mode)) {
+    std::promise<const CompiledKernelData *> loaded;
+    loaded.set_value(cached_kernel);
+    return loaded.get_future().share();
+  }
+  // Another thread is compiling the same kernel, wait for it instead.
+  if (auto iter = compiling_kernels_.find(kernel_key);
+      iter != compiling_kernels_.end()) {
+    return iter->second;
+  }
+  // The configs are copied as the caller's may be gone once the task runs.
+  using CompileTask = std::packaged_task<const CompiledKernelData *()>;
+  auto task = std::make_shared<CompileTask>(
+      [this, kernel_key, compile_config, caps, &kernel_def]() {
+        try {
+          return compile_and_cache_kernel(kernel_key, compile_config, caps,
+                                          kernel_def);
+        } catch (...) {
+          // Let the next submission retry
+          std::lock_guard<std::mutex> _(mut_);
+          compiling_kernels_.erase(kernel_key);
+          throw;
+        }
+      });
+  auto future = task->get_future().share();
+  compiling_kernels_[kernel_key] = future;
+  lock.unlock();
+  if (async) {
+    compile_workers_.enqueue([task]() { (*task)(); });
+  } else {
+    (*task)();
+  }
+  return future;
+}
+
+const CompiledKernelData *KernelCompilationManager::compile_and_cache_kernel(
     const std::string &kernel_key,
     const CompileConfig &compile_config,
     const DeviceCapabilityConfig &caps,
@@ -242,40 +408,80 @@ const CompiledKernelData &KernelCompilationManager::compile_and_cache_kernel(
   TI_DEBUG_IF(cache_mode == CacheData::MemAndDiskCache,
               "Cache kernel '{}' (key='{}')", kernel_def.get_name(),
               kernel_key);
-  TI_ASSERT(caching_kernels_.find(kernel_key) == caching_kernels_.end());
   KernelCacheData k;
   k.kernel_key = kernel_key;
   k.created_at = k.last_used_at = std::time(nullptr);
   k.compiled_kernel_data = compile_kernel(compile_config, caps, kernel_def);
   k.size = 0;  // Populate `size` within the KernelCompilationManager::dump()
   k.cache_mode = cache_mode;
+  std::lock_guard<std::mutex> _(mut_);
+  TI_ASSERT(caching_kernels_.find(kernel_key) == caching_kernels_.end());
   const auto &kernel_data = (caching_kernels_[kernel_key] = std::move(k));
-  return *kernel_data.compiled_kernel_data;
+  compiling_kernels_.erase(kernel_key);
+  return kernel_data.compiled_kernel_data.get();
 }
 
 std::unique_ptr<CompiledKernelData> KernelCompilationManager::load_ckd(
     const std::string &kernel_key,
     Arch arch) {
-  const auto filename = make_filename(kernel_key);
-  if (std::ifstream ifs(filename, std::ios::in | std::ios::binary);
-      ifs.is_open()) {
+  SharedSrcFiles shared_srcs(config_.offline_cache_path);
+  auto load = [&shared_srcs](std::istream &is, const std::string &source)
+      -> std::unique_ptr<CompiledKernelData> {
     CompiledKernelData::Err err;
-    auto ckd = CompiledKernelData::load(ifs, &err);
+    auto ckd = CompiledKernelData::load(is, &err, &shared_srcs);
     if (err != CompiledKernelData::Err::kNoError) {
-      TI_DEBUG("Load cache file {} failed: {}", filename,
+      TI_DEBUG("Load cache file {} failed: {}", source,
                CompiledKernelData::get_err_msg(err));
       return nullptr;
     }
     if (auto err = ckd->check(); err != CompiledKernelData::Err::kNoError) {
-      TI_DEBUG("Check CompiledKernelData loaded from {} failed: {}", filename,
+      TI_DEBUG("Check CompiledKernelData loaded from {} failed: {}", source,
                CompiledKernelData::get_err_msg(err));
       return nullptr;
     }
     return ckd;
+  };
+  if (cache_pack_) {
+    auto data = cache_pack_->find(kernel_key);
+    if (data.empty()) {
+      return nullptr;
+    }
+    ViewStreamBuf buf(data);
+    std::istream is(&buf);
+    return load(is, KernelCachePack::kFilename);
+  }
+  const auto filename = make_filename(kernel_key);
+  if (std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+      ifs.is_open()) {
+    return load(ifs, filename);
   }
   return nullptr;
 }
 
+void KernelCompilationManager::dump_pack() {
+  std::vector<KernelCachePack::Record> records;
+  for (auto &[kernel_key, k] : caching_kernels_) {
+    if (k.cache_mode != CacheData::MemAndDiskCache) {
+      continue;
+    }
+    std::ostringstream oss;
+    auto err = k.compiled_kernel_data->dump(oss, /*store=*/nullptr,
+                                            config_.compress_offline_cache);
+    if (err == CompiledKernelData::Err::kNoError) {
+      records.push_back({kernel_key, oss.str()});
+    } else {
+      TI_DEBUG("Dump cached CompiledKernelData(kernel_key={}) failed: {}",
+               kernel_key, CompiledKernelData::get_err_msg(err));
+    }
+  }
+  caching_kernels_.clear();
+  auto filepath =
+      join_path(config_.offline_cache_path, KernelCachePack::kFilename);
+  if (!KernelCachePack::append(filepath, records)) {
+    TI_WARN("Writing the offline cache to {} failed", filepath);
+  }
+}
+
 CacheData::CacheMode KernelCompilationManager::get_cache_mode(
     const CompileConfig &compile_config,
     const Kernel &kernel_def) {
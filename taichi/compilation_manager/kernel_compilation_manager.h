@@ -1,13 +1,17 @@
 #pragma once
 
 #include <ctime>
+#include <future>
+#include <mutex>
 #include <string>
 #include <memory>
 #include <unordered_map>
 
 #include "taichi/util/offline_cache.h"
 #include "taichi/codegen/kernel_compiler.h"
+#include "taichi/compilation_manager/kernel_cache_pack.h"
 #include "taichi/codegen/compiled_kernel_data.h"
+#include "taichi/program/parallel_executor.h"
 
 namespace taichi::lang {
 
@@ -23,13 +27,15 @@ struct CacheData {
     std::size_t size{0};          // byte
     std::time_t created_at{0};    // sec
     std::time_t last_used_at{0};  // sec
+    // Keys of the shared sources, see KernelCompilationManager::Config
+    std::vector<std::string> shared_srcs;
 
     // Dump the kernel to disk if `cache_mode` == `MemAndDiskCache`
     CacheMode cache_mode{MemCache};
 
     std::unique_ptr<lang::CompiledKernelData> compiled_kernel_data;
 
-    TI_IO_DEF(kernel_key, size, created_at, last_used_at);
+    TI_IO_DEF(kernel_key, size, created_at, last_used_at, shared_srcs);
   };
 
   using KernelMetadata = KernelData;  // Required by CacheCleaner
@@ -46,14 +52,29 @@ class KernelCompilationManager final {
  public:
   static constexpr char kMetadataFilename[] = "ticache.tcb";
   static constexpr char kCacheFilenameFormat[] = "{}.tic";
+  static constexpr char kSharedSrcFilenameFormat[] = "{}.tis";
   static constexpr char kMetadataLockName[] = "ticache.lock";
 
   using KernelCacheData = CacheData::KernelData;
   using CachingKernels = std::unordered_map<std::string, KernelCacheData>;
+  using CompiledKernelFuture = std::shared_future<const CompiledKernelData *>;
 
   struct Config {
     std::string offline_cache_path;
     std::unique_ptr<KernelCompiler> kernel_compiler;
+    // Keep the offline cache in a single pack file (see KernelCachePack)
+    // instead of a metadata file and a file per kernel.
+    bool pack_offline_cache{false};
+    // Deflate the cached kernels.
+    bool compress_offline_cache{false};
+    // Keep the sources shared by several kernels, e.g. the runtime functions
+    // linked into LLVM kernels, once in files of their own. Only applies
+    // without |pack_offline_cache|.
+    bool dedup_offline_cache{false};
+    // Number of threads compiling the kernels submitted through
+    // load_or_compile_async(), 0 to compile them on the calling thread. Only
+    // set it if |kernel_compiler| can compile several kernels concurrently.
+    int num_compile_threads{0};
   };
 
   explicit KernelCompilationManager(Config init_params);
@@ -63,6 +84,14 @@ class KernelCompilationManager final {
                                             const DeviceCapabilityConfig &caps,
                                             const Kernel &kernel_def);
 
+  // Same as load_or_compile(), but a kernel missing from the caches is
+  // compiled on one of the compile threads, concurrently with the other
+  // kernels submitted. |kernel_def| must outlive the returned future.
+  CompiledKernelFuture load_or_compile_async(
+      const CompileConfig &compile_config,
+      const DeviceCapabilityConfig &caps,
+      const Kernel &kernel_def);
+
   // Dump the cached data in memory to disk
   void dump();
 
@@ -89,7 +118,12 @@ class KernelCompilationManager final {
       Arch arch,
       CacheData::CacheMode cache_mode);
 
-  const CompiledKernelData &compile_and_cache_kernel(
+  CompiledKernelFuture submit(const CompileConfig &compile_config,
+                              const DeviceCapabilityConfig &caps,
+                              const Kernel &kernel_def,
+                              bool async);
+
+  const CompiledKernelData *compile_and_cache_kernel(
       const std::string &kernel_key,
       const CompileConfig &compile_config,
       const DeviceCapabilityConfig &caps,
@@ -98,14 +132,24 @@ class KernelCompilationManager final {
   std::unique_ptr<CompiledKernelData> load_ckd(const std::string &kernel_key,
                                                Arch arch);
 
+  void dump_pack();
+
   static CacheData::CacheMode get_cache_mode(
       const CompileConfig &compile_config,
       const Kernel &kernel_def);
 
   Config config_;
+  // Guards the caches below, which the compile threads update.
+  std::mutex mut_;
   CachingKernels caching_kernels_;
   CacheData cached_data_;
   std::vector<KernelCacheData *> updated_data_;
+  // The pack file mapped at startup, if |config_.pack_offline_cache|
+  std::unique_ptr<KernelCachePack> cache_pack_;
+  // Kernels being compiled, by kernel key
+  std::unordered_map<std::string, CompiledKernelFuture> compiling_kernels_;
+  // Declared last so that the compile threads finish before the caches go.
+  ParallelExecutor compile_workers_;
 };
 
 }  // namespace taichi::lang
@@ -26,6 +26,9 @@ constexpr std::size_t taichi_result_buffer_error_id = 30;
 constexpr std::size_t taichi_result_buffer_runtime_query_id = 31;
 
 constexpr int taichi_listgen_max_element_size = 1024;
+// Chunks of a dynamic SNode below this are found by walking the chunk list;
+// longer lists also index their chunks in a chunk table.
+constexpr int taichi_dynamic_num_list_chunks = 4;
 
 // By default, CUDA could allocate up to 48KB static shared arrays.
 // It requires dynamic shared memory to allocate a larger array.
@@ -1,5 +1,7 @@
 #include "taichi/ir/control_flow_graph.h"
 
+#include <algorithm>
+#include <functional>
 #include <queue>
 #include <unordered_set>
 
@@ -8,9 +10,142 @@
 #include "taichi/ir/statements.h"
 #include "taichi/system/profiler.h"
 #include "taichi/program/function.h"
+#include "taichi/util/bit.h"
 
 namespace taichi::lang {
 
+namespace {
+
+using NodeSet = std::unordered_set<Stmt *> CFGNode::*;
+
+// Returns the node ids in the reverse postorder of a depth-first search from
+// |entry|, along the |next| edges if |forward| and the |prev| edges
+// otherwise. The nodes unreachable from |entry| are searched from afterwards.
+std::vector<int> reverse_postorder(
+    const std::vector<std::unique_ptr<CFGNode>> &nodes,
+    const std::unordered_map<CFGNode *, int> &node_ids,
+    int entry,
+    bool forward) {
+  const int num_nodes = nodes.size();
+  std::vector<int> order;
+  order.reserve(num_nodes);
+  std::vector<bool> visited(num_nodes, false);
+  // (node id, number of its edges followed)
+  std::vector<std::pair<int, int>> stack;
+  auto search = [&](int root) {
+    visited[root] = true;
+    stack.emplace_back(root, 0);
+    while (!stack.empty()) {
+      auto [node_id, num_followed] = stack.back();
+      const auto &edges = forward ? nodes[node_id]->next : nodes[node_id]->prev;
+      if (num_followed == (int)edges.size()) {
+        order.push_back(node_id);
+        stack.pop_back();
+        continue;
+      }
+      stack.back().second++;
+      int to = node_ids.at(edges[num_followed]);
+      if (!visited[to]) {
+        visited[to] = true;
+        stack.emplace_back(to, 0);
+      }
+    }
+  };
+  search(entry);
+  for (int i = 0; i < num_nodes; i++) {
+    if (!visited[i]) {
+      search(i);
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+// Solves the dataflow equations
+//   out = gen + {stmt in in: !killed(node, stmt)}
+//   in = the union of out of the predecessors
+// where the predecessors are |prev| if |forward| and |next| otherwise, and
+// stores in, out of each node to |in_set|, |out_set|.
+//
+// The sets are dense bit vectors over a numbering of the statements in the
+// gen sets, and the worklist is visited in reverse postorder from |entry|.
+// |in| only grows, so killed() is asked at most once per node and statement.
+void solve_gen_kill_dataflow(
+    const std::vector<std::unique_ptr<CFGNode>> &nodes,
+    int entry,
+    bool forward,
+    NodeSet gen_set,
+    NodeSet in_set,
+    NodeSet out_set,
+    const std::function<bool(CFGNode *, Stmt *)> &killed) {
+  const int num_nodes = nodes.size();
+  std::unordered_map<CFGNode *, int> node_ids;
+  for (int i = 0; i < num_nodes; i++) {
+    node_ids[nodes[i].get()] = i;
+  }
+  std::vector<Stmt *> stmts;
+  std::unordered_map<Stmt *, int> stmt_ids;
+  for (auto &node : nodes) {
+    for (auto stmt : (*node).*gen_set) {
+      if (stmt_ids.emplace(stmt, (int)stmts.size()).second) {
+        stmts.push_back(stmt);
+      }
+    }
+  }
+  const int num_stmts = stmts.size();
+  std::vector<bit::Bitset> in(num_nodes, bit::Bitset(num_stmts));
+  std::vector<bit::Bitset> out = in;
+  for (int i = 0; i < num_nodes; i++) {
+    for (auto stmt : (*nodes[i]).*gen_set) {
+      out[i][stmt_ids[stmt]] = true;
+    }
+  }
+
+  const auto order = reverse_postorder(nodes, node_ids, entry, forward);
+  std::vector<int> rank(num_nodes);
+  for (int i = 0; i < num_nodes; i++) {
+    rank[order[i]] = i;
+  }
+  // The ranks of the nodes to visit
+  bit::Bitset to_visit(num_nodes);
+  for (int i = 0; i < num_nodes; i++) {
+    to_visit[i] = true;
+  }
+  for (int r = to_visit.find_first_one(); r != -1;
+       r = to_visit.find_first_one()) {
+    to_visit[r] = false;
+    const int i = order[r];
+    auto now = nodes[i].get();
+    bool changed = false;
+    for (auto pred : forward ? now->prev : now->next) {
+      for (int s : in[i].or_eq_get_update_list(out[node_ids[pred]])) {
+        if (!out[i][s] && !killed(now, stmts[s])) {
+          out[i][s] = true;
+          changed = true;
+        }
+      }
+    }
+    if (changed) {
+      for (auto succ : forward ? now->next : now->prev) {
+        to_visit[rank[node_ids[succ]]] = true;
+      }
+    }
+  }
+
+  auto to_set = [&](bit::Bitset &bits, std::unordered_set<Stmt *> &set) {
+    set.clear();
+    for (int s = bits.find_first_one(); s != -1; s = bits.lower_bound(s + 1)) {
+      set.insert(stmts[s]);
+    }
+  };
+  for (int i = 0; i < num_nodes; i++) {
+    to_set(in[i], (*nodes[i]).*in_set);
+    to_set(out[i], (*nodes[i]).*out_set);
+  }
+}
+
+}  // namespace
+
 CFGNode::CFGNode(Block *block,
                  int begin_location,
                  int end_location,
@@ -1014,8 +1149,6 @@ void ControlFlowGraph::reaching_definition_analysis(bool after_lower_access) {
 
   TI_AUTO_PROF;
   const int num_nodes = size();
-  std::queue<CFGNode *> to_visit;
-  std::unordered_map<CFGNode *, bool> in_queue;
   TI_ASSERT(nodes[start_node]->empty());
   nodes[start_node]->reach_gen.clear();
   nodes[start_node]->reach_kill.clear();
@@ -1046,54 +1179,22 @@ void ControlFlowGraph::reaching_definition_analysis(bool after_lower_access) {
     if (i != start_node) {
       nodes[i]->reaching_definition_analysis(after_lower_access);
     }
-    nodes[i]->reach_in.clear();
-    nodes[i]->reach_out = nodes[i]->reach_gen;
-    to_visit.push(nodes[i].get());
-    in_queue[nodes[i].get()] = true;
   }
 
-  // [The worklist algorithm]
-  // Determines reach_in and reach_out for each node iteratively.
-  while (!to_visit.empty()) {
-    auto now = to_visit.front();
-    to_visit.pop();
-    in_queue[now] = false;
-
-    now->reach_in.clear();
-    for (auto prev_node : now->prev) {
-      now->reach_in.insert(prev_node->reach_out.begin(),
-                           prev_node->reach_out.end());
-    }
-    auto old_out = std::move(now->reach_out);
-    now->reach_out = now->reach_gen;
-    for (auto stmt : now->reach_in) {
-      auto store_ptrs = irpass::analysis::get_store_destination(stmt);
-      bool killed;
-      if (store_ptrs.empty()) {  // the case of a global pointer
-        killed = now->reach_kill_variable(stmt);
-      } else {
-        killed = true;
+  solve_gen_kill_dataflow(
+      nodes, start_node, /*forward=*/true, &CFGNode::reach_gen,
+      &CFGNode::reach_in, &CFGNode::reach_out, [](CFGNode *now, Stmt *stmt) {
+        auto store_ptrs = irpass::analysis::get_store_destination(stmt);
+        if (store_ptrs.empty()) {  // the case of a global pointer
+          return now->reach_kill_variable(stmt);
+        }
         for (auto store_ptr : store_ptrs) {
           if (!now->reach_kill_variable(store_ptr)) {
-            killed = false;
-            break;
+            return false;
           }
         }
-      }
-      if (!killed) {
-        now->reach_out.insert(stmt);
-      }
-    }
-    if (now->reach_out != old_out) {
-      // changed
-      for (auto next_node : now->next) {
-        if (!in_queue[next_node]) {
-          to_visit.push(next_node);
-          in_queue[next_node] = true;
-        }
-      }
-    }
-  }
+        return true;
+      });
 }
 
 void ControlFlowGraph::live_variable_analysis(
@@ -1108,8 +1209,6 @@ void ControlFlowGraph::live_variable_analysis(
   // live_out: collection of all the live_in of next nodes
   TI_AUTO_PROF;
   const int num_nodes = size();
-  std::queue<CFGNode *> to_visit;
-  std::unordered_map<CFGNode *, bool> in_queue;
   TI_ASSERT(nodes[final_node]->empty());
   nodes[final_node]->live_gen.clear();
   nodes[final_node]->live_kill.clear();
@@ -1144,45 +1243,18 @@ void ControlFlowGraph::live_variable_analysis(
     }
   }
 
-  for (int i = num_nodes - 1; i >= 0; i--) {
-    // push into the queue in reversed order to make it slightly faster
+  for (int i = 0; i < num_nodes; i++) {
     if (i != final_node) {
       nodes[i]->live_variable_analysis(after_lower_access);
     }
-    nodes[i]->live_out.clear();
-    nodes[i]->live_in = nodes[i]->live_gen;
-    to_visit.push(nodes[i].get());
-    in_queue[nodes[i].get()] = true;
   }
 
-  // The worklist algorithm.
-  while (!to_visit.empty()) {
-    auto now = to_visit.front();
-    to_visit.pop();
-    in_queue[now] = false;
-
-    now->live_out.clear();
-    for (auto next_node : now->next) {
-      now->live_out.insert(next_node->live_in.begin(),
-                           next_node->live_in.end());
-    }
-    auto old_in = std::move(now->live_in);
-    now->live_in = now->live_gen;
-    for (auto stmt : now->live_out) {
-      if (!CFGNode::contain_variable(now->live_kill, stmt)) {
-        now->live_in.insert(stmt);
-      }
-    }
-    if (now->live_in != old_in) {
-      // changed
-      for (auto prev_node : now->prev) {
-        if (!in_queue[prev_node]) {
-          to_visit.push(prev_node);
-          in_queue[prev_node] = true;
-        }
-      }
-    }
-  }
+  solve_gen_kill_dataflow(nodes, final_node, /*forward=*/false,
+                          &CFGNode::live_gen, &CFGNode::live_out,
+                          &CFGNode::live_in, [](CFGNode *now, Stmt *stmt) {
+                            return CFGNode::contain_variable(now->live_kill,
+                                                             stmt);
+                          });
 }
 
 void ControlFlowGraph::simplify_graph() {
@@ -23,6 +23,7 @@ struct ForLoopConfig {
   MemoryAccessOptions mem_access_opt;
   int block_dim{0};
   bool uniform{false};
+  CpuLoopSchedule cpu_schedule{CpuLoopSchedule::unspecified};
 };
 
 #define TI_DEFINE_CLONE_FOR_FRONTEND_IR                \
@@ -207,6 +208,7 @@ class FrontendForStmt : public Stmt {
   bool strictly_serialized;
   MemoryAccessOptions mem_access_opt;
   int block_dim;
+  CpuLoopSchedule cpu_schedule;
 
   FrontendForStmt(const ExprGroup &loop_vars,
                   SNode *snode,
@@ -1027,6 +1029,7 @@ class ASTBuilder {
       config.mem_access_opt.clear();
       config.block_dim = 0;
       config.strictly_serialized = false;
+      config.cpu_schedule = CpuLoopSchedule::unspecified;
     }
   };
 
@@ -1169,6 +1172,10 @@ class ASTBuilder {
     for_loop_dec_.config.strictly_serialized = true;
   }
 
+  void cpu_schedule(const std::string &name) {
+    for_loop_dec_.config.cpu_schedule = cpu_loop_schedule_from_name(name);
+  }
+
   void block_dim(int v) {
     if (arch_ == Arch::cuda || arch_ == Arch::vulkan || arch_ == Arch::amdgpu) {
       TI_ASSERT((v % 32 == 0) || bit::is_power_of_two(v));
@@ -1,5 +1,6 @@
 #include "taichi/ir/ir.h"
 
+#include <algorithm>
 #include <numeric>
 #include <thread>
 #include <unordered_map>
@@ -22,6 +23,34 @@ std::string snode_access_flag_name(SNodeAccessFlag type) {
   }
 }
 
+std::string cpu_loop_schedule_name(CpuLoopSchedule schedule) {
+  if (schedule == CpuLoopSchedule::unspecified) {
+    return "unspecified";
+  } else if (schedule == CpuLoopSchedule::static_partition) {
+    return "static";
+  } else if (schedule == CpuLoopSchedule::dynamic) {
+    return "dynamic";
+  } else if (schedule == CpuLoopSchedule::guided) {
+    return "guided";
+  } else {
+    TI_ERROR("Undefined CpuLoopSchedule (value={})", int(schedule));
+  }
+}
+
+CpuLoopSchedule cpu_loop_schedule_from_name(const std::string &name) {
+  if (name == "static") {
+    return CpuLoopSchedule::static_partition;
+  } else if (name == "dynamic") {
+    return CpuLoopSchedule::dynamic;
+  } else if (name == "guided") {
+    return CpuLoopSchedule::guided;
+  } else {
+    TI_ERROR("Unknown CPU loop schedule \"{}\", expected one of "
+             "\"static\", \"dynamic\" or \"guided\"",
+             name);
+  }
+}
+
 std::string Identifier::raw_name() const {
   if (name_.empty())
     return fmt::format("tmp{}", id);
@@ -138,6 +167,48 @@ Stmt::Stmt(const DebugInfo &dbg_info) : Stmt() {
   this->dbg_info = dbg_info;
 }
 
+Stmt::~Stmt() {
+  for (auto &use : uses_) {
+    unlink_use(use.get());
+  }
+  // The users outlive this statement when they are destroyed later, or when
+  // they are in the trash bin of another block
+  while (first_user_) {
+    unlink_use(first_user_);
+  }
+  StmtChangeRecorder::forget(this);
+}
+
+void Stmt::link_use(StmtUse *use, Stmt *value) {
+  unlink_use(use);
+  if (value == nullptr) {
+    return;
+  }
+  use->value = value;
+  use->next = value->first_user_;
+  if (use->next) {
+    use->next->prev = use;
+  }
+  value->first_user_ = use;
+}
+
+void Stmt::unlink_use(StmtUse *use) {
+  if (use->value == nullptr) {
+    return;
+  }
+  if (use->prev) {
+    use->prev->next = use->next;
+  } else {
+    use->value->first_user_ = use->next;
+  }
+  if (use->next) {
+    use->next->prev = use->prev;
+  }
+  use->value = nullptr;
+  use->prev = nullptr;
+  use->next = nullptr;
+}
+
 Callable *Stmt::get_callable() const {
   Block *parent_block = parent;
   if (parent_block->parent_callable()) {
@@ -172,7 +243,29 @@ Stmt *Stmt::insert_after_me(std::unique_ptr<Stmt> &&new_stmt) {
 }
 
 void Stmt::replace_usages_with(Stmt *new_stmt) {
-  irpass::replace_all_usages_with(nullptr, this, new_stmt);
+  TI_ASSERT(parent != nullptr);
+  auto in_scope = [this](Stmt *user) {
+    if (user->erased) {
+      return false;
+    }
+    for (auto block = user->parent; block; block = block->parent_block()) {
+      if (block == parent) {
+        return true;
+      }
+    }
+    for (auto block = parent->parent_block(); block;
+         block = block->parent_block()) {
+      if (block == user->parent) {
+        return true;
+      }
+    }
+    return false;
+  };
+  for (auto &[user, index] : get_users()) {
+    if (in_scope(user)) {
+      user->set_operand(index, new_stmt);
+    }
+  }
 }
 
 void Stmt::replace_with(VecStatement &&new_statements, bool replace_usages) {
@@ -183,7 +276,7 @@ void Stmt::replace_operand_with(Stmt *old_stmt, Stmt *new_stmt) {
   int n_op = num_operands();
   for (int i = 0; i < n_op; i++) {
     if (operand(i) == old_stmt) {
-      *operands[i] = new_stmt;
+      set_operand(i, new_stmt);
     }
   }
 }
@@ -248,10 +341,27 @@ std::vector<Stmt *> Stmt::get_operands() const {
 
 void Stmt::set_operand(int i, Stmt *stmt) {
   *operands[i] = stmt;
+  link_use(uses_[i].get(), stmt);
+  StmtChangeRecorder::record(this);
+}
+
+void Stmt::set_operand(Stmt *&field, Stmt *stmt) {
+  int i = locate_operand(&field);
+  if (i == -1) {
+    field = stmt;
+  } else {
+    set_operand(i, stmt);
+  }
 }
 
 void Stmt::register_operand(Stmt *&stmt) {
   operands.push_back(&stmt);
+  auto use = std::make_unique<StmtUse>();
+  use->user = this;
+  use->index = (int)uses_.size();
+  link_use(use.get(), stmt);
+  uses_.push_back(std::move(use));
+  StmtChangeRecorder::record(this);
 }
 
 void Stmt::mark_fields_registered() {
@@ -268,6 +378,26 @@ bool Stmt::has_operand(Stmt *stmt) const {
   return false;
 }
 
+std::vector<std::pair<Stmt *, int>> Stmt::get_users() const {
+  std::vector<std::pair<Stmt *, int>> users;
+  for (auto use = first_user_; use; use = use->next) {
+    TI_ASSERT_INFO(use->user->operand(use->index) == this,
+                   "Operand {} of {} was assigned without set_operand()",
+                   use->index, use->user->name());
+    users.emplace_back(use->user, use->index);
+  }
+  return users;
+}
+
+bool Stmt::operand_uses_linked() const {
+  for (int i = 0; i < num_operands(); i++) {
+    if (uses_[i]->value != operand(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 int Stmt::locate_operand(Stmt **stmt) {
   for (int i = 0; i < num_operands(); i++) {
     if (operands[i] == stmt) {
@@ -585,4 +715,80 @@ void ImmediateIRModifier::replace_usages_with(Stmt *old_stmt, Stmt *new_stmt) {
   }
 }
 
+thread_local StmtChangeRecorder *StmtChangeRecorder::current_ = nullptr;
+
+StmtChangeRecorder::StmtChangeRecorder() : outer_(current_) {
+  current_ = this;
+}
+
+StmtChangeRecorder::~StmtChangeRecorder() {
+  TI_ASSERT(current_ == this);
+  current_ = outer_;
+}
+
+void StmtChangeRecorder::record(Stmt *stmt) {
+  for (auto recorder = current_; recorder; recorder = recorder->outer_) {
+    recorder->changed_.insert(stmt);
+  }
+}
+
+void StmtChangeRecorder::forget(Stmt *stmt) {
+  for (auto recorder = current_; recorder; recorder = recorder->outer_) {
+    recorder->changed_.erase(stmt);
+  }
+}
+
+std::vector<Stmt *> StmtChangeRecorder::take_affected(IRNode *root) {
+  std::unordered_set<Stmt *> affected;
+  for (auto stmt : changed_) {
+    affected.insert(stmt);
+    for (auto &[user, index] : stmt->get_users()) {
+      affected.insert(user);
+    }
+  }
+  changed_.clear();
+  auto in_tree = [root](Stmt *stmt) {
+    IRNode *node = stmt;
+    while (node != root) {
+      if (node == nullptr) {
+        return false;
+      }
+      auto s = dynamic_cast<Stmt *>(node);
+      if (s && s->erased) {
+        return false;
+      }
+      node = node->get_parent();
+    }
+    return true;
+  };
+  std::vector<Stmt *> ret;
+  for (auto stmt : affected) {
+    if (in_tree(stmt)) {
+      ret.push_back(stmt);
+    }
+  }
+  std::sort(ret.begin(), ret.end(), [](Stmt *a, Stmt *b) {
+    return a->instance_id < b->instance_id;
+  });
+  return ret;
+}
+
+bool visit_until_unmodified(IRNode *root,
+                            IRVisitor *visitor,
+                            DelayedIRModifier &modifier) {
+  StmtChangeRecorder recorder;
+  root->accept(visitor);
+  bool modified = false;
+  while (modifier.modify_ir()) {
+    modified = true;
+    for (auto stmt : recorder.take_affected(root)) {
+      // The statements in the body are recorded on their own
+      if (!stmt->is_container_statement()) {
+        stmt->accept(visitor);
+      }
+    }
+  }
+  return modified;
+}
+
 }  // namespace taichi::lang
@@ -37,6 +37,17 @@ struct CompileConfig;
 enum class SNodeAccessFlag : int { block_local, read_only, mesh_local };
 std::string snode_access_flag_name(SNodeAccessFlag type);
 
+// How the iterations of a CPU parallel range-for are distributed to threads.
+// Keep in sync with cpu_parallel_range_for_scheduled in runtime.cpp.
+enum class CpuLoopSchedule : int {
+  unspecified = 0,   // Use CompileConfig::cpu_loop_schedule.
+  static_partition,  // Even partition decided before the launch.
+  dynamic,           // Fixed-size chunks grabbed at run time.
+  guided,            // Chunks shrinking with the remaining work.
+};
+std::string cpu_loop_schedule_name(CpuLoopSchedule schedule);
+CpuLoopSchedule cpu_loop_schedule_from_name(const std::string &name);
+
 class MemoryAccessOptions {
  public:
   void add_flag(SNode *snode, SNodeAccessFlag flag) {
@@ -390,11 +401,32 @@ class StmtFieldManager {
   mark_fields_registered(); \
   io(field_manager)
 
+// An operand of a statement, linked into the list of users of the statement
+// it refers to.
+struct StmtUse {
+  Stmt *user{nullptr};
+  int index{0};
+  // The statement whose user list this use is in, nullptr if in none
+  Stmt *value{nullptr};
+  StmtUse *prev{nullptr};
+  StmtUse *next{nullptr};
+};
+
 class Stmt : public IRNode {
  protected:
   std::vector<Stmt **> operands;
   explicit Stmt(const DebugInfo &dbg_info);
 
+ private:
+  // Parallel to |operands|. Kept up to date by register_operand(),
+  // set_operand() and replace_operand_with(), so operand fields must not be
+  // assigned directly once registered.
+  std::vector<std::unique_ptr<StmtUse>> uses_;
+  StmtUse *first_user_{nullptr};
+
+  void link_use(StmtUse *use, Stmt *value);
+  static void unlink_use(StmtUse *use);
+
  public:
   StmtFieldManager field_manager;
   static std::atomic<int> instance_id_counter;
@@ -457,12 +489,23 @@ class Stmt : public IRNode {
   std::vector<Stmt *> get_operands() const;
 
   void set_operand(int i, Stmt *stmt);
+  // Sets the operand stored in |field|, a field of this statement.
+  void set_operand(Stmt *&field, Stmt *stmt);
   void register_operand(Stmt *&stmt);
   int locate_operand(Stmt **stmt);
   void mark_fields_registered();
 
   bool has_operand(Stmt *stmt) const;
 
+  // Returns false if an operand field was assigned without set_operand().
+  bool operand_uses_linked() const;
+
+  // The (user, operand index) pairs of the statements using this one,
+  // including the ones not in the IR tree, in no particular order.
+  std::vector<std::pair<Stmt *, int>> get_users() const;
+
+  // Replaces the usages in the block of this statement, including nested
+  // blocks, and in the enclosing blocks. Takes O(#usages * depth) time.
   void replace_usages_with(Stmt *new_stmt);
   void replace_with(VecStatement &&new_statements, bool replace_usages = true);
   virtual void replace_operand_with(Stmt *old_stmt, Stmt *new_stmt);
@@ -504,7 +547,7 @@ class Stmt : public IRNode {
     TI_NOT_IMPLEMENTED
   }
 
-  ~Stmt() override = default;
+  ~Stmt() override;
 
   static void reset_counter() {
     instance_id_counter = 0;
@@ -621,10 +664,9 @@ class DelayedIRModifier {
   void mark_as_modified();
 };
 
-// ImmediateIRModifier aims at replacing Stmt::replace_usages_with, which visits
-// the whole tree for a single replacement. ImmediateIRModifier is currently
-// associated with a pass, visits the whole tree once at the beginning of that
-// pass, and performs a single replacement with amortized constant time.
+// ImmediateIRModifier is associated with a pass. It gathers the usages in the
+// whole tree once at the beginning of that pass, and replaces the usages of a
+// statement that existed at that time, wherever they are in the tree.
 class ImmediateIRModifier {
  private:
   std::unordered_map<Stmt *, std::vector<std::pair<Stmt *, int>>> stmt_usages_;
@@ -634,6 +676,39 @@ class ImmediateIRModifier {
   void replace_usages_with(Stmt *old_stmt, Stmt *new_stmt);
 };
 
+// StmtChangeRecorder records the statements whose operands are set on this
+// thread while it is alive, so that a pass can revisit only the statements
+// affected by its last rewrite instead of the whole tree. Recorders nest: the
+// changes are recorded by every recorder alive on this thread.
+class StmtChangeRecorder {
+ private:
+  static thread_local StmtChangeRecorder *current_;
+  StmtChangeRecorder *outer_{nullptr};
+  std::unordered_set<Stmt *> changed_;
+
+ public:
+  StmtChangeRecorder();
+  ~StmtChangeRecorder();
+
+  StmtChangeRecorder(const StmtChangeRecorder &) = delete;
+  StmtChangeRecorder &operator=(const StmtChangeRecorder &) = delete;
+
+  static void record(Stmt *stmt);
+  static void forget(Stmt *stmt);
+
+  // Returns the recorded statements and their users that are in the tree of
+  // |root| and not erased, ordered by creation, and clears the record.
+  std::vector<Stmt *> take_affected(IRNode *root);
+};
+
+// Visits |root| with |visitor|, then applies |modifier| and revisits only the
+// statements affected by the modification until |modifier| has nothing left
+// to apply. Returns true if the IR is modified. |visitor| must not depend on
+// the traversal context, nor on the users of the statement it visits.
+bool visit_until_unmodified(IRNode *root,
+                            IRVisitor *visitor,
+                            DelayedIRModifier &modifier);
+
 template <typename T>
 inline void StmtFieldManager::operator()(const char *key, T &&value) {
   using decay_T = typename std::decay<T>::type;
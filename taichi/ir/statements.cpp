@@ -244,6 +244,7 @@ std::unique_ptr<Stmt> RangeForStmt::clone() const {
       begin, end, body->clone(), is_bit_vectorized, num_cpu_threads, block_dim,
       strictly_serialized);
   new_stmt->reversed = reversed;
+  new_stmt->cpu_schedule = cpu_schedule;
   return new_stmt;
 }
 
@@ -320,7 +321,7 @@ WhileStmt::WhileStmt(std::unique_ptr<Block> &&body)
 
 std::unique_ptr<Stmt> WhileStmt::clone() const {
   auto new_stmt = std::make_unique<WhileStmt>(body->clone());
-  new_stmt->mask = mask;
+  new_stmt->set_operand(new_stmt->mask, mask);
   return new_stmt;
 }
 
@@ -399,7 +400,9 @@ std::unique_ptr<Stmt> OffloadedStmt::clone() const {
   new_stmt->block_dim = block_dim;
   new_stmt->reversed = reversed;
   new_stmt->is_bit_vectorized = is_bit_vectorized;
+  new_stmt->is_demoted_dense_struct_for = is_demoted_dense_struct_for;
   new_stmt->num_cpu_threads = num_cpu_threads;
+  new_stmt->cpu_schedule = cpu_schedule;
   new_stmt->index_offsets = index_offsets;
 
   new_stmt->mesh = mesh;
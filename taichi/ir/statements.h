@@ -1019,6 +1019,7 @@ class RangeForStmt : public Stmt {
   int num_cpu_threads;
   int block_dim;
   bool strictly_serialized;
+  CpuLoopSchedule cpu_schedule{CpuLoopSchedule::unspecified};
   std::string range_hint;
 
   RangeForStmt(Stmt *begin,
@@ -1046,7 +1047,8 @@ class RangeForStmt : public Stmt {
                      is_bit_vectorized,
                      num_cpu_threads,
                      block_dim,
-                     strictly_serialized);
+                     strictly_serialized,
+                     cpu_schedule);
   TI_DEFINE_ACCEPT
 };
 
@@ -1418,7 +1420,10 @@ class OffloadedStmt : public Stmt {
   int block_dim{1};
   bool reversed{false};
   bool is_bit_vectorized{false};
+  // A range-for converted from a struct-for over dense containers
+  bool is_demoted_dense_struct_for{false};
   int num_cpu_threads{1};
+  CpuLoopSchedule cpu_schedule{CpuLoopSchedule::static_partition};
   Stmt *end_stmt{nullptr};
   std::string range_hint = "";
 
@@ -1484,6 +1489,7 @@ class OffloadedStmt : public Stmt {
                      block_dim,
                      reversed,
                      num_cpu_threads,
+                     cpu_schedule,
                      index_offsets,
                      mem_access_opt);
   TI_DEFINE_ACCEPT
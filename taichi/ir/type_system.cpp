@@ -309,8 +309,10 @@ void Operations::init_internals() {
   PLAIN_OP(test_active_mask, i32_void, true);
   PLAIN_OP(test_shfl, i32_void, true);
   PLAIN_OP(test_list_manager, i32_void, true);
+  PLAIN_OP(test_list_manager_64bit, i32_void, true);
   PLAIN_OP(test_node_allocator, i32_void, true);
   PLAIN_OP(test_node_allocator_gc_cpu, i32_void, true);
+  PLAIN_OP(test_node_allocator_thread_cache, i32_void, true);
   PLAIN_OP(do_nothing, i32_void, true);
   PLAIN_OP(refresh_counter, i32_void, true);
   PLAIN_OP(test_internal_func_args, i32, true, f32, f32, i32);
@@ -29,6 +29,11 @@ class JITSession {
 
   // virtual void remove_module(JITModule *module) = 0;
 
+  // Lets the modules added afterwards resolve their undefined symbols against
+  // the runtime |module|, on backends linking kernels by symbol.
+  virtual void set_runtime_module(JITModule *module) {
+  }
+
   virtual void *lookup(const std::string Name) {
     TI_NOT_IMPLEMENTED
   }
@@ -2,8 +2,81 @@
 #include "taichi/ir/type.h"
 #include "taichi/program/program.h"
 
+#include <map>
+
 namespace taichi::lang {
 
+int CallableBase::ParameterLayout::find_slot(
+    const std::vector<int> &indices) const {
+  auto it = slot_ids.find(indices);
+  return it == slot_ids.end() ? -1 : it->second;
+}
+
+std::shared_ptr<const CallableBase::ParameterLayout>
+CallableBase::get_parameter_layout() {
+  // Concurrent first launches may both build the layout; either copy is fine.
+  auto layout = std::atomic_load(&parameter_layout_);
+  if (layout) {
+    return layout;
+  }
+  auto new_layout = std::make_shared<ParameterLayout>();
+  std::map<std::vector<int>, const Parameter *> sorted;
+  for (const auto &[indices, param] : nested_parameters) {
+    sorted[indices] = &param;
+  }
+  auto offset_of = [&](std::vector<int> indices) {
+    return (int)args_type->get_element_offset(indices);
+  };
+  for (const auto &[indices, param] : sorted) {
+    ParameterSlot slot;
+    slot.indices = indices;
+    slot.parameter = *param;
+    const StructType *type = nullptr;
+    if (args_type && indices.size() == 1) {
+      type = args_type->get_element_type(indices)->cast<StructType>();
+    }
+    if (type && param->is_argpack) {
+      slot.data_ptr_offset =
+          offset_of({indices[0], TypeFactory::DATA_PTR_POS_IN_ARGPACK});
+    } else if (type && param->is_array) {
+      const int num_fields = type->elements().size();
+      if (num_fields > TypeFactory::DATA_PTR_POS_IN_NDARRAY) {
+        slot.data_ptr_offset =
+            offset_of({indices[0], TypeFactory::DATA_PTR_POS_IN_NDARRAY});
+      }
+      if (param->needs_grad &&
+          num_fields > TypeFactory::GRAD_PTR_POS_IN_NDARRAY) {
+        slot.grad_ptr_offset =
+            offset_of({indices[0], TypeFactory::GRAD_PTR_POS_IN_NDARRAY});
+      }
+      int ndim = 0;
+      if (num_fields > TypeFactory::SHAPE_POS_IN_NDARRAY) {
+        auto shape_type =
+            type->elements()[TypeFactory::SHAPE_POS_IN_NDARRAY].type;
+        if (auto shape_struct = shape_type->cast<StructType>()) {
+          ndim = shape_struct->elements().size();
+        } else if (auto shape_tensor = shape_type->cast<TensorType>()) {
+          ndim = shape_tensor->get_num_elements();
+        }
+      }
+      for (int i = 0; i < ndim; i++) {
+        slot.shape_offsets.push_back(
+            offset_of({indices[0], TypeFactory::SHAPE_POS_IN_NDARRAY, i}));
+      }
+    }
+    new_layout->slot_ids[indices] = new_layout->slots.size();
+    new_layout->slots.push_back(std::move(slot));
+  }
+  layout = std::move(new_layout);
+  std::atomic_store(&parameter_layout_, layout);
+  return layout;
+}
+
+void CallableBase::reset_parameter_layout() {
+  std::atomic_store(&parameter_layout_,
+                    std::shared_ptr<const ParameterLayout>());
+}
+
 Callable::Callable() = default;
 
 Callable::~Callable() = default;
@@ -180,5 +253,6 @@ void Callable::finalize_params() {
   std::string layout = program->get_kernel_argument_data_layout();
   std::tie(args_type, args_size) =
       program->get_struct_type_with_data_layout(type, layout);
+  reset_parameter_layout();
 }
 }  // namespace taichi::lang
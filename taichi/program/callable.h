@@ -130,6 +130,39 @@ class TI_DLL_EXPORT CallableBase {
 
   Arch arch;
   std::string name;
+
+  // A parameter in |nested_parameters| together with where its pointers and
+  // shape live in the argument buffer.
+  struct ParameterSlot {
+    std::vector<int> indices;
+    Parameter parameter;
+    // Offsets in the argument buffer, or -1 if the parameter does not have
+    // the field or is nested in an argpack.
+    int data_ptr_offset{-1};
+    int grad_ptr_offset{-1};
+    std::vector<int> shape_offsets;
+  };
+
+  // Index-based view of |nested_parameters|, so that launches can address
+  // parameters by slot instead of building and hashing index vectors.
+  // Enclosing argpacks come before their members.
+  struct ParameterLayout {
+    std::vector<ParameterSlot> slots;
+    std::unordered_map<std::vector<int>, int, hashing::Hasher<std::vector<int>>>
+        slot_ids;
+
+    // Returns -1 if |indices| is not a parameter.
+    int find_slot(const std::vector<int> &indices) const;
+  };
+
+  // Built on first use after the parameters are finalized.
+  std::shared_ptr<const ParameterLayout> get_parameter_layout();
+
+ protected:
+  void reset_parameter_layout();
+
+ private:
+  std::shared_ptr<const ParameterLayout> parameter_layout_;
 };
 
 class TI_DLL_EXPORT Callable : public CallableBase {
@@ -19,6 +19,7 @@ struct CompileConfig {
   bool print_ir;
   bool print_accessor_ir;
   bool print_ir_dbg_info;
+  bool print_full_simplify_stats{false};
   bool serial_schedule;
   bool simplify_before_lower_access;
   bool lower_access;
@@ -58,6 +59,12 @@ struct CompileConfig {
   int saturating_grid_dim;
   int max_block_dim;
   int cpu_max_num_threads;
+  std::string cpu_thread_pool{"default"};   // "default"|"work_stealing"
+  std::string cpu_loop_schedule{"static"};  // "static"|"dynamic"|"guided"
+  // Emit range-for bodies that run a whole block of iterations
+  bool cpu_block_range_for{false};
+  bool cpu_huge_pages{false};
+  bool cpu_numa_first_touch{false};
   int random_seed;
 
   // LLVM backend options:
@@ -96,6 +103,9 @@ struct CompileConfig {
   int offline_cache_max_size_of_files{100 * 1024 *
                                       1024};   // bytes, default: 100MB
   double offline_cache_cleaning_factor{0.25};  // [0.f, 1.f]
+  std::string offline_cache_format{"files"};     // "files"|"pack"
+  bool offline_cache_compression{false};
+  bool offline_cache_dedup{false};
 
   int num_compile_threads{4};
   std::string vk_api_version;
@@ -0,0 +1,439 @@
+#include "taichi/program/iterative_solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <type_traits>
+#include <unordered_map>
+
+namespace taichi::lang {
+
+namespace {
+
+constexpr int64 kMinVectorTaskSize = 1 << 15;
+// IC(0) retries with a growing diagonal shift when a pivot is not positive.
+constexpr int kMaxIC0Shifts = 16;
+constexpr double kInitialIC0Shift = 1e-3;
+
+template <typename Func>
+struct VectorTaskContext {
+  const Func *func;
+  int64 n;
+  int num_tasks;
+};
+
+template <typename Func>
+void vector_task(void *context, int thread_id, int task) {
+  auto &ctx = *(VectorTaskContext<Func> *)context;
+  (*ctx.func)(task, ctx.n * task / ctx.num_tasks,
+              ctx.n * (task + 1) / ctx.num_tasks);
+}
+
+int num_vector_tasks(Program *prog, int64 n) {
+  return std::clamp<int64>(n / kMinVectorTaskSize, 1,
+                           prog->compile_config().cpu_max_num_threads);
+}
+
+// Runs |func(task, begin, end)| over chunks of [0, n) on the host threads.
+template <typename Func>
+void parallel_for(Program *prog, int64 n, const Func &func) {
+  VectorTaskContext<Func> ctx{&func, n, num_vector_tasks(prog, n)};
+  if (ctx.num_tasks == 1) {
+    func(0, 0, n);
+  } else {
+    prog->run_host_tasks(ctx.num_tasks, &ctx, vector_task<Func>);
+  }
+}
+
+// Sums |func(begin, end)| over chunks of [0, n). The chunks only depend on n
+// and the number of threads, so the result does not change between runs.
+template <typename Func>
+double parallel_sum(Program *prog, int64 n, const Func &func) {
+  std::vector<double> partial(num_vector_tasks(prog, n), 0.0);
+  parallel_for(prog, n, [&](int task, int64 begin, int64 end) {
+    partial[task] = func(begin, end);
+  });
+  return std::accumulate(partial.begin(), partial.end(), 0.0);
+}
+
+template <typename DT>
+double dot(Program *prog, int64 n, const DT *a, const DT *b) {
+  return parallel_sum(prog, n, [&](int64 begin, int64 end) {
+    double sum = 0.0;
+    for (int64 i = begin; i < end; i++) {
+      sum += (double)a[i] * b[i];
+    }
+    return sum;
+  });
+}
+
+template <typename DT>
+Eigen::SparseMatrix<DT, Eigen::RowMajor> get_lower_triangle(SparseMatrix &A) {
+  using ColMajorMatrix = Eigen::SparseMatrix<DT, Eigen::ColMajor>;
+  using RowMajorMatrix = Eigen::SparseMatrix<DT, Eigen::RowMajor>;
+  RowMajorMatrix lower;
+  if (auto *m = dynamic_cast<EigenSparseMatrix<ColMajorMatrix> *>(&A)) {
+    lower = static_cast<ColMajorMatrix *>(m->get_matrix())
+                ->template triangularView<Eigen::Lower>();
+  } else if (auto *m = dynamic_cast<EigenSparseMatrix<RowMajorMatrix> *>(&A)) {
+    lower = static_cast<RowMajorMatrix *>(m->get_matrix())
+                ->template triangularView<Eigen::Lower>();
+  } else {
+    TI_ERROR("Preconditioners only support Eigen sparse matrices");
+  }
+  lower.makeCompressed();
+  return lower;
+}
+
+}  // namespace
+
+template <typename DT>
+void IterativeSolver<DT>::compute(SparseMatrix &A) {
+  auto dtype = std::is_same_v<DT, float64> ? PrimitiveType::f64
+                                            : PrimitiveType::f32;
+  if (A.get_data_type() != dtype) {
+    TI_ERROR("The solver of {} cannot solve a sparse matrix of {}",
+             data_type_name(dtype), data_type_name(A.get_data_type()));
+  }
+  if (A.num_rows() != A.num_cols()) {
+    TI_ERROR("Cannot solve a non-square {}x{} sparse matrix", A.num_rows(),
+             A.num_cols());
+  }
+  A_ = &A;
+  n_ = A.num_rows();
+  inv_diagonal_.clear();
+  factor_row_offsets_.clear();
+  factor_cols_.clear();
+  factor_values_.clear();
+  if (preconditioner_ == Preconditioner::None) {
+    return;
+  }
+  auto lower = get_lower_triangle<DT>(A);
+  if (preconditioner_ == Preconditioner::Jacobi) {
+    inv_diagonal_.resize(n_);
+    for (int64 i = 0; i < n_; i++) {
+      DT d = lower.coeff(i, i);
+      inv_diagonal_[i] = d != 0 ? DT(1) / d : DT(1);
+    }
+    return;
+  }
+  // IC(0): L has the pattern of the lower triangle of A, and L L^T matches A
+  // on that pattern. Row i of L only needs the rows before it.
+  factor_row_offsets_.assign(lower.outerIndexPtr(),
+                             lower.outerIndexPtr() + n_ + 1);
+  factor_cols_.assign(lower.innerIndexPtr(),
+                      lower.innerIndexPtr() + lower.nonZeros());
+  auto *offsets = factor_row_offsets_.data();
+  auto *cols = factor_cols_.data();
+  for (int64 i = 0; i < n_; i++) {
+    if (offsets[i] == offsets[i + 1] || cols[offsets[i + 1] - 1] != i) {
+      TI_ERROR("IC(0) needs a stored diagonal entry in row {}", i);
+    }
+  }
+  double shift = 0.0;
+  for (int attempt = 0; attempt < kMaxIC0Shifts; attempt++) {
+    factor_values_.assign(lower.valuePtr(),
+                          lower.valuePtr() + lower.nonZeros());
+    auto *values = factor_values_.data();
+    bool success = true;
+    for (int64 i = 0; i < n_ && success; i++) {
+      int64 diag = offsets[i + 1] - 1;
+      values[diag] *= DT(1 + shift);
+      for (int64 idx = offsets[i]; idx < diag; idx++) {
+        // L(i, k) = (A(i, k) - sum_{j < k} L(i, j) L(k, j)) / L(k, k)
+        int k = cols[idx];
+        DT sum = values[idx];
+        int64 a = offsets[i], b = offsets[k], b_end = offsets[k + 1] - 1;
+        while (a < idx && b < b_end) {
+          if (cols[a] == cols[b]) {
+            sum -= values[a++] * values[b++];
+          } else if (cols[a] < cols[b]) {
+            a++;
+          } else {
+            b++;
+          }
+        }
+        values[idx] = sum / values[b_end];
+      }
+      DT pivot = values[diag];
+      for (int64 idx = offsets[i]; idx < diag; idx++) {
+        pivot -= values[idx] * values[idx];
+      }
+      if (pivot > 0) {
+        values[diag] = std::sqrt(pivot);
+      } else {
+        success = false;
+      }
+    }
+    if (success) {
+      return;
+    }
+    shift = shift == 0.0 ? kInitialIC0Shift : shift * 2;
+    TI_TRACE("IC(0) broke down, retrying with a diagonal shift of {}", shift);
+  }
+  TI_ERROR("IC(0) failed, the matrix is probably not positive definite");
+}
+
+template <typename DT>
+void IterativeSolver<DT>::apply_preconditioner(Program *prog,
+                                               const DT *r,
+                                               DT *z) {
+  if (preconditioner_ == Preconditioner::Jacobi) {
+    auto *inv_diagonal = inv_diagonal_.data();
+    parallel_for(prog, n_, [&](int task, int64 begin, int64 end) {
+      for (int64 i = begin; i < end; i++) {
+        z[i] = inv_diagonal[i] * r[i];
+      }
+    });
+  } else if (preconditioner_ == Preconditioner::IC0) {
+    // The triangular solves are sequential.
+    auto *offsets = factor_row_offsets_.data();
+    auto *cols = factor_cols_.data();
+    auto *values = factor_values_.data();
+    for (int64 i = 0; i < n_; i++) {
+      int64 diag = offsets[i + 1] - 1;
+      DT sum = r[i];
+      for (int64 idx = offsets[i]; idx < diag; idx++) {
+        sum -= values[idx] * z[cols[idx]];
+      }
+      z[i] = sum / values[diag];
+    }
+    for (int64 i = n_ - 1; i >= 0; i--) {
+      int64 diag = offsets[i + 1] - 1;
+      z[i] /= values[diag];
+      for (int64 idx = offsets[i]; idx < diag; idx++) {
+        z[cols[idx]] -= values[idx] * z[i];
+      }
+    }
+  } else {
+    parallel_for(prog, n_, [&](int task, int64 begin, int64 end) {
+      std::copy(r + begin, r + end, z + begin);
+    });
+  }
+}
+
+template <typename DT>
+bool IterativeSolver<DT>::converged(double residual) {
+  if (verbose_) {
+    fmt::print("iter: {}, residual: {}\n", residuals_.size(), residual);
+  }
+  residuals_.push_back(residual);
+  return residual <= threshold_;
+}
+
+template <typename DT>
+bool IterativeSolver<DT>::solve(Program *prog,
+                                const Ndarray &b,
+                                const Ndarray &x) {
+  TI_ASSERT_INFO(A_ != nullptr, "Call compute() before solve()");
+  for (auto *v : {&b, &x}) {
+    if (v->dtype != A_->get_data_type() || v->get_nelement() != n_) {
+      TI_ERROR("Expected a vector of {} {}, got {} {}", n_,
+               data_type_name(A_->get_data_type()), v->get_nelement(),
+               data_type_name(v->dtype));
+    }
+  }
+  auto *b_ptr = (const DT *)prog->get_ndarray_data_ptr_as_int(&b);
+  auto *x_ptr = (DT *)prog->get_ndarray_data_ptr_as_int(&x);
+  for (auto *v : {&r_, &z_, &p_, &q_}) {
+    v->resize(n_);
+  }
+  if (method_ == Method::BiCGSTAB) {
+    for (auto *v : {&s_, &t_, &r_hat_}) {
+      v->resize(n_);
+    }
+  }
+  residuals_.clear();
+  threshold_ = std::max(rtol_ * std::sqrt(dot(prog, n_, b_ptr, b_ptr)), atol_);
+  if (method_ == Method::CG) {
+    is_success_ = solve_cg(prog, b_ptr, x_ptr);
+  } else {
+    is_success_ = solve_bicgstab(prog, b_ptr, x_ptr);
+  }
+  return is_success_;
+}
+
+template <typename DT>
+bool IterativeSolver<DT>::solve_cg(Program *prog, const DT *b, DT *x) {
+  DT *r = r_.data(), *z = z_.data(), *p = p_.data(), *q = q_.data();
+  // r = b - A x
+  A_->spmv_ptr(prog, x, q);
+  double r_norm2 = parallel_sum(prog, n_, [&](int64 begin, int64 end) {
+    double sum = 0.0;
+    for (int64 i = begin; i < end; i++) {
+      r[i] = b[i] - q[i];
+      sum += (double)r[i] * r[i];
+    }
+    return sum;
+  });
+  if (converged(std::sqrt(r_norm2))) {
+    return true;
+  }
+  apply_preconditioner(prog, r, z);
+  double rz = dot(prog, n_, r, z);
+  parallel_for(prog, n_, [&](int task, int64 begin, int64 end) {
+    std::copy(z + begin, z + end, p + begin);
+  });
+  for (int k = 0; k < max_iters_; k++) {
+    A_->spmv_ptr(prog, p, q);
+    double pq = dot(prog, n_, p, q);
+    if (pq == 0.0) {
+      return false;
+    }
+    DT alpha = rz / pq;
+    // x += alpha p, r -= alpha A p
+    r_norm2 = parallel_sum(prog, n_, [&](int64 begin, int64 end) {
+      double sum = 0.0;
+      for (int64 i = begin; i < end; i++) {
+        x[i] += alpha * p[i];
+        r[i] -= alpha * q[i];
+        sum += (double)r[i] * r[i];
+      }
+      return sum;
+    });
+    if (converged(std::sqrt(r_norm2))) {
+      return true;
+    }
+    apply_preconditioner(prog, r, z);
+    double rz_next = dot(prog, n_, r, z);
+    DT beta = rz_next / rz;
+    rz = rz_next;
+    parallel_for(prog, n_, [&](int task, int64 begin, int64 end) {
+      for (int64 i = begin; i < end; i++) {
+        p[i] = z[i] + beta * p[i];
+      }
+    });
+  }
+  return false;
+}
+
+template <typename DT>
+bool IterativeSolver<DT>::solve_bicgstab(Program *prog, const DT *b, DT *x) {
+  DT *r = r_.data(), *y = z_.data(), *p = p_.data(), *v = q_.data();
+  DT *s = s_.data(), *t = t_.data(), *r_hat = r_hat_.data();
+  // r = b - A x, r_hat = r, p = v = 0
+  A_->spmv_ptr(prog, x, v);
+  double r_norm2 = parallel_sum(prog, n_, [&](int64 begin, int64 end) {
+    double sum = 0.0;
+    for (int64 i = begin; i < end; i++) {
+      r[i] = b[i] - v[i];
+      r_hat[i] = r[i];
+      p[i] = 0;
+      v[i] = 0;
+      sum += (double)r[i] * r[i];
+    }
+    return sum;
+  });
+  if (converged(std::sqrt(r_norm2))) {
+    return true;
+  }
+  double rho = 1.0, alpha = 1.0, omega = 1.0;
+  for (int k = 0; k < max_iters_; k++) {
+    double rho_next = dot(prog, n_, r_hat, r);
+    if (rho_next == 0.0) {
+      return false;
+    }
+    DT beta = (rho_next / rho) * (alpha / omega);
+    rho = rho_next;
+    DT omega_dt = omega;
+    parallel_for(prog, n_, [&](int task, int64 begin, int64 end) {
+      for (int64 i = begin; i < end; i++) {
+        p[i] = r[i] + beta * (p[i] - omega_dt * v[i]);
+      }
+    });
+    apply_preconditioner(prog, p, y);
+    A_->spmv_ptr(prog, y, v);
+    double r_hat_v = dot(prog, n_, r_hat, v);
+    if (r_hat_v == 0.0) {
+      return false;
+    }
+    alpha = rho / r_hat_v;
+    DT alpha_dt = alpha;
+    // x += alpha y, s = r - alpha v
+    double s_norm2 = parallel_sum(prog, n_, [&](int64 begin, int64 end) {
+      double sum = 0.0;
+      for (int64 i = begin; i < end; i++) {
+        x[i] += alpha_dt * y[i];
+        s[i] = r[i] - alpha_dt * v[i];
+        sum += (double)s[i] * s[i];
+      }
+      return sum;
+    });
+    if (std::sqrt(s_norm2) <= threshold_) {
+      return converged(std::sqrt(s_norm2));
+    }
+    apply_preconditioner(prog, s, y);
+    A_->spmv_ptr(prog, y, t);
+    double tt = dot(prog, n_, t, t);
+    if (tt == 0.0) {
+      return false;
+    }
+    omega = dot(prog, n_, t, s) / tt;
+    omega_dt = omega;
+    // x += omega M^-1 s, r = s - omega t
+    r_norm2 = parallel_sum(prog, n_, [&](int64 begin, int64 end) {
+      double sum = 0.0;
+      for (int64 i = begin; i < end; i++) {
+        x[i] += omega_dt * y[i];
+        r[i] = s[i] - omega_dt * t[i];
+        sum += (double)r[i] * r[i];
+      }
+      return sum;
+    });
+    if (converged(std::sqrt(r_norm2))) {
+      return true;
+    }
+    if (omega == 0.0) {
+      return false;
+    }
+  }
+  return false;
+}
+
+template <typename DT>
+std::unique_ptr<IterativeSolver<DT>> make_iterative_solver(
+    const std::string &method,
+    const std::string &preconditioner,
+    int max_iters,
+    double rtol,
+    double atol,
+    bool verbose) {
+  using Solver = IterativeSolver<DT>;
+  static const std::unordered_map<std::string, typename Solver::Method>
+      methods = {{"cg", Solver::Method::CG},
+                 {"bicgstab", Solver::Method::BiCGSTAB}};
+  static const std::unordered_map<std::string, typename Solver::Preconditioner>
+      preconditioners = {{"none", Solver::Preconditioner::None},
+                         {"jacobi", Solver::Preconditioner::Jacobi},
+                         {"ic0", Solver::Preconditioner::IC0}};
+  auto method_it = methods.find(method);
+  if (method_it == methods.end()) {
+    TI_ERROR("Unsupported iterative solver method: {}", method);
+  }
+  auto preconditioner_it = preconditioners.find(preconditioner);
+  if (preconditioner_it == preconditioners.end()) {
+    TI_ERROR("Unsupported preconditioner: {}", preconditioner);
+  }
+  return std::make_unique<Solver>(method_it->second, preconditioner_it->second,
+                                  max_iters, rtol, atol, verbose);
+}
+
+template class IterativeSolver<float32>;
+template class IterativeSolver<float64>;
+
+template std::unique_ptr<IterativeSolver<float32>>
+make_iterative_solver<float32>(const std::string &method,
+                               const std::string &preconditioner,
+                               int max_iters,
+                               double rtol,
+                               double atol,
+                               bool verbose);
+template std::unique_ptr<IterativeSolver<float64>>
+make_iterative_solver<float64>(const std::string &method,
+                               const std::string &preconditioner,
+                               int max_iters,
+                               double rtol,
+                               double atol,
+                               bool verbose);
+
+}  // namespace taichi::lang
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "taichi/program/ndarray.h"
+#include "taichi/program/program.h"
+#include "taichi/program/sparse_matrix.h"
+
+namespace taichi::lang {
+
+/**
+ * Preconditioned Krylov solvers working in place on host Ndarray buffers.
+ *
+ * The solution ndarray holds the initial guess on entry, so that a sequence
+ * of related systems can warm start from the previous solution. SpMV and the
+ * vector operations run on the CPU thread pool of |prog|. The preconditioner
+ * is set up from the matrix once per compute() call.
+ */
+template <typename DT>
+class IterativeSolver {
+ public:
+  enum class Method { CG, BiCGSTAB };
+  enum class Preconditioner { None, Jacobi, IC0 };
+
+  IterativeSolver(Method method,
+                  Preconditioner preconditioner,
+                  int max_iters,
+                  double rtol,
+                  double atol,
+                  bool verbose)
+      : method_(method),
+        preconditioner_(preconditioner),
+        max_iters_(max_iters),
+        rtol_(rtol),
+        atol_(atol),
+        verbose_(verbose) {
+  }
+
+  // Sets up the preconditioner for |A|. Must be called again once the values
+  // of |A| change.
+  void compute(SparseMatrix &A);
+
+  // Solves A x = b, starting from the current content of |x|. Returns whether
+  // the residual norm dropped below max(rtol * |b|, atol).
+  bool solve(Program *prog, const Ndarray &b, const Ndarray &x);
+
+  // The residual norm before the first iteration and after each iteration.
+  const std::vector<double> &get_residuals() const {
+    return residuals_;
+  }
+
+  int get_iterations() const {
+    return residuals_.empty() ? 0 : (int)residuals_.size() - 1;
+  }
+
+  bool is_success() const {
+    return is_success_;
+  }
+
+ private:
+  void apply_preconditioner(Program *prog, const DT *r, DT *z);
+  bool solve_cg(Program *prog, const DT *b, DT *x);
+  bool solve_bicgstab(Program *prog, const DT *b, DT *x);
+  bool converged(double residual);
+
+  Method method_{Method::CG};
+  Preconditioner preconditioner_{Preconditioner::None};
+  int max_iters_{0};
+  double rtol_{0.0};
+  double atol_{0.0};
+  bool verbose_{false};
+  bool is_success_{false};
+
+  SparseMatrix *A_{nullptr};
+  int64 n_{0};
+  double threshold_{0.0};
+  std::vector<double> residuals_;
+  // Jacobi: the inverse diagonal
+  std::vector<DT> inv_diagonal_;
+  // IC(0): the lower triangular factor in CSR, with the diagonal last in
+  // every row
+  std::vector<int64> factor_row_offsets_;
+  std::vector<int> factor_cols_;
+  std::vector<DT> factor_values_;
+  // Work vectors, kept between solves of the same size
+  std::vector<DT> r_, z_, p_, q_, s_, t_, r_hat_;
+};
+
+template <typename DT>
+std::unique_ptr<IterativeSolver<DT>> make_iterative_solver(
+    const std::string &method,
+    const std::string &preconditioner,
+    int max_iters,
+    double rtol,
+    double atol,
+    bool verbose);
+
+}  // namespace taichi::lang
@@ -1,5 +1,6 @@
 #include "kernel_profiler.h"
 
+#include "taichi/system/threading.h"
 #include "taichi/system/timer.h"
 #include "taichi/rhi/cuda/cuda_driver.h"
 #include "taichi/rhi/cuda/cuda_profiler.h"
@@ -20,6 +21,29 @@ void KernelProfileStatisticalResult::insert_record(double t) {
   total += t;
 }
 
+void KernelProfileStatisticalResult::insert_thread_record(
+    const KernelProfileTracedRecord &record) {
+  const auto &busy_time = record.thread_busy_time_in_ms;
+  if (thread_busy_time.size() < busy_time.size()) {
+    thread_busy_time.resize(busy_time.size(), 0.0);
+  }
+  int num_active_threads = 0;
+  double max_time = 0, sum_time = 0;
+  for (std::size_t i = 0; i < busy_time.size(); i++) {
+    thread_busy_time[i] += busy_time[i];
+    if (busy_time[i] > 0) {
+      num_active_threads++;
+      max_time = std::max(max_time, (double)busy_time[i]);
+      sum_time += busy_time[i];
+    }
+  }
+  if (num_active_threads == 0)
+    return;
+  num_blocks += record.grid_size;
+  max_thread_time += max_time;
+  mean_thread_time += sum_time / num_active_threads;
+}
+
 bool KernelProfileStatisticalResult::operator<(
     const KernelProfileStatisticalResult &o) const {
   return total > o.total;
@@ -42,7 +66,22 @@ void KernelProfilerBase::query(const std::string &kernel_name,
                                double &min,
                                double &max,
                                double &avg) {
+  double num_blocks = 0, load_imbalance = 0;
+  std::vector<double> thread_busy_time;
+  query(kernel_name, counter, min, max, avg, num_blocks, load_imbalance,
+        thread_busy_time);
+}
+
+void KernelProfilerBase::query(const std::string &kernel_name,
+                               int &counter,
+                               double &min,
+                               double &max,
+                               double &avg,
+                               double &num_blocks,
+                               double &load_imbalance,
+                               std::vector<double> &thread_busy_time) {
   sync();
+  double max_thread_time = 0, mean_thread_time = 0;
   std::regex name_regex(kernel_name + "(.*)");
   for (auto &rec : statistical_results_) {
     if (std::regex_match(rec.name, name_regex)) {
@@ -58,9 +97,21 @@ void KernelProfilerBase::query(const std::string &kernel_name,
       } else {
         TI_WARN("{}.counter({}) != {}.counter({}).", kernel_name, counter,
                 rec.name, rec.counter);
+        continue;
+      }
+      num_blocks += (double)rec.num_blocks / rec.counter;
+      max_thread_time += rec.max_thread_time;
+      mean_thread_time += rec.mean_thread_time;
+      if (thread_busy_time.size() < rec.thread_busy_time.size()) {
+        thread_busy_time.resize(rec.thread_busy_time.size(), 0.0);
+      }
+      for (std::size_t i = 0; i < rec.thread_busy_time.size(); i++) {
+        thread_busy_time[i] += rec.thread_busy_time[i];
       }
     }
   }
+  load_imbalance =
+      mean_thread_time > 0 ? max_thread_time / mean_thread_time : 0.0;
 }
 
 double KernelProfilerBase::get_total_time() const {
@@ -73,19 +124,36 @@ void KernelProfilerBase::insert_record(const std::string &kernel_name,
   KernelProfileTracedRecord record;
   record.name = kernel_name;
   record.kernel_elapsed_time_in_ms = duration_ms;
-  traced_records_.push_back(record);
+  add_traced_record(std::move(record));
   // Count record
-  auto it = std::find_if(
-      statistical_results_.begin(), statistical_results_.end(),
-      [&](KernelProfileStatisticalResult &r) { return r.name == record.name; });
-  if (it == statistical_results_.end()) {
-    statistical_results_.emplace_back(record.name);
-    it = std::prev(statistical_results_.end());
-  }
-  it->insert_record(duration_ms);
+  get_statistical_result(kernel_name).insert_record(duration_ms);
   total_time_ms_ += duration_ms;
 }
 
+void KernelProfilerBase::add_traced_record(KernelProfileTracedRecord record) {
+  if (traced_records_.size() >= kMaxNumTracedRecords) {
+    TI_WARN("Over {} traced kernel profiler records, dropping the older half.",
+            kMaxNumTracedRecords);
+    traced_records_.erase(
+        traced_records_.begin(),
+        traced_records_.begin() + traced_records_.size() / 2);
+  }
+  traced_records_.push_back(std::move(record));
+}
+
+KernelProfileStatisticalResult &KernelProfilerBase::get_statistical_result(
+    const std::string &name) {
+  // The index is rebuilt lazily, since subclasses may clear the results
+  auto it = statistical_result_ids_.find(name);
+  if (it != statistical_result_ids_.end() &&
+      it->second < statistical_results_.size() &&
+      statistical_results_[it->second].name == name) {
+    return statistical_results_[it->second];
+  }
+  statistical_result_ids_[name] = statistical_results_.size();
+  return statistical_results_.emplace_back(name);
+}
+
 namespace {
 // A simple profiler that uses Time::get_time()
 class DefaultProfiler : public KernelProfilerBase {
@@ -101,9 +169,21 @@ class DefaultProfiler : public KernelProfilerBase {
     total_time_ms_ = 0;
     traced_records_.clear();
     statistical_results_.clear();
+    statistical_result_ids_.clear();
+  }
+
+  ThreadPoolStats *get_thread_pool_stats(int max_num_threads) override {
+    if (!thread_pool_stats_ ||
+        thread_pool_stats_->workers.size() != (std::size_t)max_num_threads) {
+      thread_pool_stats_ = std::make_unique<ThreadPoolStats>(max_num_threads);
+    }
+    return thread_pool_stats_.get();
   }
 
   void start(const std::string &kernel_name) override {
+    if (thread_pool_stats_) {
+      thread_pool_stats_->reset();
+    }
     start_t_ = Time::get_time();
     event_name_ = kernel_name;
   }
@@ -115,24 +195,31 @@ class DefaultProfiler : public KernelProfilerBase {
     KernelProfileTracedRecord record;
     record.name = event_name_;
     record.kernel_elapsed_time_in_ms = ms;
-    traced_records_.push_back(record);
-    // count record
-    auto it =
-        std::find_if(statistical_results_.begin(), statistical_results_.end(),
-                     [&](KernelProfileStatisticalResult &r) {
-                       return r.name == event_name_;
-                     });
-    if (it == statistical_results_.end()) {
-      statistical_results_.emplace_back(event_name_);
-      it = std::prev(statistical_results_.end());
+    if (thread_pool_stats_) {
+      int64 num_blocks = 0;
+      for (auto &worker : thread_pool_stats_->workers) {
+        num_blocks += worker.num_tasks;
+      }
+      // Serial tasks do not run on the pool
+      if (num_blocks > 0) {
+        record.grid_size = (int)num_blocks;
+        for (auto &worker : thread_pool_stats_->workers) {
+          record.thread_busy_time_in_ms.push_back(worker.busy_time * 1000.0);
+        }
+      }
     }
-    it->insert_record(ms);
+    // count record
+    auto &result = get_statistical_result(event_name_);
+    result.insert_record(ms);
+    result.insert_thread_record(record);
     total_time_ms_ += ms;
+    add_traced_record(std::move(record));
   }
 
  private:
   double start_t_;
   std::string event_name_;
+  std::unique_ptr<ThreadPoolStats> thread_pool_stats_;
 };
 
 }  // namespace
@@ -6,10 +6,15 @@
 #include <algorithm>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include <regex>
 
+namespace taichi {
+struct ThreadPoolStats;
+}  // namespace taichi
+
 namespace taichi::lang {
 
 struct KernelProfileTracedRecord {
@@ -24,6 +29,9 @@ struct KernelProfileTracedRecord {
   float time_since_base{0.0};        // for Timeline
   std::string name;                  // kernel name
   std::vector<float> metric_values;  // user selected metrics
+  // CPU thread pool: the busy time of every worker, grid_size being the
+  // number of blocks (range-for tasks) run
+  std::vector<float> thread_busy_time_in_ms;
 };
 
 struct KernelProfileStatisticalResult {
@@ -32,6 +40,13 @@ struct KernelProfileStatisticalResult {
   double min;
   double max;
   double total;
+  // CPU thread pool, summed over the launches: the blocks run, the busy time
+  // of the busiest worker and of an average worker, and the busy time of
+  // every worker
+  int64 num_blocks{0};
+  double max_thread_time{0};
+  double mean_thread_time{0};
+  std::vector<double> thread_busy_time;
 
   explicit KernelProfileStatisticalResult(const std::string &name)
       : name(name), counter(0), min(0), max(0), total(0) {
@@ -40,15 +55,26 @@ struct KernelProfileStatisticalResult {
   void insert_record(double t);  // TODO replace `double time` with
                                  // `KernelProfileTracedRecord record`
 
+  void insert_thread_record(const KernelProfileTracedRecord &record);
+
   bool operator<(const KernelProfileStatisticalResult &o) const;
 };
 
 class KernelProfilerBase {
  protected:
+  // Once full, the older half of the traced records is dropped
+  static constexpr std::size_t kMaxNumTracedRecords = 1 << 20;
+
   std::vector<KernelProfileTracedRecord> traced_records_;
   std::vector<KernelProfileStatisticalResult> statistical_results_;
+  std::unordered_map<std::string, std::size_t> statistical_result_ids_;
   double total_time_ms_{0};
 
+  void add_traced_record(KernelProfileTracedRecord record);
+
+  KernelProfileStatisticalResult &get_statistical_result(
+      const std::string &name);
+
  public:
   // Needed for the CUDA backend since we need to know which task to "stop"
   using TaskHandle = void *;
@@ -89,6 +115,25 @@ class KernelProfilerBase {
              double &max,
              double &avg);
 
+  // Also sums the CPU thread pool metrics of the offloaded tasks: the blocks
+  // per launch, the load imbalance (busiest over average worker, 1.0 being
+  // balanced, 0 if no task ran on the pool) and the busy time of every worker
+  // in ms.
+  void query(const std::string &kernel_name,
+             int &counter,
+             double &min,
+             double &max,
+             double &avg,
+             double &num_blocks,
+             double &load_imbalance,
+             std::vector<double> &thread_busy_time);
+
+  // The counters the CPU thread pool should fill in during a launch, or
+  // nullptr if the profiler does not use them.
+  virtual ThreadPoolStats *get_thread_pool_stats(int max_num_threads) {
+    return nullptr;
+  }
+
   std::vector<KernelProfileTracedRecord> get_traced_records() {
     return traced_records_;
   }
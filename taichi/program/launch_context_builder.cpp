@@ -24,6 +24,8 @@ LaunchContextBuilder::LaunchContextBuilder(CallableBase *kernel)
       arg_buffer_(std::make_unique<char[]>(kernel->args_size)),
       result_buffer_(std::make_unique<char[]>(kernel->ret_size)),
       ret_type_(kernel->ret_type),
+      parameter_layout_(kernel->get_parameter_layout()),
+      bindings_(parameter_layout_->slots.size()),
       arg_buffer_size(kernel->args_size),
       args_type(kernel->args_type),
       result_buffer_size(kernel->ret_size) {
@@ -97,6 +99,20 @@ void LaunchContextBuilder::set_ndarray_ptrs(const std::vector<int> &arg_id,
   }
 }
 
+void LaunchContextBuilder::set_ndarray_ptrs(int slot,
+                                            uint64 data_ptr,
+                                            uint64 grad_ptr) {
+  const auto &param_slot = parameter_layout_->slots[slot];
+  if (param_slot.data_ptr_offset < 0) {
+    set_ndarray_ptrs(param_slot.indices, data_ptr, grad_ptr);
+    return;
+  }
+  *(uint64 *)(ctx_->arg_buffer + param_slot.data_ptr_offset) = data_ptr;
+  if (param_slot.grad_ptr_offset >= 0) {
+    *(uint64 *)(ctx_->arg_buffer + param_slot.grad_ptr_offset) = grad_ptr;
+  }
+}
+
 void LaunchContextBuilder::set_argpack_ptr(const std::vector<int> &arg_id,
                                            uint64 data_ptr) {
   auto param_indices = arg_id;
@@ -104,6 +120,15 @@ void LaunchContextBuilder::set_argpack_ptr(const std::vector<int> &arg_id,
   set_struct_arg(param_indices, data_ptr);
 }
 
+void LaunchContextBuilder::set_argpack_ptr(int slot, uint64 data_ptr) {
+  const auto &param_slot = parameter_layout_->slots[slot];
+  if (param_slot.data_ptr_offset < 0) {
+    set_argpack_ptr(param_slot.indices, data_ptr);
+    return;
+  }
+  *(uint64 *)(ctx_->arg_buffer + param_slot.data_ptr_offset) = data_ptr;
+}
+
 template void LaunchContextBuilder::set_struct_arg(std::vector<int> arg_indices,
                                                    uint64 v);
 template void LaunchContextBuilder::set_struct_arg(std::vector<int> arg_indices,
@@ -208,13 +233,40 @@ PER_C_TYPE(gen, void *)  // Register void* as a valid type
 
 void LaunchContextBuilder::set_array_runtime_size(const std::vector<int> &i,
                                                   uint64 size) {
-  array_runtime_sizes[i] = size;
+  get_binding(i).runtime_size = size;
 }
 
 void LaunchContextBuilder::set_array_device_allocation_type(
     const std::vector<int> &i,
     DevAllocType usage) {
-  device_allocation_type[i] = usage;
+  auto slot = parameter_layout_->find_slot(i);
+  if (slot < 0 && usage == DevAllocType::kNone) {
+    // Members of struct arguments are not parameters of their own.
+    return;
+  }
+  TI_ASSERT_INFO(slot >= 0, "Argument {} is not a parameter of {}",
+                 fmt::join(i, ","), kernel_->name);
+  bindings_[slot].device_allocation_type = usage;
+}
+
+LaunchContextBuilder::ArgBinding &LaunchContextBuilder::get_binding(
+    const std::vector<int> &arg_id) {
+  auto slot = parameter_layout_->find_slot(arg_id);
+  TI_ASSERT_INFO(slot >= 0, "Argument {} is not a parameter of {}",
+                 fmt::join(arg_id, ","), kernel_->name);
+  return bindings_[slot];
+}
+
+void LaunchContextBuilder::set_shape(int slot,
+                                     const std::vector<int> &arg_id,
+                                     int dim,
+                                     int32 v) {
+  const auto &shape_offsets = parameter_layout_->slots[slot].shape_offsets;
+  if (dim < shape_offsets.size()) {
+    *(int32 *)(ctx_->arg_buffer + shape_offsets[dim]) = v;
+  } else {
+    set_struct_arg(concatenate_vector<int>(arg_id, {0, dim}), v);
+  }
 }
 
 void LaunchContextBuilder::set_arg_external_array_with_shape(
@@ -229,15 +281,15 @@ void LaunchContextBuilder::set_arg_external_array_with_shape(
 
   TI_ASSERT_INFO(shape.size() <= taichi_max_num_indices,
                  "External array cannot have > {max_num_indices} indices");
-  array_ptrs[concatenate_vector<int>(
-      arg_id, {TypeFactory::DATA_PTR_POS_IN_NDARRAY})] = (void *)ptr;
-  array_ptrs[concatenate_vector<int>(
-      arg_id, {TypeFactory::GRAD_PTR_POS_IN_NDARRAY})] = (void *)grad_ptr;
-  set_array_runtime_size(arg_id, size);
-  set_array_device_allocation_type(arg_id, DevAllocType::kNone);
-  for (uint64 i = 0; i < shape.size(); ++i) {
-    set_struct_arg(concatenate_vector<int>(arg_id, {0, (int32)i}),
-                   (int32)shape[i]);
+  auto slot = parameter_layout_->find_slot(arg_id);
+  TI_ASSERT(slot >= 0);
+  auto &binding = bindings_[slot];
+  binding.data_ptr = (void *)ptr;
+  binding.grad_ptr = (void *)grad_ptr;
+  binding.runtime_size = size;
+  binding.device_allocation_type = DevAllocType::kNone;
+  for (int i = 0; i < shape.size(); ++i) {
+    set_shape(slot, arg_id, i, (int32)shape[i]);
   }
 }
 
@@ -251,13 +303,14 @@ void LaunchContextBuilder::set_arg_ndarray(const std::vector<int> &arg_id,
 
 void LaunchContextBuilder::set_arg_argpack(const std::vector<int> &arg_id,
                                            const ArgPack &argpack) {
-  argpack_ptrs[arg_id] = &argpack;
+  auto slot = parameter_layout_->find_slot(arg_id);
+  TI_ASSERT(slot >= 0);
+  bindings_[slot].argpack = &argpack;
   if (arg_id.size() == 1) {
     // Only set ptr to arg buffer if this argpack is not nested
-    set_argpack_ptr(arg_id, argpack.get_device_allocation_ptr_as_int());
+    set_argpack_ptr(slot, argpack.get_device_allocation_ptr_as_int());
   }
-  // TODO: Consider renaming this method to `set_device_allocation_type`
-  set_array_device_allocation_type(arg_id, DevAllocType::kArgPack);
+  bindings_[slot].device_allocation_type = DevAllocType::kArgPack;
 }
 
 void LaunchContextBuilder::set_arg_ndarray_with_grad(
@@ -289,19 +342,22 @@ RuntimeContext &LaunchContextBuilder::get_context() {
 
 void LaunchContextBuilder::set_arg_texture_impl(const std::vector<int> &arg_id,
                                                 intptr_t alloc_ptr) {
-  array_ptrs[arg_id] = (void *)alloc_ptr;
-  set_array_device_allocation_type(arg_id, DevAllocType::kTexture);
+  auto &binding = get_binding(arg_id);
+  binding.data_ptr = (void *)alloc_ptr;
+  binding.device_allocation_type = DevAllocType::kTexture;
 }
 
 void LaunchContextBuilder::set_arg_rw_texture_impl(
     const std::vector<int> &arg_id,
     intptr_t alloc_ptr,
     const std::array<int, 3> &shape) {
-  array_ptrs[arg_id] = (void *)alloc_ptr;
-  set_array_device_allocation_type(arg_id, DevAllocType::kRWTexture);
+  auto slot = parameter_layout_->find_slot(arg_id);
+  TI_ASSERT(slot >= 0);
+  bindings_[slot].data_ptr = (void *)alloc_ptr;
+  bindings_[slot].device_allocation_type = DevAllocType::kRWTexture;
   TI_ASSERT(shape.size() <= taichi_max_num_indices);
   for (int i = 0; i < shape.size(); ++i) {
-    set_struct_arg(concatenate_vector<int>(arg_id, {0, i}), shape[i]);
+    set_shape(slot, arg_id, i, shape[i]);
   }
 }
 
@@ -309,24 +365,23 @@ void LaunchContextBuilder::set_arg_ndarray_impl(const std::vector<int> &arg_id,
                                                 intptr_t devalloc_ptr,
                                                 const std::vector<int> &shape,
                                                 intptr_t devalloc_ptr_grad) {
+  auto slot = parameter_layout_->find_slot(arg_id);
+  TI_ASSERT(slot >= 0);
+  auto &binding = bindings_[slot];
   // Set array ptr
-  array_ptrs[concatenate_vector<int>(
-      arg_id, {TypeFactory::DATA_PTR_POS_IN_NDARRAY})] = (void *)devalloc_ptr;
+  binding.data_ptr = (void *)devalloc_ptr;
   if (devalloc_ptr != 0) {
-    array_ptrs[concatenate_vector<int>(
-        arg_id, {TypeFactory::GRAD_PTR_POS_IN_NDARRAY})] =
-        (void *)devalloc_ptr_grad;
+    binding.grad_ptr = (void *)devalloc_ptr_grad;
   }
   // Set device allocation type and runtime size
-  set_array_device_allocation_type(arg_id, DevAllocType::kNdarray);
+  binding.device_allocation_type = DevAllocType::kNdarray;
   TI_ASSERT(shape.size() <= taichi_max_num_indices);
   size_t total_size = 1;
   for (int i = 0; i < shape.size(); i++) {
-    set_struct_arg(concatenate_vector<int>(arg_id, {0, (int32)i}),
-                   (int32)shape[i]);
+    set_shape(slot, arg_id, i, (int32)shape[i]);
     total_size *= shape[i];
   }
-  set_array_runtime_size(arg_id, total_size);
+  binding.runtime_size = total_size;
 }
 
 void LaunchContextBuilder::set_arg_matrix(int arg_id, const Matrix &matrix) {
@@ -19,6 +19,19 @@ class LaunchContextBuilder {
     kArgPack = 4,
   };
 
+  // Per-parameter state of a launch, indexed by the slots of the kernel's
+  // CallableBase::ParameterLayout.
+  struct ArgBinding {
+    // Host pointers of external arrays, or DeviceAllocation pointers of
+    // ndarrays and textures.
+    void *data_ptr{nullptr};
+    void *grad_ptr{nullptr};
+    uint64 runtime_size{0};
+    const ArgPack *argpack{nullptr};
+    // Set iff the parameter is bound to a `DeviceAllocation*`.
+    DevAllocType device_allocation_type{DevAllocType::kNone};
+  };
+
   explicit LaunchContextBuilder(CallableBase *kernel);
 
   LaunchContextBuilder(LaunchContextBuilder &&) = default;
@@ -54,7 +67,9 @@ class LaunchContextBuilder {
   void set_ndarray_ptrs(const std::vector<int> &arg_id,
                         uint64 data_ptr,
                         uint64 grad_ptr);
+  void set_ndarray_ptrs(int slot, uint64 data_ptr, uint64 grad_ptr);
   void set_argpack_ptr(const std::vector<int> &arg_id, uint64 data_ptr);
+  void set_argpack_ptr(int slot, uint64 data_ptr);
 
   template <typename T>
   T get_arg(const std::vector<int> &i);
@@ -97,7 +112,19 @@ class LaunchContextBuilder {
 
   RuntimeContext &get_context();
 
+  const CallableBase::ParameterLayout &get_parameter_layout() const {
+    return *parameter_layout_;
+  }
+
+  ArgBinding &get_binding(int slot) {
+    return bindings_[slot];
+  }
+
+  ArgBinding &get_binding(const std::vector<int> &arg_id);
+
  private:
+  void set_shape(int slot, const std::vector<int> &arg_id, int dim, int32 v);
+
   TypedConstant fetch_ret_impl(int offset, const Type *dt);
   CallableBase *kernel_;
   std::unique_ptr<RuntimeContext> owned_ctx_;
@@ -109,35 +136,13 @@ class LaunchContextBuilder {
   std::unique_ptr<char[]> arg_buffer_;
   std::unique_ptr<char[]> result_buffer_;
   const StructType *ret_type_;
+  std::shared_ptr<const CallableBase::ParameterLayout> parameter_layout_;
+  std::vector<ArgBinding> bindings_;
 
  public:
   size_t arg_buffer_size{0};
   const StructType *args_type{nullptr};
   size_t result_buffer_size{0};
-
-  // Note that I've tried to group `array_runtime_size` and
-  // `is_device_allocations` into a small struct. However, it caused some test
-  // cases to stuck.
-
-  // `array_runtime_size` records the runtime size of the
-  // corresponding array arguments.
-  std::
-      unordered_map<std::vector<int>, uint64, hashing::Hasher<std::vector<int>>>
-          array_runtime_sizes;
-  // `device_allocation_type` is set iff i-th arg is a `DeviceAllocation*`,
-  // otherwise it is set to DevAllocType::kNone
-  std::unordered_map<std::vector<int>,
-                     DevAllocType,
-                     hashing::Hasher<std::vector<int>>>
-      device_allocation_type;
-
-  std::
-      unordered_map<std::vector<int>, void *, hashing::Hasher<std::vector<int>>>
-          array_ptrs;
-  std::unordered_map<std::vector<int>,
-                     const ArgPack *,
-                     hashing::Hasher<std::vector<int>>>
-      argpack_ptrs;
 };
 
 }  // namespace taichi::lang
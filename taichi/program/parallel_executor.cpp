@@ -112,7 +112,9 @@ void ParallelExecutor::worker_loop() {
     }
     if (notify_flush_cv) {
       // It is fine to notify |flush_cv_| while nobody is waiting on it.
-      flush_cv_.notify_one();
+      // Several threads may be flushing, e.g. the ones compiling different
+      // kernels concurrently, so wake all of them.
+      flush_cv_.notify_all();
     }
   }
 }
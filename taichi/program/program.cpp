@@ -187,6 +187,27 @@ const CompiledKernelData &Program::compile_kernel(
   return ckd;
 }
 
+std::vector<const CompiledKernelData *> Program::compile_kernels(
+    const CompileConfig &compile_config,
+    const DeviceCapabilityConfig &caps,
+    const std::vector<Kernel *> &kernels) {
+  auto start_t = Time::get_time();
+  TI_AUTO_PROF;
+  auto &mgr = program_impl_->get_kernel_compilation_manager();
+  std::vector<KernelCompilationManager::CompiledKernelFuture> futures;
+  futures.reserve(kernels.size());
+  for (const auto *kernel : kernels) {
+    futures.push_back(mgr.load_or_compile_async(compile_config, caps, *kernel));
+  }
+  std::vector<const CompiledKernelData *> compiled;
+  compiled.reserve(kernels.size());
+  for (auto &future : futures) {
+    compiled.push_back(future.get());
+  }
+  total_compilation_time_ += Time::get_time() - start_t;
+  return compiled;
+}
+
 void Program::launch_kernel(const CompiledKernelData &compiled_kernel_data,
                             LaunchContextBuilder &ctx) {
   program_impl_->get_kernel_launcher().launch_kernel(compiled_kernel_data, ctx);
@@ -368,6 +389,16 @@ void Program::print_memory_profiler_info() {
   program_impl_->print_memory_profiler_info(snode_trees_, result_buffer);
 }
 
+HostCachingAllocator::Stats Program::get_caching_allocator_stats() {
+  return program_impl_->get_caching_allocator_stats();
+}
+
+void Program::run_host_tasks(int num_tasks,
+                             void *context,
+                             RangeForTaskFunc *func) {
+  program_impl_->run_host_tasks(num_tasks, context, func);
+}
+
 std::size_t Program::get_snode_num_dynamically_allocated(SNode *snode) {
   return program_impl_->get_snode_num_dynamically_allocated(snode,
                                                             result_buffer);
@@ -78,12 +78,18 @@ class TI_DLL_EXPORT Program {
     double min{0.0};
     double max{0.0};
     double avg{0.0};
+    // CPU thread pool metrics, see KernelProfilerBase::query()
+    double num_blocks{0.0};
+    double load_imbalance{0.0};
+    std::vector<double> thread_busy_time;
   };
 
   KernelProfilerQueryResult query_kernel_profile_info(const std::string &name) {
     KernelProfilerQueryResult query_result;
     profiler->query(name, query_result.counter, query_result.min,
-                    query_result.max, query_result.avg);
+                    query_result.max, query_result.avg,
+                    query_result.num_blocks, query_result.load_imbalance,
+                    query_result.thread_busy_time);
     return query_result;
   }
 
@@ -130,6 +136,14 @@ class TI_DLL_EXPORT Program {
                                            const DeviceCapabilityConfig &caps,
                                            const Kernel &kernel_def);
 
+  // Compiles |kernels| concurrently on CompileConfig::num_compile_threads
+  // threads, e.g. to warm up before the first launches. The results are in
+  // the order of |kernels|.
+  std::vector<const CompiledKernelData *> compile_kernels(
+      const CompileConfig &compile_config,
+      const DeviceCapabilityConfig &caps,
+      const std::vector<Kernel *> &kernels);
+
   void launch_kernel(const CompiledKernelData &compiled_kernel_data,
                      LaunchContextBuilder &ctx);
 
@@ -173,6 +187,12 @@ class TI_DLL_EXPORT Program {
   // Returns zero if the SNode is statically allocated
   std::size_t get_snode_num_dynamically_allocated(SNode *snode);
 
+  HostCachingAllocator::Stats get_caching_allocator_stats();
+
+  // Runs |func| for the tasks [0, num_tasks) on the host threads of the
+  // backend, e.g. the CPU thread pool.
+  void run_host_tasks(int num_tasks, void *context, RangeForTaskFunc *func);
+
   inline SNodeFieldMap *get_snode_to_fields() {
     return &snode_to_fields_;
   }
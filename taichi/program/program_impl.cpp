@@ -25,7 +25,20 @@ KernelCompilationManager &ProgramImpl::get_kernel_compilation_manager() {
   }
   KernelCompilationManager::Config cfg;
   cfg.offline_cache_path = config->offline_cache_file_path;
+  TI_ERROR_IF(config->offline_cache_format != "pack" &&
+                  config->offline_cache_format != "files",
+              "Unknown offline_cache_format \"{}\", expected \"files\" or "
+              "\"pack\"",
+              config->offline_cache_format);
+  cfg.pack_offline_cache = config->offline_cache_format == "pack";
+  cfg.compress_offline_cache = config->offline_cache_compression;
+  cfg.dedup_offline_cache = config->offline_cache_dedup;
   cfg.kernel_compiler = make_kernel_compiler();
+  // Only the LLVM kernel compiler is safe to run on several kernels at once.
+  // Printing the IR needs the kernels compiled one by one.
+  if (arch_uses_llvm(config->arch) && !config->print_ir) {
+    cfg.num_compile_threads = config->num_compile_threads;
+  }
   kernel_com_mgr_ = std::make_unique<KernelCompilationManager>(std::move(cfg));
   return *kernel_com_mgr_;
 }
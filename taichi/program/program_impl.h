@@ -8,6 +8,8 @@
 #include "taichi/program/kernel_profiler.h"
 #include "taichi/program/kernel_launcher.h"
 #include "taichi/rhi/device.h"
+#include "taichi/rhi/common/host_caching_allocator.h"
+#include "taichi/system/threading.h"
 #include "taichi/aot/graph_data.h"
 #include "taichi/codegen/kernel_compiler.h"
 #include "taichi/compilation_manager/kernel_compilation_manager.h"
@@ -138,6 +140,22 @@ class ProgramImpl {
         "print_memory_profiler_info() not implemented on the current backend");
   }
 
+  virtual HostCachingAllocator::Stats get_caching_allocator_stats() {
+    TI_ERROR(
+        "get_caching_allocator_stats() not implemented on the current "
+        "backend");
+  }
+
+  // Runs |func| for the tasks [0, num_tasks) on the host threads of the
+  // backend. Backends without host threads run them on the calling thread.
+  virtual void run_host_tasks(int num_tasks,
+                              void *context,
+                              RangeForTaskFunc *func) {
+    for (int i = 0; i < num_tasks; i++) {
+      func(context, /*thread_id=*/0, i);
+    }
+  }
+
   virtual void check_runtime_error(uint64 *result_buffer) {
     TI_ERROR("check_runtime_error() not implemented on the current backend");
   }
@@ -1,5 +1,7 @@
 #include "taichi/program/sparse_matrix.h"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -75,6 +77,131 @@ T2 get_element_from_csr(int row,
   return 0;
 }
 
+// A product of a compressed sparse matrix and a dense vector, split into
+// |num_tasks| tasks.
+template <typename Scalar, typename Index>
+struct SpmvContext {
+  const Index *outer{nullptr};
+  const Index *inner{nullptr};
+  const Scalar *values{nullptr};
+  const Scalar *x{nullptr};
+  Scalar *y{nullptr};
+  // One result vector per task for column-major matrices
+  Scalar *partial{nullptr};
+  int64_t outer_size{0};
+  int64_t rows{0};
+  int num_tasks{1};
+};
+
+constexpr int64_t kSpmvMinTaskNonzeros = 1 << 16;
+
+// Returns the first outer index of |task|, so that every task covers about the
+// same number of nonzeros.
+template <typename Scalar, typename Index>
+int64_t spmv_task_begin(const SpmvContext<Scalar, Index> &ctx, int task) {
+  if (task == ctx.num_tasks) {
+    return ctx.outer_size;
+  }
+  int64_t nnz = ctx.outer[ctx.outer_size];
+  Index target = nnz * task / ctx.num_tasks;
+  return std::lower_bound(ctx.outer, ctx.outer + ctx.outer_size, target) -
+         ctx.outer;
+}
+
+template <typename Scalar, typename Index>
+void spmv_rows_task(void *context, int thread_id, int task) {
+  auto &ctx = *(SpmvContext<Scalar, Index> *)context;
+  auto *inner = ctx.inner;
+  auto *values = ctx.values;
+  auto *x = ctx.x;
+  for (int64_t row = spmv_task_begin(ctx, task),
+               end = spmv_task_begin(ctx, task + 1);
+       row < end; row++) {
+    // Four independent partial sums break the dependency chain of the
+    // reduction, so that they are kept in SIMD lanes.
+    Scalar sum[4] = {0, 0, 0, 0};
+    Index k = ctx.outer[row];
+    Index k_end = ctx.outer[row + 1];
+    for (; k + 4 <= k_end; k += 4) {
+      sum[0] += values[k] * x[inner[k]];
+      sum[1] += values[k + 1] * x[inner[k + 1]];
+      sum[2] += values[k + 2] * x[inner[k + 2]];
+      sum[3] += values[k + 3] * x[inner[k + 3]];
+    }
+    for (; k < k_end; k++) {
+      sum[0] += values[k] * x[inner[k]];
+    }
+    ctx.y[row] = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+  }
+}
+
+template <typename Scalar, typename Index>
+void spmv_columns_task(void *context, int thread_id, int task) {
+  auto &ctx = *(SpmvContext<Scalar, Index> *)context;
+  auto *y = ctx.num_tasks > 1 ? ctx.partial + task * ctx.rows : ctx.y;
+  std::fill(y, y + ctx.rows, Scalar(0));
+  for (int64_t col = spmv_task_begin(ctx, task),
+               end = spmv_task_begin(ctx, task + 1);
+       col < end; col++) {
+    Scalar x = ctx.x[col];
+    for (Index k = ctx.outer[col]; k < ctx.outer[col + 1]; k++) {
+      y[ctx.inner[k]] += ctx.values[k] * x;
+    }
+  }
+}
+
+template <typename Scalar, typename Index>
+void spmv_sum_partial_task(void *context, int thread_id, int task) {
+  auto &ctx = *(SpmvContext<Scalar, Index> *)context;
+  int64_t begin = ctx.rows * task / ctx.num_tasks;
+  int64_t end = ctx.rows * (task + 1) / ctx.num_tasks;
+  for (int64_t row = begin; row < end; row++) {
+    Scalar sum = 0;
+    for (int t = 0; t < ctx.num_tasks; t++) {
+      sum += ctx.partial[t * ctx.rows + row];
+    }
+    ctx.y[row] = sum;
+  }
+}
+
+template <typename Scalar, typename Index>
+void run_spmv_tasks(taichi::lang::Program *prog,
+                    SpmvContext<Scalar, Index> &ctx,
+                    taichi::RangeForTaskFunc *func) {
+  if (ctx.num_tasks == 1) {
+    func(&ctx, /*thread_id=*/0, /*task=*/0);
+  } else {
+    prog->run_host_tasks(ctx.num_tasks, &ctx, func);
+  }
+}
+
+// Runs |func(begin, end)| over [0, n) split into tasks on the host threads of
+// |prog|, at most one task per thread. Ranges too small to amortize the
+// dispatch run on the calling thread.
+template <typename Func>
+void run_host_chunks(taichi::lang::Program *prog, int64_t n, const Func &func) {
+  constexpr int64_t kMinChunkSize = 1 << 15;
+  struct ChunkContext {
+    const Func *func;
+    int64_t n;
+    int num_tasks;
+  };
+  ChunkContext ctx{&func, n,
+                   (int)std::clamp<int64_t>(
+                       n / kMinChunkSize, 1,
+                       prog->compile_config().cpu_max_num_threads)};
+  if (ctx.num_tasks == 1) {
+    func(int64_t(0), n);
+    return;
+  }
+  prog->run_host_tasks(ctx.num_tasks, &ctx,
+                       [](void *context, int thread_id, int task) {
+                         auto &ctx = *(ChunkContext *)context;
+                         (*ctx.func)(ctx.n * task / ctx.num_tasks,
+                                     ctx.n * (task + 1) / ctx.num_tasks);
+                       });
+}
+
 }  // namespace
 
 namespace taichi::lang {
@@ -159,18 +286,104 @@ intptr_t SparseMatrixBuilder::get_ndarray_data_ptr() const {
 }
 
 template <typename T, typename G>
-void SparseMatrixBuilder::build_template(std::unique_ptr<SparseMatrix> &m) {
+void build_from_triplet_data(SparseMatrix &sm,
+                             const G *data,
+                             uint64 num_triplets) {
   using V = Eigen::Triplet<T>;
   std::vector<V> triplets;
+  triplets.reserve(num_triplets);
+  for (int i = 0; i < num_triplets; i++) {
+    triplets.push_back(
+        V(data[i * 3], data[i * 3 + 1], taichi_union_cast<T>(data[i * 3 + 2])));
+  }
+  sm.build_triplets(static_cast<void *>(&triplets));
+}
+
+template <typename T, typename G>
+void SparseMatrixBuilder::build_template(std::unique_ptr<SparseMatrix> &m) {
   auto ptr = get_ndarray_data_ptr();
   G *data = reinterpret_cast<G *>(ptr);
   num_triplets_ = data[0];
   data += 1;
-  for (int i = 0; i < num_triplets_; i++) {
-    triplets.push_back(
-        V(data[i * 3], data[i * 3 + 1], taichi_union_cast<T>(data[i * 3 + 2])));
+  build_from_triplet_data<T>(*m, data, num_triplets_);
+  clear();
+}
+
+template <typename G>
+bool SparseMatrixBuilder::plan_refill(const SparseMatrix &sm, const G *data) {
+  refill_pattern_id_ = 0;
+  if (sm.get_pattern_id() == 0) {
+    return false;
+  }
+  auto num_slots = sm.num_nonzeros();
+  std::vector<int64> slots(num_triplets_);
+  refill_keys_.resize(num_triplets_);
+  refill_slot_offsets_.assign(num_slots + 1, 0);
+  for (int64 i = 0; i < num_triplets_; i++) {
+    int row = data[i * 3];
+    int col = data[i * 3 + 1];
+    slots[i] = sm.find_value_slot(row, col);
+    if (slots[i] < 0) {
+      return false;
+    }
+    refill_keys_[i] = (int64)row * cols_ + col;
+    refill_slot_offsets_[slots[i] + 1]++;
+  }
+  for (int64 s = 0; s < num_slots; s++) {
+    refill_slot_offsets_[s + 1] += refill_slot_offsets_[s];
+  }
+  // Counting sort keeps the triplets of each slot in order, so duplicates are
+  // summed in the same order as setFromTriplets() does.
+  std::vector<int64> cursors(refill_slot_offsets_.begin(),
+                             refill_slot_offsets_.end() - 1);
+  refill_slot_triplets_.resize(num_triplets_);
+  for (int64 i = 0; i < num_triplets_; i++) {
+    refill_slot_triplets_[cursors[slots[i]]++] = i;
   }
-  m->build_triplets(static_cast<void *>(&triplets));
+  refill_pattern_id_ = sm.get_pattern_id();
+  return true;
+}
+
+template <typename T, typename G>
+void SparseMatrixBuilder::refill_template(Program *prog, SparseMatrix &sm) {
+  auto ptr = get_ndarray_data_ptr();
+  G *data = reinterpret_cast<G *>(ptr);
+  num_triplets_ = data[0];
+  data += 1;
+  bool same_pattern = refill_pattern_id_ != 0 &&
+                      refill_pattern_id_ == sm.get_pattern_id() &&
+                      refill_keys_.size() == num_triplets_;
+  if (same_pattern) {
+    std::atomic<bool> changed{false};
+    run_host_chunks(prog, num_triplets_, [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; i++) {
+        if ((int64)data[i * 3] * cols_ + data[i * 3 + 1] != refill_keys_[i]) {
+          changed = true;
+          return;
+        }
+      }
+    });
+    same_pattern = !changed;
+  }
+  if (!same_pattern && !plan_refill(sm, data)) {
+    // Some triplet falls outside the pattern of |sm|; rebuild it.
+    build_from_triplet_data<T>(sm, data, num_triplets_);
+    bool planned = plan_refill(sm, data);
+    TI_ASSERT(planned);
+  }
+  // Every value slot gathers its own triplets, so the threads never write to
+  // the same slot and slots without triplets are reset to zero.
+  T *values = static_cast<T *>(sm.get_values_ptr());
+  run_host_chunks(prog, sm.num_nonzeros(), [&](int64 begin, int64 end) {
+    for (int64 s = begin; s < end; s++) {
+      T sum = 0;
+      for (int64 k = refill_slot_offsets_[s]; k < refill_slot_offsets_[s + 1];
+           k++) {
+        sum += taichi_union_cast<T>(data[refill_slot_triplets_[k] * 3 + 2]);
+      }
+      values[s] = sum;
+    }
+  });
   clear();
 }
 
@@ -193,6 +406,29 @@ std::unique_ptr<SparseMatrix> SparseMatrixBuilder::build() {
   return sm;
 }
 
+void SparseMatrixBuilder::refill(Program *prog, SparseMatrix &sm) {
+  TI_ASSERT(built_ == false);
+  if (sm.get_data_type() != dtype_ || sm.num_rows() != rows_ ||
+      sm.num_cols() != cols_) {
+    TI_ERROR("Cannot refill a {}x{} {} sparse matrix from a {}x{} {} builder",
+             sm.num_rows(), sm.num_cols(), data_type_name(sm.get_data_type()),
+             rows_, cols_, data_type_name(dtype_));
+  }
+  built_ = true;
+  auto element_size = data_type_size(dtype_);
+  switch (element_size) {
+    case 4:
+      refill_template<float32, int32>(prog, sm);
+      break;
+    case 8:
+      refill_template<float64, int64>(prog, sm);
+      break;
+    default:
+      TI_ERROR("Unsupported sparse matrix data type!");
+      break;
+  }
+}
+
 std::unique_ptr<SparseMatrix> SparseMatrixBuilder::build_cuda() {
   TI_ASSERT(built_ == false);
   built_ = true;
@@ -256,6 +492,29 @@ void SparseMatrixBuilder::clear() {
   num_triplets_ = 0;
 }
 
+int64 SparseMatrix::new_pattern_id() {
+  static std::atomic<int64> next_id{1};
+  return next_id++;
+}
+
+template <class EigenMatrix>
+int64 EigenSparseMatrix<EigenMatrix>::find_value_slot(int row, int col) const {
+  if (!matrix_.isCompressed() || row < 0 || row >= rows_ || col < 0 ||
+      col >= cols_) {
+    return -1;
+  }
+  int outer = EigenMatrix::IsRowMajor ? row : col;
+  int inner = EigenMatrix::IsRowMajor ? col : row;
+  auto *inner_indices = matrix_.innerIndexPtr();
+  auto *begin = inner_indices + matrix_.outerIndexPtr()[outer];
+  auto *end = inner_indices + matrix_.outerIndexPtr()[outer + 1];
+  auto *it = std::lower_bound(begin, end, inner);
+  if (it == end || *it != inner) {
+    return -1;
+  }
+  return it - inner_indices;
+}
+
 template <class EigenMatrix>
 const std::string EigenSparseMatrix<EigenMatrix>::to_string() const {
   Eigen::IOFormat clean_fmt(4, 0, ", ", "\n", "[", "]");
@@ -291,25 +550,55 @@ void EigenSparseMatrix<EigenMatrix>::build_triplets(void *triplets_adr) {
   } else {
     TI_ERROR("Unsupported sparse matrix data type {}!", sdtype);
   }
+  pattern_id_ = new_pattern_id();
 }
 
 template <class EigenMatrix>
 void EigenSparseMatrix<EigenMatrix>::spmv(Program *prog,
                                           const Ndarray &x,
                                           const Ndarray &y) {
-  size_t dX = prog->get_ndarray_data_ptr_as_int(&x);
-  size_t dY = prog->get_ndarray_data_ptr_as_int(&y);
-  std::string sdtype = taichi::lang::data_type_name(dtype_);
-  if (sdtype == "f32") {
-    Eigen::Map<Eigen::VectorXf>((float *)dY, rows_) =
-        matrix_.template cast<float>() *
-        Eigen::Map<Eigen::VectorXf>((float *)dX, cols_);
-  } else if (sdtype == "f64") {
-    Eigen::Map<Eigen::VectorXd>((double *)dY, rows_) =
-        matrix_.template cast<double>() *
-        Eigen::Map<Eigen::VectorXd>((double *)dX, cols_);
-  } else {
-    TI_ERROR("Unsupported sparse matrix data type {}!", sdtype);
+  if (x.dtype != dtype_ || y.dtype != dtype_) {
+    TI_ERROR("Sparse matrix of {} cannot multiply a vector of {}",
+             data_type_name(dtype_), data_type_name(x.dtype));
+  }
+  spmv_ptr(prog, (const void *)prog->get_ndarray_data_ptr_as_int(&x),
+           (void *)prog->get_ndarray_data_ptr_as_int(&y));
+}
+
+template <class EigenMatrix>
+void EigenSparseMatrix<EigenMatrix>::spmv_ptr(Program *prog,
+                                              const void *x,
+                                              void *y) {
+  using Scalar = typename EigenMatrix::Scalar;
+  using StorageIndex = typename EigenMatrix::StorageIndex;
+  matrix_.makeCompressed();
+  SpmvContext<Scalar, StorageIndex> ctx;
+  ctx.outer = matrix_.outerIndexPtr();
+  ctx.inner = matrix_.innerIndexPtr();
+  ctx.values = matrix_.valuePtr();
+  ctx.x = (const Scalar *)x;
+  ctx.y = (Scalar *)y;
+  ctx.outer_size = matrix_.outerSize();
+  ctx.rows = rows_;
+  // Tasks are balanced by nonzeros, and small products stay on the calling
+  // thread.
+  ctx.num_tasks = std::clamp<int64>(
+      matrix_.nonZeros() / kSpmvMinTaskNonzeros, 1,
+      prog->compile_config().cpu_max_num_threads);
+  if (EigenMatrix::IsRowMajor) {
+    run_spmv_tasks(prog, ctx, spmv_rows_task<Scalar, StorageIndex>);
+    return;
+  }
+  // A column-major matrix is scattered into one partial result per task,
+  // which are then summed row by row.
+  std::vector<Scalar> partial;
+  if (ctx.num_tasks > 1) {
+    partial.resize(ctx.num_tasks * rows_);
+    ctx.partial = partial.data();
+  }
+  run_spmv_tasks(prog, ctx, spmv_columns_task<Scalar, StorageIndex>);
+  if (ctx.num_tasks > 1) {
+    run_spmv_tasks(prog, ctx, spmv_sum_partial_task<Scalar, StorageIndex>);
   }
 }
 
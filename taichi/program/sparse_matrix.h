@@ -35,12 +35,26 @@ class SparseMatrixBuilder {
 
   std::unique_ptr<SparseMatrix> build_cuda();
 
+  // Refills |sm| with the current triplets. If every triplet hits an entry
+  // stored in |sm|, the values are summed straight into its compressed storage
+  // and its pattern id is kept, so that solvers skip analyze_pattern().
+  // Otherwise |sm| is rebuilt from scratch. Where each triplet goes is cached
+  // until the (row, col) sequence of the triplets changes.
+  // The work is split over the host threads of |prog|.
+  void refill(Program *prog, SparseMatrix &sm);
+
   void clear();
 
  private:
   template <typename T, typename G>
   void build_template(std::unique_ptr<SparseMatrix> &);
 
+  template <typename T, typename G>
+  void refill_template(Program *prog, SparseMatrix &sm);
+
+  template <typename G>
+  bool plan_refill(const SparseMatrix &sm, const G *data);
+
   template <typename T, typename G>
   void print_triplets_template();
 
@@ -54,6 +68,13 @@ class SparseMatrixBuilder {
   bool built_{false};
   DataType dtype_{PrimitiveType::f32};
   std::string storage_format_{"col_major"};
+
+  // The refill plan: the pattern id of the matrix it targets, the (row, col)
+  // key of every triplet, and the triplets summed into each value slot.
+  int64 refill_pattern_id_{0};
+  std::vector<int64> refill_keys_;
+  std::vector<int64> refill_slot_offsets_;
+  std::vector<int64> refill_slot_triplets_;
 };
 
 class SparseMatrix {
@@ -62,10 +83,16 @@ class SparseMatrix {
   SparseMatrix(int rows, int cols, DataType dt = PrimitiveType::f32)
       : rows_{rows}, cols_(cols), dtype_(dt) {};
   SparseMatrix(SparseMatrix &sm)
-      : rows_(sm.rows_), cols_(sm.cols_), dtype_(sm.dtype_) {
+      : rows_(sm.rows_),
+        cols_(sm.cols_),
+        dtype_(sm.dtype_),
+        pattern_id_(sm.pattern_id_) {
   }
   SparseMatrix(SparseMatrix &&sm)
-      : rows_(sm.rows_), cols_(sm.cols_), dtype_(sm.dtype_) {
+      : rows_(sm.rows_),
+        cols_(sm.cols_),
+        dtype_(sm.dtype_),
+        pattern_id_(sm.pattern_id_) {
   }
   virtual ~SparseMatrix() = default;
 
@@ -99,6 +126,32 @@ class SparseMatrix {
     return dtype_;
   }
 
+  // Identifies the sparsity pattern. Matrices sharing a non-zero pattern id
+  // store the same nonzeros in the same order; 0 means unknown.
+  inline int64 get_pattern_id() const {
+    return pattern_id_;
+  }
+
+  // The values of the compressed storage, in storage order.
+  virtual void *get_values_ptr() {
+    TI_NOT_IMPLEMENTED;
+  }
+
+  // Returns the index of (row, col) in get_values_ptr(), or -1 if the entry is
+  // not stored.
+  virtual int64 find_value_slot(int row, int col) const {
+    TI_NOT_IMPLEMENTED;
+  }
+
+  virtual int64 num_nonzeros() const {
+    TI_NOT_IMPLEMENTED;
+  }
+
+  // y = A x, where |x| and |y| are host buffers of the matrix dtype.
+  virtual void spmv_ptr(Program *prog, const void *x, void *y) {
+    TI_NOT_IMPLEMENTED;
+  }
+
   template <class T>
   T get_element(int row, int col) {
     TI_NOT_IMPLEMENTED;
@@ -114,9 +167,12 @@ class SparseMatrix {
   }
 
  protected:
+  static int64 new_pattern_id();
+
   int rows_{0};
   int cols_{0};
   DataType dtype_{PrimitiveType::f32};
+  int64 pattern_id_{0};
 };
 
 template <class EigenMatrix>
@@ -128,13 +184,21 @@ class EigenSparseMatrix : public SparseMatrix {
   EigenSparseMatrix(EigenSparseMatrix &sm)
       : SparseMatrix(sm.num_rows(), sm.num_cols(), sm.dtype_),
         matrix_(sm.matrix_) {
+    pattern_id_ = sm.pattern_id_;
   }
   EigenSparseMatrix(EigenSparseMatrix &&sm)
       : SparseMatrix(sm.num_rows(), sm.num_cols(), sm.dtype_),
         matrix_(sm.matrix_) {
+    pattern_id_ = sm.pattern_id_;
   }
   explicit EigenSparseMatrix(const EigenMatrix &em)
-      : SparseMatrix(em.rows(), em.cols()), matrix_(em) {
+      : SparseMatrix(em.rows(),
+                     em.cols(),
+                     std::is_same_v<typename EigenMatrix::Scalar, float64>
+                         ? PrimitiveType::f64
+                         : PrimitiveType::f32),
+        matrix_(em) {
+    pattern_id_ = new_pattern_id();
   }
 
   ~EigenSparseMatrix() override = default;
@@ -153,8 +217,19 @@ class EigenSparseMatrix : public SparseMatrix {
     return &matrix_;
   };
 
+  void *get_values_ptr() override {
+    return matrix_.valuePtr();
+  }
+
+  int64 find_value_slot(int row, int col) const override;
+
+  int64 num_nonzeros() const override {
+    return matrix_.nonZeros();
+  }
+
   virtual EigenSparseMatrix &operator+=(const EigenSparseMatrix &other) {
     this->matrix_ += other.matrix_;
+    pattern_id_ = new_pattern_id();
     return *this;
   };
 
@@ -165,6 +240,7 @@ class EigenSparseMatrix : public SparseMatrix {
 
   virtual EigenSparseMatrix &operator-=(const EigenSparseMatrix &other) {
     this->matrix_ -= other.matrix_;
+    pattern_id_ = new_pattern_id();
     return *this;
   }
 
@@ -206,7 +282,11 @@ class EigenSparseMatrix : public SparseMatrix {
 
   template <typename T>
   void set_element(int row, int col, T value) {
+    auto nnz = matrix_.nonZeros();
     matrix_.coeffRef(row, col) = value;
+    if (matrix_.nonZeros() != nnz) {
+      pattern_id_ = new_pattern_id();
+    }
   }
 
   template <class VT>
@@ -216,6 +296,8 @@ class EigenSparseMatrix : public SparseMatrix {
 
   void spmv(Program *prog, const Ndarray &x, const Ndarray &y);
 
+  void spmv_ptr(Program *prog, const void *x, void *y) override;
+
  private:
   EigenMatrix matrix_;
 };
@@ -100,8 +100,8 @@ bool EigenSparseSolver<EigenSolver, EigenMatrix>::compute(
   if (!is_initialized_) {
     SparseSolver::init_solver(sm.num_rows(), sm.num_cols(), sm.get_data_type());
   }
-  GET_EM(sm);
-  solver_.compute(*mat);
+  analyze_pattern(sm);
+  factorize(sm);
   if (solver_.info() != Eigen::Success) {
     return false;
   } else
@@ -113,8 +113,13 @@ void EigenSparseSolver<EigenSolver, EigenMatrix>::analyze_pattern(
   if (!is_initialized_) {
     SparseSolver::init_solver(sm.num_rows(), sm.num_cols(), sm.get_data_type());
   }
+  if (sm.get_pattern_id() != 0 &&
+      sm.get_pattern_id() == analyzed_pattern_id_) {
+    return;
+  }
   GET_EM(sm);
   solver_.analyzePattern(*mat);
+  analyzed_pattern_id_ = sm.get_pattern_id();
 }
 
 template <class EigenSolver, class EigenMatrix>
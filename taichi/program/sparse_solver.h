@@ -45,6 +45,9 @@ template <class EigenSolver, class EigenMatrix>
 class EigenSparseSolver : public SparseSolver {
  private:
   EigenSolver solver_;
+  // Pattern id of the last analyzed matrix, whose analysis is reused by
+  // analyze_pattern() for matrices sharing it.
+  int64 analyzed_pattern_id_{0};
 
  public:
   ~EigenSparseSolver() override = default;
@@ -28,6 +28,7 @@
 #include "taichi/program/sparse_matrix.h"
 #include "taichi/program/sparse_solver.h"
 #include "taichi/program/conjugate_gradient.h"
+#include "taichi/program/iterative_solver.h"
 #include "taichi/aot/graph_data.h"
 #include "taichi/ir/mesh.h"
 
@@ -39,6 +40,7 @@
 
 namespace taichi {
 bool test_threading();
+bool test_work_stealing_threading();
 
 }  // namespace taichi
 
@@ -48,6 +50,111 @@ std::string libdevice_path();
 
 }  // namespace taichi::lang
 
+namespace taichi::lang {
+namespace {
+
+// Converts the Python values in |pyargs| into runtime values of |graph|. The
+// matrix arguments point into |matrix_buffers| and |matrices|. With
+// |only_present|, graph arguments missing from |pyargs| are skipped.
+std::unordered_map<std::string, aot::IValue> graph_args_from_pydict(
+    const aot::CompiledGraph &graph,
+    const py::dict &pyargs,
+    bool only_present,
+    std::vector<std::unique_ptr<char[]>> &matrix_buffers,
+    std::vector<Matrix> &matrices) {
+  std::unordered_map<std::string, aot::IValue> args;
+  auto insert_scalar_arg = [&args](std::string arg_name,
+                                   DataType expected_dtype,
+                                   py::object pyarg) {
+    auto type_id = expected_dtype->as<PrimitiveType>()->type;
+    switch (type_id) {
+#define PER_C_TYPE(type, ctype)                                           \
+  case PrimitiveTypeID::type:                                             \
+    args.insert({arg_name, aot::IValue::create(py::cast<ctype>(pyarg))}); \
+    break;
+#include "taichi/inc/data_type_with_c_type.inc.h"
+#undef PER_C_TYPE
+      default:
+        TI_ERROR("Unsupported scalar type {}", expected_dtype->to_string());
+    }
+  };
+
+  matrix_buffers.reserve(graph.args.size());
+  // Reserve to avoid changes in element addresses
+  matrices.reserve(graph.args.size());
+  for (const auto &[arg_name, arg] : graph.args) {
+    auto tag = arg.tag;
+    if (only_present && !pyargs.contains(arg_name.c_str())) {
+      continue;
+    }
+    TI_ASSERT(pyargs.contains(arg_name.c_str()));
+    auto pyarg = pyargs[arg_name.c_str()];
+    if (tag == aot::ArgKind::kNdarray) {
+      auto &val = pyarg.cast<Ndarray &>();
+      args.insert({arg_name, aot::IValue::create(val)});
+    } else if (tag == aot::ArgKind::kTexture ||
+               tag == aot::ArgKind::kRWTexture) {
+      auto &val = pyarg.cast<Texture &>();
+      args.insert({arg_name, aot::IValue::create(val)});
+    } else if (tag == aot::ArgKind::kScalar) {
+      auto expected_dtype = arg.dtype();
+      insert_scalar_arg(arg_name, expected_dtype, pyarg);
+    } else if (tag == aot::ArgKind::kMatrix) {
+      auto type_id = arg.dtype()->as<PrimitiveType>()->type;
+      switch (type_id) {
+        case PrimitiveTypeID::f16: {
+          auto arr = pyarg.cast<py::array_t<float32>>();
+          py::buffer_info buffer_info = arr.request();
+          auto length = buffer_info.size;
+          auto ptr = reinterpret_cast<intptr_t>(buffer_info.ptr);
+
+          std::unique_ptr<char[]> data(new char[128]);
+          for (uint32_t i = 0; i < length; i++) {
+            uint16 half = fp16_ieee_from_fp32_value(
+                reinterpret_cast<float32 *>(ptr)[i]);
+            reinterpret_cast<uint16 *>(data.get())[i] = half;
+          }
+          matrix_buffers.emplace_back(std::move(data));
+
+          matrices.emplace_back(Matrix(
+              length, arg.dtype(),
+              reinterpret_cast<intptr_t>(matrix_buffers.back().get())));
+          args.insert({arg_name, aot::IValue::create(matrices.back())});
+          break;
+        }
+#define PER_C_TYPE(type, ctype)                                           \
+  case PrimitiveTypeID::type: {                                           \
+    auto arr = pyarg.cast<py::array_t<ctype>>();                          \
+    py::buffer_info buffer_info = arr.request();                          \
+    auto length = buffer_info.size;                                       \
+    auto ptr = reinterpret_cast<intptr_t>(buffer_info.ptr);               \
+                                                                          \
+    std::unique_ptr<char[]> data(new char[128]);                          \
+    std::memcpy(data.get(), reinterpret_cast<char *>(ptr),                \
+                sizeof(ctype) * length);                                  \
+    matrix_buffers.emplace_back(std::move(data));                         \
+                                                                          \
+    matrices.emplace_back(                                                \
+        Matrix(length, arg.dtype(),                                       \
+               reinterpret_cast<intptr_t>(matrix_buffers.back().get()))); \
+    args.insert({arg_name, aot::IValue::create(matrices.back())});        \
+    break;                                                                \
+  }
+#include "taichi/inc/data_type_with_c_type.inc.h"
+#undef PER_C_TYPE
+        default:
+          TI_ERROR("Unsupported scalar type {}", arg.dtype()->to_string());
+      }
+    } else {
+      TI_NOT_IMPLEMENTED;
+    }
+  }
+  return args;
+}
+
+}  // namespace
+}  // namespace taichi::lang
+
 namespace taichi {
 void export_lang(py::module &m) {
   using namespace taichi::lang;
@@ -158,10 +265,13 @@ void export_lang(py::module &m) {
       .def(py::init<>())
       .def_readwrite("arch", &CompileConfig::arch)
       .def_readwrite("opt_level", &CompileConfig::opt_level)
+      .def_readwrite("simd_width", &CompileConfig::simd_width)
       .def_readwrite("print_ir", &CompileConfig::print_ir)
       .def_readwrite("print_preprocessed_ir",
                      &CompileConfig::print_preprocessed_ir)
       .def_readwrite("print_ir_dbg_info", &CompileConfig::print_ir_dbg_info)
+      .def_readwrite("print_full_simplify_stats",
+                     &CompileConfig::print_full_simplify_stats)
       .def_readwrite("debug", &CompileConfig::debug)
       .def_readwrite("cfg_optimization", &CompileConfig::cfg_optimization)
       .def_readwrite("check_out_of_bound", &CompileConfig::check_out_of_bound)
@@ -194,6 +304,13 @@ void export_lang(py::module &m) {
       .def_readwrite("saturating_grid_dim", &CompileConfig::saturating_grid_dim)
       .def_readwrite("max_block_dim", &CompileConfig::max_block_dim)
       .def_readwrite("cpu_max_num_threads", &CompileConfig::cpu_max_num_threads)
+      .def_readwrite("cpu_thread_pool", &CompileConfig::cpu_thread_pool)
+      .def_readwrite("cpu_loop_schedule", &CompileConfig::cpu_loop_schedule)
+      .def_readwrite("cpu_block_range_for",
+                     &CompileConfig::cpu_block_range_for)
+      .def_readwrite("cpu_huge_pages", &CompileConfig::cpu_huge_pages)
+      .def_readwrite("cpu_numa_first_touch",
+                     &CompileConfig::cpu_numa_first_touch)
       .def_readwrite("random_seed", &CompileConfig::random_seed)
       .def_readwrite("verbose_kernel_launches",
                      &CompileConfig::verbose_kernel_launches)
@@ -254,6 +371,12 @@ void export_lang(py::module &m) {
                      &CompileConfig::offline_cache_max_size_of_files)
       .def_readwrite("offline_cache_cleaning_factor",
                      &CompileConfig::offline_cache_cleaning_factor)
+      .def_readwrite("offline_cache_format",
+                     &CompileConfig::offline_cache_format)
+      .def_readwrite("offline_cache_compression",
+                     &CompileConfig::offline_cache_compression)
+      .def_readwrite("offline_cache_dedup",
+                     &CompileConfig::offline_cache_dedup)
       .def_readwrite("num_compile_threads", &CompileConfig::num_compile_threads)
       .def_readwrite("vk_api_version", &CompileConfig::vk_api_version)
       .def_readwrite("cuda_stack_limit", &CompileConfig::cuda_stack_limit);
@@ -270,7 +393,22 @@ void export_lang(py::module &m) {
       .def_readwrite("counter", &Program::KernelProfilerQueryResult::counter)
       .def_readwrite("min", &Program::KernelProfilerQueryResult::min)
       .def_readwrite("max", &Program::KernelProfilerQueryResult::max)
-      .def_readwrite("avg", &Program::KernelProfilerQueryResult::avg);
+      .def_readwrite("avg", &Program::KernelProfilerQueryResult::avg)
+      .def_readwrite("num_blocks",
+                     &Program::KernelProfilerQueryResult::num_blocks)
+      .def_readwrite("load_imbalance",
+                     &Program::KernelProfilerQueryResult::load_imbalance)
+      .def_readwrite("thread_busy_time",
+                     &Program::KernelProfilerQueryResult::thread_busy_time);
+
+  py::class_<HostCachingAllocator::Stats>(m, "HostCachingAllocatorStats")
+      .def_readonly("num_allocations",
+                    &HostCachingAllocator::Stats::num_allocations)
+      .def_readonly("num_cache_hits",
+                    &HostCachingAllocator::Stats::num_cache_hits)
+      .def_readonly("bytes_in_use", &HostCachingAllocator::Stats::bytes_in_use)
+      .def_readonly("bytes_cached", &HostCachingAllocator::Stats::bytes_cached)
+      .def_readonly("peak_bytes", &HostCachingAllocator::Stats::peak_bytes);
 
   py::class_<KernelProfileTracedRecord>(m, "KernelProfileTracedRecord")
       .def_readwrite("register_per_thread",
@@ -346,6 +484,7 @@ void export_lang(py::module &m) {
       .def("bit_vectorize", &ASTBuilder::bit_vectorize)
       .def("parallelize", &ASTBuilder::parallelize)
       .def("strictly_serialize", &ASTBuilder::strictly_serialize)
+      .def("cpu_schedule", &ASTBuilder::cpu_schedule)
       .def("block_dim", &ASTBuilder::block_dim)
       .def("insert_snode_access_flag", &ASTBuilder::insert_snode_access_flag)
       .def("reset_snode_access_flag", &ASTBuilder::reset_snode_access_flag);
@@ -398,6 +537,7 @@ void export_lang(py::module &m) {
       .def("get_total_compilation_time", &Program::get_total_compilation_time)
       .def("get_snode_num_dynamically_allocated",
            &Program::get_snode_num_dynamically_allocated)
+      .def("get_caching_allocator_stats", &Program::get_caching_allocator_stats)
       .def("synchronize", &Program::synchronize)
       .def("materialize_runtime", &Program::materialize_runtime)
       .def("make_aot_module_builder", &Program::make_aot_module_builder)
@@ -484,6 +624,9 @@ void export_lang(py::module &m) {
            [](Program *program) { return program->get_graphics_device(); })
       .def("compile_kernel", &Program::compile_kernel,
            py::return_value_policy::reference)
+      .def("compile_kernels", &Program::compile_kernels,
+           py::return_value_policy::reference,
+           py::call_guard<py::gil_scoped_release>())
       .def("launch_kernel", &Program::launch_kernel)
       .def("get_device_caps", &Program::get_device_caps);
 
@@ -665,95 +808,34 @@ void export_lang(py::module &m) {
       .def("jit_run", [](aot::CompiledGraph *self,
                          const CompileConfig &compile_config,
                          const py::dict &pyargs) {
-        std::unordered_map<std::string, aot::IValue> args;
-        auto insert_scalar_arg = [&args](std::string arg_name,
-                                         DataType expected_dtype,
-                                         py::object pyarg) {
-          auto type_id = expected_dtype->as<PrimitiveType>()->type;
-          switch (type_id) {
-#define PER_C_TYPE(type, ctype)                                           \
-  case PrimitiveTypeID::type:                                             \
-    args.insert({arg_name, aot::IValue::create(py::cast<ctype>(pyarg))}); \
-    break;
-#include "taichi/inc/data_type_with_c_type.inc.h"
-#undef PER_C_TYPE
-            default:
-              TI_ERROR("Unsupported scalar type {}",
-                       expected_dtype->to_string());
-          }
-        };
+        std::vector<std::unique_ptr<char[]>> matrix_buffers;
+        std::vector<Matrix> matrices;
+        auto args = graph_args_from_pydict(*self, pyargs, false,
+                                           matrix_buffers, matrices);
+        self->jit_run(compile_config, args);
+      })
+      .def("jit_bind", [](aot::CompiledGraph *self,
+                          const CompileConfig &compile_config,
+                          const py::dict &pyargs) {
+        std::vector<std::unique_ptr<char[]>> matrix_buffers;
+        std::vector<Matrix> matrices;
+        auto args = graph_args_from_pydict(*self, pyargs, false,
+                                           matrix_buffers, matrices);
+        return self->jit_bind(compile_config, args);
+      });
 
+  py::class_<aot::BoundGraph>(m, "BoundGraph")
+      .def("run", &aot::BoundGraph::run)
+      .def("set_args", [](aot::BoundGraph *self,
+                          const aot::CompiledGraph &graph,
+                          const py::dict &pyargs) {
         std::vector<std::unique_ptr<char[]>> matrix_buffers;
-        matrix_buffers.reserve(self->args.size());
         std::vector<Matrix> matrices;
-        // Reserve to avoid changes in element addresses
-        matrices.reserve(self->args.size());
-        for (const auto &[arg_name, arg] : self->args) {
-          auto tag = arg.tag;
-          TI_ASSERT(pyargs.contains(arg_name.c_str()));
-          auto pyarg = pyargs[arg_name.c_str()];
-          if (tag == aot::ArgKind::kNdarray) {
-            auto &val = pyarg.cast<Ndarray &>();
-            args.insert({arg_name, aot::IValue::create(val)});
-          } else if (tag == aot::ArgKind::kTexture ||
-                     tag == aot::ArgKind::kRWTexture) {
-            auto &val = pyarg.cast<Texture &>();
-            args.insert({arg_name, aot::IValue::create(val)});
-          } else if (tag == aot::ArgKind::kScalar) {
-            auto expected_dtype = arg.dtype();
-            insert_scalar_arg(arg_name, expected_dtype, pyarg);
-          } else if (tag == aot::ArgKind::kMatrix) {
-            auto type_id = arg.dtype()->as<PrimitiveType>()->type;
-            switch (type_id) {
-              case PrimitiveTypeID::f16: {
-                auto arr = pyarg.cast<py::array_t<float32>>();
-                py::buffer_info buffer_info = arr.request();
-                auto length = buffer_info.size;
-                auto ptr = reinterpret_cast<intptr_t>(buffer_info.ptr);
-
-                std::unique_ptr<char[]> data(new char[128]);
-                for (uint32_t i = 0; i < length; i++) {
-                  uint16 half = fp16_ieee_from_fp32_value(
-                      reinterpret_cast<float32 *>(ptr)[i]);
-                  reinterpret_cast<uint16 *>(data.get())[i] = half;
-                }
-                matrix_buffers.emplace_back(std::move(data));
-
-                matrices.emplace_back(Matrix(
-                    length, arg.dtype(),
-                    reinterpret_cast<intptr_t>(matrix_buffers.back().get())));
-                args.insert({arg_name, aot::IValue::create(matrices.back())});
-                break;
-              }
-#define PER_C_TYPE(type, ctype)                                           \
-  case PrimitiveTypeID::type: {                                           \
-    auto arr = pyarg.cast<py::array_t<ctype>>();                          \
-    py::buffer_info buffer_info = arr.request();                          \
-    auto length = buffer_info.size;                                       \
-    auto ptr = reinterpret_cast<intptr_t>(buffer_info.ptr);               \
-                                                                          \
-    std::unique_ptr<char[]> data(new char[128]);                          \
-    std::memcpy(data.get(), reinterpret_cast<char *>(ptr),                \
-                sizeof(ctype) * length);                                  \
-    matrix_buffers.emplace_back(std::move(data));                         \
-                                                                          \
-    matrices.emplace_back(                                                \
-        Matrix(length, arg.dtype(),                                       \
-               reinterpret_cast<intptr_t>(matrix_buffers.back().get()))); \
-    args.insert({arg_name, aot::IValue::create(matrices.back())});        \
-    break;                                                                \
-  }
-#include "taichi/inc/data_type_with_c_type.inc.h"
-#undef PER_C_TYPE
-              default:
-                TI_ERROR("Unsupported scalar type {}",
-                         arg.dtype()->to_string());
-            }
-          } else {
-            TI_NOT_IMPLEMENTED;
-          }
+        auto args = graph_args_from_pydict(graph, pyargs, true,
+                                           matrix_buffers, matrices);
+        for (const auto &[arg_name, value] : args) {
+          self->set_arg(arg_name, value);
         }
-        self->jit_run(compile_config, args);
       });
 
   py::class_<Kernel>(m, "Kernel")
@@ -1222,6 +1304,8 @@ void export_lang(py::module &m) {
   m.def("get_max_num_indices", [] { return taichi_max_num_indices; });
   m.def("get_max_num_args", [] { return taichi_max_num_args; });
   m.def("test_threading", test_threading);
+  m.def("test_work_stealing_threading", test_work_stealing_threading);
+  m.def("benchmark_timeline", benchmark_timeline);
   m.def("is_extension_supported", is_extension_supported);
 
   m.def("query_int64", [](const std::string &key) {
@@ -1341,6 +1425,7 @@ void export_lang(py::module &m) {
       .def("get_ndarray_data_ptr", &SparseMatrixBuilder::get_ndarray_data_ptr)
       .def("build", &SparseMatrixBuilder::build)
       .def("build_cuda", &SparseMatrixBuilder::build_cuda)
+      .def("refill", &SparseMatrixBuilder::refill)
       .def("get_addr", [](SparseMatrixBuilder *mat) { return uint64(mat); });
 
   py::class_<SparseMatrix>(m, "SparseMatrix")
@@ -1354,6 +1439,7 @@ void export_lang(py::module &m) {
       .def("mmwrite", &SparseMatrix::mmwrite)
       .def("num_rows", &SparseMatrix::num_rows)
       .def("num_cols", &SparseMatrix::num_cols)
+      .def("get_pattern_id", &SparseMatrix::get_pattern_id)
       .def("get_data_type", &SparseMatrix::get_data_type);
 
 #define MAKE_SPARSE_MATRIX(TYPE, STORAGE, VTYPE)                             \
@@ -1478,6 +1564,19 @@ void export_lang(py::module &m) {
   py::class_<CUCG>(m, "CUCG").def("solve", &CUCG::solve);
   m.def("make_cucg_solver", make_cucg_solver);
 
+  // Preconditioned CG/BiCGSTAB solvers on ndarrays
+#define REGISTER_ITERATIVE_SOLVER(dt)                                       \
+  py::class_<IterativeSolver<dt>>(m, "IterativeSolver" #dt)                 \
+      .def("compute", &IterativeSolver<dt>::compute)                        \
+      .def("solve", &IterativeSolver<dt>::solve)                            \
+      .def("get_residuals", &IterativeSolver<dt>::get_residuals)            \
+      .def("get_iterations", &IterativeSolver<dt>::get_iterations)          \
+      .def("is_success", &IterativeSolver<dt>::is_success);                 \
+  m.def("make_iterative_solver_" #dt, &make_iterative_solver<dt>);
+
+  REGISTER_ITERATIVE_SOLVER(float32)
+  REGISTER_ITERATIVE_SOLVER(float64)
+
   // Mesh Class
   // Mesh related.
   py::enum_<mesh::MeshTopology>(m, "MeshTopology", py::arithmetic())
@@ -0,0 +1,101 @@
+#include "taichi/rhi/common/host_caching_allocator.h"
+#include "taichi/rhi/common/host_memory_pool.h"
+
+#include "taichi/math/arithmetic.h"
+
+namespace taichi::lang {
+
+const std::size_t HostCachingAllocator::default_max_cached_bytes{
+    std::size_t(1) << 30};  // 1 GB
+
+HostCachingAllocator::HostCachingAllocator(HostMemoryPool &pool,
+                                           std::size_t max_cached_bytes)
+    : pool_(pool), max_cached_bytes_(max_cached_bytes) {
+}
+
+HostCachingAllocator::~HostCachingAllocator() {
+  trim();
+}
+
+std::size_t HostCachingAllocator::get_size_class(std::size_t size) {
+  const std::size_t page_size = HostMemoryPool::page_size;
+  if (size <= page_size) {
+    return page_size;
+  }
+  // Four classes per power of two: 2^k * {1, 1.25, 1.5, 1.75}
+  int k = 0;
+  while ((std::size_t(1) << (k + 1)) < size) {
+    k++;
+  }
+  std::size_t step = std::max(page_size, (std::size_t(1) << k) / 4);
+  return iroundup(size, step);
+}
+
+void *HostCachingAllocator::allocate(std::size_t size, bool *recycled) {
+  TI_ASSERT(size > 0);
+  auto size_class = get_size_class(size);
+  void *ptr = nullptr;
+  {
+    std::lock_guard<std::mutex> _(mut_);
+    stats_.num_allocations++;
+    auto it = free_blocks_.find(size_class);
+    if (it != free_blocks_.end() && !it->second.empty()) {
+      ptr = it->second.back();
+      it->second.pop_back();
+      stats_.num_cache_hits++;
+      stats_.bytes_cached -= size_class;
+      stats_.bytes_in_use += size_class;
+    }
+  }
+  if (recycled) {
+    *recycled = ptr != nullptr;
+  }
+  if (ptr) {
+    return ptr;
+  }
+
+  ptr = pool_.allocate(size_class, HostMemoryPool::page_size,
+                       true /*exclusive*/);
+  if (ptr) {
+    std::lock_guard<std::mutex> _(mut_);
+    stats_.bytes_in_use += size_class;
+    stats_.peak_bytes = std::max(stats_.peak_bytes,
+                                 stats_.bytes_in_use + stats_.bytes_cached);
+  }
+  return ptr;
+}
+
+void HostCachingAllocator::release(std::size_t size, void *ptr) {
+  auto size_class = get_size_class(size);
+  {
+    std::lock_guard<std::mutex> _(mut_);
+    stats_.bytes_in_use -= size_class;
+    if (stats_.bytes_cached + size_class <= max_cached_bytes_) {
+      free_blocks_[size_class].push_back(ptr);
+      stats_.bytes_cached += size_class;
+      return;
+    }
+  }
+  pool_.release(size_class, ptr);
+}
+
+void HostCachingAllocator::trim() {
+  std::unordered_map<std::size_t, std::vector<void *>> free_blocks;
+  {
+    std::lock_guard<std::mutex> _(mut_);
+    free_blocks.swap(free_blocks_);
+    stats_.bytes_cached = 0;
+  }
+  for (auto &[size_class, blocks] : free_blocks) {
+    for (auto *ptr : blocks) {
+      pool_.release(size_class, ptr);
+    }
+  }
+}
+
+HostCachingAllocator::Stats HostCachingAllocator::get_stats() {
+  std::lock_guard<std::mutex> _(mut_);
+  return stats_;
+}
+
+}  // namespace taichi::lang
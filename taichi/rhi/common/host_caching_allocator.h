@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "taichi/common/core.h"
+
+namespace taichi::lang {
+
+class HostMemoryPool;
+
+// Caches the host memory released by a device, so that buffers created and
+// dropped repeatedly (e.g. temporary ndarrays) reuse resident pages instead
+// of mapping fresh ones from the HostMemoryPool every time.
+//
+// Sizes are rounded up to size classes with four classes per power of two,
+// which wastes at most a quarter of a block. Released blocks are kept in a
+// free list per class until the cache grows over |max_cached_bytes|, or
+// until trim() is called.
+class TI_DLL_EXPORT HostCachingAllocator {
+ public:
+  struct Stats {
+    std::size_t num_allocations{0};
+    std::size_t num_cache_hits{0};
+    std::size_t bytes_in_use{0};
+    std::size_t bytes_cached{0};
+    // The peak of the bytes in use plus the bytes cached, all of which are
+    // resident once written.
+    std::size_t peak_bytes{0};
+  };
+
+  static const std::size_t default_max_cached_bytes;
+
+  explicit HostCachingAllocator(
+      HostMemoryPool &pool,
+      std::size_t max_cached_bytes = default_max_cached_bytes);
+  ~HostCachingAllocator();
+
+  HostCachingAllocator(const HostCachingAllocator &) = delete;
+  HostCachingAllocator &operator=(const HostCachingAllocator &) = delete;
+
+  // Returns a page-aligned block of at least |size| bytes, or nullptr when
+  // the pool is out of memory. |recycled| tells whether the block comes from
+  // the cache, in which case it holds stale data.
+  void *allocate(std::size_t size, bool *recycled = nullptr);
+  // |size| must be the one passed to allocate().
+  void release(std::size_t size, void *ptr);
+  // Returns every cached block to the pool.
+  void trim();
+
+  Stats get_stats();
+
+  static std::size_t get_size_class(std::size_t size);
+
+ private:
+  HostMemoryPool &pool_;
+  std::size_t max_cached_bytes_;
+  std::mutex mut_;
+  std::unordered_map<std::size_t, std::vector<void *>> free_blocks_;
+  Stats stats_;
+};
+
+}  // namespace taichi::lang
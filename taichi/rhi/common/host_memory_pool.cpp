@@ -2,6 +2,8 @@
 
 #include <memory>
 
+#include "taichi/math/arithmetic.h"
+
 #if defined(TI_PLATFORM_UNIX)
 #include <sys/mman.h>
 #else
@@ -17,15 +19,38 @@ HostMemoryPool::HostMemoryPool() {
            UnifiedAllocator::default_allocator_size / 1024 / 1024);
 }
 
+void HostMemoryPool::set_huge_pages(bool enabled) {
+  std::lock_guard<std::mutex> _(mut_allocation_);
+  huge_pages_ = enabled;
+}
+
+void HostMemoryPool::set_first_touch(FirstTouchFunc func) {
+  std::lock_guard<std::mutex> _(mut_allocation_);
+  first_touch_ = std::move(func);
+}
+
 void *HostMemoryPool::allocate(std::size_t size,
                                std::size_t alignment,
                                bool exclusive) {
-  std::lock_guard<std::mutex> _(mut_allocation_);
+  void *ret = nullptr;
+  FirstTouchFunc first_touch;
+  {
+    std::lock_guard<std::mutex> _(mut_allocation_);
 
-  if (!allocator_) {
-    TI_ERROR("Memory pool is already destroyed");
+    if (!allocator_) {
+      TI_ERROR("Memory pool is already destroyed");
+    }
+    ret = allocator_->allocate(size, alignment, exclusive);
+    // Only exclusive allocations get a fresh chunk of their own. The shared
+    // chunks are also allocated from inside kernels, where the first-touch
+    // threads may be busy.
+    if (exclusive && size >= first_touch_min_size) {
+      first_touch = first_touch_;
+    }
+  }
+  if (ret && first_touch) {
+    first_touch(ret, size);
   }
-  void *ret = allocator_->allocate(size, alignment, exclusive);
   return ret;
 }
 
@@ -56,10 +81,32 @@ void *HostMemoryPool::allocate_raw_memory(std::size_t size) {
 
   void *ptr = nullptr;
 #if defined(TI_PLATFORM_UNIX)
-  ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
-             -1, 0);
+  const bool use_huge_pages = huge_pages_ && size >= huge_page_size;
+  // Huge pages only back the huge-page-aligned part of a mapping, so map some
+  // slack to align the chunk and unmap the rest.
+  const std::size_t map_size = use_huge_pages ? size + huge_page_size : size;
+  ptr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
   TI_ERROR_IF(ptr == MAP_FAILED, "Virtual memory allocation ({} B) failed.",
               size);
+  if (use_huge_pages) {
+    auto begin = (std::size_t)ptr;
+    auto aligned = iroundup(begin, huge_page_size);
+    auto aligned_end = aligned + iroundup(size, page_size);
+    if (aligned > begin) {
+      munmap(ptr, aligned - begin);
+    }
+    if (begin + map_size > aligned_end) {
+      munmap((void *)aligned_end, begin + map_size - aligned_end);
+    }
+    ptr = (void *)aligned;
+#if defined(MADV_HUGEPAGE)
+    if (madvise(ptr, size, MADV_HUGEPAGE) != 0) {
+      TI_TRACE("Transparent huge pages are unavailable, using {} B pages",
+               page_size);
+    }
+#endif
+  }
 #else
   MEMORYSTATUSEX stat;
   stat.dwLength = sizeof(stat);
@@ -126,6 +173,8 @@ HostMemoryPool::~HostMemoryPool() {
 }
 
 const size_t HostMemoryPool::page_size{1 << 12};  // 4 KB page size by default
+const size_t HostMemoryPool::huge_page_size{1 << 21};  // 2 MB
+const size_t HostMemoryPool::first_touch_min_size{1 << 22};  // 4 MB
 
 HostMemoryPool &HostMemoryPool::get_instance() {
   static HostMemoryPool *memory_pool = new HostMemoryPool();
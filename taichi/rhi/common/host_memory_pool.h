@@ -2,6 +2,7 @@
 #include "taichi/common/core.h"
 #include "taichi/rhi/common/unified_allocator.h"
 #include "taichi/rhi/device.h"
+#include <functional>
 #include <mutex>
 #include <vector>
 #include <memory>
@@ -14,9 +15,24 @@ namespace taichi::lang {
 class TI_DLL_EXPORT HostMemoryPool {
  public:
   static const size_t page_size;
+  static const size_t huge_page_size;
+  // Exclusive allocations smaller than this are not first-touched.
+  static const size_t first_touch_min_size;
+
+  // Faults in the pages of [ptr, ptr + size) from the threads that will use
+  // them, so that the OS places them on their NUMA nodes.
+  using FirstTouchFunc = std::function<void(void *ptr, std::size_t size)>;
 
   static HostMemoryPool &get_instance();
 
+  // Backs the raw memory chunks of at least |huge_page_size| bytes with
+  // transparent huge pages where the OS supports them, and with normal pages
+  // otherwise.
+  void set_huge_pages(bool enabled);
+  // Calls |func| on every new exclusive allocation of at least
+  // |first_touch_min_size| bytes. An empty |func| disables first-touch.
+  void set_first_touch(FirstTouchFunc func);
+
   void *allocate(std::size_t size,
                  std::size_t alignment,
                  bool exclusive = false);
@@ -36,6 +52,9 @@ class TI_DLL_EXPORT HostMemoryPool {
   std::unique_ptr<UnifiedAllocator> allocator_;
   std::mutex mut_allocation_;
 
+  bool huge_pages_{false};
+  FirstTouchFunc first_touch_;
+
   friend class UnifiedAllocator;
 };
 
@@ -4,40 +4,61 @@
 
 #include "taichi/jit/jit_module.h"
 
+#include <limits>
+
 namespace taichi::lang {
 
 namespace cpu {
 
 CpuDevice::AllocInfo CpuDevice::get_alloc_info(const DeviceAllocation handle) {
   validate_device_alloc(handle);
-  return allocations_[handle.alloc_id];
+  return allocations_[get_slot(handle.alloc_id)];
+}
+
+CpuDevice::CpuDevice() : caching_allocator_(HostMemoryPool::get_instance()) {
 }
 
-CpuDevice::CpuDevice() {
+DeviceAllocationId CpuDevice::new_alloc_id(const AllocInfo &info) {
+  uint32_t slot;
+  if (free_slots_.empty()) {
+    TI_ASSERT(allocations_.size() < std::numeric_limits<uint32_t>::max());
+    slot = allocations_.size();
+    allocations_.push_back(info);
+    generations_.push_back(0);
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    allocations_[slot] = info;
+  }
+  return (DeviceAllocationId(generations_[slot]) << 32) | slot;
 }
 
 RhiResult CpuDevice::allocate_memory(const AllocParams &params,
                                      DeviceAllocation *out_devalloc) {
   AllocInfo info;
   info.size = params.size;
-  info.use_cached = false;
+  info.from_caching_allocator = false;
 
   if (info.size == 0) {
     info.ptr = nullptr;
   } else {
-    info.ptr = HostMemoryPool::get_instance().allocate(
-        params.size, HostMemoryPool::page_size, true /*exclusive*/);
+    bool recycled = false;
+    info.ptr = caching_allocator_.allocate(params.size, &recycled);
 
     if (info.ptr == nullptr) {
       return RhiResult::out_of_memory;
     }
+    info.from_caching_allocator = true;
+    if (recycled) {
+      // Pages fresh from the memory pool are zeroed, and so must be the
+      // recycled ones.
+      std::memset(info.ptr, 0, info.size);
+    }
   }
   *out_devalloc = DeviceAllocation{};
-  out_devalloc->alloc_id = allocations_.size();
+  out_devalloc->alloc_id = new_alloc_id(info);
   out_devalloc->device = this;
 
-  allocations_.push_back(info);
-
   return RhiResult::success;
 }
 
@@ -60,17 +81,19 @@ uint64_t *CpuDevice::allocate_llvm_runtime_memory_jit(
 
 void CpuDevice::dealloc_memory(DeviceAllocation handle) {
   validate_device_alloc(handle);
-  AllocInfo &info = allocations_[handle.alloc_id];
+  auto slot = get_slot(handle.alloc_id);
+  AllocInfo &info = allocations_[slot];
   if (info.size == 0) {
     return;
   }
-  if (info.ptr == nullptr) {
-    TI_ERROR("the DeviceAllocation is already deallocated");
-  }
-  if (!info.use_cached) {
+  if (info.from_caching_allocator) {
+    caching_allocator_.release(info.size, info.ptr);
+  } else {
     HostMemoryPool::get_instance().release(info.size, info.ptr);
-    info.ptr = nullptr;
   }
+  info.ptr = nullptr;
+  generations_[slot]++;
+  free_slots_.push_back(slot);
 }
 
 RhiResult CpuDevice::upload_data(DevicePtr *device_ptr,
@@ -82,11 +105,12 @@ RhiResult CpuDevice::upload_data(DevicePtr *device_ptr,
   }
 
   for (int i = 0; i < num_alloc; i++) {
-    if (device_ptr[i].device != this || !data[i]) {
+    if (device_ptr[i].device != this || !data[i] ||
+        !is_valid_alloc_id(device_ptr[i].alloc_id)) {
       return RhiResult::invalid_usage;
     }
 
-    AllocInfo &info = allocations_[device_ptr[i].alloc_id];
+    AllocInfo &info = allocations_[get_slot(device_ptr[i].alloc_id)];
     memcpy((uint8_t *)info.ptr + device_ptr[i].offset, data[i], size[i]);
   }
 
@@ -104,11 +128,12 @@ RhiResult CpuDevice::readback_data(
   }
 
   for (int i = 0; i < num_alloc; i++) {
-    if (device_ptr[i].device != this || !data[i]) {
+    if (device_ptr[i].device != this || !data[i] ||
+        !is_valid_alloc_id(device_ptr[i].alloc_id)) {
       return RhiResult::invalid_usage;
     }
 
-    AllocInfo &info = allocations_[device_ptr[i].alloc_id];
+    AllocInfo &info = allocations_[get_slot(device_ptr[i].alloc_id)];
     memcpy(data[i], (uint8_t *)info.ptr + device_ptr[i].offset, size[i]);
   }
 
@@ -118,7 +143,10 @@ RhiResult CpuDevice::readback_data(
 RhiResult CpuDevice::map_range(DevicePtr ptr,
                                uint64_t size,
                                void **mapped_ptr) {
-  AllocInfo &info = allocations_[ptr.alloc_id];
+  if (!is_valid_alloc_id(ptr.alloc_id)) {
+    return RhiResult::invalid_usage;
+  }
+  AllocInfo &info = allocations_[get_slot(ptr.alloc_id)];
   if (info.ptr == nullptr) {
     return RhiResult::error;
   }
@@ -127,7 +155,10 @@ RhiResult CpuDevice::map_range(DevicePtr ptr,
 }
 
 RhiResult CpuDevice::map(DeviceAllocation alloc, void **mapped_ptr) {
-  AllocInfo &info = allocations_[alloc.alloc_id];
+  if (!is_valid_alloc_id(alloc.alloc_id)) {
+    return RhiResult::invalid_usage;
+  }
+  AllocInfo &info = allocations_[get_slot(alloc.alloc_id)];
   if (info.ptr == nullptr) {
     return RhiResult::error;
   }
@@ -140,10 +171,8 @@ void CpuDevice::unmap(DeviceAllocation alloc) {
 }
 
 void CpuDevice::memcpy_internal(DevicePtr dst, DevicePtr src, uint64_t size) {
-  void *dst_ptr =
-      static_cast<char *>(allocations_[dst.alloc_id].ptr) + dst.offset;
-  void *src_ptr =
-      static_cast<char *>(allocations_[src.alloc_id].ptr) + src.offset;
+  void *dst_ptr = static_cast<char *>(get_alloc_info(dst).ptr) + dst.offset;
+  void *src_ptr = static_cast<char *>(get_alloc_info(src).ptr) + src.offset;
   std::memcpy(dst_ptr, src_ptr, size);
 }
 
@@ -153,10 +182,8 @@ DeviceAllocation CpuDevice::import_memory(void *ptr, size_t size) {
   info.size = size;
 
   DeviceAllocation alloc;
-  alloc.alloc_id = allocations_.size();
+  alloc.alloc_id = new_alloc_id(info);
   alloc.device = this;
-
-  allocations_.push_back(info);
   return alloc;
 }
 
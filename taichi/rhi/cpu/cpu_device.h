@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "taichi/common/core.h"
+#include "taichi/rhi/common/host_caching_allocator.h"
 #include "taichi/rhi/llvm/llvm_device.h"
 
 namespace taichi::lang {
@@ -79,7 +80,8 @@ class CpuDevice : public LlvmDevice {
   struct AllocInfo {
     void *ptr{nullptr};
     size_t size{0};
-    bool use_cached{false};
+    // Owned by the caching allocator of the device, i.e. not imported.
+    bool from_caching_allocator{false};
   };
 
   AllocInfo get_alloc_info(const DeviceAllocation handle);
@@ -131,13 +133,41 @@ class CpuDevice : public LlvmDevice {
 
   void wait_idle() override { TI_NOT_IMPLEMENTED };
 
+  HostCachingAllocator::Stats get_caching_allocator_stats() {
+    return caching_allocator_.get_stats();
+  }
+
  private:
   std::vector<AllocInfo> allocations_;
+  // Slots of |allocations_| freed by dealloc_memory(), reused by the next
+  // allocations so that |allocations_| doesn't grow with every buffer ever
+  // created.
+  std::vector<uint32_t> free_slots_;
+  // Bumped whenever the slot is freed. An allocation ID carries the
+  // generation of its slot in its high 32 bits, so that a stale
+  // DeviceAllocation is caught instead of reaching the slot's next owner.
+  std::vector<uint32_t> generations_;
+  HostCachingAllocator caching_allocator_;
+
+  DeviceAllocationId new_alloc_id(const AllocInfo &info);
+
+  static uint32_t get_slot(DeviceAllocationId alloc_id) {
+    return uint32_t(alloc_id);
+  }
+
+  bool is_valid_alloc_id(DeviceAllocationId alloc_id) const {
+    auto slot = get_slot(alloc_id);
+    return slot < allocations_.size() &&
+           generations_[slot] == uint32_t(alloc_id >> 32);
+  }
 
   void validate_device_alloc(const DeviceAllocation alloc) {
-    if (allocations_.size() <= alloc.alloc_id) {
+    if (get_slot(alloc.alloc_id) >= allocations_.size()) {
       TI_ERROR("invalid DeviceAllocation");
     }
+    if (!is_valid_alloc_id(alloc.alloc_id)) {
+      TI_ERROR("the DeviceAllocation is already deallocated");
+    }
   }
 };
 
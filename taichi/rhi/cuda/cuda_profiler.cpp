@@ -149,16 +149,8 @@ void KernelProfilerCUDA::stop(KernelProfilerBase::TaskHandle handle) {
 
 bool KernelProfilerCUDA::statistics_on_traced_records() {
   for (auto &record : traced_records_) {
-    auto it =
-        std::find_if(statistical_results_.begin(), statistical_results_.end(),
-                     [&](KernelProfileStatisticalResult &result) {
-                       return result.name == record.name;
-                     });
-    if (it == statistical_results_.end()) {
-      statistical_results_.emplace_back(record.name);
-      it = std::prev(statistical_results_.end());
-    }
-    it->insert_record(record.kernel_elapsed_time_in_ms);
+    get_statistical_result(record.name)
+        .insert_record(record.kernel_elapsed_time_in_ms);
     total_time_ms_ += record.kernel_elapsed_time_in_ms;
   }
 
@@ -16,81 +16,73 @@ bool KernelLauncher::on_amdgpu_device(void *ptr) {
 void KernelLauncher::launch_llvm_kernel(Handle handle,
                                         LaunchContextBuilder &ctx) {
   TI_ASSERT(handle.get_launch_id() < contexts_.size());
-  auto launcher_ctx = contexts_[handle.get_launch_id()];
+  const auto &launcher_ctx = contexts_[handle.get_launch_id()];
   auto *executor = get_runtime_executor();
   auto *amdgpu_module = launcher_ctx.jit_module;
-  const auto &parameters = launcher_ctx.parameters;
   const auto &offloaded_tasks = launcher_ctx.offloaded_tasks;
 
   AMDGPUContext::get_instance().make_current();
   ctx.get_context().runtime = executor->get_llvm_runtime();
 
-  std::unordered_map<std::vector<int>, std::pair<void *, DeviceAllocation>,
-                     hashing::Hasher<std::vector<int>>>
-      transfers;
-  std::unordered_map<std::vector<int>, void *,
-                     hashing::Hasher<std::vector<int>>>
-      device_ptrs;
+  // External arrays on host are copied to temporary device allocations, and
+  // copied back once the kernel finishes.
+  struct Transfer {
+    void *host_ptr;
+    void *device_ptr;
+    DeviceAllocation devalloc;
+    uint64 size;
+  };
+  std::vector<Transfer> transfers;
 
   char *device_result_buffer{nullptr};
   AMDGPUDriver::get_instance().malloc(
       (void **)&device_result_buffer,
       std::max(ctx.result_buffer_size, sizeof(uint64)));
 
-  for (int i = 0; i < (int)parameters.size(); i++) {
-    const auto &kv = parameters[i];
-    const auto &key = kv.first;
-    const auto &parameter = kv.second;
+  const auto &slots = ctx.get_parameter_layout().slots;
+  for (int i = 0; i < (int)slots.size(); i++) {
+    const auto &key = slots[i].indices;
+    const auto &parameter = slots[i].parameter;
+    auto &binding = ctx.get_binding(i);
     if (parameter.is_array) {
-      const auto arr_sz = ctx.array_runtime_sizes[key];
+      const auto arr_sz = binding.runtime_size;
       if (arr_sz == 0)
         continue;
-      std::vector<int> data_ptr_idx = key;
-      data_ptr_idx.push_back(TypeFactory::DATA_PTR_POS_IN_NDARRAY);
-      auto data_ptr = ctx.array_ptrs[data_ptr_idx];
-      std::vector<int> grad_ptr_idx = key;
-      grad_ptr_idx.push_back(TypeFactory::GRAD_PTR_POS_IN_NDARRAY);
+      auto data_ptr = binding.data_ptr;
+      void *device_data_ptr = nullptr;
 
-      if (ctx.device_allocation_type[key] ==
+      if (binding.device_allocation_type ==
           LaunchContextBuilder::DevAllocType::kNone) {
         if (on_amdgpu_device(data_ptr)) {
-          device_ptrs[data_ptr_idx] = data_ptr;
+          device_data_ptr = data_ptr;
         } else {
           DeviceAllocation devalloc = executor->allocate_memory_on_device(
               arr_sz, (uint64 *)device_result_buffer);
-          device_ptrs[data_ptr_idx] =
-              executor->get_device_alloc_info_ptr(devalloc);
-          transfers[data_ptr_idx] = {data_ptr, devalloc};
+          device_data_ptr = executor->get_device_alloc_info_ptr(devalloc);
+          transfers.push_back({data_ptr, device_data_ptr, devalloc, arr_sz});
 
           AMDGPUDriver::get_instance().memcpy_host_to_device(
-              (void *)device_ptrs[data_ptr_idx], data_ptr, arr_sz);
+              device_data_ptr, data_ptr, arr_sz);
         }
-        ctx.set_ndarray_ptrs(key, (uint64)device_ptrs[data_ptr_idx],
-                             (uint64)ctx.array_ptrs[grad_ptr_idx]);
-      } else if (arr_sz > 0) {  // why use arr_sz constrain?
+      } else {
         // Ndarray
         DeviceAllocation *ptr = static_cast<DeviceAllocation *>(data_ptr);
         // Unwrapped raw ptr on device
-        device_ptrs[data_ptr_idx] = executor->get_device_alloc_info_ptr(*ptr);
-
-        ctx.set_ndarray_ptrs(key, (uint64)device_ptrs[data_ptr_idx],
-                             (uint64)ctx.array_ptrs[grad_ptr_idx]);
+        device_data_ptr = executor->get_device_alloc_info_ptr(*ptr);
       }
+      ctx.set_ndarray_ptrs(i, (uint64)device_data_ptr,
+                           (uint64)binding.grad_ptr);
     } else if (parameter.is_argpack) {
-      std::vector<int> data_ptr_idx = key;
-      data_ptr_idx.push_back(TypeFactory::DATA_PTR_POS_IN_ARGPACK);
-      auto *argpack = ctx.argpack_ptrs[key];
-      auto argpack_ptr = argpack->get_device_allocation();
-      device_ptrs[data_ptr_idx] =
-          executor->get_device_alloc_info_ptr(argpack_ptr);
+      auto argpack_ptr = binding.argpack->get_device_allocation();
+      auto device_ptr =
+          (uint64)executor->get_device_alloc_info_ptr(argpack_ptr);
       if (key.size() == 1) {
-        ctx.set_argpack_ptr(key, (uint64)device_ptrs[data_ptr_idx]);
+        ctx.set_argpack_ptr(i, device_ptr);
       } else {
         auto key_parent = key;
         key_parent.pop_back();
-        auto *argpack_parent = ctx.argpack_ptrs[key_parent];
-        argpack_parent->set_arg_nested_argpack_ptr(
-            key.back(), (uint64)device_ptrs[data_ptr_idx]);
+        auto *argpack_parent = ctx.get_binding(key_parent).argpack;
+        argpack_parent->set_arg_nested_argpack_ptr(key.back(), device_ptr);
       }
     }
   }
@@ -104,6 +96,7 @@ void KernelLauncher::launch_llvm_kernel(Handle handle,
                                         ctx.result_buffer_size);
     ctx.get_context().result_buffer = (uint64 *)device_result_buffer;
   }
+  char *host_arg_buffer = ctx.get_context().arg_buffer;
   char *device_arg_buffer = nullptr;
   if (ctx.arg_buffer_size > 0) {
     AMDGPUDriver::get_instance().malloc((void **)&device_arg_buffer,
@@ -128,6 +121,9 @@ void KernelLauncher::launch_llvm_kernel(Handle handle,
                           {(void *)&context_pointer}, {arg_size});
   }
   TI_TRACE("Launching kernel");
+  // Point |ctx| back to its host buffers so that it can be launched again.
+  ctx.get_context().arg_buffer = host_arg_buffer;
+  ctx.get_context().result_buffer = (uint64 *)host_result_buffer;
   if (ctx.arg_buffer_size > 0) {
     AMDGPUDriver::get_instance().mem_free(device_arg_buffer);
   }
@@ -137,14 +133,10 @@ void KernelLauncher::launch_llvm_kernel(Handle handle,
     AMDGPUDriver::get_instance().mem_free(device_result_buffer);
   }
   if (transfers.size()) {
-    for (auto itr = transfers.begin(); itr != transfers.end(); itr++) {
-      auto &idx = itr->first;
-      auto arg_id = idx;
-      arg_id.pop_back();
+    for (const auto &transfer : transfers) {
       AMDGPUDriver::get_instance().memcpy_device_to_host(
-          itr->second.first, (void *)device_ptrs[idx],
-          ctx.array_runtime_sizes[arg_id]);
-      executor->deallocate_memory_on_device(itr->second.second);
+          transfer.host_ptr, transfer.device_ptr, transfer.size);
+      executor->deallocate_memory_on_device(transfer.devalloc);
     }
   }
 }
@@ -162,12 +154,10 @@ KernelLauncher::Handle KernelLauncher::register_llvm_kernel(
     auto *executor = get_runtime_executor();
 
     auto data = compiled.get_internal_data().compiled_data.clone();
-    auto parameters = compiled.get_internal_data().args;
     auto *jit_module = executor->create_jit_module(std::move(data.module));
 
     // Populate ctx
     ctx.jit_module = jit_module;
-    ctx.parameters = std::move(parameters);
     ctx.offloaded_tasks = std::move(data.tasks);
 
     compiled.set_handle(handle);
@@ -89,6 +89,10 @@ class JITModuleCPU : public JITModule {
 
   void *lookup_function(const std::string &name) override;
 
+  JITDylib *get_dylib() const {
+    return dylib_;
+  }
+
   bool direct_dispatch() const override {
     return true;
   }
@@ -103,6 +107,7 @@ class JITSessionCPU : public JITSession {
   MangleAndInterner mangle_;
   std::mutex mut_;
   std::vector<llvm::orc::JITDylib *> all_libs_;
+  llvm::orc::JITDylib *runtime_lib_{nullptr};
   int module_counter_;
   SectionMemoryManager *memory_manager_;
 
@@ -161,6 +166,9 @@ class JITSessionCPU : public JITSession {
             dl_.getGlobalPrefix())));
     auto *thread_safe_context =
         this->tlctx_->get_this_thread_thread_safe_context();
+    if (runtime_lib_) {
+      dylib.addToLinkOrder(*runtime_lib_);
+    }
     cantFail(compile_layer_.add(
         dylib,
         llvm::orc::ThreadSafeModule(std::move(M), *thread_safe_context)));
@@ -172,6 +180,11 @@ class JITSessionCPU : public JITSession {
     return new_module_raw_ptr;
   }
 
+  void set_runtime_module(JITModule *module) override {
+    std::lock_guard<std::mutex> _(mut_);
+    runtime_lib_ = static_cast<JITModuleCPU *>(module)->get_dylib();
+  }
+
   void *lookup(const std::string Name) override {
     std::lock_guard<std::mutex> _(mut_);
 #ifdef __APPLE__
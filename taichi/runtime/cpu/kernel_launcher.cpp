@@ -7,57 +7,49 @@ namespace cpu {
 void KernelLauncher::launch_llvm_kernel(Handle handle,
                                         LaunchContextBuilder &ctx) {
   TI_ASSERT(handle.get_launch_id() < contexts_.size());
-  auto launcher_ctx = contexts_[handle.get_launch_id()];
+  const auto &launcher_ctx = contexts_[handle.get_launch_id()];
   auto *executor = get_runtime_executor();
 
   ctx.get_context().runtime = executor->get_llvm_runtime();
-  // For taichi ndarrays, context.array_ptrs saves pointer to its
+  // For taichi ndarrays, the binding saves pointer to its
   // |DeviceAllocation|, CPU backend actually want to use the raw ptr here.
-  const auto &parameters = launcher_ctx.parameters;
-  for (int i = 0; i < (int)parameters.size(); i++) {
-    const auto &kv = parameters[i];
-    const auto &key = kv.first;
-    const auto &parameter = kv.second;
-    std::vector<int> data_ptr_idx = key;
-    data_ptr_idx.push_back(TypeFactory::DATA_PTR_POS_IN_NDARRAY);
-    std::vector<int> grad_ptr_idx = key;
-    grad_ptr_idx.push_back(TypeFactory::GRAD_PTR_POS_IN_NDARRAY);
+  // The binding itself is left untouched so that |ctx| can be launched again.
+  const auto &slots = ctx.get_parameter_layout().slots;
+  for (int i = 0; i < (int)slots.size(); i++) {
+    const auto &key = slots[i].indices;
+    const auto &parameter = slots[i].parameter;
+    auto &binding = ctx.get_binding(i);
 
-    if (parameter.is_array && ctx.device_allocation_type[key] ==
+    if (parameter.is_array && binding.device_allocation_type ==
                                   LaunchContextBuilder::DevAllocType::kNone) {
-      ctx.set_ndarray_ptrs(key, (uint64)ctx.array_ptrs[data_ptr_idx],
-                           (uint64)ctx.array_ptrs[grad_ptr_idx]);
+      ctx.set_ndarray_ptrs(i, (uint64)binding.data_ptr,
+                           (uint64)binding.grad_ptr);
     }
     if (parameter.is_array &&
-        ctx.device_allocation_type[key] !=
+        binding.device_allocation_type !=
             LaunchContextBuilder::DevAllocType::kNone &&
-        ctx.array_runtime_sizes[key] > 0) {
-      DeviceAllocation *ptr =
-          static_cast<DeviceAllocation *>(ctx.array_ptrs[data_ptr_idx]);
+        binding.runtime_size > 0) {
+      DeviceAllocation *ptr = static_cast<DeviceAllocation *>(binding.data_ptr);
       uint64 host_ptr = (uint64)executor->get_device_alloc_info_ptr(*ptr);
-      ctx.set_array_device_allocation_type(
-          key, LaunchContextBuilder::DevAllocType::kNone);
 
-      auto grad_ptr = ctx.array_ptrs[grad_ptr_idx];
+      auto grad_ptr = binding.grad_ptr;
       uint64 host_ptr_grad =
           grad_ptr == nullptr ? 0
                               : (uint64)executor->get_device_alloc_info_ptr(
                                     *static_cast<DeviceAllocation *>(grad_ptr));
-      ctx.set_ndarray_ptrs(key, host_ptr, host_ptr_grad);
+      ctx.set_ndarray_ptrs(i, host_ptr, host_ptr_grad);
     }
     if (parameter.is_argpack) {
-      data_ptr_idx = key;
-      data_ptr_idx.push_back(TypeFactory::DATA_PTR_POS_IN_ARGPACK);
-      auto *argpack = ctx.argpack_ptrs[key];
+      auto *argpack = binding.argpack;
       auto argpack_ptr = argpack->get_device_allocation();
       uint64 host_ptr =
           (uint64)executor->get_device_alloc_info_ptr(argpack_ptr);
       if (key.size() == 1) {
-        ctx.set_argpack_ptr(key, host_ptr);
+        ctx.set_argpack_ptr(i, host_ptr);
       } else {
         auto key_parent = key;
         key_parent.pop_back();
-        auto *argpack_parent = ctx.argpack_ptrs[key_parent];
+        auto *argpack_parent = ctx.get_binding(key_parent).argpack;
         argpack_parent->set_arg_nested_argpack_ptr(key.back(), host_ptr);
       }
     }
@@ -80,7 +72,6 @@ KernelLauncher::Handle KernelLauncher::register_llvm_kernel(
     auto *executor = get_runtime_executor();
 
     auto data = compiled.get_internal_data().compiled_data.clone();
-    auto parameters = compiled.get_internal_data().args;
     auto *jit_module = executor->create_jit_module(std::move(data.module));
 
     // Construct task_funcs
@@ -95,7 +86,6 @@ KernelLauncher::Handle KernelLauncher::register_llvm_kernel(
     }
 
     // Populate ctx
-    ctx.parameters = std::move(parameters);
     ctx.task_funcs = std::move(task_funcs);
 
     compiled.set_handle(handle);
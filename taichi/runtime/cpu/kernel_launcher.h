@@ -12,7 +12,6 @@ class KernelLauncher : public LLVM::KernelLauncher {
   struct Context {
     using TaskFunc = int32 (*)(void *);
     std::vector<TaskFunc> task_funcs;
-    std::vector<std::pair<std::vector<int>, Callable::Parameter>> parameters;
   };
 
  public:
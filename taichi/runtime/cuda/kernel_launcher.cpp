@@ -15,35 +15,26 @@ bool KernelLauncher::on_cuda_device(void *ptr) {
 void KernelLauncher::launch_llvm_kernel(Handle handle,
                                         LaunchContextBuilder &ctx) {
   TI_ASSERT(handle.get_launch_id() < contexts_.size());
-  auto launcher_ctx = contexts_[handle.get_launch_id()];
+  const auto &launcher_ctx = contexts_[handle.get_launch_id()];
   auto *executor = get_runtime_executor();
   auto *cuda_module = launcher_ctx.jit_module;
-  const auto &parameters = launcher_ctx.parameters;
   const auto &offloaded_tasks = launcher_ctx.offloaded_tasks;
 
   CUDAContext::get_instance().make_current();
 
   // |transfers| is only used for external arrays whose data is originally on
-  // host. They are first transferred onto device and that device pointer is
-  // stored in |device_ptrs| below. |transfers| saves its original pointer so
-  // that we can copy the data back once kernel finishes. as well as the
-  // temporary device allocations, which can be freed after kernel finishes. Key
-  // is [arg_id, ptr_pos], where ptr_pos is TypeFactory::DATA_PTR_POS_IN_NDARRAY
-  // for data_ptr and TypeFactory::GRAD_PTR_POS_IN_NDARRAY for grad_ptr. Value
-  // is [host_ptr, temporary_device_alloc]. Invariant: temp_devallocs.size() !=
-  // 0 <==> transfer happened.
-  std::unordered_map<std::vector<int>, std::pair<void *, DeviceAllocation>,
-                     hashing::Hasher<std::vector<int>>>
-      transfers;
-
-  // |device_ptrs| stores pointers on device for all arrays args, including
-  // external arrays and ndarrays, no matter whether the data is originally on
-  // device or host.
-  // This is the source of truth for us to look for device pointers used in CUDA
-  // kernels.
-  std::unordered_map<std::vector<int>, void *,
-                     hashing::Hasher<std::vector<int>>>
-      device_ptrs;
+  // host. They are first transferred onto device, and the device pointer is
+  // bound to the argument instead. Each transfer saves the original host
+  // pointer so that we can copy the data back once the kernel finishes, as well
+  // as the temporary device allocation, which can be freed afterwards.
+  // Invariant: transfers.size() != 0 <==> transfer happened.
+  struct Transfer {
+    void *host_ptr;
+    void *device_ptr;
+    DeviceAllocation devalloc;
+    uint64 size;
+  };
+  std::vector<Transfer> transfers;
 
   char *device_result_buffer{nullptr};
   CUDADriver::get_instance().malloc_async(
@@ -51,12 +42,23 @@ void KernelLauncher::launch_llvm_kernel(Handle handle,
       std::max(ctx.result_buffer_size, sizeof(uint64)), nullptr);
   ctx.get_context().runtime = executor->get_llvm_runtime();
 
-  for (int i = 0; i < (int)parameters.size(); i++) {
-    const auto &kv = parameters[i];
-    const auto &key = kv.first;
-    const auto &parameter = kv.second;
+  auto copy_to_device = [&](void *host_ptr, uint64 size) {
+    DeviceAllocation devalloc = executor->allocate_memory_on_device(
+        size, (uint64 *)device_result_buffer);
+    void *device_ptr = executor->get_device_alloc_info_ptr(devalloc);
+    transfers.push_back({host_ptr, device_ptr, devalloc, size});
+    CUDADriver::get_instance().memcpy_host_to_device(device_ptr, host_ptr,
+                                                     size);
+    return device_ptr;
+  };
+
+  const auto &slots = ctx.get_parameter_layout().slots;
+  for (int i = 0; i < (int)slots.size(); i++) {
+    const auto &key = slots[i].indices;
+    const auto &parameter = slots[i].parameter;
+    auto &binding = ctx.get_binding(i);
     if (parameter.is_array) {
-      const auto arr_sz = ctx.array_runtime_sizes[key];
+      const auto arr_sz = binding.runtime_size;
       // Note: both numpy and PyTorch support arrays/tensors with zeros
       // in shapes, e.g., shape=(0) or shape=(100, 0, 200). This makes
       // `arr_sz` zero.
@@ -64,78 +66,49 @@ void KernelLauncher::launch_llvm_kernel(Handle handle,
         continue;
       }
 
-      std::vector<int> data_ptr_idx = key;
-      data_ptr_idx.push_back(TypeFactory::DATA_PTR_POS_IN_NDARRAY);
-      auto data_ptr = ctx.array_ptrs[data_ptr_idx];
-      std::vector<int> grad_ptr_idx = key;
-      grad_ptr_idx.push_back(TypeFactory::GRAD_PTR_POS_IN_NDARRAY);
-
-      auto grad_ptr = ctx.array_ptrs[grad_ptr_idx];
-      if (ctx.device_allocation_type[key] ==
+      auto data_ptr = binding.data_ptr;
+      auto grad_ptr = binding.grad_ptr;
+      // Pointers on device, no matter whether the data is originally on
+      // device or host. These are what the CUDA kernels use.
+      void *device_data_ptr = nullptr;
+      void *device_grad_ptr = nullptr;
+      if (binding.device_allocation_type ==
           LaunchContextBuilder::DevAllocType::kNone) {
         // External array
         // Note: assuming both data & grad are on the same device
         if (on_cuda_device(data_ptr)) {
           // data_ptr is a raw ptr on CUDA device
-          device_ptrs[data_ptr_idx] = data_ptr;
-          device_ptrs[grad_ptr_idx] = grad_ptr;
+          device_data_ptr = data_ptr;
+          device_grad_ptr = grad_ptr;
         } else {
-          DeviceAllocation devalloc = executor->allocate_memory_on_device(
-              arr_sz, (uint64 *)device_result_buffer);
-          device_ptrs[data_ptr_idx] =
-              executor->get_device_alloc_info_ptr(devalloc);
-          transfers[data_ptr_idx] = {data_ptr, devalloc};
-
-          CUDADriver::get_instance().memcpy_host_to_device(
-              (void *)device_ptrs[data_ptr_idx], data_ptr, arr_sz);
+          device_data_ptr = copy_to_device(data_ptr, arr_sz);
           if (grad_ptr != nullptr) {
-            DeviceAllocation grad_devalloc =
-                executor->allocate_memory_on_device(
-                    arr_sz, (uint64 *)device_result_buffer);
-            device_ptrs[grad_ptr_idx] =
-                executor->get_device_alloc_info_ptr(grad_devalloc);
-            transfers[grad_ptr_idx] = {grad_ptr, grad_devalloc};
-
-            CUDADriver::get_instance().memcpy_host_to_device(
-                (void *)device_ptrs[grad_ptr_idx], grad_ptr, arr_sz);
-          } else {
-            device_ptrs[grad_ptr_idx] = nullptr;
+            device_grad_ptr = copy_to_device(grad_ptr, arr_sz);
           }
         }
-
-        ctx.set_ndarray_ptrs(key, (uint64)device_ptrs[data_ptr_idx],
-                             (uint64)device_ptrs[grad_ptr_idx]);
-      } else if (arr_sz > 0) {
+      } else {
         // Ndarray
         DeviceAllocation *ptr = static_cast<DeviceAllocation *>(data_ptr);
         // Unwrapped raw ptr on device
-        device_ptrs[data_ptr_idx] = executor->get_device_alloc_info_ptr(*ptr);
+        device_data_ptr = executor->get_device_alloc_info_ptr(*ptr);
 
         if (grad_ptr != nullptr) {
           ptr = static_cast<DeviceAllocation *>(grad_ptr);
-          device_ptrs[grad_ptr_idx] = executor->get_device_alloc_info_ptr(*ptr);
-        } else {
-          device_ptrs[grad_ptr_idx] = nullptr;
+          device_grad_ptr = executor->get_device_alloc_info_ptr(*ptr);
         }
-
-        ctx.set_ndarray_ptrs(key, (uint64)device_ptrs[data_ptr_idx],
-                             (uint64)device_ptrs[grad_ptr_idx]);
       }
+      ctx.set_ndarray_ptrs(i, (uint64)device_data_ptr, (uint64)device_grad_ptr);
     } else if (parameter.is_argpack) {
-      std::vector<int> data_ptr_idx = key;
-      data_ptr_idx.push_back(TypeFactory::DATA_PTR_POS_IN_ARGPACK);
-      auto *argpack = ctx.argpack_ptrs[key];
-      auto argpack_ptr = argpack->get_device_allocation();
-      device_ptrs[data_ptr_idx] =
-          executor->get_device_alloc_info_ptr(argpack_ptr);
+      auto argpack_ptr = binding.argpack->get_device_allocation();
+      auto device_ptr =
+          (uint64)executor->get_device_alloc_info_ptr(argpack_ptr);
       if (key.size() == 1) {
-        ctx.set_argpack_ptr(key, (uint64)device_ptrs[data_ptr_idx]);
+        ctx.set_argpack_ptr(i, device_ptr);
       } else {
         auto key_parent = key;
         key_parent.pop_back();
-        auto *argpack_parent = ctx.argpack_ptrs[key_parent];
-        argpack_parent->set_arg_nested_argpack_ptr(
-            key.back(), (uint64)device_ptrs[data_ptr_idx]);
+        auto *argpack_parent = ctx.get_binding(key_parent).argpack;
+        argpack_parent->set_arg_nested_argpack_ptr(key.back(), device_ptr);
       }
     }
   }
@@ -146,6 +119,7 @@ void KernelLauncher::launch_llvm_kernel(Handle handle,
   if (ctx.result_buffer_size > 0) {
     ctx.get_context().result_buffer = (uint64 *)device_result_buffer;
   }
+  char *host_arg_buffer = ctx.get_context().arg_buffer;
   char *device_arg_buffer = nullptr;
   if (ctx.arg_buffer_size > 0) {
     CUDADriver::get_instance().malloc_async((void **)&device_arg_buffer,
@@ -162,6 +136,9 @@ void KernelLauncher::launch_llvm_kernel(Handle handle,
     cuda_module->launch(task.name, task.grid_dim, task.block_dim, 0,
                         {&ctx.get_context()}, {});
   }
+  // Point |ctx| back to its host buffers so that it can be launched again.
+  ctx.get_context().arg_buffer = host_arg_buffer;
+  ctx.get_context().result_buffer = (uint64 *)host_result_buffer;
   if (ctx.arg_buffer_size > 0) {
     CUDADriver::get_instance().mem_free_async(device_arg_buffer, nullptr);
   }
@@ -174,14 +151,10 @@ void KernelLauncher::launch_llvm_kernel(Handle handle,
   // copy data back to host
   if (transfers.size() > 0) {
     CUDADriver::get_instance().stream_synchronize(nullptr);
-    for (auto itr = transfers.begin(); itr != transfers.end(); itr++) {
-      auto &idx = itr->first;
-      auto arg_id = idx;
-      arg_id.pop_back();
+    for (const auto &transfer : transfers) {
       CUDADriver::get_instance().memcpy_device_to_host(
-          itr->second.first, (void *)device_ptrs[idx],
-          ctx.array_runtime_sizes[arg_id]);
-      executor->deallocate_memory_on_device(itr->second.second);
+          transfer.host_ptr, transfer.device_ptr, transfer.size);
+      executor->deallocate_memory_on_device(transfer.devalloc);
     }
   }
 }
@@ -199,12 +172,10 @@ KernelLauncher::Handle KernelLauncher::register_llvm_kernel(
     auto *executor = get_runtime_executor();
 
     auto data = compiled.get_internal_data().compiled_data.clone();
-    auto parameters = compiled.get_internal_data().args;
     auto *jit_module = executor->create_jit_module(std::move(data.module));
 
     // Populate ctx
     ctx.jit_module = jit_module;
-    ctx.parameters = std::move(parameters);
     ctx.offloaded_tasks = std::move(data.tasks);
 
     compiled.set_handle(handle);
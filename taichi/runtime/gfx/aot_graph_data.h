@@ -12,6 +12,13 @@ class KernelImpl : public aot::Kernel {
     ret_size = params_.kernel_attribs.ctx_attribs.rets_bytes();
     args_type = params_.kernel_attribs.ctx_attribs.args_type();
     args_size = params_.kernel_attribs.ctx_attribs.args_bytes();
+    // The launch context builder addresses arguments by parameter slot.
+    for (const auto &[indices, attribs] :
+         params_.kernel_attribs.ctx_attribs.args()) {
+      nested_parameters[indices] =
+          Parameter(PrimitiveType::get(attribs.dtype), attribs.is_array,
+                    attribs.is_argpack);
+    }
     arch = Arch::vulkan;  // Only for letting the launch context builder know
                           // the arch does not use LLVM.
                           // TODO: remove arch after the refactoring of
@@ -58,18 +58,18 @@ class HostDeviceContextBlitter {
     TI_ASSERT(device_->map(*device_args_buffer_, &device_base) ==
               RhiResult::success);
 
-    for (int i = 0; i < ctx_attribs_->args().size(); ++i) {
-      const auto &arg_kv = ctx_attribs_->args()[i];
-      const auto &indices = arg_kv.first;
-      const auto &arg = arg_kv.second;
-      if (arg.is_array) {
-        if (host_ctx_.device_allocation_type[indices] ==
+    const auto &slots = host_ctx_.get_parameter_layout().slots;
+    for (int i = 0; i < slots.size(); ++i) {
+      const auto &indices = slots[i].indices;
+      const auto &binding = host_ctx_.get_binding(i);
+      if (slots[i].parameter.is_array) {
+        if (binding.device_allocation_type ==
                 LaunchContextBuilder::DevAllocType::kNone &&
             ext_arr_size.at(indices)) {
           // Only need to blit ext arrs (host array)
           auto access_it = std::find_if(ctx_attribs_->arr_access.begin(),
                                         ctx_attribs_->arr_access.end(),
-                                        [indices](const auto &pair) -> bool {
+                                        [&indices](const auto &pair) -> bool {
                                           return pair.first == indices;
                                         });
           TI_ASSERT(access_it != ctx_attribs_->arr_access.end());
@@ -79,27 +79,22 @@ class HostDeviceContextBlitter {
             void *device_arr_ptr{nullptr};
             TI_ASSERT(device_->map(buffer, &device_arr_ptr) ==
                       RhiResult::success);
-            auto data_ptr_idx = indices;
-            data_ptr_idx.push_back(TypeFactory::DATA_PTR_POS_IN_NDARRAY);
-            const void *host_ptr = host_ctx_.array_ptrs[data_ptr_idx];
-            std::memcpy(device_arr_ptr, host_ptr, ext_arr_size.at(indices));
+            std::memcpy(device_arr_ptr, binding.data_ptr,
+                        ext_arr_size.at(indices));
             device_->unmap(buffer);
           }
         }
         // Substitute in the device address.
 
-        if ((host_ctx_.device_allocation_type[indices] ==
+        if ((binding.device_allocation_type ==
                  LaunchContextBuilder::DevAllocType::kNone ||
-             host_ctx_.device_allocation_type[indices] ==
+             binding.device_allocation_type ==
                  LaunchContextBuilder::DevAllocType::kNdarray) &&
             device_->get_caps().get(
                 DeviceCapability::spirv_has_physical_storage_buffer)) {
           uint64_t addr =
               device_->get_memory_physical_pointer(ext_arrays.at(indices));
-          auto grad_ptr_idx = indices;
-          grad_ptr_idx.push_back(TypeFactory::GRAD_PTR_POS_IN_NDARRAY);
-          host_ctx_.set_ndarray_ptrs(
-              indices, addr, (uint64)host_ctx_.array_ptrs[grad_ptr_idx]);
+          host_ctx_.set_ndarray_ptrs(i, addr, (uint64)binding.grad_ptr);
         }
       }
     }
@@ -128,17 +123,17 @@ class HostDeviceContextBlitter {
     std::vector<void *> readback_host_ptrs;
     std::vector<size_t> readback_sizes;
 
-    for (int i = 0; i < ctx_attribs_->args().size(); ++i) {
-      const auto &kv = ctx_attribs_->args()[i];
-      const auto &indices = kv.first;
-      const auto &arg = kv.second;
-      if (arg.is_array &&
-          host_ctx_.device_allocation_type[indices] ==
+    const auto &slots = host_ctx_.get_parameter_layout().slots;
+    for (int i = 0; i < slots.size(); ++i) {
+      const auto &indices = slots[i].indices;
+      const auto &binding = host_ctx_.get_binding(i);
+      if (slots[i].parameter.is_array &&
+          binding.device_allocation_type ==
               LaunchContextBuilder::DevAllocType::kNone &&
           ext_arr_size.at(indices)) {
         auto access_it = std::find_if(ctx_attribs_->arr_access.begin(),
                                       ctx_attribs_->arr_access.end(),
-                                      [indices](const auto &pair) -> bool {
+                                      [&indices](const auto &pair) -> bool {
                                         return pair.first == indices;
                                       });
         TI_ASSERT(access_it != ctx_attribs_->arr_access.end());
@@ -146,9 +141,7 @@ class HostDeviceContextBlitter {
         if (access & uint32_t(irpass::ExternalPtrAccess::WRITE)) {
           // Only need to blit ext arrs (host array)
           readback_dev_ptrs.push_back(ext_arrays.at(indices).get_ptr(0));
-          auto data_ptr_idx = indices;
-          data_ptr_idx.push_back(TypeFactory::DATA_PTR_POS_IN_NDARRAY);
-          readback_host_ptrs.push_back(host_ctx_.array_ptrs[data_ptr_idx]);
+          readback_host_ptrs.push_back(binding.data_ptr);
           // TODO: readback grad_ptrs as well once ndarray ad is supported
           readback_sizes.push_back(ext_arr_size.at(indices));
           require_sync = true;
@@ -420,45 +413,40 @@ void GfxRuntime::launch_kernel(KernelHandle handle,
     TI_ASSERT(ti_kernel->get_args_buffer_size() ||
               ti_kernel->get_ret_buffer_size());
 
-    const auto &args = ti_kernel->ti_kernel_attribs().ctx_attribs.args();
-    for (auto &kv : args) {
-      const auto &indices = kv.first;
-      const auto &arg = kv.second;
+    // The kernel's context attributes and its parameter layout are both built
+    // from its nested parameters, so walk the slots of the latter.
+    const auto &slots = host_ctx.get_parameter_layout().slots;
+    for (int i = 0; i < slots.size(); ++i) {
+      const auto &indices = slots[i].indices;
+      const auto &arg = slots[i].parameter;
+      const auto &binding = host_ctx.get_binding(i);
       if (arg.is_array) {
-        if (host_ctx.device_allocation_type[indices] !=
-            LaunchContextBuilder::DevAllocType::kNone) {
+        const auto alloc_type = binding.device_allocation_type;
+        if (alloc_type != LaunchContextBuilder::DevAllocType::kNone) {
           DeviceAllocation devalloc = kDeviceNullAllocation;
-          auto data_ptr_indices = indices;
-          data_ptr_indices.push_back(TypeFactory::DATA_PTR_POS_IN_NDARRAY);
-          // NDArray
-          if (host_ctx.array_ptrs.count(data_ptr_indices)) {
-            devalloc =
-                *(DeviceAllocation *)(host_ctx.array_ptrs[data_ptr_indices]);
-          }
-          // Texture
-          if (host_ctx.array_ptrs.count(indices)) {
-            devalloc = *(DeviceAllocation *)(host_ctx.array_ptrs[indices]);
+          // NDArray or texture
+          if (binding.data_ptr) {
+            devalloc = *(DeviceAllocation *)binding.data_ptr;
           }
 
-          if (host_ctx.device_allocation_type[indices] ==
-              LaunchContextBuilder::DevAllocType::kNdarray) {
+          if (alloc_type == LaunchContextBuilder::DevAllocType::kNdarray) {
             any_arrays[indices] = devalloc;
             ndarrays_in_use_.insert(devalloc.alloc_id);
-          } else if (host_ctx.device_allocation_type[indices] ==
+          } else if (alloc_type ==
                      LaunchContextBuilder::DevAllocType::kTexture) {
             textures[indices] = devalloc;
-          } else if (host_ctx.device_allocation_type[indices] ==
+          } else if (alloc_type ==
                      LaunchContextBuilder::DevAllocType::kRWTexture) {
             textures[indices] = devalloc;
           } else {
             TI_NOT_IMPLEMENTED;
           }
         } else {
-          ext_array_size[indices] = host_ctx.array_runtime_sizes[indices];
-          auto arr_access =
+          ext_array_size[indices] = binding.runtime_size;
+          const auto &arr_access =
               ti_kernel->ti_kernel_attribs().ctx_attribs.arr_access;
           auto access_it = std::find_if(arr_access.begin(), arr_access.end(),
-                                        [indices](const auto &pair) -> bool {
+                                        [&indices](const auto &pair) -> bool {
                                           return pair.first == indices;
                                         });
           TI_ASSERT(access_it != arr_access.end());
@@ -477,17 +465,18 @@ void GfxRuntime::launch_kernel(KernelHandle handle,
       }
     }
 
-    auto argpack_types =
-        ti_kernel->ti_kernel_attribs().ctx_attribs.argpack_types();
-    for (const auto &kv : argpack_types) {
-      const auto &indices = kv.first;
-      TI_ASSERT(host_ctx.device_allocation_type[indices] ==
+    for (int i = 0; i < slots.size(); ++i) {
+      if (!slots[i].parameter.is_argpack) {
+        continue;
+      }
+      const auto &binding = host_ctx.get_binding(i);
+      TI_ASSERT(binding.device_allocation_type ==
                 LaunchContextBuilder::DevAllocType::kArgPack);
-      TI_ASSERT(host_ctx.argpack_ptrs.count(indices));
-      const ArgPack *argpack = host_ctx.argpack_ptrs[indices];
+      const ArgPack *argpack = binding.argpack;
+      TI_ASSERT(argpack);
       DeviceAllocation devalloc = argpack->get_device_allocation();
       argpacks_in_use_.insert(devalloc.alloc_id);
-      argpacks[indices] = argpack;
+      argpacks[slots[i].indices] = argpack;
     }
 
     ctx_blitter->host_to_device(any_arrays, ext_array_size, argpacks);
@@ -679,8 +679,11 @@ void TaichiLLVMContext::add_struct_module(std::unique_ptr<Module> module,
     TI_ERROR("module broken");
   }
 
-  linking_context_data->struct_modules[tree_id] =
-      clone_module_to_context(module.get(), linking_context_data->llvm_context);
+  {
+    std::lock_guard<std::mutex> _(linking_context_mut);
+    linking_context_data->struct_modules[tree_id] = clone_module_to_context(
+        module.get(), linking_context_data->llvm_context);
+  }
 
   for (auto &[id, data] : per_thread_data_) {
     if (id == std::this_thread::get_id()) {
@@ -787,6 +790,86 @@ int TaichiLLVMContext::num_instructions(llvm::Function *func) {
   return counter;
 }
 
+bool TaichiLLVMContext::is_shared_runtime_function(
+    const llvm::Function &func) const {
+  // Every runtime function is marked inline when the runtime module is
+  // loaded, unless it calls mark_force_no_inline().
+  return arch_is_cpu(arch_) && !func.isDeclaration() &&
+         !func.hasLocalLinkage() &&
+         !func.hasFnAttribute(llvm::Attribute::AlwaysInline);
+}
+
+std::unique_ptr<llvm::Module> TaichiLLVMContext::clone_needed_definitions(
+    const llvm::Module &src,
+    const llvm::Module &dest,
+    const std::vector<std::string> &roots,
+    bool is_runtime_module) {
+  TI_AUTO_PROF
+  std::unordered_set<const llvm::GlobalValue *> needed;
+  std::unordered_set<const llvm::Constant *> visited_constants;
+  std::vector<const llvm::GlobalValue *> worklist;
+  auto is_shared = [&](const llvm::GlobalValue *val) {
+    auto *func = llvm::dyn_cast<llvm::Function>(val);
+    return is_runtime_module && func && is_shared_runtime_function(*func);
+  };
+  auto require = [&](const llvm::GlobalValue *val) {
+    if (val && needed.insert(val).second) {
+      worklist.push_back(val);
+    }
+  };
+  std::function<void(const llvm::Value *)> visit =
+      [&](const llvm::Value *val) {
+        if (auto *global = llvm::dyn_cast<llvm::GlobalValue>(val)) {
+          require(global);
+        } else if (auto *c = llvm::dyn_cast<llvm::Constant>(val)) {
+          if (visited_constants.insert(c).second) {
+            for (auto &op : c->operands()) {
+              visit(op);
+            }
+          }
+        }
+      };
+
+  for (auto &val : dest.global_values()) {
+    if (val.isDeclaration()) {
+      require(src.getNamedValue(val.getName()));
+    }
+  }
+  for (auto &name : roots) {
+    require(src.getNamedValue(name));
+  }
+  while (!worklist.empty()) {
+    auto *val = worklist.back();
+    worklist.pop_back();
+    if (val->isDeclaration() || is_shared(val)) {
+      continue;
+    }
+    if (auto *func = llvm::dyn_cast<llvm::Function>(val)) {
+      if (func->hasPersonalityFn()) {
+        visit(func->getPersonalityFn());
+      }
+      for (auto &bb : *func) {
+        for (auto &inst : bb) {
+          for (auto &op : inst.operands()) {
+            visit(op);
+          }
+        }
+      }
+    } else if (auto *var = llvm::dyn_cast<llvm::GlobalVariable>(val)) {
+      if (var->hasInitializer()) {
+        visit(var->getInitializer());
+      }
+    } else if (auto *alias = llvm::dyn_cast<llvm::GlobalAlias>(val)) {
+      visit(alias->getAliasee());
+    }
+  }
+
+  llvm::ValueToValueMapTy vmap;
+  return llvm::CloneModule(src, vmap, [&](const llvm::GlobalValue *val) {
+    return needed.count(val) && !is_shared(val);
+  });
+}
+
 void TaichiLLVMContext::print_huge_functions(llvm::Module *module) {
   int total_inst = 0;
   int total_big_inst = 0;
@@ -959,9 +1042,18 @@ void TaichiLLVMContext::init_runtime_module(llvm::Module *runtime_module) {
 #endif
   }
 
-  eliminate_unused_functions(runtime_module, [](std::string func_name) {
+  // Kernels call the shared runtime functions by symbol, so they must stay
+  // exported from the runtime JIT module.
+  std::unordered_set<std::string> shared_functions;
+  for (auto &f : *runtime_module) {
+    if (is_shared_runtime_function(f)) {
+      shared_functions.insert(f.getName().str());
+    }
+  }
+  eliminate_unused_functions(runtime_module, [&](std::string func_name) {
     return starts_with(func_name, "runtime_") ||
-           starts_with(func_name, "LLVMRuntime_");
+           starts_with(func_name, "LLVMRuntime_") ||
+           shared_functions.count(func_name);
   });
 }
 
@@ -1054,11 +1146,19 @@ LLVMCompiledKernel TaichiLLVMContext::link_compiled_tasks(
   }
   for (auto tree_id : used_tree_ids) {
     linker.linkInModule(
-        llvm::CloneModule(*linking_context_data->struct_modules[tree_id]),
+        clone_needed_definitions(*linking_context_data->struct_modules[tree_id],
+                                 *mod, {}, /*is_runtime_module=*/false),
         llvm::Linker::LinkOnlyNeeded | llvm::Linker::OverrideFromSrc);
   }
+  // Only the runtime functions reachable from the kernel are cloned, and on
+  // CPUs the ones not marked inline are left to the runtime JIT module.
+  std::vector<std::string> runtime_roots;
+  if (!tls_sizes.empty()) {
+    runtime_roots.push_back("parallel_struct_for");
+  }
   auto runtime_module =
-      llvm::CloneModule(*linking_context_data->runtime_module);
+      clone_needed_definitions(*linking_context_data->runtime_module, *mod,
+                               runtime_roots, /*is_runtime_module=*/true);
   for (auto tls_size : tls_sizes) {
     add_struct_for_func(runtime_module.get(), tls_size);
   }
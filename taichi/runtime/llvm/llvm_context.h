@@ -40,6 +40,9 @@ class TaichiLLVMContext {
   // main_thread is defined to be the thread that runs the initializer
 
   std::unique_ptr<ThreadLocalData> linking_context_data{nullptr};
+  // Guards |linking_context_data|, which is shared by all the kernels being
+  // compiled concurrently.
+  std::mutex linking_context_mut;
 
   TaichiLLVMContext(const CompileConfig &config, Arch arch);
 
@@ -143,6 +146,21 @@ class TaichiLLVMContext {
 
   static int num_instructions(llvm::Function *func);
 
+  // Whether kernels call |func| of the runtime module by symbol instead of
+  // carrying a copy of it. Only the CPU JIT links kernels against the shared
+  // runtime module, and only for the functions that are not marked inline.
+  bool is_shared_runtime_function(const llvm::Function &func) const;
+
+  // Clones the definitions in |src| needed by the declarations in |dest| and
+  // by |roots|, following their references. Everything else in |src| is
+  // cloned as declarations only, so that cloning and linking scale with the
+  // kernel rather than with |src|.
+  std::unique_ptr<llvm::Module> clone_needed_definitions(
+      const llvm::Module &src,
+      const llvm::Module &dest,
+      const std::vector<std::string> &roots,
+      bool is_runtime_module);
+
   void insert_nvvm_annotation(llvm::Function *func, std::string key, int val);
 
   std::unique_ptr<llvm::Module> clone_module_to_this_thread_context(
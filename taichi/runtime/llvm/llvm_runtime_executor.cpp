@@ -31,6 +31,29 @@ void *host_allocate_aligned(HostMemoryPool *memory_pool,
   return memory_pool->allocate(size, alignment);
 }
 
+struct FirstTouchContext {
+  char *ptr;
+  std::size_t size;
+  int num_slices;
+};
+
+// Touches the pages of one of |num_slices| equal contiguous slices of the
+// buffer, the way a statically scheduled range-for over it is split between
+// the threads.
+void first_touch_task(void *context, int thread_id, int slice) {
+  auto *ctx = (FirstTouchContext *)context;
+  const auto page_size = HostMemoryPool::page_size;
+  auto slice_begin = [&](int i) {
+    return std::min(ctx->size, iroundup(ctx->size * i / ctx->num_slices,
+                                        page_size));
+  };
+  auto *ptr = (volatile char *)ctx->ptr;
+  for (auto i = slice_begin(slice); i < slice_begin(slice + 1);
+       i += page_size) {
+    ptr[i] = 0;
+  }
+}
+
 }  // namespace
 
 LlvmRuntimeExecutor::LlvmRuntimeExecutor(CompileConfig &config,
@@ -78,13 +101,36 @@ LlvmRuntimeExecutor::LlvmRuntimeExecutor(CompileConfig &config,
   }
 
   snode_tree_buffer_manager_ = std::make_unique<SNodeTreeBufferManager>(this);
-  thread_pool_ = std::make_unique<ThreadPool>(config.cpu_max_num_threads);
+  if (config.cpu_thread_pool == "work_stealing") {
+    work_stealing_thread_pool_ =
+        std::make_unique<WorkStealingThreadPool>(config.cpu_max_num_threads);
+  } else {
+    TI_ERROR_IF(config.cpu_thread_pool != "default",
+                "Unknown cpu_thread_pool \"{}\", expected \"default\" or "
+                "\"work_stealing\"",
+                config.cpu_thread_pool);
+    thread_pool_ = std::make_unique<ThreadPool>(config.cpu_max_num_threads);
+  }
+  if (profiler_ && arch_is_cpu(config.arch)) {
+    // Per-thread busy time and block counts of the offloaded tasks
+    auto *stats = profiler_->get_thread_pool_stats(config.cpu_max_num_threads);
+    if (work_stealing_thread_pool_) {
+      work_stealing_thread_pool_->set_stats(stats);
+    } else {
+      thread_pool_->set_stats(stats);
+    }
+  }
 
   llvm_runtime_ = nullptr;
 
   if (arch_is_cpu(config.arch)) {
     config.max_block_dim = 1024;
     device_ = std::make_shared<cpu::CpuDevice>();
+    HostMemoryPool::get_instance().set_huge_pages(config.cpu_huge_pages);
+    if (config.cpu_numa_first_touch) {
+      HostMemoryPool::get_instance().set_first_touch(
+          [this](void *ptr, std::size_t size) { first_touch(ptr, size); });
+    }
 
   }
 #if defined(TI_WITH_CUDA)
@@ -187,7 +233,7 @@ JITModule *LlvmRuntimeExecutor::get_runtime_jit_module() {
 
 void LlvmRuntimeExecutor::print_list_manager_info(void *list_manager,
                                                   uint64 *result_buffer) {
-  auto list_manager_len = runtime_query<int32>("ListManager_get_num_elements",
+  auto list_manager_len = runtime_query<int64>("ListManager_get_num_elements",
                                                result_buffer, list_manager);
 
   auto element_size = runtime_query<int32>("ListManager_get_element_size",
@@ -197,7 +243,7 @@ void LlvmRuntimeExecutor::print_list_manager_info(void *list_manager,
       runtime_query<int32>("ListManager_get_max_num_elements_per_chunk",
                            result_buffer, list_manager);
 
-  auto num_active_chunks = runtime_query<int32>(
+  auto num_active_chunks = runtime_query<int64>(
       "ListManager_get_num_active_chunks", result_buffer, list_manager);
 
   auto size_MB = 1e-6f * num_active_chunks * elements_per_chunk * element_size;
@@ -254,6 +300,12 @@ uint64 LlvmRuntimeExecutor::fetch_result_uint64(int i, uint64 *result_buffer) {
   return ret;
 }
 
+HostCachingAllocator::Stats LlvmRuntimeExecutor::get_caching_allocator_stats() {
+  TI_ERROR_IF(!arch_is_cpu(config_.arch),
+              "The caching allocator is only used on CPUs");
+  return llvm_device()->as<cpu::CpuDevice>()->get_caching_allocator_stats();
+}
+
 std::size_t LlvmRuntimeExecutor::get_snode_num_dynamically_allocated(
     SNode *snode,
     uint64 *result_buffer) {
@@ -262,11 +314,9 @@ std::size_t LlvmRuntimeExecutor::get_snode_num_dynamically_allocated(
   auto node_allocator =
       runtime_query<void *>("LLVMRuntime_get_node_allocators", result_buffer,
                             llvm_runtime_, snode->id);
-  auto data_list = runtime_query<void *>("NodeManager_get_data_list",
-                                         result_buffer, node_allocator);
 
-  return (std::size_t)runtime_query<int32>("ListManager_get_num_elements",
-                                           result_buffer, data_list);
+  return (std::size_t)runtime_query<int64>(
+      "NodeManager_get_num_allocated_elements", result_buffer, node_allocator);
 }
 
 void LlvmRuntimeExecutor::check_runtime_error(uint64 *result_buffer) {
@@ -345,13 +395,13 @@ void LlvmRuntimeExecutor::print_memory_profiler_info(
           auto recycled_list = runtime_query<void *>(
               "NodeManager_get_recycled_list", result_buffer, node_allocator);
 
-          auto free_list_len = runtime_query<int32>(
+          auto free_list_len = runtime_query<int64>(
               "ListManager_get_num_elements", result_buffer, free_list);
 
-          auto recycled_list_len = runtime_query<int32>(
+          auto recycled_list_len = runtime_query<int64>(
               "ListManager_get_num_elements", result_buffer, recycled_list);
 
-          auto free_list_used = runtime_query<int32>(
+          auto free_list_used = runtime_query<int64>(
               "NodeManager_get_free_list_used", result_buffer, node_allocator);
 
           auto data_list = runtime_query<void *>("NodeManager_get_data_list",
@@ -546,8 +596,36 @@ uint64_t *LlvmRuntimeExecutor::get_device_alloc_info_ptr(
       .ptr;
 }
 
+void LlvmRuntimeExecutor::first_touch(void *ptr, std::size_t size) {
+  // The work-stealing pool hands task i to worker i unless it is stolen,
+  // while the default pool hands tasks to whichever worker asks first.
+  FirstTouchContext ctx{(char *)ptr, size, config_.cpu_max_num_threads};
+  run_cpu_tasks(ctx.num_slices, &ctx, first_touch_task);
+}
+
+void LlvmRuntimeExecutor::run_cpu_tasks(int num_tasks,
+                                        void *context,
+                                        RangeForTaskFunc *func) {
+  TI_ASSERT(arch_is_cpu(config_.arch));
+  int num_threads = std::min(num_tasks, config_.cpu_max_num_threads);
+  if (work_stealing_thread_pool_) {
+    work_stealing_thread_pool_->run(num_tasks, num_threads, context, func);
+  } else {
+    thread_pool_->run(num_tasks, num_threads, context, func);
+  }
+}
+
 void LlvmRuntimeExecutor::finalize() {
   profiler_ = nullptr;
+  if (work_stealing_thread_pool_) {
+    work_stealing_thread_pool_->set_stats(nullptr);
+  } else if (thread_pool_) {
+    thread_pool_->set_stats(nullptr);
+  }
+  if (arch_is_cpu(config_.arch)) {
+    HostMemoryPool::get_instance().set_first_touch(nullptr);
+    HostMemoryPool::get_instance().set_huge_pages(false);
+  }
   if (config_.arch == Arch::cuda || config_.arch == Arch::amdgpu) {
     preallocated_runtime_objects_allocs_.reset();
     preallocated_runtime_memory_allocs_.reset();
@@ -734,9 +812,18 @@ void LlvmRuntimeExecutor::materialize_runtime(KernelProfilerBase *profiler,
   }
 
   if (arch_use_host_memory(config_.arch)) {
-    runtime_jit->call<void *, void *, void *>(
-        "LLVMRuntime_initialize_thread_pool", llvm_runtime_, thread_pool_.get(),
-        (void *)ThreadPool::static_run);
+    if (work_stealing_thread_pool_) {
+      runtime_jit->call<void *, void *, void *, int>(
+          "LLVMRuntime_initialize_thread_pool", llvm_runtime_,
+          work_stealing_thread_pool_.get(),
+          (void *)WorkStealingThreadPool::static_run,
+          work_stealing_thread_pool_->get_max_num_threads());
+    } else {
+      runtime_jit->call<void *, void *, void *, int>(
+          "LLVMRuntime_initialize_thread_pool", llvm_runtime_,
+          thread_pool_.get(), (void *)ThreadPool::static_run,
+          thread_pool_->max_num_threads);
+    }
 
     runtime_jit->call<void *, void *>("LLVMRuntime_set_assert_failed",
                                       llvm_runtime_,
@@ -772,6 +859,7 @@ void LlvmRuntimeExecutor::init_runtime_jit_module(
     std::unique_ptr<llvm::Module> module) {
   llvm_context_->init_runtime_module(module.get());
   runtime_jit_module_ = create_jit_module(std::move(module));
+  jit_session_->set_runtime_module(runtime_jit_module_);
 }
 
 }  // namespace taichi::lang
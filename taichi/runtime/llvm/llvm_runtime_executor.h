@@ -5,6 +5,7 @@
 
 #ifdef TI_WITH_LLVM
 
+#include "taichi/rhi/common/host_caching_allocator.h"
 #include "taichi/rhi/llvm/llvm_device.h"
 #include "taichi/runtime/llvm/llvm_offline_cache.h"
 #include "taichi/runtime/llvm/snode_tree_buffer_manager.h"
@@ -134,10 +135,18 @@ class LlvmRuntimeExecutor {
   void destroy_snode_tree(SNodeTree *snode_tree);
   std::size_t get_snode_num_dynamically_allocated(SNode *snode,
                                                   uint64 *result_buffer);
+  HostCachingAllocator::Stats get_caching_allocator_stats();
+
+  // Runs |func| for the tasks [0, num_tasks) on the CPU thread pool.
+  void run_cpu_tasks(int num_tasks, void *context, RangeForTaskFunc *func);
 
   void init_runtime_jit_module(std::unique_ptr<llvm::Module> module);
 
  private:
+  // Faults in the pages of a new host buffer from the CPU threads, see
+  // CompileConfig::cpu_numa_first_touch.
+  void first_touch(void *ptr, std::size_t size);
+
   CompileConfig &config_;
 
   std::unique_ptr<TaichiLLVMContext> llvm_context_{nullptr};
@@ -145,7 +154,9 @@ class LlvmRuntimeExecutor {
   JITModule *runtime_jit_module_{nullptr};
   void *llvm_runtime_{nullptr};
 
+  // Only one of the pools is created, see CompileConfig::cpu_thread_pool.
   std::unique_ptr<ThreadPool> thread_pool_{nullptr};
+  std::unique_ptr<WorkStealingThreadPool> work_stealing_thread_pool_{nullptr};
   std::shared_ptr<Device> device_{nullptr};
 
   std::unique_ptr<SNodeTreeBufferManager> snode_tree_buffer_manager_{nullptr};
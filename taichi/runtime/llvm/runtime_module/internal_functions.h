@@ -77,6 +77,33 @@ i32 test_list_manager(RuntimeContext *context) {
   return 0;
 }
 
+i32 test_list_manager_64bit(RuntimeContext *context) {
+  auto runtime = context->runtime;
+  // 1 MB chunks, so that an element past 2^32 only costs the chunk holding it,
+  // which also lives in a second-level table other than the first one.
+  auto list = context->runtime->create<ListManager>(runtime, 1, 1 << 20);
+  const i64 far = (1LL << 32) + 12345;
+  *list->touch_and_get(far) = 42;
+  TI_TEST_CHECK(list->get<u8>(far) == 42, runtime);
+  TI_TEST_CHECK(list->ptr2index(list->get_element_ptr(far)) == far, runtime);
+  TI_TEST_CHECK(list->get_num_active_chunks() == 1, runtime);
+  list->resize(far + 1);
+  TI_TEST_CHECK(list->size() == far + 1, runtime);
+  // One element per chunk, so that appending crosses a chunk table.
+  constexpr int kN = ListManager::kChunkTableSize + 100;
+  auto many = context->runtime->create<ListManager>(runtime, 4, 1);
+  for (int i = 0; i < kN; i++) {
+    many->push_back(i);
+  }
+  TI_TEST_CHECK(many->size() == kN, runtime);
+  TI_TEST_CHECK(many->get_num_active_chunks() == kN, runtime);
+  for (int i = 0; i < kN; i++) {
+    TI_TEST_CHECK(many->get<i32>(i) == i, runtime);
+    TI_TEST_CHECK(many->ptr2index(many->get_element_ptr(i)) == i, runtime);
+  }
+  return 0;
+}
+
 i32 test_node_allocator(RuntimeContext *context) {
   auto runtime = context->runtime;
   taichi_printf(runtime, "LLVMRuntime %p\n", runtime);
@@ -148,12 +175,48 @@ i32 test_node_allocator_gc_cpu(RuntimeContext *context) {
   }
   nodes->gc_serial();
   // After GC, all items should be returned to |free_list|.
-  taichi_printf(runtime, "free_list_size=%d\n", nodes->free_list->size());
+  taichi_printf(runtime, "free_list_size=%lld\n", nodes->free_list->size());
   TI_TEST_CHECK(nodes->free_list->size() == kN, runtime);
 
   return 0;
 }
 
+i32 test_node_allocator_thread_cache(RuntimeContext *context) {
+  auto runtime = context->runtime;
+  auto nodes = context->runtime->create<NodeManager>(runtime, sizeof(i64), 4);
+  if (nodes->num_thread_caches == 0) {
+    return 0;
+  }
+  constexpr int kN = 40;
+  Ptr ptrs[kN];
+  auto batch = nodes->cache_batch_size;
+  // Fresh elements are reserved a batch at a time from |data_list|, and
+  // handed out in order.
+  for (int i = 0; i < kN; i++) {
+    ptrs[i] = nodes->allocate(context);
+    TI_TEST_CHECK(nodes->locate(ptrs[i]) == i, runtime);
+  }
+  TI_TEST_CHECK(nodes->data_list->size() == (kN + batch - 1) / batch * batch,
+                runtime);
+  // Reserved but unused elements are not counted as allocated.
+  TI_TEST_CHECK(nodes->get_num_allocated_elements() == kN, runtime);
+  // Recycled indices stay in the cache until a batch is full or the GC runs.
+  for (int i = 0; i < kN; i++) {
+    nodes->recycle(ptrs[i], context);
+  }
+  TI_TEST_CHECK(nodes->recycled_list->size() == kN / batch * batch, runtime);
+  nodes->gc_serial();
+  TI_TEST_CHECK(nodes->recycled_list->size() == 0, runtime);
+  TI_TEST_CHECK(nodes->free_list->size() == kN, runtime);
+  // Freed elements are reused before the reservations left in the cache.
+  for (int i = 0; i < kN; i++) {
+    TI_TEST_CHECK(nodes->locate(nodes->allocate(context)) == i, runtime);
+  }
+  TI_TEST_CHECK(nodes->get_num_allocated_elements() == kN, runtime);
+  TI_TEST_CHECK(nodes->locate(nodes->allocate(context)) == kN, runtime);
+  return 0;
+}
+
 i32 test_active_mask(RuntimeContext *context) {
   auto rt = context->runtime;
   taichi_printf(rt, "%d activemask %x\n", thread_idx(), cuda_active_mask());
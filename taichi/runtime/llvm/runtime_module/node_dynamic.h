@@ -3,15 +3,98 @@
 struct DynamicNode {
   i32 lock;
   i32 n;
+  // Chunks are allocated in order, so chunks [0, num_chunks) all exist.
+  i32 num_chunks;
+  // Radix tree indexing the chunks past the first
+  // taichi_dynamic_num_list_chunks, built from blocks of the chunk allocator.
+  // nullptr until it is needed.
+  Ptr chunk_table;
+  // Head of the singly linked list of chunks.
   Ptr ptr;
 };
 
 // Specialized Attributes and functions
 struct DynamicMeta : public StructMeta {
   int chunk_size;
+  // Number of entries in a chunk table block, or 0 if the list is short
+  // enough not to need a chunk table.
+  int chunk_table_fanout;
+  // fanout^(depth - 1), the number of chunks under an entry of the root block.
+  int chunk_table_stride;
 };
 
 STRUCT_FIELD(DynamicMeta, chunk_size);
+STRUCT_FIELD(DynamicMeta, chunk_table_fanout);
+STRUCT_FIELD(DynamicMeta, chunk_table_stride);
+
+// Returns the chunk table block holding the entries of |chunk_id| that are
+// |stride| chunks apart, i.e. the leaf block for |stride| == 1.
+Ptr *Dynamic_get_chunk_table_block(DynamicMeta *meta,
+                                   DynamicNode *node,
+                                   i64 chunk_id,
+                                   i64 stride) {
+  auto fanout = meta->chunk_table_fanout;
+  auto block = (Ptr *)node->chunk_table;
+  for (i64 s = meta->chunk_table_stride; s > stride; s /= fanout) {
+    block = (Ptr *)block[chunk_id / s % fanout];
+  }
+  return block;
+}
+
+Ptr Dynamic_get_chunk(DynamicMeta *meta, DynamicNode *node, i64 chunk_id) {
+  if (chunk_id < taichi_dynamic_num_list_chunks ||
+      meta->chunk_table_fanout == 0) {
+    auto chunk_ptr = node->ptr;
+    for (i64 i = 0; i < chunk_id; i++) {
+      chunk_ptr = *(Ptr *)chunk_ptr;
+    }
+    return chunk_ptr;
+  }
+  auto block = Dynamic_get_chunk_table_block(meta, node, chunk_id, 1);
+  return block[chunk_id % meta->chunk_table_fanout];
+}
+
+// Makes sure chunks [0, num_chunks) are allocated.
+void Dynamic_allocate_chunks(DynamicMeta *meta,
+                             DynamicNode *node,
+                             i32 num_chunks) {
+  volatile i32 *p_num_chunks = &node->num_chunks;
+  if (*p_num_chunks >= num_chunks) {
+    return;
+  }
+  locked_task(
+      Ptr(&node->lock),
+      [&] {
+        auto rt = meta->context->runtime;
+        auto alloc = rt->node_allocators[meta->snode_id];
+        auto fanout = meta->chunk_table_fanout;
+        for (i32 c = node->num_chunks; c < num_chunks; c++) {
+          auto chunk = alloc->allocate(meta->context);
+          if (c == 0) {
+            node->ptr = chunk;
+          } else {
+            *(Ptr *)Dynamic_get_chunk(meta, node, c - 1) = chunk;
+          }
+          if (c >= taichi_dynamic_num_list_chunks && fanout != 0) {
+            if (node->chunk_table == nullptr) {
+              node->chunk_table = alloc->allocate(meta->context);
+            }
+            auto block = (Ptr *)node->chunk_table;
+            for (i64 s = meta->chunk_table_stride; s > 1; s /= fanout) {
+              auto &next = block[c / s % fanout];
+              if (next == nullptr) {
+                next = alloc->allocate(meta->context);
+              }
+              block = (Ptr *)next;
+            }
+            block[c % fanout] = chunk;
+          }
+          // Publish the chunk only after it is reachable.
+          *p_num_chunks = c + 1;
+        }
+      },
+      [&] { return *p_num_chunks < num_chunks; });
+}
 
 void Dynamic_activate(Ptr meta_, Ptr node_, int i) {
   auto meta = (DynamicMeta *)(meta_);
@@ -19,25 +102,7 @@ void Dynamic_activate(Ptr meta_, Ptr node_, int i) {
   // We need to not only update node->n, but also make sure the chunk containing
   // element i is allocated.
   atomic_max_i32(&node->n, i + 1);
-  int chunk_start = 0;
-  auto p_chunk_ptr = &node->ptr;
-  auto chunk_size = meta->chunk_size;
-  while (true) {
-    if (*p_chunk_ptr == nullptr) {
-      locked_task(Ptr(&node->lock), [&] {
-        if (*p_chunk_ptr == nullptr) {
-          auto rt = meta->context->runtime;
-          auto alloc = rt->node_allocators[meta->snode_id];
-          *p_chunk_ptr = alloc->allocate();
-        }
-      });
-    }
-    if (i < chunk_start + chunk_size) {
-      return;
-    }
-    p_chunk_ptr = (Ptr *)*p_chunk_ptr;
-    chunk_start += chunk_size;
-  }
+  Dynamic_allocate_chunks(meta, node, i / meta->chunk_size + 1);
 }
 
 void Dynamic_deactivate(Ptr meta_, Ptr node_) {
@@ -50,10 +115,29 @@ void Dynamic_deactivate(Ptr meta_, Ptr node_) {
       auto rt = meta->context->runtime;
       auto alloc = rt->node_allocators[meta->snode_id];
       while (*p_chunk_ptr) {
-        alloc->recycle(*p_chunk_ptr);
+        alloc->recycle(*p_chunk_ptr, meta->context);
         p_chunk_ptr = (Ptr *)*p_chunk_ptr;
       }
       node->ptr = nullptr;
+      if (node->chunk_table != nullptr) {
+        // Recycle the blocks level by level, from the leaves up. Recycled
+        // blocks stay intact until the next GC, so the walk remains valid.
+        auto fanout = meta->chunk_table_fanout;
+        for (i64 stride = 1; stride <= meta->chunk_table_stride;
+             stride *= fanout) {
+          auto span = stride * fanout;
+          for (i64 c = taichi_dynamic_num_list_chunks / span * span;
+               c < node->num_chunks; c += span) {
+            auto chunk_id = max_i64(c, taichi_dynamic_num_list_chunks);
+            alloc->recycle(
+                (Ptr)Dynamic_get_chunk_table_block(meta, node, chunk_id,
+                                                   stride),
+                meta->context);
+          }
+        }
+        node->chunk_table = nullptr;
+      }
+      node->num_chunks = 0;
     });
   }
 }
@@ -64,27 +148,9 @@ Ptr Dynamic_allocate(Ptr meta_, Ptr node_, i32 *len) {
   auto chunk_size = meta->chunk_size;
   auto i = atomic_add_i32(&node->n, 1);
   *len = i;
-  int chunk_start = 0;
-  auto p_chunk_ptr = &node->ptr;
-  while (true) {
-    if (*p_chunk_ptr == nullptr) {
-      locked_task(Ptr(&node->lock), [&] {
-        if (*p_chunk_ptr == nullptr) {
-          auto rt = meta->context->runtime;
-          auto alloc = rt->node_allocators[meta->snode_id];
-          *p_chunk_ptr = alloc->allocate();
-        }
-      });
-    }
-    if (i < chunk_start + chunk_size) {
-      return *p_chunk_ptr + sizeof(Ptr) +
-             (i - chunk_start) * meta->element_size;
-    }
-    p_chunk_ptr = (Ptr *)(*p_chunk_ptr);
-    chunk_start += chunk_size;
-  }
-  // Unreachable
-  return nullptr;
+  Dynamic_allocate_chunks(meta, node, i / chunk_size + 1);
+  return Dynamic_get_chunk(meta, node, i / chunk_size) + sizeof(Ptr) +
+         (i % chunk_size) * meta->element_size;
 }
 
 u1 Dynamic_is_active(Ptr meta_, Ptr node_, int i) {
@@ -96,18 +162,9 @@ Ptr Dynamic_lookup_element(Ptr meta_, Ptr node_, int i) {
   auto meta = (DynamicMeta *)(meta_);
   auto node = (DynamicNode *)(node_);
   if (Dynamic_is_active(meta_, node_, i)) {
-    int chunk_start = 0;
-    auto chunk_ptr = node->ptr;
     auto chunk_size = meta->chunk_size;
-    while (true) {
-      if (i < chunk_start + chunk_size) {
-        auto addr =
-            chunk_ptr + sizeof(Ptr) + (i - chunk_start) * meta->element_size;
-        return addr;
-      }
-      chunk_ptr = *(Ptr *)chunk_ptr;
-      chunk_start += chunk_size;
-    }
+    return Dynamic_get_chunk(meta, node, i / chunk_size) + sizeof(Ptr) +
+           (i % chunk_size) * meta->element_size;
   } else {
     return (meta->context->runtime)->ambient_elements[meta->snode_id];
   }
@@ -41,6 +41,11 @@ using host_vsnprintf_type = int (*)(char *,
                                     std::va_list);
 using host_allocator_type = void *(*)(void *, std::size_t, std::size_t);
 using RangeForTaskFunc = void(RuntimeContext *, const char *tls, int i);
+// Runs the iterations [block_start, block_end) of a range-for by itself.
+using RangeForBlockTaskFunc = void(RuntimeContext *,
+                                   const char *tls,
+                                   int block_start,
+                                   int block_end);
 using MeshForTaskFunc = void(RuntimeContext *, const char *tls, uint32_t i);
 using parallel_for_type = void (*)(void *thread_pool,
                                    int splits,
@@ -421,40 +426,49 @@ A simple list data structure that is infinitely long.
 Data are organized in chunks, where each chunk is allocated on demand.
 */
 
-// TODO: there are many i32 types in this class, which may be an issue if there
-// are >= 2 ** 31 elements.
 struct ListManager {
-  static constexpr std::size_t max_num_chunks = 128 * 1024;
-  Ptr chunks[max_num_chunks];
+  // Chunk |i| is chunk_tables[i >> kLog2ChunkTableSize][i % kChunkTableSize].
+  // The second-level tables are allocated on demand, so that a list only pays
+  // for the first level until it grows.
+  static constexpr i32 kLog2ChunkTableSize = 12;
+  static constexpr i64 kChunkTableSize = 1LL << kLog2ChunkTableSize;
+  // 16M chunks, i.e. 2^38 elements with the default 16K elements per chunk.
+  static constexpr i64 kDefaultMaxNumChunks = 1LL << 24;
+
+  Ptr **chunk_tables;
+  i64 max_num_chunks;
   std::size_t element_size{0};
   std::size_t max_num_elements_per_chunk;
   i32 log2chunk_num_elements;
   i32 lock;
-  i32 num_elements;
+  i64 num_elements;
   LLVMRuntime *runtime;
 
   ListManager(LLVMRuntime *runtime,
               std::size_t element_size,
-              std::size_t num_elements_per_chunk)
-      : element_size(element_size),
-        max_num_elements_per_chunk(num_elements_per_chunk),
-        runtime(runtime) {
-    taichi_assert_runtime(runtime, is_power_of_two(max_num_elements_per_chunk),
-                          "max_num_elements_per_chunk must be POT.");
-    lock = 0;
-    num_elements = 0;
-    log2chunk_num_elements = taichi::log2int(num_elements_per_chunk);
-  }
+              std::size_t num_elements_per_chunk,
+              i64 max_num_chunks = kDefaultMaxNumChunks);
 
   void append(void *data_ptr);
 
-  i32 reserve_new_element() {
-    auto i = atomic_add_i32(&num_elements, 1);
+  i64 reserve_new_element() {
+    auto i = atomic_add_i64(&num_elements, 1);
     auto chunk_id = i >> log2chunk_num_elements;
     touch_chunk(chunk_id);
     return i;
   }
 
+  // Reserves |n| consecutive elements with a single atomic and returns the
+  // index of the first one.
+  i64 reserve_new_elements(i64 n) {
+    auto i = atomic_add_i64(&num_elements, n);
+    for (auto chunk_id = i >> log2chunk_num_elements;
+         chunk_id <= (i + n - 1) >> log2chunk_num_elements; chunk_id++) {
+      touch_chunk(chunk_id);
+    }
+    return i;
+  }
+
   template <typename T>
   void push_back(const T &t) {
     this->append((void *)&t);
@@ -462,12 +476,25 @@ struct ListManager {
 
   Ptr allocate();
 
-  void touch_chunk(int chunk_id);
+  void touch_chunk(i64 chunk_id);
 
-  i32 get_num_active_chunks() {
-    i32 counter = 0;
-    for (int i = 0; i < max_num_chunks; i++) {
-      counter += (chunks[i] != nullptr);
+  Ptr get_chunk(i64 chunk_id) {
+    auto table = chunk_tables[chunk_id >> kLog2ChunkTableSize];
+    return table ? table[chunk_id & (kChunkTableSize - 1)] : nullptr;
+  }
+
+  i64 get_num_chunk_tables() {
+    return (max_num_chunks + kChunkTableSize - 1) >> kLog2ChunkTableSize;
+  }
+
+  i64 get_num_active_chunks() {
+    i64 counter = 0;
+    for (i64 t = 0; t < get_num_chunk_tables(); t++) {
+      if (!chunk_tables[t])
+        continue;
+      for (i64 i = 0; i < kChunkTableSize; i++) {
+        counter += (chunk_tables[t][i] != nullptr);
+      }
     }
     return counter;
   }
@@ -476,38 +503,46 @@ struct ListManager {
     num_elements = 0;
   }
 
-  void resize(i32 n) {
+  void resize(i64 n) {
     num_elements = n;
   }
 
-  Ptr get_element_ptr(i32 i) {
-    return chunks[i >> log2chunk_num_elements] +
-           element_size * (i & ((1 << log2chunk_num_elements) - 1));
+  Ptr get_element_ptr(i64 i) {
+    auto chunk_id = i >> log2chunk_num_elements;
+    return chunk_tables[chunk_id >> kLog2ChunkTableSize]
+                       [chunk_id & (kChunkTableSize - 1)] +
+           element_size * (i & ((1LL << log2chunk_num_elements) - 1));
   }
 
   template <typename T>
-  T &get(i32 i) {
+  T &get(i64 i) {
     return *(T *)get_element_ptr(i);
   }
 
-  Ptr touch_and_get(i32 i) {
+  Ptr touch_and_get(i64 i) {
     touch_chunk(i >> log2chunk_num_elements);
     return get_element_ptr(i);
   }
 
-  i32 size() {
+  i64 size() {
     return num_elements;
   }
 
-  i32 ptr2index(Ptr ptr) {
+  i64 ptr2index(Ptr ptr) {
     auto chunk_size = max_num_elements_per_chunk * element_size;
-    for (int i = 0; i < max_num_chunks; i++) {
-      taichi_assert_runtime(runtime, chunks[i] != nullptr, "ptr not found.");
-      if (chunks[i] <= ptr && ptr < chunks[i] + chunk_size) {
-        return (i << log2chunk_num_elements) +
-               i32((ptr - chunks[i]) / element_size);
+    for (i64 t = 0; t < get_num_chunk_tables(); t++) {
+      if (!chunk_tables[t])
+        continue;
+      for (i64 c = 0; c < kChunkTableSize; c++) {
+        auto chunk = chunk_tables[t][c];
+        if (chunk && chunk <= ptr && ptr < chunk + chunk_size) {
+          auto chunk_id = (t << kLog2ChunkTableSize) + c;
+          return (chunk_id << log2chunk_num_elements) +
+                 i64((ptr - chunk) / element_size);
+        }
       }
     }
+    taichi_assert_runtime(runtime, false, "ptr not found.");
     return -1;
   }
 };
@@ -596,6 +631,13 @@ struct LLVMRuntime {
 
   i64 total_requested_memory;
 
+  // Per-thread TLS storage of CPU parallel fors, reused across offloads.
+  Ptr cpu_tls_storage;
+  std::size_t cpu_tls_storage_size;
+
+  // Number of threads of |thread_pool|, 0 on GPUs.
+  i32 num_cpu_threads;
+
   template <typename T>
   void set_result(std::size_t i, T t) {
     static_assert(sizeof(T) <= sizeof(uint64));
@@ -625,20 +667,46 @@ STRUCT_FIELD(LLVMRuntime, profiler);
 STRUCT_FIELD(LLVMRuntime, profiler_start);
 STRUCT_FIELD(LLVMRuntime, profiler_stop);
 
+// Allocation cache of a NodeManager owned by one CPU thread. It refills a
+// batch of indices at a time from the shared free list (or the data list), and
+// hands recycled indices to the shared recycled list a batch at a time, so
+// that activations from many threads rarely touch the shared counters.
+// Never-used elements reserved from the data list are kept apart in
+// [fresh_begin, fresh_end), so that the free list is always drained first and
+// unused reservations are not reported as allocated.
+struct alignas(64) NodeManagerThreadCache {
+  static constexpr i32 kMaxBatchSize = 32;
+
+  i32 num_items;
+  i32 num_recycled;
+  i64 fresh_begin;
+  i64 fresh_end;
+  i64 items[kMaxBatchSize];
+  i64 recycled[kMaxBatchSize];
+};
+
 // NodeManager of node S (hash, pointer) managers the memory allocation of S_ch
 // It makes use of three ListManagers.
 struct NodeManager {
+  // Upper bound of the memory a thread cache may keep away from other threads.
+  static constexpr std::size_t kMaxThreadCacheBytes = 64 * 1024;
+
   LLVMRuntime *runtime;
   i32 lock;
 
   i32 element_size;
   i32 chunk_num_elements;
-  i32 free_list_used;
+  i64 free_list_used;
 
   ListManager *free_list, *recycled_list, *data_list;
-  i32 recycle_list_size_backup;
+  i64 recycle_list_size_backup;
+
+  // One per CPU thread, or nullptr on GPUs.
+  NodeManagerThreadCache *thread_caches;
+  i32 num_thread_caches;
+  i32 cache_batch_size;
 
-  using list_data_type = i32;
+  using list_data_type = i64;
 
   NodeManager(LLVMRuntime *runtime,
               i32 element_size,
@@ -661,11 +729,29 @@ struct NodeManager {
         runtime, sizeof(list_data_type), chunk_num_elements);
     data_list =
         runtime->create<ListManager>(runtime, element_size, chunk_num_elements);
+
+    thread_caches = nullptr;
+    num_thread_caches = runtime->num_cpu_threads;
+    cache_batch_size = (i32)std::min(
+        std::max(kMaxThreadCacheBytes / element_size, (std::size_t)1),
+        (std::size_t)NodeManagerThreadCache::kMaxBatchSize);
+    if (num_thread_caches > 0) {
+      thread_caches = (NodeManagerThreadCache *)runtime->allocate_aligned(
+          runtime->runtime_memory_chunk,
+          sizeof(NodeManagerThreadCache) * num_thread_caches,
+          alignof(NodeManagerThreadCache));
+      for (int i = 0; i < num_thread_caches; i++) {
+        thread_caches[i].num_items = 0;
+        thread_caches[i].num_recycled = 0;
+        thread_caches[i].fresh_begin = 0;
+        thread_caches[i].fresh_end = 0;
+      }
+    }
   }
 
   Ptr allocate() {
-    int old_cursor = atomic_add_i32(&free_list_used, 1);
-    i32 l;
+    auto old_cursor = atomic_add_i64(&free_list_used, 1);
+    i64 l;
     if (old_cursor >= free_list->size()) {
       // running out of free list. allocate new.
       l = data_list->reserve_new_element();
@@ -676,7 +762,33 @@ struct NodeManager {
     return data_list->get_element_ptr(l);
   }
 
-  i32 locate(Ptr ptr) {
+  // Allocates through the cache of the calling CPU thread if there is one.
+  Ptr allocate(RuntimeContext *context) {
+    auto cache = get_thread_cache(context);
+    if (!cache)
+      return allocate();
+    if (cache->num_items == 0)
+      refill(cache);
+    if (cache->num_items > 0)
+      return data_list->get_element_ptr(cache->items[--cache->num_items]);
+    if (cache->fresh_begin == cache->fresh_end) {
+      cache->fresh_begin = data_list->reserve_new_elements(cache_batch_size);
+      cache->fresh_end = cache->fresh_begin + cache_batch_size;
+    }
+    return data_list->get_element_ptr(cache->fresh_begin++);
+  }
+
+  // Elements ever handed out, i.e. the data list minus the reservations still
+  // sitting unused in thread caches.
+  i64 get_num_allocated_elements() {
+    auto n = data_list->size();
+    for (int i = 0; i < num_thread_caches; i++) {
+      n -= thread_caches[i].fresh_end - thread_caches[i].fresh_begin;
+    }
+    return n;
+  }
+
+  i64 locate(Ptr ptr) {
     return data_list->ptr2index(ptr);
   }
 
@@ -685,18 +797,72 @@ struct NodeManager {
     recycled_list->append(&index);
   }
 
+  // Recycles through the cache of the calling CPU thread if there is one. The
+  // cached indices reach |recycled_list| at the latest in the next GC.
+  void recycle(Ptr ptr, RuntimeContext *context) {
+    auto cache = get_thread_cache(context);
+    if (!cache) {
+      recycle(ptr);
+      return;
+    }
+    cache->recycled[cache->num_recycled++] = locate(ptr);
+    if (cache->num_recycled == cache_batch_size)
+      flush_recycled(cache);
+  }
+
+  NodeManagerThreadCache *get_thread_cache(RuntimeContext *context) {
+    auto thread_id = context->cpu_thread_id;
+    if (thread_id < 0 || thread_id >= num_thread_caches)
+      return nullptr;
+    return &thread_caches[thread_id];
+  }
+
+  // Takes up to a batch of indices from the free list; fewer (possibly none)
+  // if it is running out.
+  void refill(NodeManagerThreadCache *cache) {
+    if (free_list_used >= free_list->size())
+      return;
+    const i32 n = cache_batch_size;
+    // Like allocate(), this may move |free_list_used| past the end of the
+    // free list; the GC clamps it.
+    auto old_cursor = atomic_add_i64(&free_list_used, n);
+    i32 num_reused = min_i64(max_i64(free_list->size() - old_cursor, 0), n);
+    // The cache pops from the back, so fill it in reverse to hand elements
+    // out in the same order as allocate() does.
+    for (int i = 0; i < num_reused; i++) {
+      cache->items[num_reused - 1 - i] =
+          free_list->get<list_data_type>(old_cursor + i);
+    }
+    cache->num_items = num_reused;
+  }
+
+  void flush_recycled(NodeManagerThreadCache *cache) {
+    auto n = cache->num_recycled;
+    if (n == 0)
+      return;
+    auto l = recycled_list->reserve_new_elements(n);
+    for (int i = 0; i < n; i++) {
+      recycled_list->get<list_data_type>(l + i) = cache->recycled[i];
+    }
+    cache->num_recycled = 0;
+  }
+
   void gc_serial() {
+    for (int i = 0; i < num_thread_caches; i++) {
+      flush_recycled(&thread_caches[i]);
+    }
+
     // compact free list
-    for (int i = free_list_used; i < free_list->size(); i++) {
+    for (i64 i = free_list_used; i < free_list->size(); i++) {
       free_list->get<list_data_type>(i - free_list_used) =
           free_list->get<list_data_type>(i);
     }
-    const i32 num_unused = max_i32(free_list->size() - free_list_used, 0);
+    const i64 num_unused = max_i64(free_list->size() - free_list_used, 0);
     free_list_used = 0;
     free_list->resize(num_unused);
 
     // zero-fill recycled and push to free list
-    for (int i = 0; i < recycled_list->size(); i++) {
+    for (i64 i = 0; i < recycled_list->size(); i++) {
       auto idx = recycled_list->get<list_data_type>(i);
       auto ptr = data_list->get_element_ptr(idx);
       std::memset(ptr, 0, element_size);
@@ -755,6 +921,13 @@ RUNTIME_STRUCT_FIELD(NodeManager, recycled_list);
 RUNTIME_STRUCT_FIELD(NodeManager, data_list);
 RUNTIME_STRUCT_FIELD(NodeManager, free_list_used);
 
+void runtime_NodeManager_get_num_allocated_elements(
+    LLVMRuntime *runtime,
+    NodeManager *node_manager) {
+  runtime->set_result(taichi_result_buffer_runtime_query_id,
+                      node_manager->get_num_allocated_elements());
+}
+
 RUNTIME_STRUCT_FIELD(ListManager, num_elements);
 RUNTIME_STRUCT_FIELD(ListManager, max_num_elements_per_chunk);
 RUNTIME_STRUCT_FIELD(ListManager, element_size);
@@ -953,6 +1126,10 @@ void runtime_initialize(
       runtime->runtime_objects_chunk, taichi_global_tmp_buffer_size,
       taichi_page_size);
 
+  runtime->cpu_tls_storage = nullptr;
+  runtime->cpu_tls_storage_size = 0;
+  runtime->num_cpu_threads = 0;
+
   runtime->num_rand_states = num_rand_states;
   runtime->rand_states = (RandState *)runtime->allocate_aligned(
       runtime->runtime_objects_chunk,
@@ -1018,9 +1195,11 @@ void runtime_initialize_snodes(LLVMRuntime *runtime,
 
 void LLVMRuntime_initialize_thread_pool(LLVMRuntime *runtime,
                                         void *thread_pool,
-                                        void *parallel_for) {
+                                        void *parallel_for,
+                                        int num_threads) {
   runtime->thread_pool = (Ptr)thread_pool;
   runtime->parallel_for = (parallel_for_type)parallel_for;
+  runtime->num_cpu_threads = num_threads;
 }
 
 void runtime_NodeAllocator_initialize(LLVMRuntime *runtime,
@@ -1332,7 +1511,7 @@ void element_listgen_nonroot(LLVMRuntime *runtime,
                              StructMeta *parent,
                              StructMeta *child) {
   auto parent_list = runtime->element_lists[parent->snode_id];
-  int num_parent_elements = parent_list->size();
+  i64 num_parent_elements = parent_list->size();
   auto child_list = runtime->element_lists[child->snode_id];
   // Cache the func pointers here for better compiler optimization
   auto parent_refine_coordinates = parent->refine_coordinates;
@@ -1353,7 +1532,7 @@ void element_listgen_nonroot(LLVMRuntime *runtime,
   int j_start = 0;
   int j_step = 1;
 #endif
-  for (int i = i_start; i < num_parent_elements; i += i_step) {
+  for (i64 i = i_start; i < num_parent_elements; i += i_step) {
     auto element = parent_list->get<Element>(i);
     int j_lower = element.loop_bounds[0] + j_start;
     int j_higher = element.loop_bounds[1];
@@ -1384,52 +1563,150 @@ void element_listgen_nonroot(LLVMRuntime *runtime,
 
 using BlockTask = void(RuntimeContext *, char *, Element *, int, int);
 
+using range_for_xlogue = void (*)(RuntimeContext *, /*TLS*/ char *tls_base);
+using mesh_for_xlogue = void (*)(RuntimeContext *,
+                                 /*TLS*/ char *tls_base,
+                                 uint32_t patch_idx);
+
+// Thread-local storage of a CPU parallel for. Every thread of the pool owns a
+// slot in |runtime->cpu_tls_storage|. The TLS prologue runs when a thread
+// picks up its first task of the offload, and the epilogues of all used slots
+// run after the offload, so e.g. a reduction flushes once per thread instead
+// of once per block.
+//
+// Note: offloads on CPU never run concurrently, so a single storage suffices.
+struct CpuThreadLocalStorage {
+  // Each slot starts with a cache line holding the "used" flag, followed by
+  // the TLS itself padded to whole cache lines to avoid false sharing.
+  static constexpr std::size_t kSlotHeaderSize = 64;
+
+  char *slots;
+  std::size_t stride;
+
+  void initialize(LLVMRuntime *runtime, int num_threads, std::size_t tls_size) {
+    stride = kSlotHeaderSize + taichi::iroundup(tls_size, kSlotHeaderSize);
+    auto size = stride * num_threads;
+    if (runtime->cpu_tls_storage_size < size) {
+      // Grow geometrically, the old storage is not reclaimed.
+      size = std::max(size, runtime->cpu_tls_storage_size * 2);
+      runtime->cpu_tls_storage = runtime->allocate_aligned(
+          runtime->runtime_memory_chunk, size, kSlotHeaderSize);
+      runtime->cpu_tls_storage_size = size;
+    }
+    slots = (char *)runtime->cpu_tls_storage;
+    for (int i = 0; i < num_threads; i++) {
+      *(i32 *)(slots + i * stride) = 0;
+    }
+  }
+
+  char *acquire(RuntimeContext *context,
+                int thread_id,
+                range_for_xlogue prologue) {
+    auto slot = slots + thread_id * stride;
+    auto tls = slot + kSlotHeaderSize;
+    if (!*(i32 *)slot) {
+      *(i32 *)slot = 1;
+      if (prologue)
+        prologue(context, tls);
+    }
+    return tls;
+  }
+
+  void finalize(RuntimeContext *context,
+                int num_threads,
+                range_for_xlogue epilogue) {
+    if (!epilogue)
+      return;
+    for (int i = 0; i < num_threads; i++) {
+      auto slot = slots + i * stride;
+      if (*(i32 *)slot)
+        epilogue(context, slot + kSlotHeaderSize);
+    }
+  }
+};
+
 struct cpu_block_task_helper_context {
   RuntimeContext *context;
   BlockTask *task;
   ListManager *list;
   int element_size;
   int element_split;
-  std::size_t tls_buffer_size;
+  // The thread pool takes an i32 number of tasks, so a task may run several
+  // consecutive blocks of a huge list.
+  i64 num_blocks;
+  i64 blocks_per_task;
+  range_for_xlogue prologue{nullptr};
+  CpuThreadLocalStorage tls;
 };
 
 // TODO: To enforce inlining, we need to create in LLVM a new function that
 // calls block_helper and the BLS xlogues, and pass that function to the
 // scheduler.
 
-// TODO: TLS should be directly passed to the scheduler, so that it lives
-// with the threads (instead of blocks).
-
-void cpu_struct_for_block_helper(void *ctx_, int thread_id, int i) {
+void cpu_struct_for_block_helper(void *ctx_, int thread_id, int task_id) {
   auto ctx = (cpu_block_task_helper_context *)(ctx_);
-  int element_id = i / ctx->element_split;
   int part_size = ctx->element_size / ctx->element_split;
-  int part_id = i % ctx->element_split;
-  auto &e = ctx->list->get<Element>(element_id);
-  int lower = e.loop_bounds[0] + part_id * part_size;
-  int upper = e.loop_bounds[0] + (part_id + 1) * part_size;
-  upper = std::min(upper, e.loop_bounds[1]);
-  alignas(8) char tls_buffer[ctx->tls_buffer_size];
-
-  RuntimeContext this_thread_context = *ctx->context;
-  this_thread_context.cpu_thread_id = thread_id;
-  if (lower < upper) {
-    (*ctx->task)(&this_thread_context, tls_buffer,
-                 &ctx->list->get<Element>(element_id), lower, upper);
+  i64 blocks_begin = task_id * ctx->blocks_per_task;
+  i64 blocks_end =
+      min_i64(blocks_begin + ctx->blocks_per_task, ctx->num_blocks);
+  for (i64 i = blocks_begin; i < blocks_end; i++) {
+    i64 element_id = i / ctx->element_split;
+    int part_id = i % ctx->element_split;
+    auto &e = ctx->list->get<Element>(element_id);
+    int lower = e.loop_bounds[0] + part_id * part_size;
+    int upper = e.loop_bounds[0] + (part_id + 1) * part_size;
+    upper = std::min(upper, e.loop_bounds[1]);
+    if (lower < upper) {
+      auto tls_ptr = ctx->tls.acquire(ctx->context, thread_id, ctx->prologue);
+      RuntimeContext this_thread_context = *ctx->context;
+      this_thread_context.cpu_thread_id = thread_id;
+      (*ctx->task)(&this_thread_context, tls_ptr, &e, lower, upper);
+    }
   }
 }
 
+// CPU struct-for whose TLS prologue and epilogue are separate functions that
+// run once per thread rather than inside every block task.
+void cpu_parallel_struct_for(RuntimeContext *context,
+                             int snode_id,
+                             int element_size,
+                             int element_split,
+                             BlockTask *task,
+                             range_for_xlogue prologue,
+                             range_for_xlogue epilogue,
+                             std::size_t tls_size,
+                             int num_threads) {
+  auto runtime = context->runtime;
+  auto list = runtime->element_lists[snode_id];
+  auto list_tail = list->size();
+  cpu_block_task_helper_context ctx;
+  ctx.context = context;
+  ctx.task = task;
+  ctx.list = list;
+  ctx.element_size = element_size;
+  ctx.element_split = element_split;
+  ctx.num_blocks = list_tail * element_split;
+  ctx.blocks_per_task = ctx.num_blocks / INT32_MAX + 1;
+  ctx.prologue = prologue;
+  ctx.tls.initialize(runtime, num_threads, tls_size);
+  runtime->parallel_for(
+      runtime->thread_pool,
+      (ctx.num_blocks + ctx.blocks_per_task - 1) / ctx.blocks_per_task,
+      num_threads, &ctx, cpu_struct_for_block_helper);
+  ctx.tls.finalize(context, num_threads, epilogue);
+}
+
 void parallel_struct_for(RuntimeContext *context,
                          int snode_id,
                          int element_size,
                          int element_split,
                          BlockTask *task,
-                         std::size_t tls_buffer_size,
+                         std::size_t tls_size,
                          int num_threads) {
+#if ARCH_cuda || ARCH_amdgpu
   auto list = (context->runtime)->element_lists[snode_id];
   auto list_tail = list->size();
-#if ARCH_cuda || ARCH_amdgpu
-  int i = block_idx();
+  i64 i = block_idx();
   // Note: CUDA requires compile-time constant local array sizes.
   // We use "1" here and modify it during codegen to tls_buffer_size.
   alignas(8) char tls_buffer[1];
@@ -1437,7 +1714,7 @@ void parallel_struct_for(RuntimeContext *context,
   element_split = 1;
   const auto part_size = element_size / element_split;
   while (true) {
-    int element_id = i / element_split;
+    i64 element_id = i / element_split;
     if (element_id >= list_tail)
       break;
     auto part_id = i % element_split;
@@ -1450,62 +1727,65 @@ void parallel_struct_for(RuntimeContext *context,
     i += grid_dim();
   }
 #else
-  cpu_block_task_helper_context ctx;
-  ctx.context = context;
-  ctx.task = task;
-  ctx.list = list;
-  ctx.element_size = element_size;
-  ctx.element_split = element_split;
-  ctx.tls_buffer_size = tls_buffer_size;
-  auto runtime = context->runtime;
-  runtime->parallel_for(runtime->thread_pool, list_tail * element_split,
-                        num_threads, &ctx, cpu_struct_for_block_helper);
+  // The task runs its TLS xlogues by itself here.
+  cpu_parallel_struct_for(context, snode_id, element_size, element_split, task,
+                          nullptr, nullptr, tls_size, num_threads);
 #endif
 }
 
-using range_for_xlogue = void (*)(RuntimeContext *, /*TLS*/ char *tls_base);
-using mesh_for_xlogue = void (*)(RuntimeContext *,
-                                 /*TLS*/ char *tls_base,
-                                 uint32_t patch_idx);
-
 struct range_task_helper_context {
   RuntimeContext *context;
   range_for_xlogue prologue{nullptr};
   RangeForTaskFunc *body{nullptr};
   range_for_xlogue epilogue{nullptr};
-  std::size_t tls_size{1};
+  CpuThreadLocalStorage tls;
   int begin;
   int end;
   int block_size;
   int step;
+  // Whether |body| is a RangeForBlockTaskFunc
+  bool block_body{false};
 };
 
+// Runs the iterations [lower, upper) of a range-for, from the top if the step
+// is -1.
+void cpu_range_for_run_block(range_task_helper_context &ctx,
+                             RuntimeContext *context,
+                             char *tls_ptr,
+                             int lower,
+                             int upper) {
+  if (ctx.block_body) {
+    ((RangeForBlockTaskFunc *)ctx.body)(context, tls_ptr, lower, upper);
+  } else if (ctx.step == 1) {
+    for (int i = lower; i < upper; i++) {
+      ctx.body(context, tls_ptr, i);
+    }
+  } else {
+    for (int i = upper - 1; i >= lower; i--) {
+      ctx.body(context, tls_ptr, i);
+    }
+  }
+}
+
 void cpu_parallel_range_for_task(void *range_context,
                                  int thread_id,
                                  int task_id) {
-  auto ctx = *(range_task_helper_context *)range_context;
-  alignas(8) char tls_buffer[ctx.tls_size];
-  auto tls_ptr = &tls_buffer[0];
-  if (ctx.prologue)
-    ctx.prologue(ctx.context, tls_ptr);
+  auto &ctx = *(range_task_helper_context *)range_context;
+  auto tls_ptr = ctx.tls.acquire(ctx.context, thread_id, ctx.prologue);
 
   RuntimeContext this_thread_context = *ctx.context;
   this_thread_context.cpu_thread_id = thread_id;
   if (ctx.step == 1) {
     int block_start = ctx.begin + task_id * ctx.block_size;
     int block_end = std::min(block_start + ctx.block_size, ctx.end);
-    for (int i = block_start; i < block_end; i++) {
-      ctx.body(&this_thread_context, tls_ptr, i);
-    }
+    cpu_range_for_run_block(ctx, &this_thread_context, tls_ptr, block_start,
+                            block_end);
   } else if (ctx.step == -1) {
     int block_start = ctx.end - task_id * ctx.block_size;
-    int block_end = std::max(ctx.begin, block_start * ctx.block_size);
-    for (int i = block_start - 1; i >= block_end; i--) {
-      ctx.body(&this_thread_context, tls_ptr, i);
-    }
+    int block_end = std::max(ctx.begin, block_start - ctx.block_size);
+    cpu_range_for_run_block(ctx, &this_thread_context, tls_ptr, block_end,
+                            block_start);
   }
-  if (ctx.epilogue)
-    ctx.epilogue(ctx.context, tls_ptr);
 }
 
 void cpu_parallel_range_for(RuntimeContext *context,
@@ -1517,12 +1797,13 @@ void cpu_parallel_range_for(RuntimeContext *context,
                             range_for_xlogue prologue,
                             RangeForTaskFunc *body,
                             range_for_xlogue epilogue,
-                            std::size_t tls_size) {
+                            std::size_t tls_size,
+                            int block_body) {
   range_task_helper_context ctx;
   ctx.context = context;
   ctx.prologue = prologue;
-  ctx.tls_size = tls_size;
   ctx.body = body;
+  ctx.block_body = block_body;
   ctx.epilogue = epilogue;
   ctx.begin = begin;
   ctx.end = end;
@@ -1533,9 +1814,149 @@ void cpu_parallel_range_for(RuntimeContext *context,
   }
   ctx.block_size = block_dim;
   auto runtime = context->runtime;
+  ctx.tls.initialize(runtime, num_threads, tls_size);
   runtime->parallel_for(runtime->thread_pool,
                         (end - begin + block_dim - 1) / block_dim, num_threads,
                         &ctx, cpu_parallel_range_for_task);
+  ctx.tls.finalize(context, num_threads, epilogue);
+}
+
+// Schedules of cpu_parallel_range_for_scheduled, see CpuLoopSchedule.
+constexpr i32 kCpuLoopScheduleDynamic = 2;
+constexpr i32 kCpuLoopScheduleGuided = 3;
+
+// Reads a cheap monotonic tick counter, or returns 0 if there is none.
+i64 cpu_ticks() {
+#if ARCH_x64
+  return (i64)__builtin_ia32_rdtsc();
+#elif ARCH_arm64
+  i64 ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return 0;
+#endif
+}
+
+// Number of ticks a dynamically scheduled chunk aims to take: long enough to
+// amortize grabbing it, short enough to balance skewed iterations.
+#if ARCH_arm64
+// cntvct_el0 runs at a fixed frequency that is well below the core clock.
+constexpr f64 kCpuChunkTargetTicks = 1 << 12;
+#else
+constexpr f64 kCpuChunkTargetTicks = 1 << 16;
+#endif
+
+struct scheduled_range_task_helper_context {
+  range_task_helper_context range;
+  i32 schedule;
+  i32 num_threads;
+  i32 chunk_size;
+  // Number of iterations handed out so far.
+  i32 cursor;
+};
+
+void cpu_scheduled_range_for_task(void *range_context,
+                                  int thread_id,
+                                  int task_id) {
+  auto &ctx = *(scheduled_range_task_helper_context *)range_context;
+  auto &range = ctx.range;
+  const i32 n = range.end - range.begin;
+  char *tls_ptr = nullptr;
+  RuntimeContext this_thread_context = *range.context;
+  this_thread_context.cpu_thread_id = thread_id;
+  while (true) {
+    i32 start, size;
+    if (ctx.schedule == kCpuLoopScheduleGuided) {
+      // Chunks shrink with the remaining work, down to |block_size|.
+      start = __atomic_load_n(&ctx.cursor, __ATOMIC_RELAXED);
+      do {
+        if (start >= n)
+          return;
+        size = std::max(range.block_size, (n - start) / (2 * ctx.num_threads));
+        size = std::min(size, n - start);
+      } while (!__atomic_compare_exchange_n(&ctx.cursor, &start, start + size,
+                                            true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED));
+    } else {
+      start = atomic_add_i32(&ctx.cursor, ctx.chunk_size);
+      if (start >= n)
+        return;
+      size = std::min(ctx.chunk_size, n - start);
+    }
+    if (!tls_ptr)
+      tls_ptr = range.tls.acquire(range.context, thread_id, range.prologue);
+    if (range.step == 1) {
+      cpu_range_for_run_block(range, &this_thread_context, tls_ptr,
+                              range.begin + start, range.begin + start + size);
+    } else {
+      cpu_range_for_run_block(range, &this_thread_context, tls_ptr,
+                              range.end - start - size, range.end - start);
+    }
+  }
+}
+
+// CPU range-for whose iterations are handed out in chunks at run time
+// instead of being partitioned up front.
+//
+// |feedback| is a per-offload global holding the measured cost of an
+// iteration in ticks. The dynamic schedule sizes its chunks from it, so that
+// later launches of the same loop converge to chunks of about
+// kCpuChunkTargetTicks; the first launch uses |block_dim|.
+void cpu_parallel_range_for_scheduled(RuntimeContext *context,
+                                      int num_threads,
+                                      int begin,
+                                      int end,
+                                      int step,
+                                      int block_dim,
+                                      range_for_xlogue prologue,
+                                      RangeForTaskFunc *body,
+                                      range_for_xlogue epilogue,
+                                      std::size_t tls_size,
+                                      int block_body,
+                                      int schedule,
+                                      f64 *feedback) {
+  if (step != 1 && step != -1) {
+    taichi_printf(context->runtime, "step must not be %d\n", step);
+    exit(-1);
+  }
+  if (begin >= end)
+    return;
+  scheduled_range_task_helper_context ctx;
+  ctx.range.context = context;
+  ctx.range.prologue = prologue;
+  ctx.range.body = body;
+  ctx.range.block_body = block_body;
+  ctx.range.epilogue = epilogue;
+  ctx.range.begin = begin;
+  ctx.range.end = end;
+  ctx.range.step = step;
+  ctx.range.block_size = std::max(block_dim, 1);
+  ctx.schedule = schedule;
+  ctx.num_threads = num_threads;
+  ctx.cursor = 0;
+  const i32 n = end - begin;
+  ctx.chunk_size = ctx.range.block_size;
+  if (schedule == kCpuLoopScheduleDynamic && *feedback > 0) {
+    // Leave at least one chunk per thread.
+    auto max_chunk = std::max(n / num_threads, 1);
+    auto chunk = kCpuChunkTargetTicks / *feedback;
+    ctx.chunk_size = chunk >= max_chunk ? max_chunk : std::max((i32)chunk, 1);
+  }
+  auto runtime = context->runtime;
+  ctx.range.tls.initialize(runtime, num_threads, tls_size);
+  auto start_ticks = cpu_ticks();
+  // One task per thread, each grabbing chunks until none are left.
+  runtime->parallel_for(runtime->thread_pool, num_threads, num_threads, &ctx,
+                        cpu_scheduled_range_for_task);
+  auto elapsed = (f64)(cpu_ticks() - start_ticks);
+  ctx.range.tls.finalize(context, num_threads, epilogue);
+  if (elapsed > 0) {
+    auto used_threads = std::min(num_threads, (n + ctx.chunk_size - 1) /
+                                                  ctx.chunk_size);
+    auto cost = elapsed * used_threads / n;
+    *feedback = *feedback > 0 ? 0.5 * (*feedback + cost) : cost;
+  }
 }
 
 void gpu_parallel_range_for(RuntimeContext *context,
@@ -1661,19 +2082,54 @@ i32 linear_thread_idx(RuntimeContext *context) {
 #include "node_root.h"
 #include "node_bitmasked.h"
 
-void ListManager::touch_chunk(int chunk_id) {
+ListManager::ListManager(LLVMRuntime *runtime,
+                         std::size_t element_size,
+                         std::size_t num_elements_per_chunk,
+                         i64 max_num_chunks)
+    : max_num_chunks(max_num_chunks),
+      element_size(element_size),
+      max_num_elements_per_chunk(num_elements_per_chunk),
+      runtime(runtime) {
+  taichi_assert_runtime(runtime, is_power_of_two(max_num_elements_per_chunk),
+                        "max_num_elements_per_chunk must be POT.");
+  lock = 0;
+  num_elements = 0;
+  log2chunk_num_elements = taichi::log2int(num_elements_per_chunk);
+  auto num_tables = get_num_chunk_tables();
+  chunk_tables = (Ptr **)runtime->allocate_aligned(
+      runtime->runtime_memory_chunk, sizeof(Ptr *) * num_tables, 8,
+      true /*request*/);
+  for (i64 t = 0; t < num_tables; t++) {
+    chunk_tables[t] = nullptr;
+  }
+}
+
+void ListManager::touch_chunk(i64 chunk_id) {
   taichi_assert_runtime(runtime, chunk_id < max_num_chunks,
                         "List manager out of chunks.");
-  if (!chunks[chunk_id]) {
+  if (!get_chunk(chunk_id)) {
     locked_task(&lock, [&] {
       // may have been allocated during lock contention
-      if (!chunks[chunk_id]) {
+      if (get_chunk(chunk_id)) {
+        return;
+      }
+      grid_memfence();
+      auto &table = chunk_tables[chunk_id >> kLog2ChunkTableSize];
+      if (!table) {
+        auto new_table = (Ptr *)runtime->allocate_aligned(
+            runtime->runtime_memory_chunk, sizeof(Ptr) * kChunkTableSize, 8,
+            true /*request*/);
+        for (i64 i = 0; i < kChunkTableSize; i++) {
+          new_table[i] = nullptr;
+        }
         grid_memfence();
-        auto chunk_ptr = runtime->allocate_aligned(
-            runtime->runtime_memory_chunk,
-            max_num_elements_per_chunk * element_size, 4096, true /*request*/);
-        atomic_exchange_u64((u64 *)&chunks[chunk_id], (u64)chunk_ptr);
+        atomic_exchange_u64((u64 *)&table, (u64)new_table);
       }
+      auto chunk_ptr = runtime->allocate_aligned(
+          runtime->runtime_memory_chunk,
+          max_num_elements_per_chunk * element_size, 4096, true /*request*/);
+      atomic_exchange_u64(
+          (u64 *)&table[chunk_id & (kChunkTableSize - 1)], (u64)chunk_ptr);
     });
   }
 }
@@ -1688,8 +2144,132 @@ Ptr ListManager::allocate() {
   return get_element_ptr(i);
 }
 
+// Below this much work, waking up the thread pool costs more than the GC.
+constexpr std::size_t kMinParallelGcBytes = 1 << 20;
+// Nodes at least this large are zeroed with non-temporal stores.
+constexpr std::size_t kMinStreamingZeroFillBytes = 256;
+
+// Zero-fills a recycled node. Large nodes bypass the caches, so that zeroing
+// millions of them does not evict the working set of the next offload.
+void gc_zero_fill(Ptr ptr, std::size_t size) {
+#if ARCH_x64 && __has_builtin(__builtin_nontemporal_store)
+  if (size >= kMinStreamingZeroFillBytes) {
+    auto head = (8 - (uint64)ptr % 8) % 8;
+    std::memset(ptr, 0, head);
+    auto body = (u64 *)(ptr + head);
+    auto num_words = (size - head) / 8;
+    for (std::size_t i = 0; i < num_words; i++) {
+      __builtin_nontemporal_store((u64)0, body + i);
+    }
+    std::memset(body + num_words, 0, (size - head) % 8);
+    return;
+  }
+#endif
+  std::memset(ptr, 0, size);
+}
+
+struct cpu_gc_task_context {
+  NodeManager *allocator;
+  i64 num_items;
+  i64 items_per_task;
+  // Free list positions copied from and to.
+  i64 src_begin;
+  i64 dst_begin;
+};
+
+void cpu_gc_compact_task(void *ctx_, int thread_id, int task_id) {
+  auto &ctx = *(cpu_gc_task_context *)ctx_;
+  auto free_list = ctx.allocator->free_list;
+  using T = NodeManager::list_data_type;
+  i64 begin = task_id * ctx.items_per_task;
+  i64 end = min_i64(begin + ctx.items_per_task, ctx.num_items);
+  for (i64 i = begin; i < end; i++) {
+    free_list->get<T>(ctx.dst_begin + i) = free_list->get<T>(ctx.src_begin + i);
+  }
+}
+
+void cpu_gc_recycle_task(void *ctx_, int thread_id, int task_id) {
+  auto &ctx = *(cpu_gc_task_context *)ctx_;
+  auto allocator = ctx.allocator;
+  using T = NodeManager::list_data_type;
+  i64 begin = task_id * ctx.items_per_task;
+  i64 end = min_i64(begin + ctx.items_per_task, ctx.num_items);
+  for (i64 i = begin; i < end; i++) {
+    auto idx = allocator->recycled_list->get<T>(i);
+    allocator->free_list->get<T>(ctx.dst_begin + i) = idx;
+    gc_zero_fill(allocator->data_list->get_element_ptr(idx),
+                 allocator->element_size);
+  }
+#if ARCH_x64
+  // Non-temporal stores are weakly ordered.
+  __builtin_ia32_sfence();
+#endif
+}
+
+// Runs |task| over |ctx.num_items| items on the runtime thread pool.
+void cpu_gc_parallel_for(LLVMRuntime *runtime,
+                         cpu_gc_task_context &ctx,
+                         std::size_t bytes_per_item,
+                         void (*task)(void *, int, int)) {
+  if (ctx.num_items <= 0)
+    return;
+  // About 64 KB of work per task.
+  ctx.items_per_task = max_i64((64 << 10) / bytes_per_item, 1);
+  auto num_tasks =
+      (ctx.num_items + ctx.items_per_task - 1) / ctx.items_per_task;
+  runtime->parallel_for(runtime->thread_pool, num_tasks,
+                        runtime->num_cpu_threads, &ctx, task);
+}
+
+// The CPU counterpart of gc_parallel_0/1/2: compacts the free list, then
+// zero-fills the recycled nodes and appends them to it, both on the runtime
+// thread pool.
+void node_gc_parallel_cpu(LLVMRuntime *runtime, NodeManager *allocator) {
+  using T = NodeManager::list_data_type;
+  auto free_list = allocator->free_list;
+  auto free_list_size = free_list->size();
+  auto free_list_used = min_i64(allocator->free_list_used, free_list_size);
+  auto num_unused = free_list_size - free_list_used;
+
+  // Move the unused indices to the beginning of the free list. The ranges
+  // must not overlap, so when fewer indices were used than are left, only
+  // the tail fills the used slots.
+  cpu_gc_task_context ctx;
+  ctx.allocator = allocator;
+  ctx.dst_begin = 0;
+  if (free_list_used >= num_unused) {
+    ctx.num_items = num_unused;
+    ctx.src_begin = free_list_used;
+  } else {
+    ctx.num_items = free_list_used;
+    ctx.src_begin = free_list_size - free_list_used;
+  }
+  cpu_gc_parallel_for(runtime, ctx, sizeof(T), cpu_gc_compact_task);
+  allocator->free_list_used = 0;
+  free_list->resize(num_unused);
+
+  auto num_recycled = allocator->recycled_list->size();
+  ctx.num_items = num_recycled;
+  ctx.dst_begin = free_list->reserve_new_elements(num_recycled);
+  cpu_gc_parallel_for(runtime, ctx, allocator->element_size,
+                      cpu_gc_recycle_task);
+  allocator->recycled_list->clear();
+}
+
 void node_gc(LLVMRuntime *runtime, int snode_id) {
-  runtime->node_allocators[snode_id]->gc_serial();
+  auto allocator = runtime->node_allocators[snode_id];
+  for (int i = 0; i < allocator->num_thread_caches; i++) {
+    allocator->flush_recycled(&allocator->thread_caches[i]);
+  }
+  auto work_bytes =
+      allocator->recycled_list->size() * allocator->element_size +
+      max_i64(allocator->free_list->size() - allocator->free_list_used, 0) *
+          sizeof(NodeManager::list_data_type);
+  if (runtime->num_cpu_threads > 1 && work_bytes >= kMinParallelGcBytes) {
+    node_gc_parallel_cpu(runtime, allocator);
+  } else {
+    allocator->gc_serial();
+  }
 }
 
 void gc_parallel_impl_0(RuntimeContext *context, NodeManager *allocator) {
@@ -1699,7 +2279,7 @@ void gc_parallel_impl_0(RuntimeContext *context, NodeManager *allocator) {
   using T = NodeManager::list_data_type;
 
   // Move unused elements to the beginning of the free_list
-  int i = linear_thread_idx(context);
+  i64 i = linear_thread_idx(context);
   if (free_list_used * 2 > free_list_size) {
     // Directly copy. Dst and src does not overlap
     auto items_to_copy = free_list_size - free_list_used;
@@ -1726,8 +2306,8 @@ void gc_parallel_0(RuntimeContext *context, int snode_id) {
 void gc_parallel_impl_1(NodeManager *allocator) {
   auto free_list = allocator->free_list;
 
-  const i32 num_unused =
-      max_i32(free_list->size() - allocator->free_list_used, 0);
+  const i64 num_unused =
+      max_i64(free_list->size() - allocator->free_list_used, 0);
   free_list->resize(num_unused);
 
   allocator->free_list_used = 0;
@@ -1747,7 +2327,7 @@ void gc_parallel_impl_2(NodeManager *allocator) {
   auto data_list = allocator->data_list;
   auto element_size = allocator->element_size;
   using T = NodeManager::list_data_type;
-  auto i = block_idx();
+  i64 i = block_idx();
   while (i < elements) {
     auto idx = recycled_list->get<T>(i);
     auto ptr = data_list->get_element_ptr(idx);
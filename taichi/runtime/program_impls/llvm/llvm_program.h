@@ -181,6 +181,20 @@ class LlvmProgramImpl : public ProgramImpl {
                                                               result_buffer);
   }
 
+  HostCachingAllocator::Stats get_caching_allocator_stats() override {
+    return runtime_exec_->get_caching_allocator_stats();
+  }
+
+  void run_host_tasks(int num_tasks,
+                      void *context,
+                      RangeForTaskFunc *func) override {
+    if (arch_is_cpu(config->arch)) {
+      runtime_exec_->run_cpu_tasks(num_tasks, context, func);
+    } else {
+      ProgramImpl::run_host_tasks(num_tasks, context, func);
+    }
+  }
+
   void check_runtime_error(uint64 *result_buffer) override {
     runtime_exec_->check_runtime_error(result_buffer);
   }
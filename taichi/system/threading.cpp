@@ -5,13 +5,47 @@
 
 #include "taichi/system/threading.h"
 
+#include "taichi/system/timer.h"
+
 #include <algorithm>
 #include <condition_variable>
 #include <thread>
 #include <vector>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
 namespace taichi {
 
+namespace {
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Spin with a pause first, then start yielding so that an oversubscribed host
+// still lets the thread we are waiting for make progress.
+inline void backoff(int &spins) {
+  if (++spins < 1024) {
+    cpu_relax();
+  } else {
+    std::this_thread::yield();
+  }
+}
+
+// The owner of a task range takes 1/kChunkDivisor of what is left each time,
+// so it rarely touches the shared word while thieves still find work to split.
+constexpr uint32 kChunkDivisor = 8;
+
+}  // namespace
+
 bool test_threading() {
   auto tp = ThreadPool(20);
   for (int j = 0; j < 100; j++) {
@@ -26,6 +60,44 @@ bool test_threading() {
   return true;
 }
 
+bool test_work_stealing_threading() {
+  constexpr int kMaxNumThreads = 8;
+  WorkStealingThreadPool tp(kMaxNumThreads);
+
+  struct Context {
+    std::atomic<int64> sum{0};
+    std::atomic<int> bad_thread_id{0};
+    int desired_num_threads{0};
+  } ctx;
+
+  auto task = [](void *ctx_, int thread_id, int i) {
+    auto ctx = (Context *)ctx_;
+    if (thread_id < 0 || thread_id >= ctx->desired_num_threads)
+      ctx->bad_thread_id++;
+    ctx->sum.fetch_add(i, std::memory_order_relaxed);
+  };
+
+  for (int splits : {1, 3, 64, 1000, 100000}) {
+    for (int desired = 1; desired <= kMaxNumThreads + 2; desired++) {
+      ctx.sum = 0;
+      ctx.desired_num_threads = std::min(desired, kMaxNumThreads);
+      tp.run(splits, desired, &ctx, task);
+      if (ctx.sum != int64(splits) * (splits - 1) / 2 || ctx.bad_thread_id)
+        return false;
+    }
+  }
+
+  // Many back-to-back tiny launches stress the wake-up protocol.
+  ctx.desired_num_threads = kMaxNumThreads;
+  for (int j = 0; j < 10000; j++) {
+    ctx.sum = 0;
+    tp.run(kMaxNumThreads * 2, kMaxNumThreads, &ctx, task);
+    if (ctx.sum != int64(kMaxNumThreads * 2) * (kMaxNumThreads * 2 - 1) / 2)
+      return false;
+  }
+  return ctx.bad_thread_id == 0;
+}
+
 ThreadPool::ThreadPool(int max_num_threads) : max_num_threads(max_num_threads) {
   exiting = false;
   started = false;
@@ -100,6 +172,8 @@ void ThreadPool::target() {
       }
     }
 
+    const double start_time = stats ? Time::get_time() : 0;
+    int64 num_tasks = 0;
     while (true) {
       // For a single parallel task
       int task_id;
@@ -110,6 +184,12 @@ void ThreadPool::target() {
       }
 
       func(this->range_for_task_context, thread_id, task_id);
+      num_tasks++;
+    }
+    if (stats) {
+      auto &worker = stats->workers[thread_id];
+      worker.busy_time += Time::get_time() - start_time;
+      worker.num_tasks += num_tasks;
     }
 
     bool all_finished = false;
@@ -136,4 +216,184 @@ ThreadPool::~ThreadPool() {
     th.join();
 }
 
+WorkStealingThreadPool::WorkStealingThreadPool(int max_num_threads,
+                                               int spin_iterations)
+    : max_num_threads_(std::max(max_num_threads, 1)),
+      spin_iterations_(spin_iterations) {
+  ranges_ = std::make_unique<TaskRange[]>(max_num_threads_);
+  // Worker 0 is the thread calling run(), so only spawn the rest.
+  for (int i = 1; i < max_num_threads_; i++) {
+    threads_.emplace_back([this, i] { this->target(i); });
+  }
+}
+
+void WorkStealingThreadPool::run(int splits,
+                                 int desired_num_threads,
+                                 void *range_for_task_context,
+                                 RangeForTaskFunc *func) {
+  TI_ASSERT(desired_num_threads > 0);
+  if (splits <= 0)
+    return;
+  std::lock_guard<std::mutex> _(launch_mutex_);
+  const int num_threads =
+      std::min({desired_num_threads, max_num_threads_, splits});
+  if (num_threads == 1) {
+    const double start_time = stats_ ? Time::get_time() : 0;
+    for (int i = 0; i < splits; i++) {
+      func(range_for_task_context, 0, i);
+    }
+    if (stats_) {
+      stats_->workers[0].busy_time += Time::get_time() - start_time;
+      stats_->workers[0].num_tasks += splits;
+    }
+    return;
+  }
+
+  num_launch_threads_ = num_threads;
+  func_ = func;
+  range_for_task_context_ = range_for_task_context;
+  num_pending_tasks_.store(splits, std::memory_order_relaxed);
+  for (int i = 0; i < max_num_threads_; i++) {
+    uint32 begin = 0, end = 0;
+    if (i < num_threads) {
+      begin = uint32(int64(splits) * i / num_threads);
+      end = uint32(int64(splits) * (i + 1) / num_threads);
+    }
+    ranges_[i].range.store(TaskRange::pack(begin, end),
+                           std::memory_order_relaxed);
+  }
+
+  // Publish the launch. This must be sequentially consistent with the
+  // |num_parked_workers_| increment in target(), otherwise a worker that is
+  // about to park could miss the notification.
+  epoch_.fetch_add(1);
+  if (num_parked_workers_.load() > 0) {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_cv_.notify_all();
+  }
+
+  work(0);
+  int spins = 0;
+  while (num_pending_tasks_.load(std::memory_order_acquire) > 0) {
+    backoff(spins);
+  }
+
+  // Close the launch, then wait for late workers that may still be scanning
+  // the task ranges before they can be reused by the next launch.
+  epoch_.fetch_add(1);
+  spins = 0;
+  while (num_active_workers_.load() > 0) {
+    backoff(spins);
+  }
+}
+
+bool WorkStealingThreadPool::pop(int thread_id, uint32 &begin, uint32 &end) {
+  auto &range = ranges_[thread_id].range;
+  uint64 cur = range.load(std::memory_order_relaxed);
+  while (true) {
+    uint32 b = TaskRange::begin_of(cur), e = TaskRange::end_of(cur);
+    if (b >= e)
+      return false;
+    uint32 chunk = std::max<uint32>(1, (e - b) / kChunkDivisor);
+    if (range.compare_exchange_weak(cur, TaskRange::pack(b + chunk, e),
+                                    std::memory_order_acq_rel,
+                                    std::memory_order_relaxed)) {
+      begin = b;
+      end = b + chunk;
+      return true;
+    }
+  }
+}
+
+bool WorkStealingThreadPool::steal(int thread_id) {
+  const int num_threads = num_launch_threads_;
+  for (int k = 1; k < num_threads; k++) {
+    int victim = (thread_id + k) % num_threads;
+    auto &range = ranges_[victim].range;
+    uint64 cur = range.load(std::memory_order_relaxed);
+    while (true) {
+      uint32 b = TaskRange::begin_of(cur), e = TaskRange::end_of(cur);
+      if (b >= e)
+        break;
+      uint32 half = (e - b + 1) / 2;
+      if (range.compare_exchange_weak(cur, TaskRange::pack(b, e - half),
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_relaxed)) {
+        // Our own range is empty here, and thieves never CAS an empty range,
+        // so a plain store is enough.
+        ranges_[thread_id].range.store(TaskRange::pack(e - half, e),
+                                       std::memory_order_release);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::work(int thread_id) {
+  const double start_time = stats_ ? Time::get_time() : 0;
+  int64 num_tasks = 0;
+  do {
+    uint32 begin, end;
+    while (pop(thread_id, begin, end)) {
+      for (uint32 i = begin; i < end; i++) {
+        func_(range_for_task_context_, thread_id, int(i));
+      }
+      num_tasks += end - begin;
+      num_pending_tasks_.fetch_sub(int(end - begin), std::memory_order_release);
+    }
+  } while (steal(thread_id));
+  if (stats_) {
+    auto &worker = stats_->workers[thread_id];
+    worker.busy_time += Time::get_time() - start_time;
+    worker.num_tasks += num_tasks;
+  }
+}
+
+void WorkStealingThreadPool::target(int thread_id) {
+  uint64 last_epoch = 0;
+  auto has_new_launch = [&](uint64 epoch) {
+    return (epoch & 1) && epoch != last_epoch;
+  };
+  while (true) {
+    uint64 epoch = epoch_.load(std::memory_order_acquire);
+    for (int spins = 0; !has_new_launch(epoch);) {
+      if (exiting_.load(std::memory_order_relaxed))
+        return;
+      if (spins < spin_iterations_) {
+        backoff(spins);
+      } else {
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        num_parked_workers_.fetch_add(1);
+        park_cv_.wait(lock, [&] {
+          epoch = epoch_.load();
+          return exiting_.load() || has_new_launch(epoch);
+        });
+        num_parked_workers_.fetch_sub(1);
+        spins = 0;
+      }
+      epoch = epoch_.load(std::memory_order_acquire);
+    }
+    last_epoch = epoch;
+
+    // Register before touching the launch state, then make sure the launch we
+    // saw has not been closed in between; run() waits for registered workers.
+    num_active_workers_.fetch_add(1);
+    if (epoch_.load() == epoch && thread_id < num_launch_threads_) {
+      work(thread_id);
+    }
+    num_active_workers_.fetch_sub(1);
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    exiting_ = true;
+  }
+  park_cv_.notify_all();
+  for (auto &th : threads_)
+    th.join();
+}
+
 }  // namespace taichi
@@ -7,16 +7,40 @@
 
 #include "taichi/common/core.h"
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 namespace taichi {
 
 using RangeForTaskFunc = void(void *, int thread_id, int i);
 using ParallelFor = void(int n, int num_threads, void *, RangeForTaskFunc func);
 
+// Per-worker counters of a thread pool, filled in while attached to the pool
+// with set_stats(). Every worker only writes its own slot, and run() returns
+// after all workers are done with the launch, so the counters can be read
+// between launches without synchronization.
+struct ThreadPoolStats {
+  struct alignas(64) Worker {
+    double busy_time{0};  // in seconds
+    int64 num_tasks{0};
+  };
+  std::vector<Worker> workers;
+
+  explicit ThreadPoolStats(int max_num_threads)
+      : workers((std::size_t)max_num_threads) {
+  }
+
+  void reset() {
+    std::fill(workers.begin(), workers.end(), Worker{});
+  }
+};
+
 class ThreadPool {
  public:
   std::vector<std::thread> threads;
@@ -38,9 +62,15 @@ class ThreadPool {
                                  // LLVM runtime, which is different from
                                  // taichi::lang::Context.
   int thread_counter;
+  ThreadPoolStats *stats{nullptr};
 
   explicit ThreadPool(int max_num_threads);
 
+  // Must not be called while a launch is in flight.
+  void set_stats(ThreadPoolStats *stats) {
+    this->stats = stats;
+  }
+
   void run(int splits,
            int desired_num_threads,
            void *range_for_task_context,
@@ -59,4 +89,85 @@ class ThreadPool {
   ~ThreadPool();
 };
 
+// A thread pool with per-thread task ranges and work stealing. The calling
+// thread participates as worker 0, so a launch never has to wait for a worker
+// to wake up before making progress. Idle workers spin for a while before
+// parking, which keeps back-to-back launches of small kernels cheap.
+//
+// Each worker owns a contiguous range of task ids. The owner pops chunks from
+// the front of its range, and idle workers steal the back half of a victim's
+// range. Both ends are packed into a single 64-bit word so that either side
+// can update it with one CAS.
+class WorkStealingThreadPool {
+ public:
+  explicit WorkStealingThreadPool(int max_num_threads,
+                                  int spin_iterations = 1 << 14);
+
+  void run(int splits,
+           int desired_num_threads,
+           void *range_for_task_context,
+           RangeForTaskFunc *func);
+
+  static void static_run(WorkStealingThreadPool *pool,
+                         int splits,
+                         int desired_num_threads,
+                         void *range_for_task_context,
+                         RangeForTaskFunc *func) {
+    return pool->run(splits, desired_num_threads, range_for_task_context, func);
+  }
+
+  int get_max_num_threads() const {
+    return max_num_threads_;
+  }
+
+  // Must not be called while a launch is in flight.
+  void set_stats(ThreadPoolStats *stats) {
+    stats_ = stats;
+  }
+
+  ~WorkStealingThreadPool();
+
+ private:
+  struct alignas(64) TaskRange {
+    std::atomic<uint64> range{0};
+
+    static uint64 pack(uint32 begin, uint32 end) {
+      return (uint64(end) << 32) | uint64(begin);
+    }
+    static uint32 begin_of(uint64 r) {
+      return uint32(r);
+    }
+    static uint32 end_of(uint64 r) {
+      return uint32(r >> 32);
+    }
+  };
+
+  void target(int thread_id);
+  void work(int thread_id);
+  bool pop(int thread_id, uint32 &begin, uint32 &end);
+  bool steal(int thread_id);
+
+  int max_num_threads_;
+  int spin_iterations_;
+  std::vector<std::thread> threads_;
+  std::unique_ptr<TaskRange[]> ranges_;
+
+  // Odd epochs denote a launch in flight, even epochs an idle pool.
+  std::atomic<uint64> epoch_{0};
+  std::atomic<int> num_pending_tasks_{0};
+  std::atomic<int> num_active_workers_{0};
+  std::atomic<int> num_parked_workers_{0};
+  std::atomic<bool> exiting_{false};
+
+  int num_launch_threads_{0};
+  RangeForTaskFunc *func_{nullptr};
+  void *range_for_task_context_{nullptr};
+  ThreadPoolStats *stats_{nullptr};
+
+  std::mutex park_mutex_;
+  std::condition_variable park_cv_;
+  // Serializes concurrent run() calls from different host threads.
+  std::mutex launch_mutex_;
+};
+
 }  // namespace taichi
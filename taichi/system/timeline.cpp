@@ -1,69 +1,151 @@
 #include "taichi/system/timeline.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
 namespace taichi {
 
-std::string TimelineEvent::to_json() {
-  std::string json{"{"};
-  json += fmt::format("\"cat\":\"taichi\",");
-  json += fmt::format("\"pid\":0,");
-  json += fmt::format("\"tid\":\"{}\",", tid);
-  json += fmt::format("\"ph\":\"{}\",", begin ? "B" : "E");
-  json += fmt::format("\"name\":\"{}\",", name);
-  json += fmt::format("\"ts\":\"{}\"", uint64(time * 1000000));
-  json += "}";
-  return json;
+float64 benchmark_timeline(int num_threads, int64 num_events, bool enabled) {
+  auto &timelines = Timelines::get_instance();
+  const bool was_enabled = timelines.get_enabled();
+  timelines.set_enabled(enabled);
+  const uint32 name_id = timelines.get_name_id("benchmark_timeline");
+  std::vector<std::thread> threads;
+  auto start_time = Time::get_time();
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&] {
+      for (int64 j = 0; j < num_events / 2; j++) {
+        Timeline::Guard _(name_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed_time = Time::get_time() - start_time;
+  timelines.clear();
+  timelines.set_enabled(was_enabled);
+  return elapsed_time;
 }
 
-Timeline::Timeline() : tid_("unnamed") {
+Timeline::Timeline() : tid_("unnamed"), registered_(true) {
   Timelines::get_instance().insert_timeline(this);
 }
 
+Timeline::Timeline(const std::string &tid) : tid_(tid) {
+}
+
 Timeline &Timeline::get_this_thread_instance() {
   thread_local Timeline instance;
   return instance;
 }
 
 Timeline::~Timeline() {
-  Timelines::get_instance().insert_events(fetch_events());
-  Timelines::get_instance().remove_timeline(this);
+  if (registered_) {
+    Timelines::get_instance().remove_timeline(this);
+  }
 }
 
 void Timeline::clear() {
-  std::lock_guard<std::mutex> _(mut_);
-  events_.clear();
+  tail_ = head_.load(std::memory_order_acquire);
 }
+
 void Timeline::insert_event(const TimelineEvent &e) {
-  if (!Timelines::get_instance().get_enabled())
-    return;
-  std::lock_guard<std::mutex> _(mut_);
-  events_.push_back(e);
+  Timelines::get_instance().insert_event(e);
 }
 
-std::vector<TimelineEvent> Timeline::fetch_events() {
-  std::lock_guard<std::mutex> _(mut_);
-  std::vector<TimelineEvent> fetched;
-  std::swap(fetched, events_);
-  return fetched;
+void Timeline::insert_record(const TimelineRecord &record) {
+  if (!slots_) {
+    slots_ = std::make_unique<Slot[]>(kCapacity);
+  }
+  const uint64 head = head_.load(std::memory_order_relaxed);
+  write_head_.store(head + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  auto &slot = slots_[head % kCapacity];
+  slot.ticks.store(record.ticks, std::memory_order_relaxed);
+  slot.name_id_and_begin.store(
+      (uint64(record.name_id) << 1) | uint64(record.begin),
+      std::memory_order_relaxed);
+  head_.store(head + 1, std::memory_order_release);
 }
 
-Timeline::Guard::Guard(const std::string &name) : name_(name) {
-  auto &timeline = Timeline::get_this_thread_instance();
-  timeline.insert_event({name, true, Time::get_time(), timeline.tid_});
+uint32 Timeline::get_name_id(const std::string &name) {
+  auto it = name_ids_.find(name);
+  if (it != name_ids_.end()) {
+    return it->second;
+  }
+  auto id = Timelines::get_instance().get_name_id(name);
+  name_ids_.emplace(name, id);
+  return id;
 }
 
-Timeline::Guard::~Guard() {
-  auto &timeline = Timeline::get_this_thread_instance();
-  timeline.insert_event({name_, false, Time::get_time(), timeline.tid_});
+void Timeline::fetch_records(std::vector<TimelineRecord> &records) {
+  const uint64 head = head_.load(std::memory_order_acquire);
+  const uint64 begin =
+      std::max(tail_, head > kCapacity ? head - kCapacity : uint64(0));
+  if (begin >= head) {
+    return;
+  }
+  const std::size_t num_fetched = records.size();
+  for (uint64 i = begin; i < head; i++) {
+    auto &slot = slots_[i % kCapacity];
+    uint64 name_id_and_begin =
+        slot.name_id_and_begin.load(std::memory_order_relaxed);
+    records.push_back({slot.ticks.load(std::memory_order_relaxed),
+                       uint32(name_id_and_begin >> 1),
+                       bool(name_id_and_begin & 1)});
+  }
+  // Drop the slots that the writer started to overwrite in the meantime
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64 write_head = write_head_.load(std::memory_order_relaxed);
+  if (write_head > begin + kCapacity) {
+    const uint64 num_dropped =
+        std::min(write_head - kCapacity - begin, head - begin);
+    records.erase(records.begin() + num_fetched,
+                  records.begin() + num_fetched + num_dropped);
+  }
+  // Once the ring wrapped, the begin records of the oldest open events may
+  // have been overwritten. Drop their end records to keep the trace balanced.
+  int depth = 0;
+  auto end = std::remove_if(records.begin() + num_fetched, records.end(),
+                            [&depth](const TimelineRecord &record) {
+                              if (record.begin) {
+                                depth++;
+                                return false;
+                              }
+                              if (depth == 0) {
+                                return true;
+                              }
+                              depth--;
+                              return false;
+                            });
+  records.erase(end, records.end());
 }
 
-void Timelines::insert_events(const std::vector<TimelineEvent> &events) {
-  std::lock_guard<std::mutex> _(mut_);
-  insert_events_without_locking(events);
+Timeline::Guard::Guard(const std::string &name) {
+  if (!Timelines::get_instance().get_enabled())
+    return;
+  timeline_ = &Timeline::get_this_thread_instance();
+  name_id_ = timeline_->get_name_id(name);
+  timeline_->insert_record({Timelines::now(), name_id_, true});
 }
 
-void Timelines::insert_events_without_locking(
-    const std::vector<TimelineEvent> &events) {
-  events_.insert(events_.end(), events.begin(), events.end());
+Timeline::Guard::Guard(uint32 name_id) : name_id_(name_id) {
+  if (!Timelines::get_instance().get_enabled())
+    return;
+  timeline_ = &Timeline::get_this_thread_instance();
+  timeline_->insert_record({Timelines::now(), name_id_, true});
+}
+
+Timeline::Guard::~Guard() {
+  // Only closes the events that were opened, even if the timeline was
+  // disabled in between
+  if (timeline_) {
+    timeline_->insert_record({Timelines::now(), name_id_, false});
+  }
 }
 
 Timelines &taichi::Timelines::get_instance() {
@@ -71,35 +153,110 @@ Timelines &taichi::Timelines::get_instance() {
   return *instance;
 }
 
+uint64 Timelines::now() {
+#if defined(TI_ARCH_x64) && !(defined(__arm64__) || defined(__aarch64__))
+  return Time::get_cycles();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+uint32 Timelines::get_name_id(const std::string &name) {
+  std::lock_guard<std::mutex> _(names_mut_);
+  auto it = name_ids_.find(name);
+  if (it != name_ids_.end()) {
+    return it->second;
+  }
+  auto id = (uint32)names_.size();
+  names_.push_back(name);
+  name_ids_.emplace(name, id);
+  return id;
+}
+
+void Timelines::insert_event(const TimelineEvent &e) {
+  if (!get_enabled())
+    return;
+  auto name_id = get_name_id(e.name);
+  std::lock_guard<std::mutex> _(mut_);
+  auto &timeline = event_timelines_[e.tid];
+  if (!timeline) {
+    timeline = std::make_unique<Timeline>(e.tid);
+  }
+  // Convert relative to the current time, so that the error of the tick rate
+  // only scales with the age of the event
+  float64 ticks =
+      float64(now()) - (Time::get_time() - e.time) * ticks_per_second_;
+  timeline->insert_record({uint64(std::max(ticks, 0.0)), name_id, e.begin});
+}
+
 void Timelines::clear() {
   std::lock_guard<std::mutex> _(mut_);
-  events_.clear();
+  retired_.clear();
   for (auto timeline : timelines_) {
     timeline->clear();
   }
+  for (auto &[tid, timeline] : event_timelines_) {
+    timeline->clear();
+  }
 }
 
 void Timelines::save(const std::string &filename) {
   std::lock_guard<std::mutex> _(mut_);
-  std::sort(timelines_.begin(), timelines_.end(), [](Timeline *a, Timeline *b) {
-    return a->get_name() < b->get_name();
-  });
-  for (auto timeline : timelines_) {
-    insert_events_without_locking(timeline->fetch_events());
-  }
   if (!ends_with(filename, ".json")) {
     TI_WARN("Timeline filename {} should end with '.json'.", filename);
   }
+  if (ticks_per_second_ == 0) {
+    calibrate();
+  }
+#if defined(TI_ARCH_x64) && !(defined(__arm64__) || defined(__aarch64__))
+  // Refine the TSC rate over the whole time since calibration
+  const float64 elapsed_time = Time::get_time() - base_time_;
+  if (elapsed_time > 1.0) {
+    ticks_per_second_ = float64(now() - base_ticks_) / elapsed_time;
+  }
+#endif
+
   std::ofstream fout(filename);
-  fout << "[";
+  fout << std::fixed << std::setprecision(3) << "[";
   bool first = true;
-  for (auto &e : events_) {
-    if (first) {
-      first = false;
-    } else {
-      fout << ",";
+  std::lock_guard<std::mutex> names_lock(names_mut_);
+  auto write_records = [&](const std::string &tid,
+                           const std::vector<TimelineRecord> &records) {
+    for (auto &record : records) {
+      if (first) {
+        first = false;
+      } else {
+        fout << ",";
+      }
+      // Microseconds since calibration
+      float64 ts = float64(int64(record.ticks - base_ticks_)) /
+                   ticks_per_second_ * 1e6;
+      fout << "{\"cat\":\"taichi\",\"pid\":0,\"tid\":\"" << tid
+           << "\",\"ph\":\"" << (record.begin ? "B" : "E")
+           << "\",\"name\":\"" << names_[record.name_id] << "\",\"ts\":" << ts
+           << "}\n";
     }
-    fout << e.to_json() << std::endl;
+  };
+
+  for (auto &[tid, records] : retired_) {
+    write_records(tid, records);
+  }
+  std::sort(timelines_.begin(), timelines_.end(), [](Timeline *a, Timeline *b) {
+    return a->get_name() < b->get_name();
+  });
+  // Fetch one timeline at a time to bound the memory used
+  std::vector<TimelineRecord> records;
+  for (auto timeline : timelines_) {
+    records.clear();
+    timeline->fetch_records(records);
+    write_records(timeline->get_name(), records);
+  }
+  for (auto &[tid, timeline] : event_timelines_) {
+    records.clear();
+    timeline->fetch_records(records);
+    write_records(tid, records);
   }
   fout << "]";
 }
@@ -111,15 +268,39 @@ void Timelines::insert_timeline(Timeline *timeline) {
 
 void Timelines::remove_timeline(Timeline *timeline) {
   std::lock_guard<std::mutex> _(mut_);
-  trash(std::remove(timelines_.begin(), timelines_.end(), timeline));
+  std::vector<TimelineRecord> records;
+  timeline->fetch_records(records);
+  if (!records.empty()) {
+    retired_.emplace_back(timeline->get_name(), std::move(records));
+  }
+  timelines_.erase(std::remove(timelines_.begin(), timelines_.end(), timeline),
+                   timelines_.end());
 }
 
-bool Timelines::get_enabled() {
-  return enabled_;
+void Timelines::set_enabled(bool enabled) {
+  if (enabled) {
+    std::lock_guard<std::mutex> _(mut_);
+    if (ticks_per_second_ == 0) {
+      calibrate();
+    }
+  }
+  enabled_.store(enabled, std::memory_order_relaxed);
 }
 
-void Timelines::set_enabled(bool enabled) {
-  enabled_ = enabled;
+void Timelines::calibrate() {
+  base_ticks_ = now();
+  base_time_ = Time::get_time();
+#if defined(TI_ARCH_x64) && !(defined(__arm64__) || defined(__aarch64__))
+  // A first estimate of the TSC rate, refined by save()
+  float64 elapsed_time = 0;
+  while (elapsed_time < 2e-3) {
+    std::this_thread::yield();
+    elapsed_time = Time::get_time() - base_time_;
+  }
+  ticks_per_second_ = float64(now() - base_ticks_) / elapsed_time;
+#else
+  ticks_per_second_ = 1e9;
+#endif
 }
 
 }  // namespace taichi
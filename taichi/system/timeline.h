@@ -1,7 +1,12 @@
 #pragma once
 
-#include <vector>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "taichi/common/core.h"
 #include "taichi/system/timer.h"
@@ -11,16 +16,29 @@ namespace taichi {
 struct TimelineEvent {
   std::string name;
   bool begin;
-  float64 time;
+  float64 time;  // Time::get_time()
   std::string tid;
+};
 
-  std::string to_json();
+// An event with an interned name, timestamped with Timelines::now().
+struct TimelineRecord {
+  uint64 ticks;
+  uint32 name_id;
+  bool begin;
 };
 
+// The events of a thread, in a ring buffer that keeps the newest kCapacity
+// events. Only the owning thread writes to it, without locking. Timelines reads
+// it concurrently and drops the slots overwritten while they were being read.
 class Timeline {
  public:
+  static constexpr uint64 kCapacity = 1 << 16;
+
   Timeline();
 
+  // A timeline that is not registered to Timelines, for events of other tids.
+  explicit Timeline(const std::string &tid);
+
   ~Timeline();
 
   static Timeline &get_this_thread_instance();
@@ -33,26 +51,50 @@ class Timeline {
     return tid_;
   }
 
+  // Must be called with the Timelines lock held.
   void clear();
 
+  // Records an event of a timestamp in the past, of any tid.
   void insert_event(const TimelineEvent &e);
 
-  std::vector<TimelineEvent> fetch_events();
+  void insert_record(const TimelineRecord &record);
+
+  uint32 get_name_id(const std::string &name);
+
+  // Appends the records, oldest first, to |records|, leaving out end records
+  // whose begin record is gone. Must be called with the Timelines lock held.
+  void fetch_records(std::vector<TimelineRecord> &records);
 
   class Guard {
    public:
     explicit Guard(const std::string &name);
 
+    explicit Guard(uint32 name_id);
+
     ~Guard();
 
    private:
-    std::string name_;
+    Timeline *timeline_{nullptr};
+    uint32 name_id_{0};
   };
 
  private:
+  struct Slot {
+    std::atomic<uint64> ticks{0};
+    std::atomic<uint64> name_id_and_begin{0};
+  };
+
   std::string tid_;
-  std::mutex mut_;
-  std::vector<TimelineEvent> events_;
+  bool registered_{false};
+  // Allocated by the first event, before |head_| is published
+  std::unique_ptr<Slot[]> slots_;
+  // The writer claims a slot by bumping |write_head_| before writing to it,
+  // and publishes it by bumping |head_| afterwards
+  std::atomic<uint64> write_head_{0};
+  std::atomic<uint64> head_{0};
+  uint64 tail_{0};
+  // Cache of Timelines::get_name_id(), only used by the owning thread
+  std::unordered_map<std::string, uint32> name_ids_;
 };
 
 // A timeline system for multi-threaded applications
@@ -60,9 +102,12 @@ class Timelines {
  public:
   static Timelines &get_instance();
 
-  void insert_events(const std::vector<TimelineEvent> &events);
+  // Monotonic timestamps in ticks: the TSC on x64, nanoseconds elsewhere.
+  static uint64 now();
+
+  uint32 get_name_id(const std::string &name);
 
-  void insert_events_without_locking(const std::vector<TimelineEvent> &events);
+  void insert_event(const TimelineEvent &e);
 
   void insert_timeline(Timeline *timeline);
 
@@ -70,22 +115,48 @@ class Timelines {
 
   void clear();
 
+  // Writes the events in the Chrome trace format, one timeline at a time,
+  // without building the whole trace in memory.
   void save(const std::string &filename);
 
-  bool get_enabled();
+  bool get_enabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
 
   void set_enabled(bool enabled);
 
  private:
+  void calibrate();
+
   std::mutex mut_;
-  std::vector<TimelineEvent> events_;
   std::vector<Timeline *> timelines_;
-  bool enabled_{false};
+  // Events inserted with a tid, per tid
+  std::map<std::string, std::unique_ptr<Timeline>> event_timelines_;
+  // Events of the threads that exited
+  std::vector<std::pair<std::string, std::vector<TimelineRecord>>> retired_;
+  std::atomic<bool> enabled_{false};
+  // Maps ticks to Time::get_time()
+  uint64 base_ticks_{0};
+  float64 base_time_{0};
+  float64 ticks_per_second_{0};
+
+  std::mutex names_mut_;
+  std::deque<std::string> names_;
+  std::unordered_map<std::string, uint32> name_ids_;
 };
 
+// Returns the seconds |num_threads| threads take to record |num_events|
+// events each, as begin/end pairs. Clears the timelines afterwards.
+float64 benchmark_timeline(int num_threads, int64 num_events, bool enabled);
+
 #define TI_TIMELINE(name) \
   taichi::Timeline::Guard _timeline_guard_##__LINE__(name);
 
-#define TI_AUTO_TIMELINE TI_TIMELINE(__FUNCTION__)
+// Interns the function name once per call site
+#define TI_AUTO_TIMELINE                                      \
+  static const taichi::uint32 _timeline_name_id_ =            \
+      taichi::Timelines::get_instance().get_name_id(          \
+          __FUNCTION__);                                      \
+  taichi::Timeline::Guard _timeline_guard_(_timeline_name_id_);
 
 }  // namespace taichi
@@ -342,12 +342,12 @@ class AlgSimp : public BasicStmtVisitor {
         auto prev_cast = stmt->operand->as<UnaryOpStmt>();
         if (stmt->op_type == UnaryOpType::cast_bits &&
             prev_cast->op_type == UnaryOpType::cast_bits) {
-          stmt->operand = prev_cast->operand;
+          stmt->set_operand(stmt->operand, prev_cast->operand);
           modifier.mark_as_modified();
         } else if (stmt->op_type == UnaryOpType::cast_value &&
                    prev_cast->op_type == UnaryOpType::cast_value &&
                    is_redundant_cast(prev_cast->cast_type, stmt->cast_type)) {
-          stmt->operand = prev_cast->operand;
+          stmt->set_operand(stmt->operand, prev_cast->operand);
           modifier.mark_as_modified();
         }
       }
@@ -375,8 +375,9 @@ class AlgSimp : public BasicStmtVisitor {
         (alg_is_pot(lhs) || alg_is_pot(rhs))) {
       // a * pot -> a << log2(pot)
       if (alg_is_pot(lhs)) {
-        std::swap(stmt->lhs, stmt->rhs);
         std::swap(lhs, rhs);
+        stmt->set_operand(stmt->lhs, lhs);
+        stmt->set_operand(stmt->rhs, rhs);
       }
 
       Stmt *new_rhs = get_log2rhs(stmt);
@@ -678,15 +679,7 @@ class AlgSimp : public BasicStmtVisitor {
 
   static bool run(IRNode *node, bool fast_math) {
     AlgSimp simplifier(fast_math);
-    bool modified = false;
-    while (true) {
-      node->accept(&simplifier);
-      if (simplifier.modifier.modify_ir())
-        modified = true;
-      else
-        break;
-    }
-    return modified;
+    return visit_until_unmodified(node, &simplifier, simplifier.modifier);
   }
 };
 
@@ -85,8 +85,8 @@ class BinaryOpSimp : public BasicStmtVisitor {
     auto const_lhs = stmt->lhs->cast<ConstStmt>();
     if (const_lhs && is_commutative(stmt->op_type) &&
         !stmt->rhs->is<ConstStmt>()) {
-      stmt->lhs = stmt->rhs;
-      stmt->rhs = const_lhs;
+      stmt->set_operand(stmt->lhs, stmt->rhs);
+      stmt->set_operand(stmt->rhs, const_lhs);
       operand_swapped = true;
     }
     // Disable other optimizations if fast_math=True and the data type is not
@@ -171,14 +171,8 @@ class BinaryOpSimp : public BasicStmtVisitor {
 
   static bool run(IRNode *node, bool fast_math) {
     BinaryOpSimp simplifier(fast_math);
-    bool modified = false;
-    while (true) {
-      node->accept(&simplifier);
-      if (simplifier.modifier.modify_ir()) {
-        modified = true;
-      } else
-        break;
-    }
+    bool modified =
+        visit_until_unmodified(node, &simplifier, simplifier.modifier);
     return modified || simplifier.operand_swapped;
   }
 };
@@ -303,18 +303,7 @@ class ConstantFold : public BasicStmtVisitor {
 
   static bool run(IRNode *node) {
     ConstantFold folder;
-    bool modified = false;
-
-    while (true) {
-      node->accept(&folder);
-      if (folder.modifier.modify_ir()) {
-        modified = true;
-      } else {
-        break;
-      }
-    }
-
-    return modified;
+    return visit_until_unmodified(node, &folder, folder.modifier);
   }
 
  private:
@@ -105,10 +105,11 @@ void convert_to_range_for(OffloadedStmt *offloaded) {
 
   offloaded->body = std::move(body);
   offloaded->body->set_parent_stmt(offloaded);
-  main_loop_var->loop = offloaded;
+  main_loop_var->set_operand(main_loop_var->loop, offloaded);
   ////// End core transformation
 
   offloaded->task_type = TaskType::range_for;
+  offloaded->is_demoted_dense_struct_for = true;
 }
 
 void maybe_convert(OffloadedStmt *stmt) {
@@ -42,7 +42,7 @@ class HandleExternalPtrBound : public BasicStmtVisitor {
 
         checked_index = new_stmts.push_back<BinaryOpStmt>(
             BinaryOpType::min, checked_index, valid_upper);
-        stmt->indices[i] = checked_index;
+        stmt->set_operand(stmt->indices[i], checked_index);
       }
 
       modifier.insert_before(stmt, std::move(new_stmts));
@@ -79,7 +79,7 @@ class HandleExternalPtrBound : public BasicStmtVisitor {
       checked_index = new_stmts.push_back<BinaryOpStmt>(
           BinaryOpType::min, checked_index, upper_bound);
 
-      stmt->offset = checked_index;
+      stmt->set_operand(stmt->offset, checked_index);
       modifier.insert_before(stmt, std::move(new_stmts));
       set_done(stmt);
     }
@@ -700,6 +700,10 @@ class IRPrinter : public IRVisitor {
       details =
           fmt::format("range_for({}, {}) grid_dim={} block_dim={}", begin_str,
                       end_str, stmt->grid_dim, stmt->block_dim);
+      if (stmt->cpu_schedule != CpuLoopSchedule::static_partition) {
+        details += fmt::format(" schedule={}",
+                               cpu_loop_schedule_name(stmt->cpu_schedule));
+      }
     } else if (stmt->task_type == OffloadedTaskType::struct_for) {
       details =
           fmt::format("struct_for({}) grid_dim={} block_dim={} bls={}",
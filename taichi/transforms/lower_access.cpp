@@ -126,7 +126,7 @@ class LowerAccess : public IRVisitor {
       return;
     // No need to activate for all read accesses
     auto lowered = lower_ptr(stmt->src->as<GlobalPtrStmt>(), false);
-    stmt->src = lowered.back().get();
+    stmt->set_operand(stmt->src, lowered.back().get());
     modifier.insert_before(stmt, std::move(lowered));
   }
 
@@ -138,7 +138,7 @@ class LowerAccess : public IRVisitor {
     // If ptr already has activate = false, no need to activate all the
     // generated micro-access ops. Otherwise, activate the nodes.
     auto lowered = lower_ptr(ptr, ptr->activate);
-    stmt->origin = lowered.back().get();
+    stmt->set_operand(stmt->origin, lowered.back().get());
     modifier.insert_before(stmt, std::move(lowered));
   }
 
@@ -149,7 +149,7 @@ class LowerAccess : public IRVisitor {
     // If ptr already has activate = false, no need to activate all the
     // generated micro-access ops. Otherwise, activate the nodes.
     auto lowered = lower_ptr(ptr, ptr->activate);
-    stmt->dest = lowered.back().get();
+    stmt->set_operand(stmt->dest, lowered.back().get());
     modifier.insert_before(stmt, std::move(lowered));
   }
 
@@ -165,12 +165,12 @@ class LowerAccess : public IRVisitor {
                                                    lowered.back().get());
         cast->cast_type = TypeFactory::get_instance().get_primitive_type(
             PrimitiveTypeID::u64);
-        stmt->ptr = lowered.back().get();
+        stmt->set_operand(stmt->ptr, lowered.back().get());
         modifier.replace_with(stmt, std::move(lowered));
       } else {
         auto lowered =
             lower_ptr(global_ptr, SNodeOpStmt::need_activation(stmt->op_type));
-        stmt->ptr = lowered.back().get();
+        stmt->set_operand(stmt->ptr, lowered.back().get());
         modifier.insert_before(stmt, std::move(lowered));
       }
     }
@@ -182,7 +182,7 @@ class LowerAccess : public IRVisitor {
     if (stmt->dest->is<GlobalPtrStmt>()) {
       auto lowered = lower_ptr(stmt->dest->as<GlobalPtrStmt>(),
                                stmt->dest->as<GlobalPtrStmt>()->activate);
-      stmt->dest = lowered.back().get();
+      stmt->set_operand(stmt->dest, lowered.back().get());
       modifier.insert_before(stmt, std::move(lowered));
     }
   }
@@ -190,7 +190,7 @@ class LowerAccess : public IRVisitor {
   void visit(LocalStoreStmt *stmt) override {
     if (stmt->val->is<GlobalPtrStmt>()) {
       auto lowered = lower_ptr(stmt->val->as<GlobalPtrStmt>(), true);
-      stmt->val = lowered.back().get();
+      stmt->set_operand(stmt->val, lowered.back().get());
       modifier.insert_before(stmt, std::move(lowered));
     }
   }
@@ -166,7 +166,7 @@ class LowerAST : public IRVisitor {
 
     auto &&new_while = std::make_unique<WhileStmt>(std::move(stmt->body));
     auto mask = std::make_unique<AllocaStmt>(PrimitiveType::i32);
-    new_while->mask = mask.get();
+    new_while->set_operand(new_while->mask, mask.get());
     auto &stmts = new_while->body;
     stmts->insert(std::move(fctx.stmts), /*location=*/0);
     // insert break
@@ -277,6 +277,7 @@ class LowerAST : public IRVisitor {
           begin, end, std::move(stmt->body), stmt->is_bit_vectorized,
           stmt->num_cpu_threads, stmt->block_dim, stmt->strictly_serialized,
           /*range_hint=*/fmt::format("arg ({})", fmt::join(arg_id, ", ")));
+      new_for->cpu_schedule = stmt->cpu_schedule;
       VecStatement new_statements;
       Stmt *loop_index =
           new_statements.push_back<LoopIndexStmt>(new_for.get(), 0);
@@ -318,6 +319,7 @@ class LowerAST : public IRVisitor {
             begin_stmt, end_stmt, std::move(stmt->body),
             stmt->is_bit_vectorized, stmt->num_cpu_threads, stmt->block_dim,
             stmt->strictly_serialized);
+        new_for->cpu_schedule = stmt->cpu_schedule;
         new_for->body->insert(std::make_unique<LoopIndexStmt>(new_for.get(), 0),
                               0);
         new_for->body->local_var_to_stmt[stmt->loop_var_ids[0]] =
@@ -346,7 +348,7 @@ class LowerAST : public IRVisitor {
 
         auto &&new_while = std::make_unique<WhileStmt>(std::move(stmt->body));
         auto mask = std::make_unique<AllocaStmt>(PrimitiveType::i32);
-        new_while->mask = mask.get();
+        new_while->set_operand(new_while->mask, mask.get());
 
         // insert break
         load_and_compare.push_back<WhileControlStmt>(new_while->mask,
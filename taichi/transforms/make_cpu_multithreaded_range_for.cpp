@@ -44,6 +44,9 @@ using TaskType = OffloadedStmt::TaskType;
  * moved outside, so that LLVM has more chance to vectorize the innermost
  * loop. This pass especially accelerates simple single level loops, e.g.
  * memcpy and vecadd, even when the loop bounds are determined at runtime.
+ *
+ * Loops with a dynamic or guided CpuLoopSchedule are left alone: their
+ * iterations are handed out in chunks by the runtime instead.
  */
 
 class MakeCPUMultithreadedRangeFor : public BasicStmtVisitor {
@@ -59,7 +62,8 @@ class MakeCPUMultithreadedRangeFor : public BasicStmtVisitor {
   }
 
   void visit(OffloadedStmt *offloaded) override {
-    if (offloaded->task_type != TaskType::range_for) {
+    if (offloaded->task_type != TaskType::range_for ||
+        offloaded->cpu_schedule != CpuLoopSchedule::static_partition) {
       return;
     }
 
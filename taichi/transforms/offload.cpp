@@ -131,6 +131,12 @@ class Offloader {
 
         offloaded->num_cpu_threads =
             std::min(s->num_cpu_threads, config.cpu_max_num_threads);
+        if (arch_is_cpu(arch)) {
+          offloaded->cpu_schedule =
+              s->cpu_schedule == CpuLoopSchedule::unspecified
+                  ? cpu_loop_schedule_from_name(config.cpu_loop_schedule)
+                  : s->cpu_schedule;
+        }
         replace_all_usages_with(s, s, offloaded.get());
         for (int j = 0; j < (int)s->body->statements.size(); j++) {
           offloaded->body->insert(std::move(s->body->statements[j]));
@@ -729,9 +735,9 @@ class AssociateContinueScope : public BasicStmtVisitor {
   void visit(ContinueStmt *stmt) override {
     if (stmt->scope == nullptr) {
       if (cur_internal_loop_ != nullptr) {
-        stmt->scope = cur_internal_loop_;
+        stmt->set_operand(stmt->scope, cur_internal_loop_);
       } else {
-        stmt->scope = cur_offloaded_stmt_;
+        stmt->set_operand(stmt->scope, cur_offloaded_stmt_);
       }
       modified_ = true;
     }
@@ -7,7 +7,10 @@
 #include "taichi/program/kernel.h"
 #include "taichi/program/program.h"
 #include "taichi/transforms/utils.h"
+#include "taichi/system/timer.h"
+#include <functional>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
@@ -164,9 +167,10 @@ class BasicBlockSimplify : public IRVisitor {
       auto offset_stmt =
           Stmt::make<IntegerOffsetStmt>(stmt, previous_offset->offset);
 
-      stmt->inputs.back() = previous_offset->input;
+      stmt->set_operand(stmt->inputs.back(), previous_offset->input);
       stmt->replace_usages_with(offset_stmt.get());
-      offset_stmt->as<IntegerOffsetStmt>()->input = stmt;
+      offset_stmt->set_operand(offset_stmt->as<IntegerOffsetStmt>()->input,
+                               stmt);
       modifier.insert_after(stmt, std::move(offset_stmt));
       return;
     }
@@ -238,9 +242,10 @@ class BasicBlockSimplify : public IRVisitor {
       auto offset_stmt = Stmt::make<IntegerOffsetStmt>(
           stmt, previous_offset->offset * sizeof(int32) * (snode->ch.size()));
 
-      stmt->input_index = previous_offset->input;
+      stmt->set_operand(stmt->input_index, previous_offset->input);
       stmt->replace_usages_with(offset_stmt.get());
-      offset_stmt->as<IntegerOffsetStmt>()->input = stmt;
+      offset_stmt->set_operand(offset_stmt->as<IntegerOffsetStmt>()->input,
+                               stmt);
       modifier.insert_after(stmt, std::move(offset_stmt));
       return;
     }
@@ -260,11 +265,12 @@ class BasicBlockSimplify : public IRVisitor {
       auto offset_stmt = Stmt::make<IntegerOffsetStmt>(
           stmt, stmt->chid * sizeof(int32) + previous_offset->offset);
 
-      stmt->input_ptr = previous_offset->input;
+      stmt->set_operand(stmt->input_ptr, previous_offset->input);
       stmt->replace_usages_with(offset_stmt.get());
       stmt->chid = 0;
       stmt->output_snode = stmt->input_snode->ch[stmt->chid].get();
-      offset_stmt->as<IntegerOffsetStmt>()->input = stmt;
+      offset_stmt->set_operand(offset_stmt->as<IntegerOffsetStmt>()->input,
+                               stmt);
       modifier.insert_after(stmt, std::move(offset_stmt));
       return;
     }
@@ -274,7 +280,7 @@ class BasicBlockSimplify : public IRVisitor {
 
   void visit(WhileControlStmt *stmt) override {
     if (stmt->mask) {
-      stmt->mask = nullptr;
+      stmt->set_operand(stmt->mask, nullptr);
       modifier.mark_as_modified();
       return;
     }
@@ -347,7 +353,7 @@ class BasicBlockSimplify : public IRVisitor {
                 true_branch ? store->val : load.get(),
                 true_branch ? load.get() : store->val);
             modifier.type_check(select.get(), config);
-            store->val = select.get();
+            store->set_operand(store->val, select.get());
             modifier.insert_before(if_stmt, std::move(load));
             modifier.insert_before(if_stmt, std::move(select));
             modifier.insert_before(if_stmt, std::move(clause[i]));
@@ -438,7 +444,7 @@ class BasicBlockSimplify : public IRVisitor {
 
   void visit(WhileStmt *stmt) override {
     if (stmt->mask) {
-      stmt->mask = nullptr;
+      stmt->set_operand(stmt->mask, nullptr);
       modifier.mark_as_modified();
       return;
     }
@@ -504,6 +510,78 @@ class Simplify : public IRVisitor {
 
 const PassID FullSimplifyPass::id = "FullSimplifyPass";
 
+namespace {
+
+// Runs the passes of full_simplify, skipping a pass when the IR is unmodified
+// since it last ran without modifying it.
+class SimplifyPassScheduler {
+ public:
+  explicit SimplifyPassScheduler(
+      const std::function<void(const std::string &)> &print)
+      : print_(print) {
+  }
+
+  bool run(const std::string &name, const std::function<bool()> &pass) {
+    auto it = pass_ids_.find(name);
+    if (it == pass_ids_.end()) {
+      it = pass_ids_.emplace(name, (int)passes_.size()).first;
+      passes_.push_back({name});
+    }
+    auto &stats = passes_[it->second];
+    if (stats.clean_at == num_modifications_) {
+      stats.skips++;
+      return false;
+    }
+    auto start_time = Time::get_time();
+    bool modified = pass();
+    stats.seconds += Time::get_time() - start_time;
+    stats.runs++;
+    if (modified) {
+      stats.modifications++;
+      num_modifications_++;
+      // The pass may have enabled more of its own rewrites
+      stats.clean_at = -1;
+    } else {
+      stats.clean_at = num_modifications_;
+    }
+    print_(name);
+    return modified;
+  }
+
+  void print_stats(const std::string &kernel_name) const {
+    float64 total_seconds = 0;
+    for (auto &stats : passes_) {
+      total_seconds += stats.seconds;
+    }
+    TI_INFO("full_simplify of {}: {:.3f} ms", kernel_name,
+            total_seconds * 1e3);
+    for (auto &stats : passes_) {
+      TI_INFO("  {:<28} runs {:>3}  skips {:>3}  modified {:>3}  {:>9.3f} ms",
+              stats.name, stats.runs, stats.skips, stats.modifications,
+              stats.seconds * 1e3);
+    }
+  }
+
+ private:
+  struct PassStats {
+    std::string name;
+    // The value of num_modifications_ when the pass last ran without
+    // modifying the IR, -1 if it has to run again
+    int clean_at{-1};
+    int runs{0};
+    int skips{0};
+    int modifications{0};
+    float64 seconds{0};
+  };
+
+  std::function<void(const std::string &)> print_;
+  int num_modifications_{0};
+  std::vector<PassStats> passes_;
+  std::unordered_map<std::string, int> pass_ids_;
+};
+
+}  // namespace
+
 namespace irpass {
 
 bool simplify(IRNode *root, const CompileConfig &config) {
@@ -526,53 +604,57 @@ void full_simplify(IRNode *root,
                                  args.kernel_name + ".simplify", root);
   TI_AUTO_PROF;
   if (config.advanced_optimization) {
+    SimplifyPassScheduler scheduler(print);
     bool first_iteration = true;
     while (true) {
       bool modified = false;
-      if (extract_constant(root, config))
+      if (scheduler.run("extract_constant",
+                        [&] { return extract_constant(root, config); }))
         modified = true;
-      print("extract_constant");
-      if (unreachable_code_elimination(root))
+      if (scheduler.run("unreachable_code_elimination",
+                        [&] { return unreachable_code_elimination(root); }))
         modified = true;
-      print("unreachable_code_elimination");
-      if (binary_op_simplify(root, config))
+      if (scheduler.run("binary_op_simplify",
+                        [&] { return binary_op_simplify(root, config); }))
         modified = true;
-      print("binary_op_simplify");
-      if (config.constant_folding && constant_fold(root))
+      if (config.constant_folding &&
+          scheduler.run("constant_fold", [&] { return constant_fold(root); }))
         modified = true;
-      print("constant_fold");
-      if (die(root))
+      if (scheduler.run("die", [&] { return die(root); }))
         modified = true;
-      print("die");
-      if (alg_simp(root, config))
+      if (scheduler.run("alg_simp", [&] { return alg_simp(root, config); }))
         modified = true;
-      print("alg_simp");
-      if (loop_invariant_code_motion(root, config))
+      if (scheduler.run("loop_invariant_code_motion", [&] {
+            return loop_invariant_code_motion(root, config);
+          }))
         modified = true;
-      print("loop_invariant_code_motion");
-      if (die(root))
+      if (scheduler.run("die", [&] { return die(root); }))
         modified = true;
-      print("die");
-      if (simplify(root, config))
+      if (scheduler.run("simplify", [&] { return simplify(root, config); }))
         modified = true;
-      print("simplify");
-      if (die(root))
+      if (scheduler.run("die", [&] { return die(root); }))
         modified = true;
-      print("die");
-      if (config.opt_level > 0 && whole_kernel_cse(root))
+      if (config.opt_level > 0 &&
+          scheduler.run("whole_kernel_cse",
+                        [&] { return whole_kernel_cse(root); }))
         modified = true;
       // Don't do this time-consuming optimization pass again if the IR is
       // not modified.
       if (config.opt_level > 0 && first_iteration && config.cfg_optimization &&
-          cfg_optimization(
-              root, args.after_lower_access, args.autodiff_enabled,
-              !config.real_matrix_scalarize && !config.force_scalarize_matrix))
+          scheduler.run("cfg_optimization", [&] {
+            return cfg_optimization(
+                root, args.after_lower_access, args.autodiff_enabled,
+                !config.real_matrix_scalarize &&
+                    !config.force_scalarize_matrix);
+          }))
         modified = true;
-      print("cfg_optimization");
       first_iteration = false;
       if (!modified)
         break;
     }
+    if (config.print_full_simplify_stats) {
+      scheduler.print_stats(args.kernel_name);
+    }
     return;
   }
   if (config.constant_folding) {
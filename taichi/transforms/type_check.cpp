@@ -27,7 +27,7 @@ class TypeCheck : public IRVisitor {
       dst_type = dst_type->get_compute_type();
     }
     if (dst_type != val_type) {
-      val = insert_type_cast_before(stmt, val, dst_type);
+      stmt->set_operand(val, insert_type_cast_before(stmt, val, dst_type));
     }
     return dst_type;
   }
@@ -215,7 +215,7 @@ class TypeCheck : public IRVisitor {
               target_dtype);
         }
 
-        cast(stmt->operand, target_dtype);
+        cast(stmt, stmt->operand, target_dtype);
         stmt->ret_type = target_dtype;
       } else if (stmt->op_type == UnaryOpType::logic_not) {
         DataType target_dtype = PrimitiveType::u1;
@@ -225,7 +225,7 @@ class TypeCheck : public IRVisitor {
               target_dtype);
         }
 
-        cast(stmt->operand, target_dtype);
+        cast(stmt, stmt->operand, target_dtype);
         stmt->ret_type = target_dtype;
       }
     }
@@ -279,12 +279,13 @@ class TypeCheck : public IRVisitor {
     stmt->insert_before_me(std::move(assert_stmt));
   }
 
-  void cast(Stmt *&val, DataType dt) {
+  // Casts |val|, an operand field of |stmt|, to |dt|.
+  void cast(Stmt *stmt, Stmt *&val, DataType dt) {
     if (val->ret_type == dt)
       return;
 
     auto cast_stmt = insert_type_cast_after(val, val, dt);
-    val = cast_stmt;
+    stmt->set_operand(val, cast_stmt);
   }
 
   void visit(BinaryOpStmt *stmt) override {
@@ -317,10 +318,10 @@ class TypeCheck : public IRVisitor {
     if (stmt->op_type == BinaryOpType::truediv) {
       auto default_fp = config_.default_fp;
       if (!is_real(stmt->lhs->ret_type.get_element_type())) {
-        cast(stmt->lhs, make_dt(default_fp));
+        cast(stmt, stmt->lhs, make_dt(default_fp));
       }
       if (!is_real(stmt->rhs->ret_type.get_element_type())) {
-        cast(stmt->rhs, make_dt(default_fp));
+        cast(stmt, stmt->rhs, make_dt(default_fp));
       }
       stmt->op_type = BinaryOpType::div;
     }
@@ -331,12 +332,12 @@ class TypeCheck : public IRVisitor {
       if (stmt->rhs->ret_type == PrimitiveType::f64 ||
           stmt->lhs->ret_type == PrimitiveType::f64) {
         stmt->ret_type = make_dt(PrimitiveType::f64);
-        cast(stmt->rhs, make_dt(PrimitiveType::f64));
-        cast(stmt->lhs, make_dt(PrimitiveType::f64));
+        cast(stmt, stmt->rhs, make_dt(PrimitiveType::f64));
+        cast(stmt, stmt->lhs, make_dt(PrimitiveType::f64));
       } else {
         stmt->ret_type = make_dt(PrimitiveType::f32);
-        cast(stmt->rhs, make_dt(PrimitiveType::f32));
-        cast(stmt->lhs, make_dt(PrimitiveType::f32));
+        cast(stmt, stmt->rhs, make_dt(PrimitiveType::f32));
+        cast(stmt, stmt->lhs, make_dt(PrimitiveType::f32));
       }
     }
 
@@ -364,12 +365,12 @@ class TypeCheck : public IRVisitor {
       if (ret_type != stmt->lhs->ret_type) {
         // promote lhs
         auto cast_stmt = insert_type_cast_before(stmt, stmt->lhs, ret_type);
-        stmt->lhs = cast_stmt;
+        stmt->set_operand(stmt->lhs, cast_stmt);
       }
       if (ret_type != stmt->rhs->ret_type) {
         // promote rhs
         auto cast_stmt = insert_type_cast_before(stmt, stmt->rhs, ret_type);
-        stmt->rhs = cast_stmt;
+        stmt->set_operand(stmt->rhs, cast_stmt);
       }
     }
     bool matching = true;
@@ -392,11 +393,11 @@ class TypeCheck : public IRVisitor {
       TI_ASSERT(is_integral(stmt->op1->ret_type.get_element_type()));
       if (ret_type != stmt->op2->ret_type) {
         auto cast_stmt = insert_type_cast_before(stmt, stmt->op2, ret_type);
-        stmt->op2 = cast_stmt;
+        stmt->set_operand(stmt->op2, cast_stmt);
       }
       if (ret_type != stmt->op3->ret_type) {
         auto cast_stmt = insert_type_cast_before(stmt, stmt->op3, ret_type);
-        stmt->op3 = cast_stmt;
+        stmt->set_operand(stmt->op3, cast_stmt);
       }
       stmt->ret_type = ret_type;
     } else {
@@ -584,7 +585,7 @@ class TypeCheck : public IRVisitor {
     auto element_dtype = tensor_type->get_element_type();
     for (int i = 0; i < stmt->values.size(); ++i) {
       if (element_dtype != stmt->values[i]->ret_type) {
-        cast(stmt->values[i], element_dtype);
+        cast(stmt, stmt->values[i], element_dtype);
       }
     }
   }
@@ -0,0 +1,36 @@
+#include "gtest/gtest.h"
+
+#include "taichi/rhi/cpu/cpu_device.h"
+
+namespace taichi::lang {
+
+TEST(CpuDevice, ReuseSlotsOfFreedAllocations) {
+  cpu::CpuDevice device;
+  Device::AllocParams params;
+  params.size = 4096;
+
+  DeviceAllocation alloc1;
+  ASSERT_EQ(device.allocate_memory(params, &alloc1), RhiResult::success);
+  void *ptr1 = device.get_alloc_info(alloc1).ptr;
+  device.dealloc_memory(alloc1);
+
+  // The next allocation takes over the slot, but not the handle
+  DeviceAllocation alloc2;
+  ASSERT_EQ(device.allocate_memory(params, &alloc2), RhiResult::success);
+  EXPECT_NE(alloc2.alloc_id, alloc1.alloc_id);
+  EXPECT_EQ(uint32_t(alloc2.alloc_id), uint32_t(alloc1.alloc_id));
+  EXPECT_EQ(device.get_alloc_info(alloc2).ptr, ptr1);
+
+  void *mapped = nullptr;
+  EXPECT_EQ(device.map(alloc1, &mapped), RhiResult::invalid_usage);
+  EXPECT_EQ(device.map(alloc2, &mapped), RhiResult::success);
+  EXPECT_EQ(mapped, ptr1);
+
+  // Freeing the stale handle again must not free the new owner's buffer
+  EXPECT_ANY_THROW(device.dealloc_memory(alloc1));
+  EXPECT_EQ(device.get_alloc_info(alloc2).ptr, ptr1);
+  device.dealloc_memory(alloc2);
+  EXPECT_ANY_THROW(device.dealloc_memory(alloc2));
+}
+
+}  // namespace taichi::lang
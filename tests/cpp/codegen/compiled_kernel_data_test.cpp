@@ -40,6 +40,9 @@ class FakeCompiledKernelData : public CompiledKernelData {
       return CompiledKernelData::Err::kParseMetadataFailed;
     }
     compiled_data_.so_bin = file.src_code();
+    for (const auto &src : file.shared_srcs()) {
+      compiled_data_.so_bin += src;
+    }
     return CompiledKernelData::Err::kNoError;
   }
 
@@ -64,6 +67,25 @@ class FakeCompiledKernelData : public CompiledKernelData {
     std::string so_bin;
   } compiled_data_;
 };
+
+class FakeSharedSrcStore : public SharedSrcStore {
+ public:
+  bool load(const std::string &key, std::string &src) override {
+    auto iter = srcs.find(key);
+    if (iter == srcs.end()) {
+      return false;
+    }
+    src = iter->second;
+    return true;
+  }
+
+  bool store(const std::string &key, const std::string &src) override {
+    srcs[key] = src;
+    return true;
+  }
+
+  std::unordered_map<std::string, std::string> srcs;
+};
 }  // namespace
 
 TEST(CompiledKernelDataTest, Correct) {
@@ -182,4 +204,56 @@ TEST(CompiledKernelDataTest, Error) {
   }
 }
 
+TEST(CompiledKernelDataTest, CompressedAndSharedSrcs) {
+  using Err = CompiledKernelData::Err;
+  using FErr = CompiledKernelDataFile::Err;
+
+  std::string metadata_j = "{ \"func_names\" : [ \"f_1\" ] }";
+  std::string so_bin = "I am a so...";
+  std::string shared_src(4096, 'r');
+
+  CompiledKernelDataFile file;
+  file.set_arch(kFakeArch);
+  file.set_metadata(metadata_j);
+  file.set_src_code(so_bin);
+  file.add_shared_src(shared_src);
+
+  {  // Shared sources are kept in the file without a store
+    std::ostringstream oss;
+    EXPECT_EQ(file.dump(oss), FErr::kNoError);
+    auto fckd = std::make_unique<FakeCompiledKernelData>();
+    std::istringstream iss(oss.str());
+    EXPECT_EQ(fckd->load(iss), Err::kNoError);
+    EXPECT_EQ(fckd->compiled_data_.so_bin, so_bin + shared_src);
+  }
+
+  {  // Compressed, with the shared sources in a store
+    FakeSharedSrcStore store;
+    auto file_copy = file;
+    file_copy.set_compressed(true);
+    file_copy.set_shared_src_store(&store);
+    std::ostringstream oss;
+    EXPECT_EQ(file_copy.dump(oss), FErr::kNoError);
+    auto ser_data = oss.str();
+    EXPECT_LT(ser_data.size(), shared_src.size());
+    EXPECT_EQ(store.srcs.size(), 1);
+
+    auto fckd = std::make_unique<FakeCompiledKernelData>();
+    std::istringstream iss(ser_data);
+    EXPECT_EQ(fckd->load(iss, &store), Err::kNoError);
+    EXPECT_EQ(fckd->compiled_data_.metadata.func_names,
+              std::vector<std::string>{"f_1"});
+    EXPECT_EQ(fckd->compiled_data_.so_bin, so_bin + shared_src);
+
+    // The shared source is missing
+    std::istringstream iss_no_store(ser_data);
+    EXPECT_EQ(fckd->load(iss_no_store), Err::kSharedSrcNotFound);
+
+    // The shared source doesn't match its key
+    store.srcs.begin()->second[0] = 'B';
+    std::istringstream iss_bad_store(ser_data);
+    EXPECT_EQ(fckd->load(iss_bad_store, &store), Err::kCorruptedFile);
+  }
+}
+
 }  // namespace taichi::lang
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "taichi/system/timeline.h"
+#include "taichi/util/io.h"
+
+namespace taichi {
+
+namespace {
+
+int count_substr(const std::string &str, const std::string &sub) {
+  int count = 0;
+  for (auto pos = str.find(sub); pos != std::string::npos;
+       pos = str.find(sub, pos + sub.size())) {
+    count++;
+  }
+  return count;
+}
+
+std::string save_timelines() {
+  std::string filename = fmt::format("{}.json", std::tmpnam(nullptr));
+  Timelines::get_instance().save(filename);
+  std::ifstream fin(filename);
+  std::stringstream ss;
+  ss << fin.rdbuf();
+  taichi::remove(filename);
+  return ss.str();
+}
+
+}  // namespace
+
+TEST(TimelineTest, RecordAndSave) {
+  auto &timelines = Timelines::get_instance();
+  timelines.set_enabled(true);
+  timelines.clear();
+  {
+    TI_TIMELINE("outer");
+    { TI_TIMELINE("inner"); }
+  }
+  // Events of an exited thread are kept
+  std::thread([] {
+    Timeline::get_this_thread_instance().set_name("worker");
+    TI_TIMELINE("outer");
+  }).join();
+  // Events of another tid
+  auto &timeline = Timeline::get_this_thread_instance();
+  auto t = Time::get_time();
+  timeline.insert_event({"kernel", true, t, "cuda"});
+  timeline.insert_event({"kernel", false, t + 1e-3, "cuda"});
+  auto trace = save_timelines();
+  EXPECT_EQ(trace.front(), '[');
+  EXPECT_EQ(trace.back(), ']');
+  EXPECT_EQ(count_substr(trace, "\"ph\":\"B\""), 4);
+  EXPECT_EQ(count_substr(trace, "\"ph\":\"E\""), 4);
+  EXPECT_EQ(count_substr(trace, "\"name\":\"outer\""), 4);
+  EXPECT_EQ(count_substr(trace, "\"tid\":\"worker\""), 2);
+  EXPECT_EQ(count_substr(trace, "\"tid\":\"cuda\""), 2);
+
+  // Nothing is recorded once disabled
+  timelines.clear();
+  timelines.set_enabled(false);
+  { TI_TIMELINE("disabled"); }
+  EXPECT_EQ(count_substr(save_timelines(), "\"ph\""), 0);
+}
+
+TEST(TimelineTest, KeepsNewestEvents) {
+  auto &timelines = Timelines::get_instance();
+  timelines.set_enabled(true);
+  timelines.clear();
+  const int num_pairs = Timeline::kCapacity / 2 + 10;
+  for (int i = 0; i < num_pairs; i++) {
+    TI_TIMELINE("event");
+  }
+  auto trace = save_timelines();
+  EXPECT_EQ(count_substr(trace, "\"ph\""), Timeline::kCapacity);
+
+  // The ring wraps in the middle of events, whose end records are dropped
+  timelines.clear();
+  const int num_inner_pairs = Timeline::kCapacity / 2;
+  {
+    TI_TIMELINE("outer");
+    for (int i = 0; i < num_inner_pairs; i++) {
+      TI_TIMELINE("inner");
+    }
+  }
+  trace = save_timelines();
+  const int num_begins = count_substr(trace, "\"ph\":\"B\"");
+  EXPECT_EQ(num_begins, num_inner_pairs - 1);
+  EXPECT_EQ(count_substr(trace, "\"ph\":\"E\""), num_begins);
+  EXPECT_EQ(count_substr(trace, "\"name\":\"outer\""), 0);
+  timelines.clear();
+  timelines.set_enabled(false);
+}
+
+}  // namespace taichi
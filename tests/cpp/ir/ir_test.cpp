@@ -41,5 +41,74 @@ TEST(Block, EraseRange) {
   EXPECT_EQ(b.locate(stmt_ptrs.back()), 1);
 }
 
+TEST(Stmt, Users) {
+  Block b;
+  auto s1 = b.insert(make_const_i32(1));
+  auto s2 = b.insert(make_const_i32(2));
+  auto add = b.push_back<BinaryOpStmt>(BinaryOpType::add, s1, s1);
+  auto mul = b.push_back<BinaryOpStmt>(BinaryOpType::mul, add, s2);
+  EXPECT_EQ(s1->get_users().size(), 2);
+  EXPECT_EQ(add->get_users(),
+            (std::vector<std::pair<Stmt *, int>>{{mul, 0}}));
+
+  mul->set_operand(0, s1);
+  EXPECT_EQ(s1->get_users().size(), 3);
+  EXPECT_TRUE(add->get_users().empty());
+
+  // An operand field assigned directly is detected
+  auto bin = mul->as<BinaryOpStmt>();
+  bin->rhs = add;
+  EXPECT_FALSE(mul->operand_uses_linked());
+  bin->set_operand(bin->rhs, add);
+  EXPECT_TRUE(mul->operand_uses_linked());
+  EXPECT_TRUE(s2->get_users().empty());
+  EXPECT_EQ(add->get_users(),
+            (std::vector<std::pair<Stmt *, int>>{{mul, 1}}));
+}
+
+TEST(Stmt, ReplaceUsagesWith) {
+  Block b;
+  auto s1 = b.insert(make_const_i32(1));
+  auto s2 = b.insert(make_const_i32(2));
+  auto add = b.push_back<BinaryOpStmt>(BinaryOpType::add, s1, s1);
+  // Not in the block yet
+  auto mul = Stmt::make_typed<BinaryOpStmt>(BinaryOpType::mul, s1, s2);
+  s1->replace_usages_with(s2);
+  EXPECT_EQ(add->operand(0), s2);
+  EXPECT_EQ(add->operand(1), s2);
+  EXPECT_EQ(mul->lhs, s1);
+  EXPECT_EQ(s1->get_users().size(), 1);
+  EXPECT_EQ(s2->get_users().size(), 3);
+}
+
+TEST(Stmt, DestroyOperandFirst) {
+  auto s1 = make_const_i32(1);
+  auto neg = Stmt::make_typed<UnaryOpStmt>(UnaryOpType::neg, s1.get());
+  auto abs = Stmt::make_typed<UnaryOpStmt>(UnaryOpType::abs, s1.get());
+  abs.reset();
+  EXPECT_EQ(s1->get_users().size(), 1);
+  s1.reset();
+  neg.reset();
+}
+
+TEST(StmtChangeRecorder, TakeAffected) {
+  Block b;
+  auto s1 = b.insert(make_const_i32(1));
+  auto s2 = b.insert(make_const_i32(2));
+  auto add = b.push_back<BinaryOpStmt>(BinaryOpType::add, s1, s1);
+  auto mul = b.push_back<BinaryOpStmt>(BinaryOpType::mul, add, s2);
+  auto neg = b.push_back<UnaryOpStmt>(UnaryOpType::neg, s2);
+  StmtChangeRecorder recorder;
+  add->set_operand(1, s2);
+  EXPECT_EQ(recorder.take_affected(&b), (std::vector<Stmt *>{add, mul}));
+  EXPECT_TRUE(recorder.take_affected(&b).empty());
+
+  // Erased statements and statements out of the tree are dropped
+  neg->set_operand(0, s1);
+  b.erase(neg);
+  auto sub = Stmt::make_typed<BinaryOpStmt>(BinaryOpType::sub, s1, s2);
+  EXPECT_TRUE(recorder.take_affected(&b).empty());
+}
+
 }  // namespace
 }  // namespace taichi::lang
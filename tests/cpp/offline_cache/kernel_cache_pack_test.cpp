@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "taichi/compilation_manager/kernel_cache_pack.h"
+#include "taichi/util/io.h"
+
+namespace taichi::lang {
+
+TEST(OfflineCache, KernelCachePack) {
+  std::string pack_file = fmt::format("{}.pack", std::tmpnam(nullptr));
+
+  // A missing pack file is empty
+  {
+    KernelCachePack pack(pack_file);
+    EXPECT_EQ(pack.size(), 0);
+    EXPECT_TRUE(pack.find("1").empty());
+  }
+  // Append two batches, the newest kernel wins
+  ASSERT_TRUE(KernelCachePack::append(pack_file, {{"1", "aaaa"}, {"2", "bb"}}));
+  ASSERT_TRUE(KernelCachePack::append(pack_file, {{"2", "cc"}, {"3", "d"}}));
+  {
+    KernelCachePack pack(pack_file);
+    EXPECT_EQ(pack.size(), 3);
+    EXPECT_EQ(pack.find("1"), "aaaa");
+    EXPECT_EQ(pack.find("2"), "cc");
+    EXPECT_EQ(pack.find("3"), "d");
+    EXPECT_TRUE(pack.find("4").empty());
+  }
+  // A pack file under the limit is kept as is
+  KernelCachePack::compact(pack_file, 1024 * 1024, 0.25);
+  EXPECT_EQ(KernelCachePack(pack_file).size(), 3);
+  // Only the newest kernels are kept once over the limit
+  KernelCachePack::compact(pack_file, 1, 0.0);
+  EXPECT_FALSE(path_exists(pack_file));
+  ASSERT_TRUE(
+      KernelCachePack::append(pack_file, {{"1", std::string(64, 'a')}}));
+  ASSERT_TRUE(KernelCachePack::append(pack_file, {{"2", "b"}}));
+  KernelCachePack::compact(pack_file, 64, 0.0);
+  {
+    KernelCachePack pack(pack_file);
+    EXPECT_EQ(pack.size(), 1);
+    EXPECT_EQ(pack.find("2"), "b");
+  }
+  // A corrupted pack file is recreated by the next append
+  std::ofstream(pack_file, std::ios::trunc | std::ios::binary)
+      << "I-AM-BAD-BYTES" << std::flush;
+  EXPECT_EQ(KernelCachePack(pack_file).size(), 0);
+  ASSERT_TRUE(KernelCachePack::append(pack_file, {{"5", "e"}}));
+  {
+    KernelCachePack pack(pack_file);
+    EXPECT_EQ(pack.size(), 1);
+    EXPECT_EQ(pack.find("5"), "e");
+  }
+
+  taichi::remove(pack_file);
+}
+
+}  // namespace taichi::lang
@@ -0,0 +1,45 @@
+#include "gtest/gtest.h"
+
+#include "taichi/program/program.h"
+#include "tests/cpp/ir/ndarray_kernel.h"
+#include "tests/cpp/program/test_program.h"
+
+namespace taichi::lang {
+
+TEST(Program, CompileKernelsConcurrently) {
+  TestProgram test_prog;
+  test_prog.setup(Arch::x64);
+  auto *prog = test_prog.prog();
+
+  const int size = 10;
+  auto array = Ndarray(prog, PrimitiveType::i32, {size});
+  array.write_int({0}, 2);
+  array.write_int({2}, 40);
+  auto ker1 = setup_kernel1(prog);
+  auto ker2 = setup_kernel2(prog);
+
+  // The same kernel submitted twice is compiled once.
+  auto compiled = prog->compile_kernels(prog->compile_config(),
+                                        prog->get_device_caps(),
+                                        {ker1.get(), ker2.get(), ker1.get()});
+  ASSERT_EQ(compiled.size(), 3);
+  EXPECT_NE(compiled[0], compiled[1]);
+  EXPECT_EQ(compiled[0], compiled[2]);
+  // Later compilations are served from the cache.
+  EXPECT_EQ(&prog->compile_kernel(prog->compile_config(),
+                                  prog->get_device_caps(), *ker2),
+            compiled[1]);
+
+  auto launch_ctx1 = ker1->make_launch_context();
+  launch_ctx1.set_arg_ndarray(/*arg_id=*/{0}, array);
+  prog->launch_kernel(*compiled[0], launch_ctx1);
+  auto launch_ctx2 = ker2->make_launch_context();
+  launch_ctx2.set_arg_ndarray(/*arg_id=*/{0}, array);
+  launch_ctx2.set_arg_int(/*arg_id=*/{1}, 3);
+  prog->launch_kernel(*compiled[1], launch_ctx2);
+  prog->synchronize();
+  EXPECT_EQ(array.read_int({1}), 3);
+  EXPECT_EQ(array.read_int({2}), 42);
+}
+
+}  // namespace taichi::lang
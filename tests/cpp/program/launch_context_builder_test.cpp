@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+
+#include "taichi/program/launch_context_builder.h"
+#define TI_RUNTIME_HOST
+#include "taichi/program/context.h"
+#undef TI_RUNTIME_HOST
+#include "tests/cpp/ir/ndarray_kernel.h"
+#include "tests/cpp/program/test_program.h"
+
+namespace taichi::lang {
+
+TEST(LaunchContextBuilder, ParameterLayout) {
+  TestProgram test_prog;
+  test_prog.setup(Arch::x64);
+
+  auto ker = setup_kernel2(test_prog.prog());
+  const auto &layout = *ker->get_parameter_layout();
+  ASSERT_EQ(layout.slots.size(), 2);
+  EXPECT_EQ(layout.find_slot({0}), 0);
+  EXPECT_EQ(layout.find_slot({1}), 1);
+  EXPECT_EQ(layout.find_slot({0, 0}), -1);
+
+  // The ndarray slot knows where its pointer and shape go.
+  const auto &arr = layout.slots[0];
+  EXPECT_TRUE(arr.parameter.is_array);
+  EXPECT_EQ(arr.data_ptr_offset,
+            ker->args_type->get_element_offset(
+                {0, TypeFactory::DATA_PTR_POS_IN_NDARRAY}));
+  EXPECT_EQ(arr.grad_ptr_offset, -1);
+  ASSERT_EQ(arr.shape_offsets.size(), 1);
+  EXPECT_EQ(arr.shape_offsets[0],
+            ker->args_type->get_element_offset(
+                {0, TypeFactory::SHAPE_POS_IN_NDARRAY, 0}));
+  EXPECT_EQ(layout.slots[1].data_ptr_offset, -1);
+
+  // The layout is shared by every launch until the parameters change.
+  EXPECT_EQ(ker->get_parameter_layout().get(), &layout);
+}
+
+TEST(LaunchContextBuilder, BindBySlot) {
+  TestProgram test_prog;
+  test_prog.setup(Arch::x64);
+
+  const int size = 10;
+  auto array = Ndarray(test_prog.prog(), PrimitiveType::i32, {size});
+  auto ker = setup_kernel2(test_prog.prog());
+  auto launch_ctx = ker->make_launch_context();
+  launch_ctx.set_arg_ndarray(/*arg_id=*/{0}, array);
+  launch_ctx.set_arg_int(/*arg_id=*/{1}, 3);
+
+  auto &binding = launch_ctx.get_binding(0);
+  EXPECT_EQ(binding.device_allocation_type,
+            LaunchContextBuilder::DevAllocType::kNdarray);
+  EXPECT_EQ(binding.runtime_size, size);
+  EXPECT_EQ((intptr_t)binding.data_ptr,
+            array.get_device_allocation_ptr_as_int());
+  EXPECT_EQ(&launch_ctx.get_binding({0}), &binding);
+  EXPECT_EQ(launch_ctx.get_struct_arg<int32>(
+                {0, TypeFactory::SHAPE_POS_IN_NDARRAY, 0}),
+            size);
+  EXPECT_EQ(launch_ctx.get_binding(1).device_allocation_type,
+            LaunchContextBuilder::DevAllocType::kNone);
+
+  launch_ctx.set_ndarray_ptrs(/*slot=*/0, /*data_ptr=*/0x1000,
+                              /*grad_ptr=*/0);
+  EXPECT_EQ(launch_ctx.get_struct_arg<uint64>(
+                {0, TypeFactory::DATA_PTR_POS_IN_NDARRAY}),
+            0x1000);
+}
+
+}  // namespace taichi::lang
@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include "taichi/rhi/common/host_caching_allocator.h"
+#include "taichi/rhi/common/host_memory_pool.h"
+
+namespace taichi::lang {
+
+TEST(HostCachingAllocator, SizeClasses) {
+  const std::size_t page_size = HostMemoryPool::page_size;
+  EXPECT_EQ(HostCachingAllocator::get_size_class(1), page_size);
+  EXPECT_EQ(HostCachingAllocator::get_size_class(page_size), page_size);
+  EXPECT_EQ(HostCachingAllocator::get_size_class(page_size + 1),
+            2 * page_size);
+  // Four classes per power of two once over four pages
+  const std::size_t mb = 1 << 20;
+  EXPECT_EQ(HostCachingAllocator::get_size_class(mb), mb);
+  EXPECT_EQ(HostCachingAllocator::get_size_class(mb + 1), mb + mb / 4);
+  EXPECT_EQ(HostCachingAllocator::get_size_class(mb + mb / 2 + 1),
+            mb + mb * 3 / 4);
+}
+
+TEST(HostCachingAllocator, RecycleBlocks) {
+  HostCachingAllocator allocator(HostMemoryPool::get_instance(),
+                                 /*max_cached_bytes=*/64 * 1024);
+  bool recycled = true;
+  void *ptr1 = allocator.allocate(10000, &recycled);
+  ASSERT_NE(ptr1, nullptr);
+  EXPECT_FALSE(recycled);
+
+  // A block is reused by any size of the same class
+  allocator.release(10000, ptr1);
+  EXPECT_EQ(allocator.allocate(9000, &recycled), ptr1);
+  EXPECT_TRUE(recycled);
+  void *ptr2 = allocator.allocate(10000, &recycled);
+  EXPECT_NE(ptr2, ptr1);
+  EXPECT_FALSE(recycled);
+
+  auto stats = allocator.get_stats();
+  EXPECT_EQ(stats.num_allocations, 3);
+  EXPECT_EQ(stats.num_cache_hits, 1);
+  EXPECT_EQ(stats.bytes_cached, 0);
+  EXPECT_EQ(stats.bytes_in_use, 2 * 12288);
+  EXPECT_EQ(stats.peak_bytes, 2 * 12288);
+
+  // Blocks over the cache limit go back to the pool
+  void *big = allocator.allocate(128 * 1024);
+  allocator.release(128 * 1024, big);
+  allocator.release(9000, ptr1);
+  allocator.release(10000, ptr2);
+  stats = allocator.get_stats();
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.bytes_cached, 2 * 12288);
+
+  allocator.trim();
+  EXPECT_EQ(allocator.get_stats().bytes_cached, 0);
+  void *ptr3 = allocator.allocate(10000, &recycled);
+  EXPECT_FALSE(recycled);
+  allocator.release(10000, ptr3);
+}
+
+}  // namespace taichi::lang
@@ -118,6 +118,7 @@ user_api[ti] = [
     "cache_read_only",
     "cast",
     "ceil",
+    "compile_kernels",
     "cos",
     "cpu",
     "cuda",
@@ -0,0 +1,42 @@
+import numpy as np
+
+import taichi as ti
+from tests import test_utils
+
+
+@test_utils.test(arch=ti.cpu, num_compile_threads=4)
+def test_compile_kernels():
+    n = 16
+    x = ti.ndarray(ti.f32, shape=n)
+
+    @ti.kernel
+    def fill(x: ti.types.ndarray(dtype=ti.f32, ndim=1), v: ti.f32):
+        for i in x:
+            x[i] = v + i
+
+    @ti.kernel
+    def scale(x: ti.types.ndarray(dtype=ti.f32, ndim=1)):
+        for i in x:
+            x[i] *= 2
+
+    ti.compile_kernels([(fill, (x, 1.0)), (scale, (x,))])
+    fill(x, 1.0)
+    scale(x)
+    np.testing.assert_allclose(x.to_numpy(), 2 * (np.arange(n) + 1.0))
+
+
+@test_utils.test(arch=ti.cpu)
+def test_compile_kernels_data_oriented():
+    @ti.data_oriented
+    class Counter:
+        def __init__(self):
+            self.x = ti.field(ti.i32, shape=())
+
+        @ti.kernel
+        def add(self, v: ti.i32):
+            self.x[None] += v
+
+    c = Counter()
+    ti.compile_kernels([(c.add, (1,))])
+    c.add(3)
+    assert c.x[None] == 3
@@ -320,3 +320,37 @@ def test_append_matrix_in_struct():
             for k in range(4):
                 assert f[i, j].b[k // 2, k % 2] == i * j * (k + 1) % 256
             assert f[i, j].c == i * j * 5000 % 65536
+
+
+@pytest.mark.parametrize("chunk_size", [4, 64])
+@test_utils.test(require=ti.extension.sparse, exclude=[ti.metal])
+def test_dynamic_chunk_table(chunk_size):
+    # Long enough for the chunk table; with 4-element chunks its blocks only
+    # hold 3 pointers, so the table is several levels deep.
+    n = 1 << 16
+    x = ti.field(ti.i32)
+    lists = ti.root.dense(ti.i, 2).dynamic(ti.j, n, chunk_size=chunk_size)
+    lists.place(x)
+
+    @ti.kernel
+    def append():
+        for i in range(2):
+            for j in range(n):
+                x[i].append(i * n + j)
+
+    @ti.kernel
+    def check() -> ti.i32:
+        num_errors = 0
+        for i, j in x:
+            # Visit the chunks in a scattered order.
+            k = (j * 7919) % n
+            if x[i, k] != i * n + k:
+                num_errors += 1
+        return num_errors
+
+    for _ in range(2):
+        append()
+        assert x[0].length() == n
+        assert x[1].length() == n
+        assert check() == 0
+        lists.deactivate_all()
@@ -88,3 +88,49 @@ def test_pointer_gc():
 
         # Note that being inactive doesn't mean it's not allocated.
         assert L._num_dynamically_allocated == 1
+
+
+@test_utils.test(arch=ti.cpu, cpu_max_num_threads=4)
+def test_pointer_gc_parallel():
+    # 4096 blocks of 4 KB are recycled at once, enough for the GC to run on
+    # the thread pool.
+    n = 4096
+    block_size = 1024
+    x = ti.field(ti.f32)
+    block = ti.root.pointer(ti.i, n)
+    block.dense(ti.i, block_size).place(x)
+
+    @ti.kernel
+    def fill():
+        for i in range(n * block_size):
+            x[i] = i + 1
+
+    @ti.kernel
+    def activate():
+        for i in range(n):
+            ti.activate(block, i)
+
+    @ti.kernel
+    def check() -> ti.i32:
+        num_errors = 0
+        for i in x:
+            if x[i] != 0:
+                num_errors += 1
+        return num_errors
+
+    @ti.kernel
+    def count_active() -> ti.i32:
+        num_active = 0
+        for i in block:
+            num_active += 1
+        return num_active
+
+    for _ in range(3):
+        fill()
+        block.deactivate_all()
+        activate()
+        assert count_active() == n
+        # Reused blocks must have been zeroed by the GC.
+        assert check() == 0
+    # Apart from what thread caches hold back, blocks are reused.
+    assert n <= block._num_dynamically_allocated < 2 * n
@@ -186,6 +186,43 @@ def test_ndarray_dtype_mismatch_runtime():
         g.run({"pos": a})
 
 
+
+@test_utils.test(arch=supported_archs_cgraph + [ti.cpu, ti.cuda])
+def test_bound_graph_replay():
+    n = 4
+
+    @ti.kernel
+    def inc(pos: ti.types.ndarray(dtype=ti.i32, ndim=1), delta: ti.i32):
+        for i in range(n):
+            pos[i] += delta
+
+    sym_pos = ti.graph.Arg(ti.graph.ArgKind.NDARRAY, "pos", ti.i32, ndim=1)
+    sym_delta = ti.graph.Arg(ti.graph.ArgKind.SCALAR, "delta", ti.i32)
+    g_init = ti.graph.GraphBuilder()
+    g_init.dispatch(inc, sym_pos, sym_delta)
+    g_init.dispatch(inc, sym_pos, sym_delta)
+    g = g_init.compile()
+
+    a = ti.ndarray(ti.i32, shape=(n,))
+    b = ti.ndarray(ti.i32, shape=(n,))
+    bound = g.bind({"pos": a, "delta": 1})
+    for _ in range(3):
+        bound.run()
+    assert (a.to_numpy() == np.full(n, 6)).all()
+
+    bound.set_args({"delta": 2})
+    bound.run()
+    assert (a.to_numpy() == np.full(n, 10)).all()
+
+    bound.set_args({"pos": b})
+    bound.run()
+    assert (a.to_numpy() == np.full(n, 10)).all()
+    assert (b.to_numpy() == np.full(n, 4)).all()
+
+    c = ti.ndarray(ti.f32, shape=(n,))
+    with pytest.raises(RuntimeError, match="but got an ndarray with dtype="):
+        bound.set_args({"pos": c})
+
 def build_graph_vector(N, dtype):
     @ti.kernel
     def vector_sum(mat: ti.types.vector(N, dtype), res: ti.types.ndarray(dtype=dtype, ndim=1)):
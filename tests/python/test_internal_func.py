@@ -40,6 +40,15 @@ def test_list_manager():
     test()
 
 
+@test_utils.test(exclude=[ti.metal, ti.opengl, ti.gles, ti.cuda, ti.vulkan, ti.amdgpu])
+def test_list_manager_64bit():
+    @ti.kernel
+    def test():
+        impl.call_internal("test_list_manager_64bit")
+
+    test()
+
+
 @test_utils.test(exclude=[ti.metal, ti.opengl, ti.gles, ti.cuda, ti.vulkan, ti.amdgpu])
 def test_node_manager():
     @ti.kernel
@@ -59,6 +68,15 @@ def test_node_manager_gc():
     test_cpu()
 
 
+@test_utils.test(arch=[ti.cpu])
+def test_node_manager_thread_cache():
+    @ti.kernel
+    def test():
+        impl.call_internal("test_node_allocator_thread_cache")
+
+    test()
+
+
 @test_utils.test(arch=[ti.cpu, ti.cuda, ti.amdgpu], debug=True)
 def test_return():
     @ti.kernel
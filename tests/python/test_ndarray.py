@@ -1161,3 +1161,20 @@ def test_real_func_write_ndarray_cfg():
     a = ti.Vector.ndarray(3, float, shape=(2,))
     foo(a)
     assert (a[0] == vec3(3)).all()
+
+
+@test_utils.test(arch=ti.cpu)
+def test_ndarray_caching_allocator():
+    x = ti.ndarray(ti.i32, shape=1024)
+    x.fill(7)
+    del x
+    stats = ti.profiler.get_caching_allocator_stats()
+    assert stats["bytes_cached"] > 0
+
+    # The memory of |x| is recycled, and zeroed again.
+    y = ti.ndarray(ti.i32, shape=1024)
+    assert (y.to_numpy() == 0).all()
+    new_stats = ti.profiler.get_caching_allocator_stats()
+    assert new_stats["num_cache_hits"] > stats["num_cache_hits"]
+    assert new_stats["hit_rate"] > 0
+    assert new_stats["peak_bytes"] >= new_stats["bytes_in_use"]
@@ -384,6 +384,61 @@ def test_calling_many_kernels(curr_arch):
     assert added_files() == expected_num_cache_files(len(simple_kernels_to_test))
 
 
+@pytest.mark.parametrize("curr_arch", supported_archs_offline_cache)
+@_test_offline_cache_dec
+def test_offline_cache_pack_file(curr_arch):
+    pack_path = join(tmp_offline_cache_file_path(), "ticache.pack")
+
+    def helper():
+        for kernel, args, get_res in simple_kernels_to_test:
+            assert kernel(*args) == test_utils.approx(get_res(*args))
+
+    ti.init(arch=curr_arch, enable_fallback=False, offline_cache_format="pack", **current_thread_ext_options())
+    helper()
+    ti.reset()
+    assert listdir(tmp_offline_cache_file_path()) == ["ticache.pack"]
+    size_of_pack = stat(pack_path).st_size
+
+    # Every kernel is loaded from the pack, so nothing is appended to it.
+    ti.init(arch=curr_arch, enable_fallback=False, offline_cache_format="pack", **current_thread_ext_options())
+    helper()
+    ti.reset()
+    assert listdir(tmp_offline_cache_file_path()) == ["ticache.pack"]
+    assert stat(pack_path).st_size == size_of_pack
+
+
+@pytest.mark.parametrize("curr_arch", supported_archs_offline_cache)
+@pytest.mark.parametrize("compression", [False, True])
+@pytest.mark.parametrize("dedup", [False, True])
+@_test_offline_cache_dec
+def test_offline_cache_compression_and_dedup(curr_arch, compression, dedup):
+    def helper():
+        ti.init(
+            arch=curr_arch,
+            enable_fallback=False,
+            offline_cache_compression=compression,
+            offline_cache_dedup=dedup,
+            **current_thread_ext_options(),
+        )
+        for kernel, args, get_res in simple_kernels_to_test:
+            assert kernel(*args) == test_utils.approx(get_res(*args))
+        ti.reset()
+
+    def cached_files():
+        return sorted(listdir(tmp_offline_cache_file_path()))
+
+    helper()
+    files = cached_files()
+    num_kernel_files = len([f for f in files if is_offline_cache_file(f)])
+    assert num_kernel_files == len(simple_kernels_to_test)
+    if not dedup:
+        assert not any(f.endswith(".tis") for f in files)
+
+    # Every kernel is loaded from the cache, so nothing is added to it.
+    helper()
+    assert cached_files() == files
+
+
 @pytest.mark.parametrize("curr_arch", supported_archs_offline_cache)
 @_test_offline_cache_dec
 def test_offline_cache_with_different_snode_trees(curr_arch):
@@ -1,3 +1,5 @@
+import pytest
+
 import taichi as ti
 from tests import test_utils
 
@@ -87,3 +89,84 @@ def test_loop_config_block_dim_adaptive():
     val_np = val.to_numpy()
     for i in range(n):
         assert val_np[i] == i
+
+
+@pytest.mark.parametrize("schedule", ["static", "dynamic", "guided"])
+@test_utils.test(arch=[ti.cpu])
+def test_loop_config_schedule(schedule):
+    n = 10000
+    val = ti.field(ti.i32, shape=(n))
+
+    @ti.kernel
+    def fill(begin: ti.i32) -> ti.i32:
+        s = 0
+        ti.loop_config(schedule=schedule, block_dim=4)
+        for i in range(begin, n):
+            # Skewed work, so that chunks finish out of order.
+            t = 0
+            for j in range(i % 97):
+                t += 1
+            val[i] = i + t - i % 97
+            s += 1
+        return s
+
+    # Later launches size their chunks from the earlier ones.
+    for begin in [0, 0, 5000, n - 3, n]:
+        val.fill(-1)
+        assert fill(begin) == n - begin
+        val_np = val.to_numpy()
+        assert (val_np[:begin] == -1).all()
+        assert (val_np[begin:] == range(begin, n)).all()
+
+
+@test_utils.test(arch=[ti.cpu], cpu_loop_schedule="dynamic")
+def test_cpu_loop_schedule_option():
+    n = 4096
+    val = ti.ndarray(ti.i32, shape=(n))
+
+    @ti.kernel
+    def fill(val: ti.types.ndarray()):
+        for i in range(val.shape[0]):
+            val[i] = i
+
+    fill(val)
+    assert (val.to_numpy() == range(n)).all()
+
+
+def _test_block_range_for():
+    n = 10007
+    x = ti.ndarray(ti.f32, shape=(n))
+    y = ti.ndarray(ti.f32, shape=(n))
+
+    @ti.kernel
+    def saxpy_and_sum(a: ti.f32, x: ti.types.ndarray(), y: ti.types.ndarray()) -> ti.i32:
+        s = 0
+        ti.loop_config(block_dim=64)
+        for i in range(x.shape[0]):
+            if i % 3 == 0:
+                continue
+            y[i] = a * x[i] + y[i]
+            s += 1  # Thread-local reduction
+        return s
+
+    x.fill(2.0)
+    y.fill(1.0)
+    assert saxpy_and_sum(3.0, x, y) == n - (n + 2) // 3
+    y_np = y.to_numpy()
+    for i in [0, 1, 2, 3, n - 2, n - 1]:
+        assert y_np[i] == (1.0 if i % 3 == 0 else 7.0)
+
+
+@test_utils.test(arch=[ti.cpu], cpu_block_range_for=True)
+def test_block_range_for():
+    _test_block_range_for()
+
+
+@test_utils.test(arch=[ti.cpu], cpu_block_range_for=False)
+def test_block_range_for_disabled():
+    _test_block_range_for()
+
+
+@test_utils.test(arch=[ti.cpu], cpu_block_range_for=True, cpu_loop_schedule="guided")
+def test_block_range_for_guided():
+    _test_block_range_for()
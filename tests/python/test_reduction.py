@@ -163,3 +163,47 @@ def test_reduction_ndarray():
     n = 1024
     x = np.ones(n, dtype=np.int32)
     assert reduce(x) == -n
+
+
+@test_utils.test(require=ti.extension.sparse)
+def test_reduction_struct_for_many_blocks():
+    n = 1 << 16
+    block = ti.root.pointer(ti.i, n // 16)
+    x = ti.field(ti.i32)
+    block.dense(ti.i, 16).place(x)
+    total = ti.field(ti.i32, shape=())
+    maximum = ti.field(ti.i32, shape=())
+
+    @ti.kernel
+    def fill():
+        for i in range(n):
+            if i % 3 != 0:
+                x[i] = i % 7
+
+    @ti.kernel
+    def reduce():
+        for i in x:
+            total[None] += x[i]
+            ti.atomic_max(maximum[None], x[i])
+
+    fill()
+    for _ in range(3):
+        total[None] = 0
+        maximum[None] = 0
+        reduce()
+        assert total[None] == sum(i % 7 for i in range(n) if i % 3 != 0)
+        assert maximum[None] == 6
+
+
+@test_utils.test()
+def test_reduction_small_blocks():
+    @ti.kernel
+    def func(n: ti.i32) -> ti.i32:
+        s = 0
+        ti.loop_config(block_dim=1)
+        for i in range(n):
+            s += i
+        return s
+
+    for n in [1, 7, 1000, 100000]:
+        assert func(n) == n * (n - 1) // 2
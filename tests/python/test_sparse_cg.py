@@ -65,3 +65,49 @@ def test_cg_cuda(ti_dtype):
     assert exit_code == True
     for i in range(n):
         assert x[i] == test_utils.approx(res[i], rel=1.0)
+
+
+@pytest.mark.parametrize("ti_dtype", [ti.f32, ti.f64])
+@pytest.mark.parametrize("method", ["cg", "bicgstab"])
+@pytest.mark.parametrize("preconditioner", [None, "jacobi", "ic0"])
+@test_utils.test(arch=[ti.cpu])
+def test_iterative_solver(ti_dtype, method, preconditioner):
+    # A 2D Poisson matrix with a varying diagonal
+    grid = 16
+    n = grid * grid
+    Abuilder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=5 * n, dtype=ti_dtype)
+    b = ti.ndarray(dtype=ti_dtype, shape=n)
+    x = ti.ndarray(dtype=ti_dtype, shape=n)
+
+    @ti.kernel
+    def fill(Abuilder: ti.types.sparse_matrix_builder(), b: ti.types.ndarray()):
+        for i, j in ti.ndrange(grid, grid):
+            row = i * grid + j
+            Abuilder[row, row] += 4.0 + 0.01 * (row % 7)
+            if i > 0:
+                Abuilder[row, row - grid] += -1.0
+            if i < grid - 1:
+                Abuilder[row, row + grid] += -1.0
+            if j > 0:
+                Abuilder[row, row - 1] += -1.0
+            if j < grid - 1:
+                Abuilder[row, row + 1] += -1.0
+            b[row] = ti.sin(0.1 * row)
+
+    fill(Abuilder, b)
+    A = Abuilder.build()
+    rtol = 1e-4 if ti_dtype == ti.f32 else 1e-10
+    solver = ti.linalg.IterativeSolver(method=method, preconditioner=preconditioner, max_iter=500, rtol=rtol)
+    solver.compute(A)
+    x.fill(0)
+    assert solver.solve(b, x)
+    residuals = solver.residuals
+    assert len(residuals) == solver.iterations + 1
+    assert residuals[-1] <= rtol * np.linalg.norm(b.to_numpy())
+    res = (A @ x).to_numpy()
+    np.testing.assert_allclose(res, b.to_numpy(), atol=100 * rtol)
+
+    # Warm starting from the solution takes fewer iterations
+    cold_iterations = solver.iterations
+    assert solver.solve(b, x)
+    assert solver.iterations < cold_iterations
@@ -174,3 +174,36 @@ def test_gpu_sparse_solver2(dtype, solver_type):
     res = np.linalg.solve(A_psd, b.to_numpy())
     for i in range(n):
         assert x[i] == test_utils.approx(res[i], rel=1.0)
+
+
+@pytest.mark.parametrize("dtype", [ti.f32, ti.f64])
+@pytest.mark.parametrize("solver_type", ["LLT", "LDLT", "LU"])
+@test_utils.test(arch=ti.cpu)
+def test_sparse_solver_refill(dtype, solver_type):
+    np_dtype = ti.lang.util.to_numpy_type(dtype)
+    n = 10
+    Abuilder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=100, dtype=dtype)
+    b = ti.ndarray(dtype=dtype, shape=n)
+    b.from_numpy(np.arange(1, n + 1).astype(np_dtype))
+
+    @ti.kernel
+    def fill(Abuilder: ti.types.sparse_matrix_builder(), InputArray: ti.types.ndarray()):
+        for i, j in ti.ndrange(n, n):
+            Abuilder[i, j] += InputArray[i, j]
+
+    solver = ti.linalg.SparseSolver(dtype=dtype, solver_type=solver_type)
+    A = None
+    for _ in range(3):
+        M = np.random.rand(n, n)
+        M_psd = (np.dot(M, M.transpose()) + np.eye(n)).astype(np_dtype)
+        fill(Abuilder, M_psd)
+        if A is None:
+            A = Abuilder.build()
+        else:
+            Abuilder.refill(A)
+        solver.compute(A)
+        x = solver.solve(b)
+        res = np.linalg.solve(M_psd, b.to_numpy())
+        x = x.to_numpy()
+        for i in range(n):
+            assert x[i] == test_utils.approx(res[i], rel=1.0)
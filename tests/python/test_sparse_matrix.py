@@ -409,6 +409,40 @@ def test_sparse_matrix_ndarray_vector_multiplication(dtype, storage_format):
     assert res_n[1] == 3.0
 
 
+@pytest.mark.parametrize(
+    "dtype, storage_format",
+    [
+        (ti.f32, "col_major"),
+        (ti.f32, "row_major"),
+        (ti.f64, "col_major"),
+        (ti.f64, "row_major"),
+    ],
+)
+@test_utils.test(arch=ti.cpu, cpu_max_num_threads=4)
+def test_sparse_matrix_ndarray_vector_multiplication_parallel(dtype, storage_format):
+    import numpy as np
+
+    # Enough nonzeros to split the product between the CPU threads
+    n = 100000
+    Abuilder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=5 * n, dtype=dtype, storage_format=storage_format)
+
+    @ti.kernel
+    def fill(Abuilder: ti.types.sparse_matrix_builder()):
+        for i in range(n):
+            for k in ti.static(range(-2, 3)):
+                Abuilder[i, (i + k + n) % n] += (k + 3) * 0.5
+
+    fill(Abuilder)
+    A = Abuilder.build()
+    np_dtype = ti.lang.util.to_numpy_type(dtype)
+    x_np = np.random.rand(n).astype(np_dtype)
+    x = ti.ndarray(dtype, n)
+    x.from_numpy(x_np)
+    res = (A @ x).to_numpy()
+    expected = sum((k + 3) * 0.5 * np.roll(x_np, -k) for k in range(-2, 3))
+    np.testing.assert_allclose(res, expected, rtol=1e-5)
+
+
 @test_utils.test(arch=ti.cuda)
 def test_gpu_sparse_matrix():
     import numpy as np
@@ -519,3 +553,58 @@ def test_gpu_sparse_matrix_ops(N):
     H = A @ B.transpose()
     S8 = S1 @ S2.T
     verify(S8, H)
+
+
+@pytest.mark.parametrize(
+    "dtype, storage_format",
+    [
+        (ti.f32, "col_major"),
+        (ti.f32, "row_major"),
+        (ti.f64, "col_major"),
+        (ti.f64, "row_major"),
+    ],
+)
+@test_utils.test(arch=ti.cpu)
+def test_sparse_matrix_builder_refill(dtype, storage_format):
+    n = 8
+    Abuilder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=300, dtype=dtype, storage_format=storage_format)
+
+    @ti.kernel
+    def fill(Abuilder: ti.types.sparse_matrix_builder(), scale: ti.f32):
+        for i in range(n):
+            Abuilder[i, i] += scale
+            Abuilder[i, i] += scale
+            Abuilder[i, (i + 1) % n] += scale * i
+
+    @ti.kernel
+    def fill_dense(Abuilder: ti.types.sparse_matrix_builder()):
+        for i, j in ti.ndrange(n, n):
+            Abuilder[i, j] += i + j
+
+    fill(Abuilder, 1.0)
+    A = Abuilder.build()
+    pattern_id = A.matrix.get_pattern_id()
+    # The values change in place while the pattern stays the same
+    for scale in [2.0, 3.0]:
+        fill(Abuilder, scale)
+        Abuilder.refill(A)
+        assert A.matrix.get_pattern_id() == pattern_id
+        for i in range(n):
+            assert A[i, i] == 2 * scale
+            assert A[i, (i + 1) % n] == scale * i
+            assert A[i, (i + 2) % n] == 0
+    # New entries rebuild the matrix
+    fill_dense(Abuilder)
+    Abuilder.refill(A)
+    assert A.matrix.get_pattern_id() != pattern_id
+    for i in range(n):
+        for j in range(n):
+            assert A[i, j] == i + j
+    # Fewer entries keep the pattern, and the dropped ones become zeros
+    pattern_id = A.matrix.get_pattern_id()
+    fill(Abuilder, 1.0)
+    Abuilder.refill(A)
+    assert A.matrix.get_pattern_id() == pattern_id
+    for i in range(n):
+        assert A[i, i] == 2
+        assert A[i, (i + 2) % n] == 0
@@ -1,3 +1,7 @@
+import os
+
+import pytest
+
 import taichi as ti
 from tests import test_utils
 
@@ -78,3 +82,38 @@ def test_nested_struct_fill_and_clear():
     for i in range(10):
         task()
         ti.sync()
+
+
+def _physical_memory_GB():
+    return os.sysconf("SC_PAGE_SIZE") * os.sysconf("SC_PHYS_PAGES") / 2**30
+
+
+@pytest.mark.run_in_serial
+@pytest.mark.skipif(
+    not hasattr(os, "sysconf") or _physical_memory_GB() < 256,
+    reason="Needs a host with at least 256 GB of memory.",
+)
+@test_utils.test(arch=[ti.cpu])
+def test_struct_for_more_than_2_31_elements():
+    num_cells_per_block = 2**17
+    # Activates 2^31 + 2^24 leaf cells, more than an i32 element list holds.
+    num_active_blocks = 2**14 + 2**7
+    x = ti.field(ti.u8)
+    s = ti.field(ti.i64, shape=())
+    blocks = ti.root.pointer(ti.i, 2**15)
+    blocks.pointer(ti.j, num_cells_per_block).dense(ti.j, 1).place(x)
+
+    @ti.kernel
+    def activate():
+        for i in range(num_active_blocks):
+            for j in range(num_cells_per_block):
+                x[i, j] = 1
+
+    @ti.kernel
+    def count():
+        for i, j in x:
+            s[None] += ti.cast(x[i, j], ti.i64)
+
+    activate()
+    count()
+    assert s[None] == num_active_blocks * num_cells_per_block
@@ -1,3 +1,5 @@
+import numpy as np
+
 import taichi as ti
 from tests import test_utils
 
@@ -312,3 +314,90 @@ def test_struct_for_continue():
     init()
     assert struct_for_continue() == n * (n - 1)
     assert range_for_continue() == n * (n - 1)
+
+
+def _test_dense_struct_for_simd():
+    n, m = 37, 29
+    a = ti.field(ti.f32)
+    b = ti.field(ti.f64)
+    c = ti.field(ti.i32)
+    # Non-contiguous accesses to a and b from the loops over c
+    ti.root.dense(ti.ij, (n, m)).place(a, b)
+    ti.root.dense(ti.ij, (m, n)).place(c)
+
+    @ti.kernel
+    def fill():
+        for i, j in a:
+            a[i, j] = i * 0.5 + j
+            b[i, j] = i - j * 0.25
+        for i, j in c:
+            c[i, j] = i * n + j
+
+    @ti.kernel
+    def stencil():
+        for i, j in c:
+            if 0 < j < n - 1:
+                c[i, j] += ti.cast(a[j - 1, i] + a[j + 1, i] - b[j, i], ti.i32)
+
+    @ti.kernel
+    def reduce() -> ti.f64:
+        s = 0.0
+        for i, j in b:
+            s += b[i, j] * a[i, j]
+        return s
+
+    fill()
+    stencil()
+    expected_sum = 0.0
+    for i in range(n):
+        for j in range(m):
+            expected_sum += (i - j * 0.25) * (i * 0.5 + j)
+    assert reduce() == test_utils.approx(expected_sum, rel=1e-6)
+    c_np = c.to_numpy()
+    for i in range(m):
+        for j in range(n):
+            expected = i * n + j
+            if 0 < j < n - 1:
+                expected += int((j - 1) * 0.5 + i + (j + 1) * 0.5 + i - (j - i * 0.25))
+            assert c_np[i, j] == expected
+
+
+@test_utils.test(arch=ti.cpu, demote_dense_struct_fors=False)
+def test_dense_struct_for_simd():
+    _test_dense_struct_for_simd()
+
+
+@test_utils.test(arch=ti.cpu, demote_dense_struct_fors=False, simd_width=1)
+def test_dense_struct_for_simd_disabled():
+    _test_dense_struct_for_simd()
+
+
+@test_utils.test(arch=ti.cpu)
+def test_dense_struct_for_simd_demoted():
+    _test_dense_struct_for_simd()
+
+
+@test_utils.test(arch=ti.cpu)
+def test_ndarray_range_for_simd():
+    # Range-fors that are not demoted struct-fors are left to the cost model
+    n = 1003
+    x = ti.ndarray(ti.f32, shape=n)
+    y = ti.ndarray(ti.f32, shape=n)
+
+    @ti.kernel
+    def saxpy(x: ti.types.ndarray(ndim=1), y: ti.types.ndarray(ndim=1)):
+        for i in x:
+            y[i] = 2.0 * x[i] + y[i]
+
+    @ti.kernel
+    def total(y: ti.types.ndarray(ndim=1)) -> ti.f32:
+        s = 0.0
+        for i in range(n):
+            s += y[i]
+        return s
+
+    x.from_numpy(np.arange(n, dtype=np.float32))
+    y.from_numpy(np.ones(n, dtype=np.float32))
+    saxpy(x, y)
+    np.testing.assert_allclose(y.to_numpy(), 2.0 * np.arange(n) + 1.0)
+    assert total(y) == test_utils.approx(n * (n - 1) + n, rel=1e-5)
@@ -7,3 +7,82 @@ from tests import test_utils
 @test_utils.test(arch=get_host_arch_list())
 def test_while():
     assert ti._lib.core.test_threading()
+
+
+@test_utils.test(arch=get_host_arch_list())
+def test_work_stealing_threading():
+    assert ti._lib.core.test_work_stealing_threading()
+
+
+@test_utils.test(arch=ti.cpu, cpu_thread_pool="work_stealing")
+def test_work_stealing_thread_pool_kernels():
+    n = 100000
+    x = ti.field(ti.i32, shape=n)
+    s = ti.field(ti.i64, shape=())
+
+    @ti.kernel
+    def fill():
+        for i in range(n):
+            x[i] = i
+
+    @ti.kernel
+    def reduce():
+        for i in x:
+            s[None] += x[i]
+
+    for _ in range(10):
+        s[None] = 0
+        fill()
+        reduce()
+        assert s[None] == n * (n - 1) // 2
+
+
+@test_utils.test(arch=ti.cpu, cpu_huge_pages=True, cpu_numa_first_touch=True)
+def test_huge_pages_and_first_touch():
+    # Large enough to be first-touched and backed by huge pages.
+    n = 4 * 1024 * 1024
+    x = ti.field(ti.i32, shape=n)
+    y = ti.ndarray(ti.i32, shape=n)
+
+    @ti.kernel
+    def fill(y: ti.types.ndarray()):
+        for i in x:
+            x[i] += i
+            y[i] += 2 * i
+
+    fill(y)
+    assert x[n - 1] == n - 1
+    assert y[n - 1] == 2 * (n - 1)
+    assert x.to_numpy().sum() == n * (n - 1) // 2
+
+
+
+def _test_kernel_profiler_thread_metrics():
+    n = 100000
+    x = ti.field(ti.f32, shape=n)
+
+    @ti.kernel
+    def fill():
+        for i in range(n):
+            x[i] = ti.sin(i * 0.1)
+
+    fill()
+    ti.profiler.clear_kernel_profiler_info()
+    for _ in range(10):
+        fill()
+    result = ti.profiler.query_kernel_profiler_info(fill.__name__)
+    assert result.counter == 10
+    assert result.num_blocks > 1
+    assert result.load_imbalance >= 1.0
+    assert len(result.thread_busy_time) == 4
+    assert sum(result.thread_busy_time) > 0
+
+
+@test_utils.test(arch=ti.cpu, kernel_profiler=True, cpu_max_num_threads=4)
+def test_kernel_profiler_thread_metrics():
+    _test_kernel_profiler_thread_metrics()
+
+
+@test_utils.test(arch=ti.cpu, kernel_profiler=True, cpu_max_num_threads=4, cpu_thread_pool="work_stealing")
+def test_kernel_profiler_thread_metrics_work_stealing():
+    _test_kernel_profiler_thread_metrics()